@@ -0,0 +1,462 @@
+////////////////////////////////////////////////////////////////////////////////
+// Assembly micro-benchmarks on generated meshes, results are written as json
+////////////////////////////////////////////////////////////////////////////////
+#include <CLI/CLI.hpp>
+
+#include <polyfem/State.hpp>
+#include <polyfem/assembler/AssemblerUtils.hpp>
+#include <polyfem/assembler/AssemblyValsCache.hpp>
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
+
+#include <igl/Timer.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace polyfem;
+using namespace polyfem::assembler;
+
+namespace
+{
+	// counts the calls to the global allocator while enabled, from any thread
+	std::atomic<bool> count_allocations(false);
+	std::atomic<size_t> n_allocations(0);
+	std::atomic<size_t> allocated_bytes(0);
+
+	struct Measurement
+	{
+		double min_time = 0;
+		double median_time = 0;
+		size_t allocations = 0;
+		size_t allocated_bytes = 0;
+	};
+
+	// runs fun once to warm up the caches (eg, the sparsity of the hessian),
+	// then times repeats runs and counts the allocations of one more run
+	Measurement measure(const int repeats, const std::function<void()> &fun)
+	{
+		fun();
+
+		std::vector<double> times;
+		igl::Timer timer;
+		for (int r = 0; r < std::max(1, repeats); ++r)
+		{
+			timer.start();
+			fun();
+			timer.stop();
+			times.push_back(timer.getElapsedTime());
+		}
+		std::sort(times.begin(), times.end());
+
+		Measurement res;
+		res.min_time = times.front();
+		res.median_time = times[times.size() / 2];
+
+		n_allocations = 0;
+		allocated_bytes = 0;
+		count_allocations = true;
+		fun();
+		count_allocations = false;
+		res.allocations = n_allocations;
+		res.allocated_bytes = allocated_bytes;
+
+		return res;
+	}
+
+	// regular grid of the unit square/cube with n elements per side
+	// tri and tet are the Freudenthal split of quad and hex, so the meshes are conforming
+	void generate_mesh(const std::string &type, const int n, Eigen::MatrixXd &V, Eigen::MatrixXi &F)
+	{
+		const int n1 = n + 1;
+		if (type == "tri" || type == "quad")
+		{
+			V.resize(n1 * n1, 2);
+			for (int j = 0; j < n1; ++j)
+				for (int i = 0; i < n1; ++i)
+					V.row(j * n1 + i) << double(i) / n, double(j) / n;
+
+			const auto vid = [n1](int i, int j) { return j * n1 + i; };
+			const bool is_tri = type == "tri";
+			F.resize(n * n * (is_tri ? 2 : 1), is_tri ? 3 : 4);
+			int index = 0;
+			for (int j = 0; j < n; ++j)
+			{
+				for (int i = 0; i < n; ++i)
+				{
+					if (is_tri)
+					{
+						F.row(index++) << vid(i, j), vid(i + 1, j), vid(i + 1, j + 1);
+						F.row(index++) << vid(i, j), vid(i + 1, j + 1), vid(i, j + 1);
+					}
+					else
+						F.row(index++) << vid(i, j), vid(i + 1, j), vid(i + 1, j + 1), vid(i, j + 1);
+				}
+			}
+			return;
+		}
+
+		assert(type == "tet" || type == "hex");
+		V.resize(n1 * n1 * n1, 3);
+		for (int k = 0; k < n1; ++k)
+			for (int j = 0; j < n1; ++j)
+				for (int i = 0; i < n1; ++i)
+					V.row((k * n1 + j) * n1 + i) << double(i) / n, double(j) / n, double(k) / n;
+
+		const auto vid = [n1](int i, int j, int k) { return (k * n1 + j) * n1 + i; };
+		const bool is_tet = type == "tet";
+		F.resize(n * n * n * (is_tet ? 6 : 1), is_tet ? 4 : 8);
+
+		// the six monotone paths from (0,0,0) to (1,1,1)
+		static const std::array<std::array<int, 3>, 6> axis_orders = {{{{0, 1, 2}}, {{0, 2, 1}}, {{1, 0, 2}}, {{1, 2, 0}}, {{2, 0, 1}}, {{2, 1, 0}}}};
+
+		int index = 0;
+		for (int k = 0; k < n; ++k)
+		{
+			for (int j = 0; j < n; ++j)
+			{
+				for (int i = 0; i < n; ++i)
+				{
+					if (!is_tet)
+					{
+						// msh ordering
+						F.row(index++) << vid(i, j, k), vid(i + 1, j, k), vid(i + 1, j + 1, k), vid(i, j + 1, k),
+							vid(i, j, k + 1), vid(i + 1, j, k + 1), vid(i + 1, j + 1, k + 1), vid(i, j + 1, k + 1);
+						continue;
+					}
+
+					for (const auto &order : axis_orders)
+					{
+						std::array<int, 3> c = {{i, j, k}};
+						Eigen::Vector4i tet;
+						tet(0) = vid(c[0], c[1], c[2]);
+						for (int l = 0; l < 3; ++l)
+						{
+							++c[order[l]];
+							tet(l + 1) = vid(c[0], c[1], c[2]);
+						}
+
+						Eigen::Matrix3d jac;
+						for (int l = 0; l < 3; ++l)
+							jac.row(l) = V.row(tet(l + 1)) - V.row(tet(0));
+						if (jac.determinant() < 0)
+							std::swap(tet(1), tet(2));
+
+						F.row(index++) = tet.transpose();
+					}
+				}
+			}
+		}
+	}
+
+	bool is_simplex(const std::string &mesh_type)
+	{
+		return mesh_type == "tri" || mesh_type == "tet";
+	}
+
+	json material_args(const std::string &formulation)
+	{
+		if (formulation == "Laplacian")
+			return json({{"type", "Laplacian"}});
+		if (formulation == "Stokes")
+			return json({{"type", "Stokes"}, {"viscosity", 1}});
+		if (formulation == "MultiModels")
+		{
+			// two halves of the domain, see the volume selection in run_case
+			return json::array({{{"id", 1}, {"type", "NeoHookean"}, {"E", 1e5}, {"nu", 0.3}},
+								{{"id", 2}, {"type", "LinearElasticity"}, {"E", 1e5}, {"nu", 0.3}}});
+		}
+
+		return json({{"type", formulation}, {"E", 1e5}, {"nu", 0.3}});
+	}
+
+	struct BenchCase
+	{
+		std::string mesh_type;
+		int n;
+		int order;
+		std::string formulation;
+		int n_threads;
+	};
+
+	void run_case(const BenchCase &bc, const int repeats, const spdlog::level::level_enum log_level, json &results)
+	{
+		Eigen::MatrixXd V;
+		Eigen::MatrixXi F;
+		generate_mesh(bc.mesh_type, bc.n, V, F);
+
+		// the generated mesh is handed to the loader by name instead of read from a file
+		const std::string mesh_name = fmt::format("{}_{}.msh", bc.mesh_type, bc.n);
+		json geometry = {{"mesh", mesh_name}};
+		if (bc.formulation == "MultiModels")
+		{
+			// two bodies, split at x = 0.5, the first matching selection gives the id
+			const int dim = V.cols();
+			std::vector<double> min(dim, 0), mid(dim, 1), max(dim, 1);
+			mid[0] = 0.5;
+			geometry["volume_selection"] = json::array({{{"id", 1}, {"box", {min, mid}}},
+														{{"id", 2}, {"box", {min, max}}}});
+		}
+
+		json in_args = json({});
+		in_args["geometry"] = json::array({geometry});
+		in_args["space"] = {{"discr_order", bc.order}};
+		in_args["materials"] = material_args(bc.formulation);
+
+		State state(bc.n_threads);
+		state.init_logger("", log_level, false);
+		state.init(in_args, true);
+
+		state.load_mesh(/*non_conforming=*/false, {mesh_name}, {F}, {V});
+		state.build_basis();
+
+		const Formulation formulation(state.formulation());
+		const bool is_volume = state.mesh->is_volume();
+		const int n_elements = state.mesh->n_elements();
+		const int dim = AssemblerUtils::is_scalar(formulation) ? 1 : state.mesh->dimension();
+
+		const auto add_result = [&](const std::string &operation, const Measurement &m) {
+			json r;
+			r["mesh"] = bc.mesh_type;
+			r["n"] = bc.n;
+			r["order"] = bc.order;
+			r["space"] = (is_simplex(bc.mesh_type) ? "P" : "Q") + std::to_string(bc.order);
+			r["formulation"] = bc.formulation;
+			r["threads"] = bc.n_threads;
+			r["operation"] = operation;
+			r["n_elements"] = n_elements;
+			r["n_bases"] = state.n_bases;
+			r["repeats"] = repeats;
+			r["min_time"] = m.min_time;
+			r["median_time"] = m.median_time;
+			r["elements_per_second"] = m.median_time > 0 ? n_elements / m.median_time : 0.;
+			r["allocations"] = m.allocations;
+			r["allocated_bytes"] = m.allocated_bytes;
+			results.push_back(r);
+
+			// progress goes to stderr, stdout is reserved for the json
+			std::cerr << fmt::format(
+				"{:>4} {:>3} {:>16} {:>2}t {:>14}: {:>10.3e}s {:>12.4g} el/s {:>8} allocs",
+				bc.mesh_type, r["space"].get<std::string>(), bc.formulation, bc.n_threads, operation,
+				m.median_time, r["elements_per_second"].get<double>(), m.allocations)
+					  << std::endl;
+		};
+
+		{
+			AssemblyValsCache cache;
+			add_result("cache_init", measure(repeats, [&]() {
+						   cache.init(is_volume, state.bases, state.geom_bases());
+					   }));
+
+			// deep copy of every element against borrowing the stored values, the second should not allocate
+			assembler::ElementAssemblyValues vals;
+			add_result("cache_copy", measure(repeats, [&]() {
+						   for (int e = 0; e < n_elements; ++e)
+							   cache.compute(e, is_volume, state.bases[e], state.geom_bases()[e], vals);
+					   }));
+			add_result("cache_borrow", measure(repeats, [&]() {
+						   for (int e = 0; e < n_elements; ++e)
+							   cache.get(e, is_volume, state.bases[e], state.geom_bases()[e], vals);
+					   }));
+		}
+
+		if (AssemblerUtils::is_linear(formulation))
+		{
+			StiffnessMatrix stiffness;
+			add_result("assemble", measure(repeats, [&]() {
+						   state.assembler.assemble_problem(
+							   formulation, is_volume, state.n_bases,
+							   state.bases, state.geom_bases(), state.ass_vals_cache, stiffness);
+					   }));
+		}
+
+		if (AssemblerUtils::is_mixed(formulation))
+		{
+			StiffnessMatrix mixed_stiffness;
+			add_result("assemble_mixed", measure(repeats, [&]() {
+						   state.assembler.assemble_mixed_problem(
+							   formulation, is_volume, state.n_pressure_bases, state.n_bases,
+							   state.pressure_bases, state.bases, state.geom_bases(),
+							   state.pressure_ass_vals_cache, state.ass_vals_cache, mixed_stiffness);
+					   }));
+		}
+
+		if (AssemblerUtils::is_solution_displacement(formulation))
+		{
+			Eigen::MatrixXd disp(state.n_bases * dim, 1);
+			disp.setRandom();
+			disp *= 1e-3;
+
+			double energy = 0;
+			add_result("energy", measure(repeats, [&]() {
+						   energy += state.assembler.assemble_energy(
+							   formulation, is_volume, state.bases, state.geom_bases(),
+							   state.ass_vals_cache, 0, disp, Eigen::MatrixXd());
+					   }));
+
+			Eigen::MatrixXd grad;
+			add_result("gradient", measure(repeats, [&]() {
+						   state.assembler.assemble_energy_gradient(
+							   formulation, is_volume, state.n_bases, state.bases, state.geom_bases(),
+							   state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), grad);
+					   }));
+
+			utils::SpareMatrixCache mat_cache;
+			StiffnessMatrix hessian;
+			add_result("hessian", measure(repeats, [&]() {
+						   state.assembler.assemble_energy_hessian(
+							   formulation, is_volume, state.n_bases, false, state.bases, state.geom_bases(),
+							   state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), mat_cache, hessian);
+					   }));
+
+			add_result("energy_gradient_hessian", measure(repeats, [&]() {
+						   double e;
+						   state.assembler.assemble_energy_gradient_hessian(
+							   formulation, is_volume, state.n_bases, false, state.bases, state.geom_bases(),
+							   state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), &e, &grad, mat_cache, &hessian);
+						   energy += e;
+					   }));
+		}
+	}
+
+	// speedup of every result with respect to the run with the fewest threads of the same case
+	void add_thread_scaling(json &results)
+	{
+		const auto key = [](const json &r) {
+			return fmt::format("{}/{}/{}/{}/{}", r["mesh"].get<std::string>(), r["n"].get<int>(), r["order"].get<int>(),
+							   r["formulation"].get<std::string>(), r["operation"].get<std::string>());
+		};
+
+		std::map<std::string, std::pair<int, double>> reference;
+		for (const auto &r : results)
+		{
+			const int threads = r["threads"];
+			auto it = reference.find(key(r));
+			if (it == reference.end() || threads < it->second.first)
+				reference[key(r)] = std::make_pair(threads, r["median_time"].get<double>());
+		}
+
+		for (auto &r : results)
+		{
+			const auto &ref = reference.at(key(r));
+			const double time = r["median_time"];
+			r["speedup"] = time > 0 ? ref.second / time : 0.;
+			r["parallel_efficiency"] = time > 0 ? ref.second / time * ref.first / r["threads"].get<int>() : 0.;
+		}
+	}
+} // namespace
+
+void *operator new(std::size_t size)
+{
+	if (count_allocations)
+	{
+		++n_allocations;
+		allocated_bytes += size;
+	}
+
+	if (void *ptr = std::malloc(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+int main(int argc, char **argv)
+{
+	CLI::App command_line{"polyfem assembly benchmarks"};
+
+	std::vector<std::string> mesh_types = {"tri", "quad", "tet", "hex"};
+	command_line.add_option("--meshes", mesh_types, "Mesh types to generate")
+		->check(CLI::IsMember({"tri", "quad", "tet", "hex"}));
+
+	int n_2d = 64;
+	command_line.add_option("--n_2d", n_2d, "Number of elements per side of the 2D grids")->check(CLI::PositiveNumber);
+
+	int n_3d = 12;
+	command_line.add_option("--n_3d", n_3d, "Number of elements per side of the 3D grids")->check(CLI::PositiveNumber);
+
+	std::vector<int> orders = {1, 2};
+	command_line.add_option("--orders", orders, "Discretization orders, P1-P4 on simplices and Q1-Q2 on quads/hexes")->check(CLI::Range(1, 4));
+
+	std::vector<std::string> formulations = {"Laplacian", "LinearElasticity", "NeoHookean", "SaintVenant", "MultiModels", "Stokes"};
+	command_line.add_option("--formulations", formulations, "Formulations to benchmark")
+		->check(CLI::IsMember({"Laplacian", "LinearElasticity", "NeoHookean", "SaintVenant", "MultiModels", "Stokes"}));
+
+	std::vector<int> threads = {1, int(std::max(1u, std::thread::hardware_concurrency()))};
+	command_line.add_option("--threads", threads, "Thread counts, used for the thread scaling")->check(CLI::PositiveNumber);
+
+	int repeats = 5;
+	command_line.add_option("--repeats", repeats, "Number of timed runs per operation")->check(CLI::PositiveNumber);
+
+	std::string output = "";
+	command_line.add_option("-o,--output", output, "Output json file, stdout if empty");
+
+	const std::vector<std::pair<std::string, spdlog::level::level_enum>>
+		SPDLOG_LEVEL_NAMES_TO_LEVELS = {
+			{"trace", spdlog::level::trace},
+			{"debug", spdlog::level::debug},
+			{"info", spdlog::level::info},
+			{"warning", spdlog::level::warn},
+			{"error", spdlog::level::err},
+			{"critical", spdlog::level::critical},
+			{"off", spdlog::level::off}};
+	spdlog::level::level_enum log_level = spdlog::level::err;
+	command_line.add_option("--log_level", log_level, "Log level of the simulation setup")
+		->transform(CLI::CheckedTransformer(SPDLOG_LEVEL_NAMES_TO_LEVELS, CLI::ignore_case));
+
+	CLI11_PARSE(command_line, argc, argv);
+
+	std::sort(threads.begin(), threads.end());
+	threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+
+	json results = json::array();
+	for (const auto &mesh_type : mesh_types)
+	{
+		const int n = (mesh_type == "tri" || mesh_type == "quad") ? n_2d : n_3d;
+		for (const int order : orders)
+		{
+			if (!is_simplex(mesh_type) && order > 2)
+				continue;
+
+			for (const auto &formulation : formulations)
+			{
+				for (const int n_threads : threads)
+					run_case({mesh_type, n, order, formulation, n_threads}, repeats, log_level, results);
+			}
+		}
+	}
+	add_thread_scaling(results);
+
+	json out;
+	out["hardware_concurrency"] = std::thread::hardware_concurrency();
+	out["repeats"] = repeats;
+	out["results"] = results;
+
+	if (output.empty())
+		std::cout << out.dump(1, '\t') << std::endl;
+	else
+	{
+		std::ofstream file(output);
+		if (!file.is_open())
+		{
+			logger().error("unable to open {}", output);
+			return EXIT_FAILURE;
+		}
+		file << out.dump(1, '\t') << std::endl;
+	}
+
+	return EXIT_SUCCESS;
+}
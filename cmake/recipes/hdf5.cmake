@@ -24,6 +24,18 @@ option(HDF5_TEST_VFD OFF)
 #To prevent changes in the oput dirs
 set (HDF5_EXTERNALLY_CONFIGURED 1)
 
+# Deflate filter (/output/hdf5/compression_level), built against the zlib recipe. Setting H5_ZLIB_HEADER
+# makes HDF5 take the zlib configured here instead of looking for one on the system.
+if(POLYFEM_WITH_ZLIB)
+    include(zlib)
+    set(HDF5_ENABLE_Z_LIB_SUPPORT ON CACHE BOOL "Enable Zlib Filters" FORCE)
+    set(H5_ZLIB_HEADER "zlib.h")
+    set(ZLIB_STATIC_LIBRARY ZLIB::ZLIB)
+    get_target_property(ZLIB_INCLUDE_DIRS ZLIB::ZLIB INTERFACE_INCLUDE_DIRECTORIES)
+else()
+    set(HDF5_ENABLE_Z_LIB_SUPPORT OFF CACHE BOOL "Enable Zlib Filters" FORCE)
+endif()
+
 include(FetchContent)
 FetchContent_Declare(
     hdf5
@@ -0,0 +1,25 @@
+# LZ4 (https://github.com/lz4/lz4)
+# License: BSD-2-Clause
+
+if(TARGET LZ4::lz4)
+    return()
+endif()
+
+message(STATUS "Third-party: creating target 'LZ4::lz4'")
+
+include(FetchContent)
+FetchContent_Declare(
+    lz4
+    GIT_REPOSITORY https://github.com/lz4/lz4.git
+    GIT_TAG v1.9.4
+    GIT_SHALLOW TRUE
+)
+
+FetchContent_GetProperties(lz4)
+if(NOT lz4_POPULATED)
+    FetchContent_Populate(lz4)
+endif()
+
+add_library(polyfem_lz4 "${lz4_SOURCE_DIR}/lib/lz4.c")
+target_include_directories(polyfem_lz4 SYSTEM PUBLIC "${lz4_SOURCE_DIR}/lib")
+add_library(LZ4::lz4 ALIAS polyfem_lz4)
@@ -328,7 +328,7 @@ namespace polyfem
 		logger().trace("Done (took {}s)", timer.getElapsedTime());
 	}
 
-	std::string State::formulation() const
+	std::string State::formulation_from_materials() const
 	{
 		if (args["materials"].is_null())
 		{
@@ -556,6 +556,9 @@ namespace polyfem
 
 	void State::build_basis()
 	{
+		// the timesteps written in the background read the bases
+		flush_export();
+
 		if (!mesh)
 		{
 			logger().error("Load the mesh first!");
@@ -579,7 +582,7 @@ namespace polyfem
 		sol.resize(0, 0);
 		pressure.resize(0, 0);
 
-		if (formulation() == "MultiModels")
+		if (formulation().type() == AssemblerType::MultiModels)
 		{
 			assert(args["materials"].is_array());
 
@@ -876,17 +879,26 @@ namespace polyfem
 		logger().info("n pressure bases: {}", n_pressure_bases);
 
 		ass_vals_cache.clear();
-		if (n_bases <= args["solver"]["advanced"]["cache_size"])
-		{
-			timer.start();
-			logger().info("Building cache...");
-			ass_vals_cache.init(mesh->is_volume(), bases, curret_bases);
-			if (assembler.is_mixed(formulation()))
-				pressure_ass_vals_cache.init(mesh->is_volume(), pressure_bases, curret_bases);
+		pressure_ass_vals_cache.clear();
+		AssemblyValsCache::StorageMode cache_mode = AssemblyValsCache::storage_mode_from_string(args["solver"]["advanced"]["cache_mode"].get<std::string>());
+		if (n_bases > args["solver"]["advanced"]["cache_size"])
+			cache_mode = AssemblyValsCache::StorageMode::None;
 
-			logger().info(" took {}s", timer.getElapsedTime());
-		}
+		timer.start();
+		logger().info("Building cache ({})...", AssemblyValsCache::to_string(cache_mode));
+		ass_vals_cache.init(mesh->is_volume(), bases, curret_bases, cache_mode);
+		if (assembler.is_mixed(formulation()))
+			pressure_ass_vals_cache.init(mesh->is_volume(), pressure_bases, curret_bases, cache_mode);
+		timer.stop();
+
+		const size_t cache_memory = ass_vals_cache.memory() + pressure_ass_vals_cache.memory();
+		logger().info(" took {}s, {} MiB", timer.getElapsedTime(), cache_memory / double(1024 * 1024));
+		stats.assembly_cache_info = {
+			{"mode", AssemblyValsCache::to_string(cache_mode)},
+			{"memory", cache_memory},
+			{"time_building", timer.getElapsedTime()}};
 
+		out_geom.clear_vis_meshes();
 		out_geom.build_grid(*mesh, args["output"]["advanced"]["sol_on_grid"]);
 
 		if (!problem->is_time_dependent() && boundary_nodes.empty())
@@ -1030,7 +1042,7 @@ namespace polyfem
 			logger().error("Build the bases first!");
 			return;
 		}
-		if (formulation() == "OperatorSplitting")
+		if (formulation().type() == AssemblerType::OperatorSplitting)
 		{
 			stiffness.resize(1, 1);
 			timings.assembling_stiffness_mat_time = 0;
@@ -1145,6 +1157,9 @@ namespace polyfem
 
 	void State::assemble_rhs()
 	{
+		// the timesteps written in the background read the rhs
+		flush_export();
+
 		if (!mesh)
 		{
 			logger().error("Load the mesh first!");
@@ -1162,7 +1177,7 @@ namespace polyfem
 		// 	rhs_path = resolve_input_path(args["boundary_conditions"]["rhs"]);
 
 		json p_params = {};
-		p_params["formulation"] = formulation();
+		p_params["formulation"] = formulation().name();
 		{
 			RowVectorNd min, max, delta;
 			mesh->bounding_box(min, max);
@@ -1192,13 +1207,13 @@ namespace polyfem
 			const int prev_size = rhs.size();
 			const int n_larger = n_pressure_bases + (use_avg_pressure ? (assembler.is_fluid(formulation()) ? 1 : 0) : 0);
 			rhs.conservativeResize(prev_size + n_larger, rhs.cols());
-			if (formulation() == "OperatorSplitting")
+			if (formulation().type() == AssemblerType::OperatorSplitting)
 			{
 				timings.assigning_rhs_time = 0;
 				return;
 			}
 			// Divergence free rhs
-			if (formulation() != "Bilaplacian" || local_neumann_boundary.empty())
+			if (formulation().type() != AssemblerType::Bilaplacian || local_neumann_boundary.empty())
 			{
 				rhs.block(prev_size, 0, n_larger, rhs.cols()).setZero();
 			}
@@ -1250,7 +1265,7 @@ namespace polyfem
 
 		igl::Timer timer;
 		timer.start();
-		logger().info("Solving {}", formulation());
+		logger().info("Solving {}", formulation().name());
 
 		const std::string full_mat_path = args["output"]["data"]["full_mat"];
 		if (!full_mat_path.empty())
@@ -1273,9 +1288,9 @@ namespace polyfem
 							  resolve_output_path(args["output"]["paraview"]["file_name"]));
 			}
 
-			if (formulation() == "NavierStokes")
+			if (formulation().type() == AssemblerType::NavierStokes)
 				solve_transient_navier_stokes(time_steps, t0, dt);
-			else if (formulation() == "OperatorSplitting")
+			else if (formulation().type() == AssemblerType::OperatorSplitting)
 				solve_transient_navier_stokes_split(time_steps, dt);
 			else if (assembler.is_linear(formulation()) && !is_contact_enabled()) // Collisions add nonlinearity to the problem
 				solve_transient_linear(time_steps, t0, dt);
@@ -1286,7 +1301,7 @@ namespace polyfem
 		}
 		else
 		{
-			if (formulation() == "NavierStokes")
+			if (formulation().type() == AssemblerType::NavierStokes)
 				solve_navier_stokes();
 			else if (assembler.is_linear(formulation()) && !is_contact_enabled())
 				solve_linear();
@@ -1302,6 +1317,8 @@ namespace polyfem
 			}
 		}
 
+		flush_export();
+
 		timer.stop();
 		timings.solving_time = timer.getElapsedTime();
 		logger().info(" took {}s", timings.solving_time);
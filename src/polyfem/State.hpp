@@ -21,6 +21,8 @@
 #include <polyfem/utils/Logger.hpp>
 
 #include <polyfem/io/OutData.hpp>
+#include <polyfem/io/AsyncWriter.hpp>
+#include <polyfem/io/HDF5Writer.hpp>
 
 #include <polysolve/LinearSolver.hpp>
 
@@ -190,7 +192,8 @@ namespace polyfem
 		/// Mapping from input nodes to FE nodes
 		std::shared_ptr<polyfem::mesh::MeshNodes> mesh_nodes;
 
-		/// used to store assembly values for small problems
+		/// used to store assembly values for small problems,
+		/// it also holds the assembly schedule and the element coloring of bases (rebuilt with the bases)
 		assembler::AssemblyValsCache ass_vals_cache;
 		/// used to store assembly values for pressure for small problems
 		assembler::AssemblyValsCache pressure_ass_vals_cache;
@@ -216,8 +219,9 @@ namespace polyfem
 		bool use_avg_pressure;
 
 		/// return the formulation (checks if the problem is scalar or not and delas with multiphisics)
+		/// resolved once from the materials in init
 		/// @return fomulation
-		std::string formulation() const;
+		const assembler::Formulation &formulation() const { return formulation_; }
 
 		/// check if using iso parametric bases
 		/// @return if basis are isoparametric
@@ -269,6 +273,11 @@ namespace polyfem
 		/// set the multimaterial, this is mean for internal usage.
 		void set_materials();
 
+		/// formulation of the materials in args, combined into MultiModels if needed
+		std::string formulation_from_materials() const;
+		/// formulation resolved from the materials in init
+		assembler::Formulation formulation_;
+
 		//---------------------------------------------------
 		//-----------------solver----------------------------
 		//---------------------------------------------------
@@ -357,6 +366,16 @@ namespace polyfem
 			StiffnessMatrix &A,
 			Eigen::VectorXd &b,
 			const bool compute_spectrum);
+		/// @brief Solve the linear problem with a system already factorized in the solver (see polysolve::prefactorize).
+		/// @param solver Linear solver holding the factorization of A_bc.
+		/// @param A Linear system matrix, used to lift the Dirichlet values.
+		/// @param A_bc A with the Dirichlet rows and columns set to identity, used to check the residual.
+		/// @param b Right-hand side.
+		void solve_linear_prefactorized(
+			const std::unique_ptr<polysolve::LinearSolver> &solver,
+			const StiffnessMatrix &A,
+			const StiffnessMatrix &A_bc,
+			Eigen::VectorXd &b);
 
 		//---------------------------------------------------
 		//-----------------nodes flags-----------------------
@@ -489,6 +508,8 @@ namespace polyfem
 		bool solve_export_to_file = true;
 		/// saves the frames in a vector instead of VTU
 		std::vector<io::SolutionFrame> solution_frames;
+		/// time series of the hdf5 output, replaces the VTU of the timesteps, created at the first timestep
+		std::shared_ptr<io::HDF5Writer> hdf5_writer;
 		/// visualization stuff
 		io::OutGeometryData out_geom;
 		/// runtime statistics
@@ -506,6 +527,10 @@ namespace polyfem
 		/// @param[in] dt delta t
 		void save_timestep(const double time, const int t, const double t0, const double dt);
 
+		/// waits for the timesteps being written in the background (see export_queue_size)
+		/// @throws the first error of the background export
+		void flush_export();
+
 		/// saves a subsolve when save_solve_sequence_debug is true
 		/// @param[in] i sub solve index
 		/// @param[in] t time index
@@ -541,6 +566,13 @@ namespace polyfem
 		/// limits the number of used threads
 		std::shared_ptr<tbb::global_control> thread_limiter;
 #endif
+
+	private:
+		/// writes the timesteps in the background, declared last so that it is
+		/// destroyed (after writing the pending timesteps) before the data it reads.
+		/// Besides the ExportFrame of each timestep the tasks read the mesh, bases, arguments, and rhs,
+		/// the functions changing them call flush_export first
+		std::unique_ptr<io::AsyncWriter> async_writer;
 	};
 
 } // namespace polyfem
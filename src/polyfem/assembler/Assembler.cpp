@@ -26,6 +26,11 @@
 
 #include <ipc/utils/eigen_ext.hpp>
 
+#include <array>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
 namespace polyfem::assembler
 {
 	using namespace basis;
@@ -40,6 +45,7 @@ namespace polyfem::assembler
 			SpareMatrixCache cache;
 			ElementAssemblyValues vals;
 			QuadratureVector da;
+			LocalWorkspace workspace;
 
 			LocalThreadMatStorage()
 			{
@@ -69,18 +75,12 @@ namespace polyfem::assembler
 			}
 		};
 
-		class LocalThreadVecStorage
+		class LocalThreadElementStorage
 		{
 		public:
-			Eigen::MatrixXd vec;
 			ElementAssemblyValues vals;
 			QuadratureVector da;
-
-			LocalThreadVecStorage(const int size)
-			{
-				vec.resize(size, 1);
-				vec.setZero();
-			}
+			LocalWorkspace workspace;
 		};
 
 		class LocalThreadScalarStorage
@@ -89,12 +89,228 @@ namespace polyfem::assembler
 			double val;
 			ElementAssemblyValues vals;
 			QuadratureVector da;
+			LocalWorkspace workspace;
 
 			LocalThreadScalarStorage()
 			{
 				val = 0;
 			}
 		};
+
+		// maximum number of elements whose quadrature points are evaluated together by the batched local assemblers,
+		// enough to fill the vector registers with the points of P1 elements
+		constexpr int max_batch_size = 8;
+
+		class LocalThreadFusedStorage
+		{
+		public:
+			double val = 0;
+			SpareMatrixCache cache;
+			ElementAssemblyValues vals;
+			QuadratureVector da;
+			Eigen::VectorXd grad;
+			Eigen::MatrixXd hessian;
+			LocalWorkspace workspace;
+
+			// per element values of a batch of elements
+			std::array<ElementAssemblyValues, max_batch_size> batch_vals;
+			std::array<QuadratureVector, max_batch_size> batch_da;
+			std::array<double, max_batch_size> batch_energy;
+			std::array<Eigen::VectorXd, max_batch_size> batch_grad;
+			std::array<Eigen::MatrixXd, max_batch_size> batch_hessian;
+
+			void init(const int buffer_size, const SpareMatrixCache &c)
+			{
+				cache.reserve(buffer_size);
+				cache.init(c);
+			}
+		};
+
+		// turns the triplets of every thread into a matrix in parallel, then sums the matrices pairwise (each level in parallel)
+		template <typename Storages>
+		void merge_local_matrices(Storages &storage, StiffnessMatrix &stiffness)
+		{
+			std::vector<SpareMatrixCache *> caches;
+			for (auto &local_storage : storage)
+				caches.push_back(&local_storage.cache);
+
+			std::vector<StiffnessMatrix> matrices(caches.size());
+			maybe_parallel_for(int(caches.size()), [&](int i) {
+				matrices[i] = caches[i]->get_matrix(false); // will also prune
+			});
+
+			for (size_t step = 1; step < matrices.size(); step *= 2)
+			{
+				maybe_parallel_for(int((matrices.size() + 2 * step - 1) / (2 * step)), [&](int k) {
+					const size_t i = 2 * k * step;
+					if (i + step < matrices.size())
+					{
+						matrices[i] += matrices[i + step];
+						matrices[i + step] = StiffnessMatrix();
+					}
+				});
+			}
+
+			if (!matrices.empty())
+				stiffness += matrices.front();
+			stiffness.makeCompressed();
+		}
+
+		// true if the local assembler computes energy, gradient, and hessian together
+		// with assemble_energy_gradient_hessian(data, energy, grad, hessian)
+		template <class LocalAssembler, class = void>
+		struct HasFusedAssembly : std::false_type
+		{
+		};
+
+		template <class LocalAssembler>
+		struct HasFusedAssembly<LocalAssembler, std::void_t<decltype(std::declval<const LocalAssembler &>().assemble_energy_gradient_hessian(
+													 std::declval<const NonLinearAssemblerData &>(), std::declval<double *>(), std::declval<Eigen::VectorXd *>(), std::declval<Eigen::MatrixXd *>()))>>
+			: std::true_type
+		{
+		};
+
+		// true if the local assembler computes energy, gradient, and hessian of several elements with the same number of
+		// local bases at once with assemble_energy_gradient_hessian(data, n_elements, energy, grad, hessian)
+		template <class LocalAssembler, class = void>
+		struct HasBatchedAssembly : std::false_type
+		{
+		};
+
+		template <class LocalAssembler>
+		struct HasBatchedAssembly<LocalAssembler, std::void_t<decltype(std::declval<const LocalAssembler &>().assemble_energy_gradient_hessian(
+													   std::declval<const NonLinearAssemblerData *const *>(), std::declval<int>(), std::declval<double *>(), std::declval<Eigen::VectorXd *>(), std::declval<Eigen::MatrixXd *>()))>>
+			: std::true_type
+		{
+		};
+
+		// local energy, gradient, and hessian of an element, null outputs are skipped
+		template <class LocalAssembler>
+		void local_energy_gradient_hessian(const LocalAssembler &local_assembler, const NonLinearAssemblerData &data, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian)
+		{
+			if constexpr (HasFusedAssembly<LocalAssembler>::value)
+			{
+				local_assembler.assemble_energy_gradient_hessian(data, energy, grad, hessian);
+			}
+			else
+			{
+				if (energy)
+					*energy = local_assembler.compute_energy(data);
+				if (grad)
+					*grad = local_assembler.assemble_grad(data);
+				if (hessian)
+					*hessian = local_assembler.assemble_hessian(data);
+			}
+		}
+
+		// true if the local assembler computes the product of its hessian with a global direction
+		// with assemble_hessian_apply(data, direction, hv)
+		template <class LocalAssembler, class = void>
+		struct HasHessianApply : std::false_type
+		{
+		};
+
+		template <class LocalAssembler>
+		struct HasHessianApply<LocalAssembler, std::void_t<decltype(std::declval<const LocalAssembler &>().assemble_hessian_apply(
+													std::declval<const NonLinearAssemblerData &>(), std::declval<const Eigen::MatrixXd &>(), std::declval<Eigen::VectorXd &>()))>>
+			: std::true_type
+		{
+		};
+
+		// local values of the global vector x
+		void gather_local_vector(const int size, const ElementAssemblyValues &vals, const Eigen::MatrixXd &x, Eigen::VectorXd &local)
+		{
+			const int n_loc_bases = int(vals.basis_values.size());
+
+			local.setZero(n_loc_bases * size);
+			for (int i = 0; i < n_loc_bases; ++i)
+			{
+				const auto &global_i = vals.basis_values[i].global;
+				for (size_t ii = 0; ii < global_i.size(); ++ii)
+				{
+					for (int d = 0; d < size; ++d)
+					{
+						local(i * size + d) += global_i[ii].val * x(global_i[ii].index * size + d);
+					}
+				}
+			}
+		}
+
+		// adds the local gradient of the element to rhs
+		void scatter_local_gradient(const int size, const ElementAssemblyValues &vals, const Eigen::VectorXd &local_grad, Eigen::MatrixXd &rhs)
+		{
+			const int n_loc_bases = int(vals.basis_values.size());
+			assert(local_grad.size() == n_loc_bases * size);
+
+			for (int j = 0; j < n_loc_bases; ++j)
+			{
+				const auto &global_j = vals.basis_values[j].global;
+
+				for (int m = 0; m < size; ++m)
+				{
+					const double local_value = local_grad(j * size + m);
+					if (std::abs(local_value) < 1e-30)
+					{
+						continue;
+					}
+
+					for (size_t jj = 0; jj < global_j.size(); ++jj)
+					{
+						const auto gj = global_j[jj].index * size + m;
+						const auto wj = global_j[jj].val;
+
+						rhs(gj) += local_value * wj;
+					}
+				}
+			}
+		}
+
+		// calls add(gi, gj, value) for every entry of the local hessian of the element,
+		// the order of the calls is the same for every assembly of the element
+		template <typename AddFunction>
+		void scatter_local_hessian(const int size, const ElementAssemblyValues &vals, const Eigen::MatrixXd &local_hessian, const AddFunction &add)
+		{
+			const int n_loc_bases = int(vals.basis_values.size());
+			assert(local_hessian.rows() == n_loc_bases * size);
+			assert(local_hessian.cols() == n_loc_bases * size);
+
+			for (int i = 0; i < n_loc_bases; ++i)
+			{
+				const auto &global_i = vals.basis_values[i].global;
+
+				for (int j = 0; j < n_loc_bases; ++j)
+				// for(int j = 0; j <= i; ++j)
+				{
+					const auto &global_j = vals.basis_values[j].global;
+
+					for (int n = 0; n < size; ++n)
+					{
+						for (int m = 0; m < size; ++m)
+						{
+							const double local_value = local_hessian(i * size + m, j * size + n);
+							//  if (std::abs(local_value) < 1e-30)
+							//  {
+							// 	 continue;
+							//  }
+
+							for (size_t ii = 0; ii < global_i.size(); ++ii)
+							{
+								const auto gi = global_i[ii].index * size + m;
+								const auto wi = global_i[ii].val;
+
+								for (size_t jj = 0; jj < global_j.size(); ++jj)
+								{
+									const auto gj = global_j[jj].index * size + n;
+									const auto wj = global_j[jj].val;
+
+									add(gi, gj, local_value * wi * wj);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
 	} // namespace
 
 	template <class LocalAssembler>
@@ -118,27 +334,29 @@ namespace polyfem::assembler
 			stiffness.resize(n_basis * local_assembler_.size(), n_basis * local_assembler_.size());
 			stiffness.setZero();
 
-			auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, stiffness.rows(), stiffness.cols()));
+			// the copies of the thread storage refer to the cache of initial_storage, it has to outlive them,
+			// nothing is reserved in it since the copies do not inherit the capacity
+			const LocalThreadMatStorage initial_storage(/*buffer_size=*/0, stiffness.rows(), stiffness.cols());
+			auto storage = create_thread_storage(initial_storage);
 
-			const int n_bases = int(bases.size());
+			AssemblySchedule tmp_schedule;
+			const AssemblySchedule &schedule = cache.schedule(bases, tmp_schedule);
 			igl::Timer timerg;
 			timerg.start();
 
-			maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+			maybe_parallel_for(schedule.n_chunks(), [&](int start, int end, int thread_id) {
 				LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
 
-				for (int e = start; e < end; ++e)
+				for (const int e : schedule.elements(start, end))
 				{
-					ElementAssemblyValues &vals = local_storage.vals;
 					// igl::Timer timer; timer.start();
 					// vals.compute(e, is_volume, bases[e], gbases[e]);
 					if (is_mass)
 					{
-						bases[e].compute_mass_quadrature(vals.quadrature);
-						vals.compute(e, is_volume, vals.quadrature.points, bases[e], gbases[e]);
+						ElementAssemblyValues &mass_vals = local_storage.vals;
+						mass_vals.compute_mass(e, is_volume, bases[e], gbases[e]);
 					}
-					else
-						cache.compute(e, is_volume, bases[e], gbases[e], vals);
+					const ElementAssemblyValues &vals = is_mass ? local_storage.vals : cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
 
 					const Quadrature &quadrature = vals.quadrature;
 
@@ -253,10 +471,7 @@ namespace polyfem::assembler
 				logger().warn("Cannot allocate space for triplets, switching to serial assembly.");
 
 				timerg.start();
-				// Serially merge local storages
-				for (LocalThreadMatStorage &local_storage : storage)
-					stiffness += local_storage.cache.get_matrix(false); // will also prune
-				stiffness.makeCompressed();
+				merge_local_matrices(storage, stiffness);
 				timerg.stop();
 
 				logger().debug("Serial assembly time: {}s...", timerg.getElapsedTime());
@@ -337,22 +552,26 @@ namespace polyfem::assembler
 		stiffness.resize(n_phi_basis * local_assembler_.rows(), n_psi_basis * local_assembler_.cols());
 		stiffness.setZero();
 
-		auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, stiffness.rows(), stiffness.cols()));
+		// the copies of the thread storage refer to the cache of initial_storage, it has to outlive them,
+		// nothing is reserved in it since the copies do not inherit the capacity
+		const LocalThreadMatStorage initial_storage(/*buffer_size=*/0, stiffness.rows(), stiffness.cols());
+		auto storage = create_thread_storage(initial_storage);
 
-		const int n_bases = int(phi_bases.size());
+		AssemblySchedule tmp_schedule;
+		const AssemblySchedule &schedule = phi_cache.schedule(phi_bases, tmp_schedule);
 		igl::Timer timerg;
 		timerg.start();
 
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+		maybe_parallel_for(schedule.n_chunks(), [&](int start, int end, int thread_id) {
 			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
-			ElementAssemblyValues psi_vals, phi_vals;
+			ElementAssemblyValues psi_tmp, phi_tmp;
 
-			for (int e = start; e < end; ++e)
+			for (const int e : schedule.elements(start, end))
 			{
 				// psi_vals.compute(e, is_volume, psi_bases[e], gbases[e]);
 				// phi_vals.compute(e, is_volume, phi_bases[e], gbases[e]);
-				psi_cache.compute(e, is_volume, psi_bases[e], gbases[e], psi_vals);
-				phi_cache.compute(e, is_volume, phi_bases[e], gbases[e], phi_vals);
+				const ElementAssemblyValues &psi_vals = psi_cache.get(e, is_volume, psi_bases[e], gbases[e], psi_tmp);
+				const ElementAssemblyValues &phi_vals = phi_cache.get(e, is_volume, phi_bases[e], gbases[e], phi_tmp);
 
 				const Quadrature &quadrature = phi_vals.quadrature;
 
@@ -413,10 +632,7 @@ namespace polyfem::assembler
 		logger().trace("done separate assembly {}s...", timerg.getElapsedTime());
 
 		timerg.start();
-		// Serially merge local storages
-		for (LocalThreadMatStorage &local_storage : storage)
-			stiffness += local_storage.cache.get_matrix(false); // will also prune
-		stiffness.makeCompressed();
+		merge_local_matrices(storage, stiffness);
 		timerg.stop();
 		logger().trace("done merge assembly {}s...", timerg.getElapsedTime());
 
@@ -439,64 +655,41 @@ namespace polyfem::assembler
 		rhs.resize(n_basis * local_assembler_.size(), 1);
 		rhs.setZero();
 
-		auto storage = create_thread_storage(LocalThreadVecStorage(rhs.size()));
-
-		const int n_bases = int(bases.size());
+		auto storage = create_thread_storage(LocalThreadElementStorage());
 
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
-			LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
-
-			for (int e = start; e < end; ++e)
-			{
-				// igl::Timer timer; timer.start();
+		// elements of the same color share no node, so they are scattered directly into rhs
+		mesh::ElementColoring tmp_coloring;
+		const mesh::ElementColoring &coloring = cache.coloring(bases, tmp_coloring);
 
-				ElementAssemblyValues &vals = local_storage.vals;
-				// vals.compute(e, is_volume, bases[e], gbases[e]);
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
-
-				const Quadrature &quadrature = vals.quadrature;
-
-				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = vals.det.array() * quadrature.weights.array();
-				const int n_loc_bases = int(vals.basis_values.size());
-
-				const auto val = local_assembler_.assemble_grad(NonLinearAssemblerData(vals, dt, displacement, displacement_prev, local_storage.da));
-				assert(val.size() == n_loc_bases * local_assembler_.size());
+		for (int c = 0; c < coloring.n_colors(); ++c)
+		{
+			maybe_parallel_for(coloring.color_size(c), [&](int start, int end, int thread_id) {
+				LocalThreadElementStorage &local_storage = get_local_thread_storage(storage, thread_id);
 
-				for (int j = 0; j < n_loc_bases; ++j)
+				for (int k = start; k < end; ++k)
 				{
-					const auto &global_j = vals.basis_values[j].global;
+					const int e = coloring.element(c, k);
+					// igl::Timer timer; timer.start();
 
-					// igl::Timer t1; t1.start();
-					for (int m = 0; m < local_assembler_.size(); ++m)
-					{
-						const double local_value = val(j * local_assembler_.size() + m);
-						if (std::abs(local_value) < 1e-30)
-						{
-							continue;
-						}
+					// vals.compute(e, is_volume, bases[e], gbases[e]);
+					const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
 
-						for (size_t jj = 0; jj < global_j.size(); ++jj)
-						{
-							const auto gj = global_j[jj].index * local_assembler_.size() + m;
-							const auto wj = global_j[jj].val;
+					const Quadrature &quadrature = vals.quadrature;
 
-							local_storage.vec(gj) += local_value * wj;
-						}
-					}
+					assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+					local_storage.da = vals.det.array() * quadrature.weights.array();
+					const int n_loc_bases = int(vals.basis_values.size());
 
-					// t1.stop();
-					// if (!vals.has_parameterization) { std::cout << "-- t1: " << t1.getElapsedTime() << std::endl; }
-				}
+					const Eigen::VectorXd val = local_assembler_.assemble_grad(NonLinearAssemblerData(vals, dt, displacement, displacement_prev, local_storage.da, &local_storage.workspace));
+					assert(val.size() == n_loc_bases * local_assembler_.size());
 
-				// timer.stop();
-				// if (!vals.has_parameterization) { std::cout << "-- Timer: " << timer.getElapsedTime() << std::endl; }
-			}
-		});
+					scatter_local_gradient(local_assembler_.size(), vals, val, rhs);
 
-		// Serially merge local storages
-		for (const LocalThreadVecStorage &local_storage : storage)
-			rhs += local_storage.vec;
+					// timer.stop();
+					// if (!vals.has_parameterization) { std::cout << "-- Timer: " << timer.getElapsedTime() << std::endl; }
+				}
+			});
+		}
 	}
 
 	template <class LocalAssembler>
@@ -523,32 +716,78 @@ namespace polyfem::assembler
 		mat_cache.init(n_basis * local_assembler_.size());
 		mat_cache.set_zero();
 
-		auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, mat_cache));
+		AssemblySchedule tmp_schedule;
+		const AssemblySchedule &schedule = cache.schedule(bases, tmp_schedule);
+
+		const auto local_hessian = [&](const ElementAssemblyValues &vals, QuadratureVector &da, LocalWorkspace &workspace) {
+			const Quadrature &quadrature = vals.quadrature;
+
+			assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+			da = vals.det.array() * quadrature.weights.array();
+			const int n_loc_bases = int(vals.basis_values.size());
+
+			Eigen::MatrixXd stiffness_val = local_assembler_.assemble_hessian(NonLinearAssemblerData(vals, dt, displacement, displacement_prev, da, &workspace));
+			assert(stiffness_val.rows() == n_loc_bases * local_assembler_.size());
+			assert(stiffness_val.cols() == n_loc_bases * local_assembler_.size());
+
+			if (project_to_psd)
+				stiffness_val = ipc::project_to_psd(stiffness_val);
+
+			return stiffness_val;
+		};
 
-		const int n_bases = int(bases.size());
 		igl::Timer timerg;
-		timerg.start();
 
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
-			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
+		if (mat_cache.has_element_mapping())
+		{
+			// the position of every entry is known, the threads scatter directly into the values of mat_cache.
+			// Elements of the same color share no node, so they never write the same entry
+			// and no per-thread copy of the values (nor their reduction) is needed
+			mesh::ElementColoring tmp_coloring;
+			const mesh::ElementColoring &coloring = cache.coloring(bases, tmp_coloring);
+
+			auto storage = create_thread_storage(LocalThreadElementStorage());
 
-			for (int e = start; e < end; ++e)
+			timerg.start();
+			for (int c = 0; c < coloring.n_colors(); ++c)
 			{
-				ElementAssemblyValues &vals = local_storage.vals;
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+				maybe_parallel_for(coloring.color_size(c), [&](int start, int end, int thread_id) {
+					LocalThreadElementStorage &local_storage = get_local_thread_storage(storage, thread_id);
 
-				const Quadrature &quadrature = vals.quadrature;
+					for (int k = start; k < end; ++k)
+					{
+						const int e = coloring.element(c, k);
+						const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
+						const Eigen::MatrixXd stiffness_val = local_hessian(vals, local_storage.da, local_storage.workspace);
+
+						const std::vector<int> &indices = mat_cache.element_value_indices(e);
+						int index = 0;
+						scatter_local_hessian(local_assembler_.size(), vals, stiffness_val, [&](const int, const int, const double value) {
+							assert(index < indices.size());
+							mat_cache.add_to_value(indices[index++], value);
+						});
+						assert(index == indices.size());
+					}
+				});
+			}
+			timerg.stop();
+			logger().trace("done colored assembly {}s...", timerg.getElapsedTime());
 
-				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = vals.det.array() * quadrature.weights.array();
-				const int n_loc_bases = int(vals.basis_values.size());
+			grad = mat_cache.get_matrix();
+			return;
+		}
 
-				auto stiffness_val = local_assembler_.assemble_hessian(NonLinearAssemblerData(vals, dt, displacement, displacement_prev, local_storage.da));
-				assert(stiffness_val.rows() == n_loc_bases * local_assembler_.size());
-				assert(stiffness_val.cols() == n_loc_bases * local_assembler_.size());
+		auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, mat_cache));
+
+		timerg.start();
+
+		maybe_parallel_for(schedule.n_chunks(), [&](int start, int end, int thread_id) {
+			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
 
-				if (project_to_psd)
-					stiffness_val = ipc::project_to_psd(stiffness_val);
+			for (const int e : schedule.elements(start, end))
+			{
+				const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
+				const Eigen::MatrixXd stiffness_val = local_hessian(vals, local_storage.da, local_storage.workspace);
 
 				// bool has_nan = false;
 				// for(int k = 0; k < stiffness_val.size(); ++k)
@@ -566,51 +805,15 @@ namespace polyfem::assembler
 				// 	break;
 				// }
 
-				for (int i = 0; i < n_loc_bases; ++i)
-				{
-					const auto &global_i = vals.basis_values[i].global;
+				scatter_local_hessian(local_assembler_.size(), vals, stiffness_val, [&](const int gi, const int gj, const double value) {
+					local_storage.cache.add_value(e, gi, gj, value);
 
-					for (int j = 0; j < n_loc_bases; ++j)
-					// for(int j = 0; j <= i; ++j)
+					if (local_storage.cache.entries_size() >= max_triplets_size)
 					{
-						const auto &global_j = vals.basis_values[j].global;
-
-						for (int n = 0; n < local_assembler_.size(); ++n)
-						{
-							for (int m = 0; m < local_assembler_.size(); ++m)
-							{
-								const double local_value = stiffness_val(i * local_assembler_.size() + m, j * local_assembler_.size() + n);
-								//  if (std::abs(local_value) < 1e-30)
-								//  {
-								// 	 continue;
-								//  }
-
-								for (size_t ii = 0; ii < global_i.size(); ++ii)
-								{
-									const auto gi = global_i[ii].index * local_assembler_.size() + m;
-									const auto wi = global_i[ii].val;
-
-									for (size_t jj = 0; jj < global_j.size(); ++jj)
-									{
-										const auto gj = global_j[jj].index * local_assembler_.size() + n;
-										const auto wj = global_j[jj].val;
-
-										local_storage.cache.add_value(e, gi, gj, local_value * wi * wj);
-										// if (j < i) {
-										// 	local_storage.entries.emplace_back(gj, gi, local_value * wj * wi);
-										// }
-
-										if (local_storage.cache.entries_size() >= max_triplets_size)
-										{
-											local_storage.cache.prune();
-											logger().debug("cleaning memory...");
-										}
-									}
-								}
-							}
-						}
+						local_storage.cache.prune();
+						logger().debug("cleaning memory...");
 					}
-				}
+				});
 			}
 		});
 
@@ -642,22 +845,21 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &displacement_prev) const
 	{
 		auto storage = create_thread_storage(LocalThreadScalarStorage());
-		const int n_bases = int(bases.size());
+		AssemblySchedule tmp_schedule;
+		const AssemblySchedule &schedule = cache.schedule(bases, tmp_schedule);
 
-		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+		maybe_parallel_for(schedule.n_chunks(), [&](int start, int end, int thread_id) {
 			LocalThreadScalarStorage &local_storage = get_local_thread_storage(storage, thread_id);
-			ElementAssemblyValues &vals = local_storage.vals;
-
-			for (int e = start; e < end; ++e)
+			for (const int e : schedule.elements(start, end))
 			{
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+				const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
 
 				const Quadrature &quadrature = vals.quadrature;
 
 				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
 				local_storage.da = vals.det.array() * quadrature.weights.array();
 
-				const double val = local_assembler_.compute_energy(NonLinearAssemblerData(vals, dt, displacement, displacement_prev, local_storage.da));
+				const double val = local_assembler_.compute_energy(NonLinearAssemblerData(vals, dt, displacement, displacement_prev, local_storage.da, &local_storage.workspace));
 				local_storage.val += val;
 			}
 		});
@@ -669,7 +871,233 @@ namespace polyfem::assembler
 		return res;
 	}
 
+	template <class LocalAssembler>
+	void NLAssembler<LocalAssembler>::assemble_energy_gradient_hessian(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		double *energy,
+		Eigen::MatrixXd *grad,
+		SpareMatrixCache &mat_cache,
+		StiffnessMatrix *hessian) const
+	{
+		const int max_triplets_size = int(1e7);
+		const int buffer_size = std::min(long(max_triplets_size), long(n_basis) * local_assembler_.size());
+
+		if (grad)
+		{
+			grad->resize(n_basis * local_assembler_.size(), 1);
+			grad->setZero();
+		}
+
+		if (hessian)
+		{
+			mat_cache.init(n_basis * local_assembler_.size());
+			mat_cache.set_zero();
+		}
+		// same as in assemble_hessian, without the mapping the entries go to per-thread caches
+		const bool scatter_to_values = hessian && mat_cache.has_element_mapping();
+
+		LocalThreadFusedStorage initial_storage;
+		if (hessian && !scatter_to_values)
+			initial_storage.init(buffer_size, mat_cache);
+		auto storage = create_thread_storage(initial_storage);
+
+		// elements of the same color share no node, the gradient and the hessian values are scattered directly
+		mesh::ElementColoring tmp_coloring;
+		const mesh::ElementColoring &coloring = cache.coloring(bases, tmp_coloring);
+
+		igl::Timer timerg;
+		timerg.start();
+
+		for (int c = 0; c < coloring.n_colors(); ++c)
+		{
+			maybe_parallel_for(coloring.color_size(c), [&](int start, int end, int thread_id) {
+				LocalThreadFusedStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+				for (int k = start; k < end;)
+				{
+					// consecutive elements with the same number of local bases are evaluated together if the local assembler can
+					int n_batch = 1;
+					if constexpr (HasBatchedAssembly<LocalAssembler>::value)
+					{
+						const size_t n_loc_bases = bases[coloring.element(c, k)].bases.size();
+						while (n_batch < max_batch_size && k + n_batch < end && bases[coloring.element(c, k + n_batch)].bases.size() == n_loc_bases)
+							++n_batch;
+					}
+
+					std::array<std::optional<NonLinearAssemblerData>, max_batch_size> batch;
+					std::array<const NonLinearAssemblerData *, max_batch_size> batch_data;
+					for (int i = 0; i < n_batch; ++i)
+					{
+						const int e = coloring.element(c, k + i);
+						const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.batch_vals[i]);
+
+						const Quadrature &quadrature = vals.quadrature;
+
+						assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+						local_storage.batch_da[i] = vals.det.array() * quadrature.weights.array();
+
+						batch[i].emplace(vals, dt, displacement, displacement_prev, local_storage.batch_da[i], &local_storage.workspace);
+						batch_data[i] = &*batch[i];
+					}
+
+					double *local_energy = energy ? local_storage.batch_energy.data() : nullptr;
+					Eigen::VectorXd *local_grad = grad ? local_storage.batch_grad.data() : nullptr;
+					Eigen::MatrixXd *local_hessian = hessian ? local_storage.batch_hessian.data() : nullptr;
+					if constexpr (HasBatchedAssembly<LocalAssembler>::value)
+						local_assembler_.assemble_energy_gradient_hessian(batch_data.data(), n_batch, local_energy, local_grad, local_hessian);
+					else
+						local_energy_gradient_hessian(local_assembler_, *batch_data[0], local_energy, local_grad, local_hessian);
+
+					for (int i = 0; i < n_batch; ++i)
+					{
+						const int e = coloring.element(c, k + i);
+						const ElementAssemblyValues &vals = batch_data[i]->vals;
+
+						if (energy)
+							local_storage.val += local_storage.batch_energy[i];
+
+						if (grad)
+							scatter_local_gradient(local_assembler_.size(), vals, local_storage.batch_grad[i], *grad);
+
+						if (!hessian)
+							continue;
+
+						Eigen::MatrixXd &local_hessian_i = local_storage.batch_hessian[i];
+						if (project_to_psd)
+							local_hessian_i = ipc::project_to_psd(local_hessian_i);
+
+						if (scatter_to_values)
+						{
+							const std::vector<int> &indices = mat_cache.element_value_indices(e);
+							int index = 0;
+							scatter_local_hessian(local_assembler_.size(), vals, local_hessian_i, [&](const int, const int, const double value) {
+								assert(index < indices.size());
+								mat_cache.add_to_value(indices[index++], value);
+							});
+							assert(index == indices.size());
+						}
+						else
+						{
+							scatter_local_hessian(local_assembler_.size(), vals, local_hessian_i, [&](const int gi, const int gj, const double value) {
+								local_storage.cache.add_value(e, gi, gj, value);
+
+								if (local_storage.cache.entries_size() >= max_triplets_size)
+								{
+									local_storage.cache.prune();
+									logger().debug("cleaning memory...");
+								}
+							});
+						}
+					}
+
+					k += n_batch;
+				}
+			});
+		}
+
+		timerg.stop();
+		logger().trace("done fused assembly {}s...", timerg.getElapsedTime());
+
+		if (energy)
+		{
+			// Serially merge local storages
+			*energy = 0;
+			for (const LocalThreadFusedStorage &local_storage : storage)
+				*energy += local_storage.val;
+		}
+
+		if (hessian)
+		{
+			if (!scatter_to_values)
+			{
+				// Serially merge local storages
+				for (LocalThreadFusedStorage &local_storage : storage)
+				{
+					local_storage.cache.prune();
+					mat_cache += local_storage.cache;
+				}
+			}
+			*hessian = mat_cache.get_matrix();
+		}
+	}
+
 	// template instantiation
+	template <class LocalAssembler>
+	void NLAssembler<LocalAssembler>::assemble_hessian_apply(
+		const bool is_volume,
+		const int n_basis,
+		const bool project_to_psd,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double dt,
+		const Eigen::MatrixXd &displacement,
+		const Eigen::MatrixXd &displacement_prev,
+		const Eigen::MatrixXd &direction,
+		Eigen::MatrixXd &result) const
+	{
+		assert(direction.size() == n_basis * local_assembler_.size());
+
+		result.resize(n_basis * local_assembler_.size(), 1);
+		result.setZero();
+
+		auto storage = create_thread_storage(LocalThreadFusedStorage());
+
+		// same as assemble_grad, the local products are scattered directly by color
+		mesh::ElementColoring tmp_coloring;
+		const mesh::ElementColoring &coloring = cache.coloring(bases, tmp_coloring);
+
+		for (int c = 0; c < coloring.n_colors(); ++c)
+		{
+			maybe_parallel_for(coloring.color_size(c), [&](int start, int end, int thread_id) {
+				LocalThreadFusedStorage &local_storage = get_local_thread_storage(storage, thread_id);
+
+				for (int k = start; k < end; ++k)
+				{
+					const int e = coloring.element(c, k);
+					const ElementAssemblyValues &vals = cache.get(e, is_volume, bases[e], gbases[e], local_storage.vals);
+
+					const Quadrature &quadrature = vals.quadrature;
+
+					assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+					local_storage.da = vals.det.array() * quadrature.weights.array();
+					const NonLinearAssemblerData data(vals, dt, displacement, displacement_prev, local_storage.da, &local_storage.workspace);
+
+					bool applied = false;
+					if constexpr (HasHessianApply<LocalAssembler>::value)
+					{
+						if (!project_to_psd)
+						{
+							local_assembler_.assemble_hessian_apply(data, direction, local_storage.grad);
+							applied = true;
+						}
+					}
+
+					if (!applied)
+					{
+						local_storage.hessian = local_assembler_.assemble_hessian(data);
+						if (project_to_psd)
+							local_storage.hessian = ipc::project_to_psd(local_storage.hessian);
+
+						Eigen::VectorXd local_direction;
+						gather_local_vector(local_assembler_.size(), vals, direction, local_direction);
+						local_storage.grad = local_storage.hessian * local_direction;
+					}
+
+					scatter_local_gradient(local_assembler_.size(), vals, local_storage.grad, result);
+				}
+			});
+		}
+	}
+
 	template class Assembler<Mass>;
 
 	template class Assembler<Laplacian>;
@@ -107,6 +107,38 @@ namespace polyfem::assembler
 			const Eigen::MatrixXd &displacement,
 			const Eigen::MatrixXd &displacement_prev) const;
 
+		// assemble any combination of energy, gradient, and hessian in a single pass over the elements,
+		// the element values are fetched once and null outputs are skipped
+		void assemble_energy_gradient_hessian(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			double *energy,
+			Eigen::MatrixXd *grad,
+			utils::SpareMatrixCache &mat_cache,
+			StiffnessMatrix *hessian) const;
+
+		// product of the hessian of energy with direction, element by element without assembling the hessian,
+		// the local hessians are formed only if the local assembler has no hessian-vector product or project_to_psd
+		void assemble_hessian_apply(
+			const bool is_volume,
+			const int n_basis,
+			const bool project_to_psd,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double dt,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			const Eigen::MatrixXd &direction,
+			Eigen::MatrixXd &result) const;
+
 		inline LocalAssembler &local_assembler() { return local_assembler_; }
 		inline const LocalAssembler &local_assembler() const { return local_assembler_; }
 
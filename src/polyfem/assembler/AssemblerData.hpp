@@ -2,8 +2,53 @@
 
 #include "ElementAssemblyValues.hpp"
 
+#include <memory>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
 namespace polyfem::assembler
 {
+	/// Scratch buffers of the local assemblers, one object of each type T asked with get<T>().
+	/// It lives in the thread storage of the assembler, so the buffers allocated for an element
+	/// are reused by the next elements the thread assembles. Copies start empty.
+	class LocalWorkspace
+	{
+	public:
+		LocalWorkspace() = default;
+		LocalWorkspace(const LocalWorkspace &) {}
+		LocalWorkspace(LocalWorkspace &&) = default;
+		LocalWorkspace &operator=(const LocalWorkspace &) { return *this; }
+		LocalWorkspace &operator=(LocalWorkspace &&) = default;
+
+		template <typename T>
+		T &get()
+		{
+			const std::type_index type(typeid(T));
+			for (auto &entry : entries_)
+			{
+				if (entry.first == type)
+					return static_cast<Entry<T> &>(*entry.second).value;
+			}
+			entries_.emplace_back(type, std::make_unique<Entry<T>>());
+			return static_cast<Entry<T> &>(*entries_.back().second).value;
+		}
+
+	private:
+		struct EntryBase
+		{
+			virtual ~EntryBase() = default;
+		};
+
+		template <typename T>
+		struct Entry : EntryBase
+		{
+			T value;
+		};
+
+		std::vector<std::pair<std::type_index, std::unique_ptr<EntryBase>>> entries_;
+	};
+
 	class NonLinearAssemblerData
 	{
 	public:
@@ -12,8 +57,9 @@ namespace polyfem::assembler
 			const double dt,
 			const Eigen::MatrixXd &x,
 			const Eigen::MatrixXd &x_prev,
-			const QuadratureVector &da)
-			: vals(vals), dt(dt), x(x), x_prev(x_prev), da(da)
+			const QuadratureVector &da,
+			LocalWorkspace *workspace = nullptr)
+			: vals(vals), dt(dt), x(x), x_prev(x_prev), da(da), workspace(workspace)
 		{
 		}
 
@@ -22,6 +68,8 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &x;
 		const Eigen::MatrixXd &x_prev;
 		const QuadratureVector &da;
+		/// scratch buffers of the calling thread, null if the caller keeps none
+		LocalWorkspace *const workspace;
 	};
 
 	class LinearAssemblerData
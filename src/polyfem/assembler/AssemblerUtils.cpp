@@ -3,6 +3,10 @@
 
 #include <unsupported/Eigen/SparseExtra>
 
+#include <array>
+#include <type_traits>
+#include <unordered_map>
+
 namespace polyfem
 {
 	using namespace basis;
@@ -10,47 +14,494 @@ namespace polyfem
 
 	namespace assembler
 	{
-		struct FormulationProperties
-		{
-			bool is_scalar;
-			bool is_fluid;
-			bool is_mixed;
-			bool is_solution_displacement;
-			bool is_linear;
-			bool is_tensor() const { return !is_scalar; }
-			bool is_nonlinear() const { return !is_linear; }
+		// interface of the assemblers of a formulation, AssemblerUtils forwards every call
+		// to the assemblers of the requested formulation
+		class FormulationAssembler
+		{
+		public:
+			virtual ~FormulationAssembler() = default;
+
+			virtual void assemble_problem(const bool is_volume, const int n_basis, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+										  const AssemblyValsCache &cache, StiffnessMatrix &stiffness) const = 0;
+			virtual void assemble_mixed_problem(const bool is_volume, const int n_psi_basis, const int n_phi_basis,
+												const std::vector<ElementBases> &psi_bases, const std::vector<ElementBases> &phi_bases, const std::vector<ElementBases> &gbases,
+												const AssemblyValsCache &psi_cache, const AssemblyValsCache &phi_cache, StiffnessMatrix &stiffness) const = 0;
+			virtual void assemble_pressure_problem(const bool is_volume, const int n_basis, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+												   const AssemblyValsCache &cache, StiffnessMatrix &stiffness) const = 0;
+
+			virtual double assemble_energy(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+										   const AssemblyValsCache &cache, const double dt, const Eigen::MatrixXd &displacement, const Eigen::MatrixXd &displacement_prev) const = 0;
+			virtual void assemble_energy_gradient(const bool is_volume, const int n_basis, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+												  const AssemblyValsCache &cache, const double dt, const Eigen::MatrixXd &displacement, const Eigen::MatrixXd &displacement_prev,
+												  Eigen::MatrixXd &grad) const = 0;
+			virtual void assemble_energy_hessian(const bool is_volume, const int n_basis, const bool project_to_psd, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+												 const AssemblyValsCache &cache, const double dt, const Eigen::MatrixXd &displacement, const Eigen::MatrixXd &displacement_prev,
+												 SpareMatrixCache &mat_cache, StiffnessMatrix &hessian) const = 0;
+			virtual void assemble_energy_gradient_hessian(const bool is_volume, const int n_basis, const bool project_to_psd, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+														  const AssemblyValsCache &cache, const double dt, const Eigen::MatrixXd &displacement, const Eigen::MatrixXd &displacement_prev,
+														  double *energy, Eigen::MatrixXd *grad, SpareMatrixCache &mat_cache, StiffnessMatrix *hessian) const = 0;
+			virtual void assemble_energy_hessian_apply(const bool is_volume, const int n_basis, const bool project_to_psd, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+													   const AssemblyValsCache &cache, const double dt, const Eigen::MatrixXd &displacement, const Eigen::MatrixXd &displacement_prev,
+													   const Eigen::MatrixXd &direction, Eigen::MatrixXd &result) const = 0;
+
+			virtual void compute_scalar_value(const int el_id, const ElementBases &bs, const ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &fun, Eigen::MatrixXd &result) const = 0;
+			virtual void compute_tensor_value(const int el_id, const ElementBases &bs, const ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &fun, Eigen::MatrixXd &result) const = 0;
+			virtual VectorNd compute_rhs(const AutodiffHessianPt &pt) const = 0;
+			virtual Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1> local_assemble(const ElementAssemblyValues &vals, const int i, const int j, const QuadratureVector &da) const = 0;
+			virtual Eigen::Matrix<AutodiffScalarGrad, Eigen::Dynamic, 1, 0, 3, 1> kernel(const int dim, const AutodiffGradPt &rvect, const AutodiffScalarGrad &r) const = 0;
+
+			virtual void set_size(const int dim) = 0;
+			virtual void add_multimaterial(const int index, const json &params) = 0;
+			virtual void init_multimodels(const std::vector<std::string> &materials) = 0;
 		};
 
-		// clang-format off
-		static const std::unordered_map<std::string, FormulationProperties> formulation_properties = {
-			{"Laplacian",                      {/*is_scalar=*/true,  /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/false, /*is_linear=*/true}},
-			{"Helmholtz",                      {/*is_scalar=*/true,  /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/false, /*is_linear=*/true}},
-			{"Bilaplacian",                    {/*is_scalar=*/true,  /*is_fluid=*/false, /*is_mixed=*/true,  /*is_solution_displacement=*/false, /*is_linear=*/true}},
-			{"LinearElasticity",               {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/true}},
-			{"HookeLinearElasticity",          {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/true}},
-			{"Damping",                        {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/false}},
-			{"IncompressibleLinearElasticity", {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/true,  /*is_solution_displacement=*/true,  /*is_linear=*/true}},
-			{"SaintVenant",                    {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/false}},
-			{"NeoHookean",                     {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/false}},
-			{"MultiModels",                    {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/false}},
-			// {"Ogden",                          {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true, /*is_linear=*/false}},
-			{"Stokes",                         {/*is_scalar=*/false, /*is_fluid=*/true,  /*is_mixed=*/true,  /*is_solution_displacement=*/false, /*is_linear=*/true}},
-			{"NavierStokes",                   {/*is_scalar=*/false, /*is_fluid=*/true,  /*is_mixed=*/true,  /*is_solution_displacement=*/false, /*is_linear=*/false}},
-			{"OperatorSplitting",              {/*is_scalar=*/false, /*is_fluid=*/true,  /*is_mixed=*/true,  /*is_solution_displacement=*/false, /*is_linear=*/false}},
-		};
-		// clang-format on
+		namespace
+		{
+			// capabilities of the local assemblers that not all of them have
+
+			template <class T, class = void>
+			struct HasSetSize : std::false_type
+			{
+			};
+			template <class T>
+			struct HasSetSize<T, std::void_t<decltype(std::declval<T &>().set_size(0))>> : std::true_type
+			{
+			};
+
+			template <class T, class = void>
+			struct HasMultiModels : std::false_type
+			{
+			};
+			template <class T>
+			struct HasMultiModels<T, std::void_t<decltype(std::declval<T &>().init_multimodels(std::declval<const std::vector<std::string> &>()))>> : std::true_type
+			{
+			};
+
+			// von Mises stresses of an element (elasticity)
+			template <class T, class = void>
+			struct HasStresses : std::false_type
+			{
+			};
+			template <class T>
+			struct HasStresses<T, std::void_t<decltype(std::declval<const T &>().compute_von_mises_stresses(
+									  0, std::declval<const ElementBases &>(), std::declval<const ElementBases &>(),
+									  std::declval<const Eigen::MatrixXd &>(), std::declval<const Eigen::MatrixXd &>(), std::declval<Eigen::MatrixXd &>()))>> : std::true_type
+			{
+			};
+
+			// norm of the velocity (fluids)
+			template <class T, class = void>
+			struct HasVelocityNorm : std::false_type
+			{
+			};
+			template <class T>
+			struct HasVelocityNorm<T, std::void_t<decltype(std::declval<const T &>().compute_norm_velocity(
+										  std::declval<const ElementBases &>(), std::declval<const ElementBases &>(),
+										  std::declval<const Eigen::MatrixXd &>(), std::declval<const Eigen::MatrixXd &>(), std::declval<Eigen::MatrixXd &>()))>> : std::true_type
+			{
+			};
+
+			// stress tensor of an element (elasticity)
+			template <class T, class = void>
+			struct HasElementStressTensor : std::false_type
+			{
+			};
+			template <class T>
+			struct HasElementStressTensor<T, std::void_t<decltype(std::declval<const T &>().compute_stress_tensor(
+												 0, std::declval<const ElementBases &>(), std::declval<const ElementBases &>(),
+												 std::declval<const Eigen::MatrixXd &>(), std::declval<const Eigen::MatrixXd &>(), std::declval<Eigen::MatrixXd &>()))>> : std::true_type
+			{
+			};
+
+			// stress tensor without element (fluids)
+			template <class T, class = void>
+			struct HasStressTensor : std::false_type
+			{
+			};
+			template <class T>
+			struct HasStressTensor<T, std::void_t<decltype(std::declval<const T &>().compute_stress_tensor(
+										  std::declval<const ElementBases &>(), std::declval<const ElementBases &>(),
+										  std::declval<const Eigen::MatrixXd &>(), std::declval<const Eigen::MatrixXd &>(), std::declval<Eigen::MatrixXd &>()))>> : std::true_type
+			{
+			};
+
+			// kernel of a scalar pde
+			template <class T, class = void>
+			struct HasScalarKernel : std::false_type
+			{
+			};
+			template <class T>
+			struct HasScalarKernel<T, std::void_t<decltype(std::declval<const T &>().kernel(0, std::declval<const AutodiffScalarGrad &>()))>> : std::true_type
+			{
+			};
+
+			// kernel of a tensor pde
+			template <class T, class = void>
+			struct HasTensorKernel : std::false_type
+			{
+			};
+			template <class T>
+			struct HasTensorKernel<T, std::void_t<decltype(std::declval<const T &>().kernel(0, std::declval<const AutodiffGradPt &>()))>> : std::true_type
+			{
+			};
+
+			struct NoAssembler
+			{
+			};
+
+			template <template <class> class AssemblerT, class LocalAssembler>
+			using AssemblerSlot = std::conditional_t<std::is_void_v<LocalAssembler>, NoAssembler, AssemblerT<LocalAssembler>>;
+
+			template <class T, class F>
+			void for_local_assembler(T &assembler, const F &f)
+			{
+				if constexpr (!std::is_same_v<T, NoAssembler>)
+					f(assembler.local_assembler());
+			}
+
+			// the assemblers of a formulation, each local assembler is void if the formulation has none of that kind:
+			// Linear for the stiffness matrix, Mixed and Pressure for the mixed formulations, and NonLinear for the energy and its derivatives.
+			// Post is the local assembler (Linear or NonLinear) computing the stresses, the exact rhs, and the kernels.
+			// energy_based is false if NonLinear is a residual (eg, Navier-Stokes) without energy
+			template <class Linear, class Mixed, class Pressure, class NonLinear, class Post, bool energy_based = true>
+			class FormulationAssemblers final : public FormulationAssembler
+			{
+				static_assert(std::is_void_v<Post> || std::is_same_v<Post, Linear> || std::is_same_v<Post, NonLinear>);
+
+			public:
+				explicit FormulationAssemblers(const char *name) : name_(name) {}
+
+				const auto &linear() const { return linear_.local_assembler(); }
+				const auto &non_linear() const { return non_linear_.local_assembler(); }
+
+				void assemble_problem(const bool is_volume, const int n_basis, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+									  const AssemblyValsCache &cache, StiffnessMatrix &stiffness) const override
+				{
+					if constexpr (!std::is_void_v<Linear>)
+						linear_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
+					else if constexpr (std::is_void_v<NonLinear>)
+						unsupported("stiffness matrix");
+					// else the formulation is nonlinear, there is no matrix
+				}
+
+				void assemble_mixed_problem(const bool is_volume, const int n_psi_basis, const int n_phi_basis,
+											const std::vector<ElementBases> &psi_bases, const std::vector<ElementBases> &phi_bases, const std::vector<ElementBases> &gbases,
+											const AssemblyValsCache &psi_cache, const AssemblyValsCache &phi_cache, StiffnessMatrix &stiffness) const override
+				{
+					if constexpr (!std::is_void_v<Mixed>)
+						mixed_.assemble(is_volume, n_psi_basis, n_phi_basis, psi_bases, phi_bases, gbases, psi_cache, phi_cache, stiffness);
+					else
+						unsupported("mixed matrix");
+				}
+
+				void assemble_pressure_problem(const bool is_volume, const int n_basis, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+											   const AssemblyValsCache &cache, StiffnessMatrix &stiffness) const override
+				{
+					if constexpr (!std::is_void_v<Pressure>)
+						pressure_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
+					else
+						unsupported("pressure matrix");
+				}
+
+				double assemble_energy(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+									   const AssemblyValsCache &cache, const double dt, const Eigen::MatrixXd &displacement, const Eigen::MatrixXd &displacement_prev) const override
+				{
+					if constexpr (!std::is_void_v<NonLinear> && energy_based)
+						return non_linear_.assemble(is_volume, bases, gbases, cache, dt, displacement, displacement_prev);
+					else
+						return 0;
+				}
+
+				void assemble_energy_gradient(const bool is_volume, const int n_basis, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+											  const AssemblyValsCache &cache, const double dt, const Eigen::MatrixXd &displacement, const Eigen::MatrixXd &displacement_prev,
+											  Eigen::MatrixXd &grad) const override
+				{
+					if constexpr (!std::is_void_v<NonLinear>)
+						non_linear_.assemble_grad(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, grad);
+				}
+
+				void assemble_energy_hessian(const bool is_volume, const int n_basis, const bool project_to_psd, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+											 const AssemblyValsCache &cache, const double dt, const Eigen::MatrixXd &displacement, const Eigen::MatrixXd &displacement_prev,
+											 SpareMatrixCache &mat_cache, StiffnessMatrix &hessian) const override
+				{
+					if constexpr (!std::is_void_v<NonLinear>)
+						non_linear_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, mat_cache, hessian);
+				}
+
+				void assemble_energy_gradient_hessian(const bool is_volume, const int n_basis, const bool project_to_psd, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+													  const AssemblyValsCache &cache, const double dt, const Eigen::MatrixXd &displacement, const Eigen::MatrixXd &displacement_prev,
+													  double *energy, Eigen::MatrixXd *grad, SpareMatrixCache &mat_cache, StiffnessMatrix *hessian) const override
+				{
+					if constexpr (!std::is_void_v<NonLinear> && energy_based)
+					{
+						non_linear_.assemble_energy_gradient_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, energy, grad, mat_cache, hessian);
+					}
+					else
+					{
+						// not energy based (eg Navier-Stokes), the three are unrelated
+						if (energy)
+							*energy = assemble_energy(is_volume, bases, gbases, cache, dt, displacement, displacement_prev);
+						if (grad)
+							assemble_energy_gradient(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, *grad);
+						if (hessian)
+							assemble_energy_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, mat_cache, *hessian);
+					}
+				}
+
+				void assemble_energy_hessian_apply(const bool is_volume, const int n_basis, const bool project_to_psd, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
+												   const AssemblyValsCache &cache, const double dt, const Eigen::MatrixXd &displacement, const Eigen::MatrixXd &displacement_prev,
+												   const Eigen::MatrixXd &direction, Eigen::MatrixXd &result) const override
+				{
+					if constexpr (!std::is_void_v<NonLinear>)
+						non_linear_.assemble_hessian_apply(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, direction, result);
+				}
+
+				void compute_scalar_value(const int el_id, const ElementBases &bs, const ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &fun, Eigen::MatrixXd &result) const override
+				{
+					if constexpr (!std::is_void_v<Post>)
+					{
+						if constexpr (HasStresses<Post>::value)
+							post().compute_von_mises_stresses(el_id, bs, gbs, local_pts, fun, result);
+						else if constexpr (HasVelocityNorm<Post>::value)
+							post().compute_norm_velocity(bs, gbs, local_pts, fun, result);
+					}
+				}
+
+				void compute_tensor_value(const int el_id, const ElementBases &bs, const ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &fun, Eigen::MatrixXd &result) const override
+				{
+					if constexpr (!std::is_void_v<Post>)
+					{
+						if constexpr (HasElementStressTensor<Post>::value)
+							post().compute_stress_tensor(el_id, bs, gbs, local_pts, fun, result);
+						else if constexpr (HasStressTensor<Post>::value) // WARNING stokes and NS dont have el_id
+							post().compute_stress_tensor(bs, gbs, local_pts, fun, result);
+					}
+				}
+
+				VectorNd compute_rhs(const AutodiffHessianPt &pt) const override
+				{
+					if constexpr (!std::is_void_v<Post>)
+					{
+						const VectorNd res = post().compute_rhs(pt);
+						return res;
+					}
+					else
+					{
+						unsupported("rhs");
+						return VectorNd();
+					}
+				}
+
+				Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1> local_assemble(const ElementAssemblyValues &vals, const int i, const int j, const QuadratureVector &da) const override
+				{
+					if constexpr (!std::is_void_v<Linear>)
+					{
+						const Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1> res = linear_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
+						return res;
+					}
+					else
+					{
+						unsupported("local stiffness");
+						return Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>();
+					}
+				}
+
+				Eigen::Matrix<AutodiffScalarGrad, Eigen::Dynamic, 1, 0, 3, 1> kernel(const int dim, const AutodiffGradPt &rvect, const AutodiffScalarGrad &r) const override
+				{
+					if constexpr (!std::is_void_v<Linear> && HasScalarKernel<Linear>::value)
+						return linear_.local_assembler().kernel(dim, r);
+					else if constexpr (!std::is_void_v<Linear> && HasTensorKernel<Linear>::value)
+						return linear_.local_assembler().kernel(dim, rvect);
+					else
+					{
+						unsupported("kernel");
+						return Eigen::Matrix<AutodiffScalarGrad, Eigen::Dynamic, 1, 0, 3, 1>();
+					}
+				}
+
+				void set_size(const int dim) override
+				{
+					for_each_local_assembler([dim](auto &local_assembler) {
+						if constexpr (HasSetSize<std::decay_t<decltype(local_assembler)>>::value)
+							local_assembler.set_size(dim);
+					});
+				}
+
+				void add_multimaterial(const int index, const json &params) override
+				{
+					for_each_local_assembler([&](auto &local_assembler) { local_assembler.add_multimaterial(index, params); });
+				}
+
+				void init_multimodels(const std::vector<std::string> &materials) override
+				{
+					for_each_local_assembler([&](auto &local_assembler) {
+						if constexpr (HasMultiModels<std::decay_t<decltype(local_assembler)>>::value)
+							local_assembler.init_multimodels(materials);
+					});
+				}
+
+			private:
+				const char *name_;
+
+				AssemblerSlot<Assembler, Linear> linear_;
+				AssemblerSlot<MixedAssembler, Mixed> mixed_;
+				AssemblerSlot<Assembler, Pressure> pressure_;
+				AssemblerSlot<NLAssembler, NonLinear> non_linear_;
+
+				const auto &post() const
+				{
+					if constexpr (std::is_same_v<Post, Linear>)
+						return linear_.local_assembler();
+					else
+						return non_linear_.local_assembler();
+				}
+
+				template <class F>
+				void for_each_local_assembler(const F &f)
+				{
+					for_local_assembler(linear_, f);
+					for_local_assembler(mixed_, f);
+					for_local_assembler(pressure_, f);
+					for_local_assembler(non_linear_, f);
+				}
+
+				void unsupported(const std::string &what) const
+				{
+					log_and_throw_error(fmt::format("Formulation {} has no {}", name_, what));
+				}
+			};
+
+			// the assemblers of each formulation, <Linear, Mixed, Pressure, NonLinear, Post>
+			using NoAssemblers = FormulationAssemblers<void, void, void, void, void>;
+			using LaplacianAssemblers = FormulationAssemblers<Laplacian, void, void, void, Laplacian>;
+			using HelmholtzAssemblers = FormulationAssemblers<Helmholtz, void, void, void, Helmholtz>;
+			using BilaplacianAssemblers = FormulationAssemblers<BilaplacianMain, BilaplacianMixed, BilaplacianAux, void, BilaplacianMain>;
+			using LinearElasticityAssemblers = FormulationAssemblers<LinearElasticity, void, void, LinearElasticity, LinearElasticity>;
+			using HookeLinearElasticityAssemblers = FormulationAssemblers<HookeLinearElasticity, void, void, void, HookeLinearElasticity>;
+			using DampingAssemblers = FormulationAssemblers<void, void, void, ViscousDamping, void>;
+			using IncompressibleLinearElasticityAssemblers = FormulationAssemblers<IncompressibleLinearElasticityDispacement, IncompressibleLinearElasticityMixed, IncompressibleLinearElasticityPressure, void, IncompressibleLinearElasticityDispacement>;
+			using SaintVenantAssemblers = FormulationAssemblers<void, void, void, SaintVenantElasticity, SaintVenantElasticity>;
+			using NeoHookeanAssemblers = FormulationAssemblers<void, void, void, NeoHookeanElasticity, NeoHookeanElasticity>;
+			using MultiModelsAssemblers = FormulationAssemblers<void, void, void, MultiModel, MultiModel>;
+			// using OgdenAssemblers = FormulationAssemblers<void, void, void, OgdenElasticity, OgdenElasticity>;
+			using StokesAssemblers = FormulationAssemblers<StokesVelocity, StokesMixed, StokesPressure, void, StokesVelocity>;
+			using NavierStokesAssemblers = FormulationAssemblers<StokesVelocity, StokesMixed, StokesPressure, NavierStokesVelocity<true>, NavierStokesVelocity<true>, false>;
+			using NavierStokesPicardAssemblers = FormulationAssemblers<void, void, void, NavierStokesVelocity<false>, void, false>;
+
+			template <class Assemblers>
+			std::unique_ptr<FormulationAssembler> create_assemblers(const char *name)
+			{
+				return std::make_unique<Assemblers>(name);
+			}
+
+			struct FormulationProperties
+			{
+				bool is_scalar;
+				bool is_fluid;
+				bool is_mixed;
+				bool is_solution_displacement;
+				bool is_linear;
+				bool is_tensor() const { return !is_scalar; }
+				bool is_nonlinear() const { return !is_linear; }
+			};
+
+			struct FormulationEntry
+			{
+				const char *name;
+				AssemblerType type;
+				bool has_properties; // false for internal assemblers, not selectable as formulation
+				FormulationProperties properties;
+				std::unique_ptr<FormulationAssembler> (*create)(const char *name);
+			};
+
+			// registry of all formulations, ordered as AssemblerType
+			// a new formulation only needs an entry here, with the local assemblers it uses
+			// clang-format off
+			const std::array<FormulationEntry, size_t(AssemblerType::Unknown)> formulations = {{
+				{"Mass",                           AssemblerType::Mass,                           false, {},                                                                                                                                   &create_assemblers<NoAssemblers>},
+				{"Laplacian",                      AssemblerType::Laplacian,                      true,  {/*is_scalar=*/true,  /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/false, /*is_linear=*/true},  &create_assemblers<LaplacianAssemblers>},
+				{"Helmholtz",                      AssemblerType::Helmholtz,                      true,  {/*is_scalar=*/true,  /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/false, /*is_linear=*/true},  &create_assemblers<HelmholtzAssemblers>},
+				{"Bilaplacian",                    AssemblerType::Bilaplacian,                    true,  {/*is_scalar=*/true,  /*is_fluid=*/false, /*is_mixed=*/true,  /*is_solution_displacement=*/false, /*is_linear=*/true},  &create_assemblers<BilaplacianAssemblers>},
+				{"LinearElasticity",               AssemblerType::LinearElasticity,               true,  {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/true},  &create_assemblers<LinearElasticityAssemblers>},
+				{"HookeLinearElasticity",          AssemblerType::HookeLinearElasticity,          true,  {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/true},  &create_assemblers<HookeLinearElasticityAssemblers>},
+				{"Damping",                        AssemblerType::Damping,                        true,  {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/false}, &create_assemblers<DampingAssemblers>},
+				{"IncompressibleLinearElasticity", AssemblerType::IncompressibleLinearElasticity, true,  {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/true,  /*is_solution_displacement=*/true,  /*is_linear=*/true},  &create_assemblers<IncompressibleLinearElasticityAssemblers>},
+				{"SaintVenant",                    AssemblerType::SaintVenant,                    true,  {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/false}, &create_assemblers<SaintVenantAssemblers>},
+				{"NeoHookean",                     AssemblerType::NeoHookean,                     true,  {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/false}, &create_assemblers<NeoHookeanAssemblers>},
+				{"MultiModels",                    AssemblerType::MultiModels,                    true,  {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/false}, &create_assemblers<MultiModelsAssemblers>},
+				// {"Ogden",                       AssemblerType::Ogden,                          true,  {/*is_scalar=*/false, /*is_fluid=*/false, /*is_mixed=*/false, /*is_solution_displacement=*/true,  /*is_linear=*/false}, &create_assemblers<OgdenAssemblers>},
+				{"Stokes",                         AssemblerType::Stokes,                         true,  {/*is_scalar=*/false, /*is_fluid=*/true,  /*is_mixed=*/true,  /*is_solution_displacement=*/false, /*is_linear=*/true},  &create_assemblers<StokesAssemblers>},
+				{"NavierStokes",                   AssemblerType::NavierStokes,                   true,  {/*is_scalar=*/false, /*is_fluid=*/true,  /*is_mixed=*/true,  /*is_solution_displacement=*/false, /*is_linear=*/false}, &create_assemblers<NavierStokesAssemblers>},
+				{"NavierStokesPicard",             AssemblerType::NavierStokesPicard,             false, {},                                                                                                                                   &create_assemblers<NavierStokesPicardAssemblers>},
+				{"OperatorSplitting",              AssemblerType::OperatorSplitting,              true,  {/*is_scalar=*/false, /*is_fluid=*/true,  /*is_mixed=*/true,  /*is_solution_displacement=*/false, /*is_linear=*/false}, &create_assemblers<StokesAssemblers>},
+			}};
+			// clang-format on
+
+			AssemblerType find_formulation(const std::string &name)
+			{
+				static const std::unordered_map<std::string, AssemblerType> types = []() {
+					std::unordered_map<std::string, AssemblerType> res;
+					for (size_t i = 0; i < formulations.size(); ++i)
+					{
+						assert(size_t(formulations[i].type) == i);
+						res[formulations[i].name] = formulations[i].type;
+					}
+					return res;
+				}();
+
+				const auto it = types.find(name);
+				return it == types.end() ? AssemblerType::Unknown : it->second;
+			}
+
+			const FormulationProperties &properties(const Formulation &formulation)
+			{
+				if (formulation.type() == AssemblerType::Unknown || !formulations[size_t(formulation.type())].has_properties)
+					log_and_throw_error(fmt::format("Unknown formulation {}", formulation.name()));
+				return formulations[size_t(formulation.type())].properties;
+			}
+		} // namespace
+
+		Formulation::Formulation(const std::string &name)
+			: type_(find_formulation(name))
+		{
+			if (type_ == AssemblerType::Unknown)
+				unknown_name_ = name;
+		}
+
+		const std::string &Formulation::name() const
+		{
+			static const std::array<std::string, size_t(AssemblerType::Unknown)> names = []() {
+				std::array<std::string, size_t(AssemblerType::Unknown)> res;
+				for (size_t i = 0; i < formulations.size(); ++i)
+					res[i] = formulations[i].name;
+				return res;
+			}();
+
+			return type_ == AssemblerType::Unknown ? unknown_name_ : names[size_t(type_)];
+		}
 
 		AssemblerUtils::AssemblerUtils()
 		{
+			for (const auto &f : formulations)
+				assemblers_[size_t(f.type)] = f.create(f.name);
+		}
+
+		AssemblerUtils::~AssemblerUtils() = default;
+
+		const FormulationAssembler &AssemblerUtils::formulation_assembler(const Formulation &formulation) const
+		{
+			if (formulation.type() == AssemblerType::Unknown)
+				log_and_throw_error(fmt::format("Unknown formulation {}", formulation.name()));
+			return *assemblers_[size_t(formulation.type())];
 		}
 
 		std::vector<std::string> AssemblerUtils::scalar_assemblers()
 		{
 			std::vector<std::string> names;
-			for (const auto &[name, props] : formulation_properties)
+			for (const auto &f : formulations)
 			{
-				if (props.is_scalar)
-					names.push_back(name);
+				if (f.has_properties && f.properties.is_scalar)
+					names.push_back(f.name);
 			}
 			return names;
 		}
@@ -58,49 +509,54 @@ namespace polyfem
 		std::vector<std::string> AssemblerUtils::tensor_assemblers()
 		{
 			std::vector<std::string> names;
-			for (const auto &[name, props] : formulation_properties)
+			for (const auto &f : formulations)
 			{
-				if (props.is_tensor())
-					names.push_back(name);
+				if (f.has_properties && f.properties.is_tensor())
+					names.push_back(f.name);
 			}
 			return names;
 		}
 
-		bool AssemblerUtils::is_scalar(const std::string &assembler)
+		bool AssemblerUtils::is_scalar(const Formulation &assembler)
 		{
-			return formulation_properties.at(assembler).is_scalar;
+			return properties(assembler).is_scalar;
 		}
 
-		bool AssemblerUtils::is_fluid(const std::string &assembler)
+		bool AssemblerUtils::is_fluid(const Formulation &assembler)
 		{
-			return formulation_properties.at(assembler).is_fluid;
+			return properties(assembler).is_fluid;
 		}
 
-		bool AssemblerUtils::is_tensor(const std::string &assembler)
+		bool AssemblerUtils::is_tensor(const Formulation &assembler)
 		{
-			return formulation_properties.at(assembler).is_tensor();
+			return properties(assembler).is_tensor();
 		}
-		bool AssemblerUtils::is_mixed(const std::string &assembler)
+		bool AssemblerUtils::is_mixed(const Formulation &assembler)
 		{
-			return formulation_properties.at(assembler).is_mixed;
+			return properties(assembler).is_mixed;
 		}
 
-		bool AssemblerUtils::is_solution_displacement(const std::string &assembler)
+		bool AssemblerUtils::is_solution_displacement(const Formulation &assembler)
 		{
-			return formulation_properties.at(assembler).is_solution_displacement;
+			return properties(assembler).is_solution_displacement;
 		}
 
-		bool AssemblerUtils::is_linear(const std::string &assembler)
+		bool AssemblerUtils::is_linear(const Formulation &assembler)
 		{
-			return formulation_properties.at(assembler).is_linear;
+			return properties(assembler).is_linear;
 		}
 
 		bool AssemblerUtils::has_damping() const
 		{
-			return damping_.local_assembler().is_valid();
+			return static_cast<const DampingAssemblers &>(*assemblers_[size_t(AssemblerType::Damping)]).non_linear().is_valid();
+		}
+
+		const LameParameters &AssemblerUtils::lame_params() const
+		{
+			return static_cast<const LinearElasticityAssemblers &>(*assemblers_[size_t(AssemblerType::LinearElasticity)]).linear().lame_params();
 		}
 
-		void AssemblerUtils::assemble_problem(const std::string &assembler,
+		void AssemblerUtils::assemble_problem(const Formulation &assembler,
 											  const bool is_volume,
 											  const int n_basis,
 											  const std::vector<ElementBases> &bases,
@@ -108,41 +564,10 @@ namespace polyfem
 											  const AssemblyValsCache &cache,
 											  StiffnessMatrix &stiffness) const
 		{
-			if (assembler == "Helmholtz")
-				helmholtz_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-			else if (assembler == "Laplacian")
-				laplacian_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-			else if (assembler == "Bilaplacian")
-				bilaplacian_main_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-
-			else if (assembler == "LinearElasticity")
-				linear_elasticity_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-			else if (assembler == "HookeLinearElasticity")
-				hooke_linear_elasticity_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-			else if (assembler == "Stokes" || assembler == "NavierStokes" || assembler == "OperatorSplitting")
-				stokes_velocity_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-			else if (assembler == "IncompressibleLinearElasticity")
-				incompressible_lin_elast_displacement_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-
-			else if (assembler == "SaintVenant")
-				return;
-			else if (assembler == "NeoHookean")
-				return;
-			else if (assembler == "MultiModels")
-				return;
-			// else if (assembler == "NavierStokes")
-			// return;
-			// else if(assembler == "Ogden")
-			//	return;
-			else
-			{
-				logger().warn("{} not found, fallback to default", assembler);
-				assert(false);
-				laplacian_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-			}
+			formulation_assembler(assembler).assemble_problem(is_volume, n_basis, bases, gbases, cache, stiffness);
 		}
 
-		void AssemblerUtils::assemble_mass_matrix(const std::string &assembler,
+		void AssemblerUtils::assemble_mass_matrix(const Formulation &assembler,
 												  const bool is_volume,
 												  const int n_basis,
 												  const bool use_density,
@@ -158,7 +583,7 @@ namespace polyfem
 				mass_mat_no_density_.assemble(is_volume, n_basis, bases, gbases, cache, mass, true);
 		}
 
-		void AssemblerUtils::assemble_mixed_problem(const std::string &assembler,
+		void AssemblerUtils::assemble_mixed_problem(const Formulation &assembler,
 													const bool is_volume,
 													const int n_psi_basis,
 													const int n_phi_basis,
@@ -170,23 +595,10 @@ namespace polyfem
 													StiffnessMatrix &stiffness) const
 		{
 			// TODO add cache
-			if (assembler == "Bilaplacian")
-				bilaplacian_mixed_.assemble(is_volume, n_psi_basis, n_phi_basis, psi_bases, phi_bases, gbases, psi_cache, phi_cache, stiffness);
-
-			else if (assembler == "Stokes" || assembler == "NavierStokes" || assembler == "OperatorSplitting")
-				stokes_mixed_.assemble(is_volume, n_psi_basis, n_phi_basis, psi_bases, phi_bases, gbases, psi_cache, phi_cache, stiffness);
-			else if (assembler == "IncompressibleLinearElasticity")
-				incompressible_lin_elast_mixed_.assemble(is_volume, n_psi_basis, n_phi_basis, psi_bases, phi_bases, gbases, psi_cache, phi_cache, stiffness);
-
-			else
-			{
-				logger().warn("{} not found, fallback to default", assembler);
-				assert(false);
-				stokes_mixed_.assemble(is_volume, n_psi_basis, n_phi_basis, psi_bases, phi_bases, gbases, psi_cache, phi_cache, stiffness);
-			}
+			formulation_assembler(assembler).assemble_mixed_problem(is_volume, n_psi_basis, n_phi_basis, psi_bases, phi_bases, gbases, psi_cache, phi_cache, stiffness);
 		}
 
-		void AssemblerUtils::assemble_pressure_problem(const std::string &assembler,
+		void AssemblerUtils::assemble_pressure_problem(const Formulation &assembler,
 													   const bool is_volume,
 													   const int n_basis,
 													   const std::vector<ElementBases> &bases,
@@ -194,23 +606,10 @@ namespace polyfem
 													   const AssemblyValsCache &cache,
 													   StiffnessMatrix &stiffness) const
 		{
-			if (assembler == "Bilaplacian")
-				bilaplacian_aux_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-
-			else if (assembler == "Stokes" || assembler == "NavierStokes" || assembler == "OperatorSplitting")
-				stokes_pressure_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-			else if (assembler == "IncompressibleLinearElasticity")
-				incompressible_lin_elast_pressure_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-
-			else
-			{
-				logger().warn("{} not found, fallback to default", assembler);
-				assert(false);
-				stokes_pressure_.assemble(is_volume, n_basis, bases, gbases, cache, stiffness);
-			}
+			formulation_assembler(assembler).assemble_pressure_problem(is_volume, n_basis, bases, gbases, cache, stiffness);
 		}
 
-		double AssemblerUtils::assemble_energy(const std::string &assembler,
+		double AssemblerUtils::assemble_energy(const Formulation &assembler,
 											   const bool is_volume,
 											   const std::vector<ElementBases> &bases,
 											   const std::vector<ElementBases> &gbases,
@@ -219,24 +618,10 @@ namespace polyfem
 											   const Eigen::MatrixXd &displacement,
 											   const Eigen::MatrixXd &displacement_prev) const
 		{
-			if (assembler == "SaintVenant")
-				return saint_venant_elasticity_.assemble(is_volume, bases, gbases, cache, dt, displacement, displacement_prev);
-			else if (assembler == "NeoHookean")
-				return neo_hookean_elasticity_.assemble(is_volume, bases, gbases, cache, dt, displacement, displacement_prev);
-			else if (assembler == "MultiModels")
-				return multi_models_elasticity_.assemble(is_volume, bases, gbases, cache, dt, displacement, displacement_prev);
-			else if (assembler == "Damping")
-				return damping_.assemble(is_volume, bases, gbases, cache, dt, displacement, displacement_prev);
-
-			// else if(assembler == "Ogden")
-			//	return ogden_elasticity_.assemble(is_volume, bases, gbases, cache, dt, displacement, displacement_prev);
-			else if (assembler == "LinearElasticity")
-				return linear_elasticity_energy_.assemble(is_volume, bases, gbases, cache, dt, displacement, displacement_prev);
-			else
-				return 0;
+			return formulation_assembler(assembler).assemble_energy(is_volume, bases, gbases, cache, dt, displacement, displacement_prev);
 		}
 
-		void AssemblerUtils::assemble_energy_gradient(const std::string &assembler,
+		void AssemblerUtils::assemble_energy_gradient(const Formulation &assembler,
 													  const bool is_volume,
 													  const int n_basis,
 													  const std::vector<ElementBases> &bases,
@@ -247,25 +632,10 @@ namespace polyfem
 													  const Eigen::MatrixXd &displacement_prev,
 													  Eigen::MatrixXd &grad) const
 		{
-			if (assembler == "SaintVenant")
-				saint_venant_elasticity_.assemble_grad(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, grad);
-			else if (assembler == "NeoHookean")
-				neo_hookean_elasticity_.assemble_grad(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, grad);
-			else if (assembler == "MultiModels")
-				multi_models_elasticity_.assemble_grad(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, grad);
-			else if (assembler == "Damping")
-				damping_.assemble_grad(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, grad);
-			else if (assembler == "NavierStokes")
-				navier_stokes_velocity_.assemble_grad(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, grad);
-			else if (assembler == "LinearElasticity")
-				linear_elasticity_energy_.assemble_grad(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, grad);
-			// else if(assembler == "Ogden")
-			//	ogden_elasticity_.assemble_grad(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, grad);
-			else
-				return;
+			formulation_assembler(assembler).assemble_energy_gradient(is_volume, n_basis, bases, gbases, cache, dt, displacement, displacement_prev, grad);
 		}
 
-		void AssemblerUtils::assemble_energy_hessian(const std::string &assembler,
+		void AssemblerUtils::assemble_energy_hessian(const Formulation &assembler,
 													 const bool is_volume,
 													 const int n_basis,
 													 const bool project_to_psd,
@@ -278,28 +648,44 @@ namespace polyfem
 													 utils::SpareMatrixCache &mat_cache,
 													 StiffnessMatrix &hessian) const
 		{
-			if (assembler == "SaintVenant")
-				saint_venant_elasticity_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, mat_cache, hessian);
-			else if (assembler == "NeoHookean")
-				neo_hookean_elasticity_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, mat_cache, hessian);
-			else if (assembler == "MultiModels")
-				multi_models_elasticity_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, mat_cache, hessian);
-			else if (assembler == "Damping")
-				damping_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, mat_cache, hessian);
-			else if (assembler == "NavierStokesPicard")
-				navier_stokes_velocity_picard_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, mat_cache, hessian);
-			else if (assembler == "NavierStokes")
-				navier_stokes_velocity_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, mat_cache, hessian);
-			else if (assembler == "LinearElasticity")
-				linear_elasticity_energy_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, mat_cache, hessian);
-
-			// else if(assembler == "Ogden")
-			//	ogden_elasticity_.assemble_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, mat_cache, hessian);
-			else
-				return;
+			formulation_assembler(assembler).assemble_energy_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, mat_cache, hessian);
+		}
+
+		void AssemblerUtils::assemble_energy_hessian_apply(const Formulation &assembler,
+														   const bool is_volume,
+														   const int n_basis,
+														   const bool project_to_psd,
+														   const std::vector<ElementBases> &bases,
+														   const std::vector<ElementBases> &gbases,
+														   const AssemblyValsCache &cache,
+														   const double dt,
+														   const Eigen::MatrixXd &displacement,
+														   const Eigen::MatrixXd &displacement_prev,
+														   const Eigen::MatrixXd &direction,
+														   Eigen::MatrixXd &result) const
+		{
+			formulation_assembler(assembler).assemble_energy_hessian_apply(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, direction, result);
+		}
+
+		void AssemblerUtils::assemble_energy_gradient_hessian(const Formulation &assembler,
+															  const bool is_volume,
+															  const int n_basis,
+															  const bool project_to_psd,
+															  const std::vector<ElementBases> &bases,
+															  const std::vector<ElementBases> &gbases,
+															  const AssemblyValsCache &cache,
+															  const double dt,
+															  const Eigen::MatrixXd &displacement,
+															  const Eigen::MatrixXd &displacement_prev,
+															  double *energy,
+															  Eigen::MatrixXd *grad,
+															  utils::SpareMatrixCache &mat_cache,
+															  StiffnessMatrix *hessian) const
+		{
+			formulation_assembler(assembler).assemble_energy_gradient_hessian(is_volume, n_basis, project_to_psd, bases, gbases, cache, dt, displacement, displacement_prev, energy, grad, mat_cache, hessian);
 		}
 
-		void AssemblerUtils::compute_scalar_value(const std::string &assembler,
+		void AssemblerUtils::compute_scalar_value(const Formulation &assembler,
 												  const int el_id,
 												  const ElementBases &bs,
 												  const ElementBases &gbs,
@@ -307,40 +693,10 @@ namespace polyfem
 												  const Eigen::MatrixXd &fun,
 												  Eigen::MatrixXd &result) const
 		{
-			if (assembler == "Mass" || assembler == "Laplacian" || assembler == "Helmholtz" || assembler == "Bilaplacian")
-				return;
-
-			else if (assembler == "LinearElasticity")
-				linear_elasticity_.local_assembler().compute_von_mises_stresses(el_id, bs, gbs, local_pts, fun, result);
-			else if (assembler == "HookeLinearElasticity")
-				hooke_linear_elasticity_.local_assembler().compute_von_mises_stresses(el_id, bs, gbs, local_pts, fun, result);
-
-			else if (assembler == "SaintVenant")
-				saint_venant_elasticity_.local_assembler().compute_von_mises_stresses(el_id, bs, gbs, local_pts, fun, result);
-			else if (assembler == "NeoHookean")
-				neo_hookean_elasticity_.local_assembler().compute_von_mises_stresses(el_id, bs, gbs, local_pts, fun, result);
-			else if (assembler == "MultiModels")
-				multi_models_elasticity_.local_assembler().compute_von_mises_stresses(el_id, bs, gbs, local_pts, fun, result);
-			// else if(assembler == "Ogden")
-			//	ogden_elasticity_.local_assembler().compute_von_mises_stresses(bs, gbs, local_pts, fun, result);
-
-			else if (assembler == "Stokes" || assembler == "OperatorSplitting")
-				stokes_velocity_.local_assembler().compute_norm_velocity(bs, gbs, local_pts, fun, result);
-			else if (assembler == "NavierStokes")
-				navier_stokes_velocity_.local_assembler().compute_norm_velocity(bs, gbs, local_pts, fun, result);
-
-			else if (assembler == "IncompressibleLinearElasticity")
-				incompressible_lin_elast_displacement_.local_assembler().compute_von_mises_stresses(el_id, bs, gbs, local_pts, fun, result);
-
-			else
-			{
-				logger().warn("{} not found, fallback to default", assembler);
-				assert(false);
-				linear_elasticity_.local_assembler().compute_von_mises_stresses(el_id, bs, gbs, local_pts, fun, result);
-			}
+			formulation_assembler(assembler).compute_scalar_value(el_id, bs, gbs, local_pts, fun, result);
 		}
 
-		void AssemblerUtils::compute_tensor_value(const std::string &assembler,
+		void AssemblerUtils::compute_tensor_value(const Formulation &assembler,
 												  const int el_id,
 												  const ElementBases &bs,
 												  const ElementBases &gbs,
@@ -348,212 +704,49 @@ namespace polyfem
 												  const Eigen::MatrixXd &fun,
 												  Eigen::MatrixXd &result) const
 		{
-			if (assembler == "Mass" || assembler == "Laplacian" || assembler == "Helmholtz" || assembler == "Bilaplacian")
-				return;
-
-			else if (assembler == "LinearElasticity")
-				linear_elasticity_.local_assembler().compute_stress_tensor(el_id, bs, gbs, local_pts, fun, result);
-			else if (assembler == "HookeLinearElasticity")
-				hooke_linear_elasticity_.local_assembler().compute_stress_tensor(el_id, bs, gbs, local_pts, fun, result);
-
-			else if (assembler == "SaintVenant")
-				saint_venant_elasticity_.local_assembler().compute_stress_tensor(el_id, bs, gbs, local_pts, fun, result);
-			else if (assembler == "NeoHookean")
-				neo_hookean_elasticity_.local_assembler().compute_stress_tensor(el_id, bs, gbs, local_pts, fun, result);
-			else if (assembler == "MultiModels")
-				multi_models_elasticity_.local_assembler().compute_stress_tensor(el_id, bs, gbs, local_pts, fun, result);
-			// else if(assembler == "Ogden")
-			//	ogden_elasticity_.local_assembler().compute_stress_tensor(bs, gbs, local_pts, fun, result);
-
-			else if (assembler == "Stokes" || assembler == "OperatorSplitting") // WARNING stokes and NS dont have el_id
-				stokes_velocity_.local_assembler().compute_stress_tensor(bs, gbs, local_pts, fun, result);
-			else if (assembler == "NavierStokes")
-				navier_stokes_velocity_.local_assembler().compute_stress_tensor(bs, gbs, local_pts, fun, result);
-			else if (assembler == "IncompressibleLinearElasticity")
-				incompressible_lin_elast_displacement_.local_assembler().compute_stress_tensor(el_id, bs, gbs, local_pts, fun, result);
-
-			else
-			{
-				logger().warn("{} not found, fallback to default", assembler);
-				assert(false);
-				linear_elasticity_.local_assembler().compute_stress_tensor(el_id, bs, gbs, local_pts, fun, result);
-			}
+			formulation_assembler(assembler).compute_tensor_value(el_id, bs, gbs, local_pts, fun, result);
 		}
 
-		VectorNd AssemblerUtils::compute_rhs(const std::string &assembler, const AutodiffHessianPt &pt) const
-		{
-			if (assembler == "Laplacian")
-				return laplacian_.local_assembler().compute_rhs(pt);
-			else if (assembler == "Helmholtz")
-				return helmholtz_.local_assembler().compute_rhs(pt);
-			else if (assembler == "Bilaplacian")
-				return bilaplacian_main_.local_assembler().compute_rhs(pt);
-
-			else if (assembler == "LinearElasticity")
-				return linear_elasticity_.local_assembler().compute_rhs(pt);
-			else if (assembler == "HookeLinearElasticity")
-				return hooke_linear_elasticity_.local_assembler().compute_rhs(pt);
-
-			else if (assembler == "SaintVenant")
-				return saint_venant_elasticity_.local_assembler().compute_rhs(pt);
-			else if (assembler == "NeoHookean")
-				return neo_hookean_elasticity_.local_assembler().compute_rhs(pt);
-			else if (assembler == "MultiModels")
-				return multi_models_elasticity_.local_assembler().compute_rhs(pt);
-			// else if(assembler == "Ogden")
-			//	return ogden_elasticity_.local_assembler().compute_rhs(pt);
-
-			else if (assembler == "Stokes" || assembler == "OperatorSplitting")
-				return stokes_velocity_.local_assembler().compute_rhs(pt);
-			else if (assembler == "NavierStokes")
-				return navier_stokes_velocity_.local_assembler().compute_rhs(pt);
-			else if (assembler == "IncompressibleLinearElasticity")
-				return incompressible_lin_elast_displacement_.local_assembler().compute_rhs(pt);
-
-			else
-			{
-				logger().warn("{} not found, fallback to default", assembler);
-
-				assert(false);
-				return laplacian_.local_assembler().compute_rhs(pt);
-			}
+		VectorNd AssemblerUtils::compute_rhs(const Formulation &assembler, const AutodiffHessianPt &pt) const
+		{
+			return formulation_assembler(assembler).compute_rhs(pt);
 		}
 
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>
-		AssemblerUtils::local_assemble(const std::string &assembler, const ElementAssemblyValues &vals, const int i, const int j, const QuadratureVector &da) const
-		{
-			if (assembler == "Laplacian")
-				return laplacian_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-			else if (assembler == "Helmholtz")
-				return helmholtz_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-			else if (assembler == "Bilaplacian")
-				return bilaplacian_main_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-
-			else if (assembler == "LinearElasticity")
-				return linear_elasticity_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-			else if (assembler == "HookeLinearElasticity")
-				return hooke_linear_elasticity_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-
-			// else if(assembler == "SaintVenant")
-			// 	return saint_venant_elasticity_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-			// else if(assembler == "NeoHookean")
-			// 	return neo_hookean_elasticity_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-			// else if(assembler == "MultiModels")
-			// 	return multi_models_elasticity_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-			// else if(assembler == "Ogden")
-			// 	return ogden_elasticity_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-
-			else if (assembler == "Stokes" || assembler == "OperatorSplitting")
-				return stokes_velocity_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-			else if (assembler == "IncompressibleLinearElasticity")
-				return incompressible_lin_elast_displacement_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-
-			else
-			{
-				logger().warn("{} not found, fallback to default", assembler);
-
-				assert(false);
-				return laplacian_.local_assembler().assemble(LinearAssemblerData(vals, i, j, da));
-			}
+		AssemblerUtils::local_assemble(const Formulation &assembler, const ElementAssemblyValues &vals, const int i, const int j, const QuadratureVector &da) const
+		{
+			return formulation_assembler(assembler).local_assemble(vals, i, j, da);
 		}
 
-		Eigen::Matrix<AutodiffScalarGrad, Eigen::Dynamic, 1, 0, 3, 1> AssemblerUtils::kernel(const std::string &assembler, const int dim, const AutodiffGradPt &rvect, const AutodiffScalarGrad &r) const
+		Eigen::Matrix<AutodiffScalarGrad, Eigen::Dynamic, 1, 0, 3, 1> AssemblerUtils::kernel(const Formulation &assembler, const int dim, const AutodiffGradPt &rvect, const AutodiffScalarGrad &r) const
 		{
-			if (assembler == "Laplacian")
-				return laplacian_.local_assembler().kernel(dim, r);
-			else if (assembler == "Helmholtz")
-				return helmholtz_.local_assembler().kernel(dim, r);
-			else if (assembler == "LinearElasticity")
-				return linear_elasticity_.local_assembler().kernel(dim, rvect);
-			// else if(assembler == "HookeLinearElasticity")
-			// 	return hooke_linear_elasticity_.local_assembler().kernel(dim, r);
-
-			// else if(assembler == "SaintVenant")
-			// 	return saint_venant_elasticity_.local_assembler().kernel(dim, r);
-			// else if(assembler == "NeoHookean")
-			// 	return neo_hookean_elasticity_.local_assembler().kernel(dim, r);
-			// else if(assembler == "MultiModels")
-			// 	return multi_models_elasticity_.local_assembler().kernel(dim, r);
-			// else if(assembler == "Ogden")
-			// 	return ogden_elasticity_.local_assembler().kernel(dim, r);
-
-			else
-			{
-				logger().warn("{} not found, fallback to default", assembler);
-
-				assert(false);
-				return laplacian_.local_assembler().kernel(dim, r);
-			}
+			return formulation_assembler(assembler).kernel(dim, rvect, r);
 		}
 
-		void AssemblerUtils::set_size(const std::string &assembler, const int dim)
+		void AssemblerUtils::set_size(const Formulation &assembler, const int dim)
 		{
 			int size = dim;
-			if (assembler == "Helmholtz" || assembler == "Laplacian")
+			if (assembler.type() == AssemblerType::Helmholtz || assembler.type() == AssemblerType::Laplacian)
 				size = 1;
 			mass_mat_.local_assembler().set_size(size);
 			mass_mat_no_density_.local_assembler().set_size(size);
 
-			linear_elasticity_.local_assembler().set_size(dim);
-			linear_elasticity_energy_.local_assembler().set_size(dim);
-			hooke_linear_elasticity_.local_assembler().set_size(dim);
-
-			saint_venant_elasticity_.local_assembler().set_size(dim);
-			neo_hookean_elasticity_.local_assembler().set_size(dim);
-			multi_models_elasticity_.local_assembler().set_size(dim);
-			// ogden_elasticity_.local_assembler().set_size(dim);
-
-			damping_.local_assembler().set_size(dim);
-
-			incompressible_lin_elast_displacement_.local_assembler().set_size(dim);
-			incompressible_lin_elast_mixed_.local_assembler().set_size(dim);
-			incompressible_lin_elast_pressure_.local_assembler().set_size(dim);
-
-			stokes_velocity_.local_assembler().set_size(dim);
-			stokes_mixed_.local_assembler().set_size(dim);
-			// stokes_pressure_.local_assembler().set_size(dim);
-
-			navier_stokes_velocity_.local_assembler().set_size(dim);
-			navier_stokes_velocity_picard_.local_assembler().set_size(dim);
+			for (auto &a : assemblers_)
+				a->set_size(dim);
 		}
 
 		void AssemblerUtils::init_multimodels(const std::vector<std::string> &materials)
 		{
-			multi_models_elasticity_.local_assembler().init_multimodels(materials);
+			for (auto &a : assemblers_)
+				a->init_multimodels(materials);
 		}
 
 		void AssemblerUtils::add_multimaterial(const int index, const json &params)
 		{
 			mass_mat_.local_assembler().add_multimaterial(index, params);
 
-			laplacian_.local_assembler().add_multimaterial(index, params);
-			helmholtz_.local_assembler().add_multimaterial(index, params);
-
-			bilaplacian_main_.local_assembler().add_multimaterial(index, params);
-			bilaplacian_mixed_.local_assembler().add_multimaterial(index, params);
-			bilaplacian_aux_.local_assembler().add_multimaterial(index, params);
-
-			linear_elasticity_.local_assembler().add_multimaterial(index, params);
-			linear_elasticity_energy_.local_assembler().add_multimaterial(index, params);
-			hooke_linear_elasticity_.local_assembler().add_multimaterial(index, params);
-
-			saint_venant_elasticity_.local_assembler().add_multimaterial(index, params);
-			neo_hookean_elasticity_.local_assembler().add_multimaterial(index, params);
-			multi_models_elasticity_.local_assembler().add_multimaterial(index, params);
-			// ogden_elasticity_.local_assembler().add_multimaterial(index, params);
-
-			damping_.local_assembler().add_multimaterial(index, params);
-
-			stokes_velocity_.local_assembler().add_multimaterial(index, params);
-			stokes_mixed_.local_assembler().add_multimaterial(index, params);
-			stokes_pressure_.local_assembler().add_multimaterial(index, params);
-
-			navier_stokes_velocity_.local_assembler().add_multimaterial(index, params);
-			navier_stokes_velocity_picard_.local_assembler().add_multimaterial(index, params);
-
-			incompressible_lin_elast_displacement_.local_assembler().add_multimaterial(index, params);
-			incompressible_lin_elast_mixed_.local_assembler().add_multimaterial(index, params);
-			incompressible_lin_elast_pressure_.local_assembler().add_multimaterial(index, params);
+			for (auto &a : assemblers_)
+				a->add_multimaterial(index, params);
 		}
 
 		void AssemblerUtils::merge_mixed_matrices(
@@ -24,6 +24,8 @@
 
 #include <polyfem/utils/MatrixUtils.hpp>
 
+#include <array>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -31,15 +33,59 @@ namespace polyfem
 {
 	namespace assembler
 	{
+		// all the assemblers known by AssemblerUtils, in the order of the registry in AssemblerUtils.cpp
+		enum class AssemblerType
+		{
+			Mass,
+			Laplacian,
+			Helmholtz,
+			Bilaplacian,
+			LinearElasticity,
+			HookeLinearElasticity,
+			Damping,
+			IncompressibleLinearElasticity,
+			SaintVenant,
+			NeoHookean,
+			MultiModels,
+			Stokes,
+			NavierStokes,
+			NavierStokesPicard,
+			OperatorSplitting,
+			Unknown
+		};
+
+		// formulation name resolved once into its AssemblerType
+		// the constructors are implicit so that names can be passed directly,
+		// callers dispatching repeatedly should keep a Formulation instead of the name
+		class Formulation
+		{
+		public:
+			// unknown formulation with an empty name
+			Formulation() : type_(AssemblerType::Unknown) {}
+			Formulation(const std::string &name);
+			Formulation(const char *name) : Formulation(std::string(name)) {}
+
+			AssemblerType type() const { return type_; }
+			const std::string &name() const;
+
+		private:
+			AssemblerType type_;
+			std::string unknown_name_;
+		};
+
+		// the assemblers of one formulation, defined with the registry in AssemblerUtils.cpp
+		class FormulationAssembler;
+
 		// factory class that dispaces call to the different assemblers
 		// templated with differnt local assemblers
 		class AssemblerUtils
 		{
 		public:
 			AssemblerUtils();
+			~AssemblerUtils();
 
 			// Linear, assembler is the name of the formulation
-			void assemble_problem(const std::string &assembler,
+			void assemble_problem(const Formulation &assembler,
 								  const bool is_volume,
 								  const int n_basis,
 								  const std::vector<basis::ElementBases> &bases,
@@ -48,7 +94,7 @@ namespace polyfem
 								  StiffnessMatrix &stiffness) const;
 
 			// mass matrix assembler, assembler is the name of the formulation
-			void assemble_mass_matrix(const std::string &assembler,
+			void assemble_mass_matrix(const Formulation &assembler,
 									  const bool is_volume,
 									  const int n_basis,
 									  const bool use_density,
@@ -58,7 +104,7 @@ namespace polyfem
 									  StiffnessMatrix &mass) const;
 
 			// mixed assembler phi is the tensor, psi the scalar, assembler is the name of the formulation
-			void assemble_mixed_problem(const std::string &assembler,
+			void assemble_mixed_problem(const Formulation &assembler,
 										const bool is_volume,
 										const int n_psi_basis,
 										const int n_phi_basis,
@@ -69,7 +115,7 @@ namespace polyfem
 										const AssemblyValsCache &phi_cache,
 										StiffnessMatrix &stiffness) const;
 			// pressure pressure assembler, assembler is the name of the formulation
-			void assemble_pressure_problem(const std::string &assembler,
+			void assemble_pressure_problem(const Formulation &assembler,
 										   const bool is_volume,
 										   const int n_basis,
 										   const std::vector<basis::ElementBases> &bases,
@@ -78,7 +124,7 @@ namespace polyfem
 										   StiffnessMatrix &stiffness) const;
 
 			// Non linear energy, assembler is the name of the formulation
-			double assemble_energy(const std::string &assembler,
+			double assemble_energy(const Formulation &assembler,
 								   const bool is_volume,
 								   const std::vector<basis::ElementBases> &bases,
 								   const std::vector<basis::ElementBases> &gbases,
@@ -88,7 +134,7 @@ namespace polyfem
 								   const Eigen::MatrixXd &displacement_prev) const;
 
 			// non linear gradient, assembler is the name of the formulation
-			void assemble_energy_gradient(const std::string &assembler,
+			void assemble_energy_gradient(const Formulation &assembler,
 										  const bool is_volume,
 										  const int n_basis,
 										  const std::vector<basis::ElementBases> &bases,
@@ -99,7 +145,7 @@ namespace polyfem
 										  const Eigen::MatrixXd &displacement_prev,
 										  Eigen::MatrixXd &grad) const;
 			// non-linear hessian, assembler is the name of the formulation
-			void assemble_energy_hessian(const std::string &assembler,
+			void assemble_energy_hessian(const Formulation &assembler,
 										 const bool is_volume,
 										 const int n_basis,
 										 const bool project_to_psd,
@@ -111,9 +157,40 @@ namespace polyfem
 										 const Eigen::MatrixXd &displacement_prev,
 										 utils::SpareMatrixCache &mat_cache,
 										 StiffnessMatrix &hessian) const;
+			// non-linear energy, gradient, and hessian in a single pass over the elements,
+			// null outputs are skipped, assembler is the name of the formulation
+			void assemble_energy_gradient_hessian(const Formulation &assembler,
+												  const bool is_volume,
+												  const int n_basis,
+												  const bool project_to_psd,
+												  const std::vector<basis::ElementBases> &bases,
+												  const std::vector<basis::ElementBases> &gbases,
+												  const AssemblyValsCache &cache,
+												  const double dt,
+												  const Eigen::MatrixXd &displacement,
+												  const Eigen::MatrixXd &displacement_prev,
+												  double *energy,
+												  Eigen::MatrixXd *grad,
+												  utils::SpareMatrixCache &mat_cache,
+												  StiffnessMatrix *hessian) const;
+
+			// non-linear hessian times direction, computed element by element without assembling the hessian,
+			// assembler is the name of the formulation
+			void assemble_energy_hessian_apply(const Formulation &assembler,
+											   const bool is_volume,
+											   const int n_basis,
+											   const bool project_to_psd,
+											   const std::vector<basis::ElementBases> &bases,
+											   const std::vector<basis::ElementBases> &gbases,
+											   const AssemblyValsCache &cache,
+											   const double dt,
+											   const Eigen::MatrixXd &displacement,
+											   const Eigen::MatrixXd &displacement_prev,
+											   const Eigen::MatrixXd &direction,
+											   Eigen::MatrixXd &result) const;
 
 			// plotting (eg von mises), assembler is the name of the formulation
-			void compute_scalar_value(const std::string &assembler,
+			void compute_scalar_value(const Formulation &assembler,
 									  const int el_id,
 									  const basis::ElementBases &bs,
 									  const basis::ElementBases &gbs,
@@ -121,7 +198,7 @@ namespace polyfem
 									  const Eigen::MatrixXd &fun,
 									  Eigen::MatrixXd &result) const;
 			// computes tensor, assembler is the name of the formulation
-			void compute_tensor_value(const std::string &assembler,
+			void compute_tensor_value(const Formulation &assembler,
 									  const int el_id,
 									  const basis::ElementBases &bs,
 									  const basis::ElementBases &gbs,
@@ -130,39 +207,39 @@ namespace polyfem
 									  Eigen::MatrixXd &result) const;
 
 			// for errors, uses the rhs methods inside local assemblers
-			VectorNd compute_rhs(const std::string &assembler, const AutodiffHessianPt &pt) const;
+			VectorNd compute_rhs(const Formulation &assembler, const AutodiffHessianPt &pt) const;
 
 			// for constraints in polygonal bases
 			Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>
-			local_assemble(const std::string &assembler,
+			local_assemble(const Formulation &assembler,
 						   const ElementAssemblyValues &vals,
 						   const int i,
 						   const int j,
 						   const QuadratureVector &da) const;
 
 			// returns the kernel of the assembler, if present
-			Eigen::Matrix<AutodiffScalarGrad, Eigen::Dynamic, 1, 0, 3, 1> kernel(const std::string &assembler, const int dim, const AutodiffGradPt &rvect, const AutodiffScalarGrad &r) const;
+			Eigen::Matrix<AutodiffScalarGrad, Eigen::Dynamic, 1, 0, 3, 1> kernel(const Formulation &assembler, const int dim, const AutodiffGradPt &rvect, const AutodiffScalarGrad &r) const;
 
 			// dispaces to all set parameters of the local assemblers
 			void add_multimaterial(const int index, const json &params);
-			void set_size(const std::string &assembler, const int dim);
+			void set_size(const Formulation &assembler, const int dim);
 			void init_multimodels(const std::vector<std::string> &materials);
-			const LameParameters &lame_params() const { return linear_elasticity_.local_assembler().lame_params(); }
+			const LameParameters &lame_params() const;
 			const Density &density() const { return mass_mat_.local_assembler().density(); }
 			// checks if assembler is linear
-			static bool is_linear(const std::string &assembler);
+			static bool is_linear(const Formulation &assembler);
 
 			// checks if assembler solution is displacement (true for elasticty)
-			static bool is_solution_displacement(const std::string &assembler);
+			static bool is_solution_displacement(const Formulation &assembler);
 
 			// checks if assembler is scalar (Laplace and Helmolz)
-			static bool is_scalar(const std::string &assembler);
+			static bool is_scalar(const Formulation &assembler);
 			// checks if assembler is tensor (other)
-			static bool is_tensor(const std::string &assembler);
+			static bool is_tensor(const Formulation &assembler);
 			// checks if assembler is mixed (eg, stokes)
-			static bool is_mixed(const std::string &assembler);
+			static bool is_mixed(const Formulation &assembler);
 			// checks if it is a fluid simulation
-			static bool is_fluid(const std::string &assembler);
+			static bool is_fluid(const Formulation &assembler);
 
 			bool has_damping() const;
 
@@ -180,38 +257,15 @@ namespace polyfem
 				StiffnessMatrix &stiffness);
 
 		private:
-			// all assemblers
+			// assemblers of every formulation indexed by AssemblerType, created by the registry
+			std::array<std::unique_ptr<FormulationAssembler>, size_t(AssemblerType::Unknown)> assemblers_;
+
+			// the mass matrices are shared by all formulations
 			Assembler<Mass> mass_mat_;
 			Assembler<Mass> mass_mat_no_density_;
 
-			Assembler<Laplacian> laplacian_;
-			Assembler<Helmholtz> helmholtz_;
-
-			Assembler<BilaplacianMain> bilaplacian_main_;
-			MixedAssembler<BilaplacianMixed> bilaplacian_mixed_;
-			Assembler<BilaplacianAux> bilaplacian_aux_;
-
-			Assembler<LinearElasticity> linear_elasticity_;
-			NLAssembler<LinearElasticity> linear_elasticity_energy_;
-			Assembler<HookeLinearElasticity> hooke_linear_elasticity_;
-
-			NLAssembler<SaintVenantElasticity> saint_venant_elasticity_;
-			NLAssembler<NeoHookeanElasticity> neo_hookean_elasticity_;
-			NLAssembler<MultiModel> multi_models_elasticity_;
-			// NLAssembler<OgdenElasticity> ogden_elasticity_;
-
-			NLAssembler<ViscousDamping> damping_;
-
-			Assembler<StokesVelocity> stokes_velocity_;
-			MixedAssembler<StokesMixed> stokes_mixed_;
-			Assembler<StokesPressure> stokes_pressure_;
-
-			NLAssembler<NavierStokesVelocity<false>> navier_stokes_velocity_picard_;
-			NLAssembler<NavierStokesVelocity<true>> navier_stokes_velocity_;
-
-			Assembler<IncompressibleLinearElasticityDispacement> incompressible_lin_elast_displacement_;
-			MixedAssembler<IncompressibleLinearElasticityMixed> incompressible_lin_elast_mixed_;
-			Assembler<IncompressibleLinearElasticityPressure> incompressible_lin_elast_pressure_;
+			// assemblers of formulation, throws if it is unknown
+			const FormulationAssembler &formulation_assembler(const Formulation &formulation) const;
 		};
 	} // namespace assembler
 } // namespace polyfem
@@ -0,0 +1,90 @@
+#include <polyfem/assembler/AssemblySchedule.hpp>
+
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/par_for.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace polyfem
+{
+	using namespace basis;
+
+	namespace assembler
+	{
+		void AssemblySchedule::init(const std::vector<ElementBases> &bases)
+		{
+			const int n_bases = bases.size();
+			std::vector<int> n_quadrature_points(n_bases);
+
+			utils::maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+				quadrature::Quadrature quadrature;
+				for (int e = start; e < end; ++e)
+				{
+					bases[e].compute_quadrature(quadrature);
+					n_quadrature_points[e] = quadrature.weights.size();
+				}
+			});
+
+			init(bases, n_quadrature_points);
+		}
+
+		void AssemblySchedule::init(const std::vector<ElementBases> &bases, const std::vector<int> &n_quadrature_points)
+		{
+			assert(n_quadrature_points.size() == bases.size());
+			const int n_bases = bases.size();
+
+			// cost model: the local assembly is dominated by the local Hessian,
+			// quadratic in the number of global dofs touched and linear in the quadrature size
+			std::vector<int> n_local_bases(n_bases);
+			std::vector<double> cost(n_bases);
+			for (int e = 0; e < n_bases; ++e)
+			{
+				n_local_bases[e] = bases[e].bases.size();
+				double n_global = 0;
+				for (const auto &b : bases[e].bases)
+					n_global += b.global().size();
+				cost[e] = std::max(1., n_global * n_global * n_quadrature_points[e]);
+			}
+
+			elements_.resize(n_bases);
+			std::iota(elements_.begin(), elements_.end(), 0);
+			std::stable_sort(elements_.begin(), elements_.end(), [&](const int a, const int b) {
+				if (n_local_bases[a] != n_local_bases[b])
+					return n_local_bases[a] > n_local_bases[b];
+				return n_quadrature_points[a] > n_quadrature_points[b];
+			});
+
+			// a few chunks per thread so that the dynamic scheduling can balance the load
+			const double total_cost = std::accumulate(cost.begin(), cost.end(), 0.);
+			const double chunk_cost = total_cost / (8 * utils::get_n_threads());
+
+			chunk_offsets_.assign(1, 0);
+			group_offsets_.assign(1, 0);
+			double current_cost = 0;
+			for (int i = 0; i < n_bases; ++i)
+			{
+				const int e = elements_[i];
+				if (i > 0)
+				{
+					const int prev = elements_[i - 1];
+					const bool new_group = n_local_bases[e] != n_local_bases[prev] || n_quadrature_points[e] != n_quadrature_points[prev];
+					if (new_group)
+						group_offsets_.push_back(i);
+					if (new_group || current_cost >= chunk_cost)
+					{
+						chunk_offsets_.push_back(i);
+						current_cost = 0;
+					}
+				}
+				current_cost += cost[e];
+			}
+
+			if (n_bases > 0)
+			{
+				chunk_offsets_.push_back(n_bases);
+				group_offsets_.push_back(n_bases);
+			}
+		}
+	} // namespace assembler
+} // namespace polyfem
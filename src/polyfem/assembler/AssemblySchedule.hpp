@@ -0,0 +1,71 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+
+#include <vector>
+
+namespace polyfem
+{
+	namespace assembler
+	{
+		// order in which the elements are assembled
+		// elements are grouped by number of local bases and quadrature points (so that
+		// consecutive elements have the same cost and local matrix sizes), the most expensive
+		// groups first, and each group keeps the mesh order for cache locality.
+		// the order is split in chunks of similar estimated cost which are the units handed
+		// to the threads by maybe_parallel_for, a chunk never spans two groups
+		class AssemblySchedule
+		{
+		public:
+			// contiguous range of element indices
+			class Range
+			{
+			public:
+				Range(const int *begin, const int *end) : begin_(begin), end_(end) {}
+				const int *begin() const { return begin_; }
+				const int *end() const { return end_; }
+				int size() const { return int(end_ - begin_); }
+
+			private:
+				const int *begin_;
+				const int *end_;
+			};
+
+			// builds the schedule, the quadrature of every element is computed to estimate its cost
+			void init(const std::vector<basis::ElementBases> &bases);
+			// builds the schedule from the already known number of quadrature points per element
+			void init(const std::vector<basis::ElementBases> &bases, const std::vector<int> &n_quadrature_points);
+
+			void clear()
+			{
+				elements_.clear();
+				chunk_offsets_.assign(1, 0);
+				group_offsets_.assign(1, 0);
+			}
+
+			// number of scheduled elements
+			size_t size() const { return elements_.size(); }
+			// number of chunks, to be used as size of maybe_parallel_for
+			int n_chunks() const { return int(chunk_offsets_.size()) - 1; }
+
+			// elements of the chunks [start, end)
+			Range elements(const int start, const int end) const
+			{
+				return Range(elements_.data() + chunk_offsets_[start], elements_.data() + chunk_offsets_[end]);
+			}
+
+			// number of groups of elements with the same number of local bases and quadrature points
+			int n_groups() const { return int(group_offsets_.size()) - 1; }
+			// elements of group g
+			Range group(const int g) const
+			{
+				return Range(elements_.data() + group_offsets_[g], elements_.data() + group_offsets_[g + 1]);
+			}
+
+		private:
+			std::vector<int> elements_;
+			std::vector<int> chunk_offsets_ = {0};
+			std::vector<int> group_offsets_ = {0};
+		};
+	} // namespace assembler
+} // namespace polyfem
@@ -1,5 +1,10 @@
 #include <polyfem/assembler/AssemblyValsCache.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <set>
 
 namespace polyfem
 {
@@ -7,25 +12,325 @@ namespace polyfem
 
 	namespace assembler
 	{
-		void AssemblyValsCache::init(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases)
+		namespace
+		{
+			size_t matrix_memory(const Eigen::MatrixXd &m)
+			{
+				return m.size() * sizeof(double);
+			}
+
+			size_t element_memory(const ElementAssemblyValues &vals)
+			{
+				size_t mem = sizeof(ElementAssemblyValues);
+				for (const AssemblyValues &v : vals.basis_values)
+				{
+					mem += sizeof(AssemblyValues) + v.global.size() * sizeof(Local2Global);
+					mem += matrix_memory(v.val) + matrix_memory(v.grad) + matrix_memory(v.grad_t_m);
+				}
+				mem += vals.jac_it.size() * sizeof(vals.jac_it.front());
+				mem += matrix_memory(vals.quadrature.points) + vals.quadrature.weights.size() * sizeof(double);
+				mem += matrix_memory(vals.val) + vals.det.size() * sizeof(double);
+				return mem;
+			}
+		} // namespace
+
+		AssemblyValsCache::StorageMode AssemblyValsCache::storage_mode_from_string(const std::string &mode)
+		{
+			if (mode == "full")
+				return StorageMode::Full;
+			if (mode == "compact")
+				return StorageMode::Compact;
+			if (mode == "none")
+				return StorageMode::None;
+
+			log_and_throw_error("Unknown assembly values cache mode " + mode);
+			return StorageMode::None;
+		}
+
+		std::string AssemblyValsCache::to_string(const StorageMode mode)
+		{
+			switch (mode)
+			{
+			case StorageMode::Full:
+				return "full";
+			case StorageMode::Compact:
+				return "compact";
+			case StorageMode::None:
+				return "none";
+			}
+			return "";
+		}
+
+		void AssemblyValsCache::init(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, const StorageMode mode)
+		{
+			const int n_bases = bases.size();
+			cache.clear();
+			clear_compact();
+			mode_ = mode;
+
+			if (mode == StorageMode::None)
+			{
+				init_schedule(bases);
+				return;
+			}
+
+			std::vector<int> n_quadrature_points(n_bases);
+			if (mode == StorageMode::Full)
+			{
+				cache.resize(n_bases);
+
+				utils::maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+					for (int e = start; e < end; ++e)
+					{
+						cache[e].compute(e, is_volume, bases[e], gbases[e]);
+					}
+				});
+
+				for (int e = 0; e < n_bases; ++e)
+					n_quadrature_points[e] = cache[e].quadrature.weights.size();
+			}
+			else
+			{
+				utils::maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+					quadrature::Quadrature quad;
+					for (int e = start; e < end; ++e)
+					{
+						bases[e].compute_quadrature(quad);
+						n_quadrature_points[e] = quad.weights.size();
+					}
+				});
+
+				init_compact(is_volume, bases, gbases, n_quadrature_points);
+			}
+
+			std::lock_guard<std::mutex> lock(schedule_mutex_);
+			set_bases(&bases);
+			schedule_.init(bases, n_quadrature_points);
+			coloring_.init(bases);
+			has_schedule_ = true;
+			has_coloring_ = true;
+		}
+
+		void AssemblyValsCache::init_compact(const bool is_volume, const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, const std::vector<int> &n_quadrature_points)
 		{
 			const int n_bases = bases.size();
-			cache.resize(n_bases);
+			dim_ = is_volume ? 3 : 2;
+
+			offsets_.resize(n_bases + 1);
+			offsets_[0] = 0;
+			for (int e = 0; e < n_bases; ++e)
+				offsets_[e + 1] = offsets_[e] + n_quadrature_points[e];
+
+			const int n_points = offsets_.back();
+			weights_.resize(n_points);
+			det_.resize(n_points);
+			points_.resize(n_points, dim_);
+			jac_it_.resize(n_points, dim_ * dim_);
+			tabulations_.resize(n_bases);
+			fallback_.resize(n_bases);
 
 			utils::maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+				ElementAssemblyValues vals;
 				for (int e = start; e < end; ++e)
 				{
-					cache[e].compute(e, is_volume, bases[e], gbases[e]);
+					vals.compute(e, is_volume, bases[e], gbases[e]);
+
+					if (!vals.tabulation || !vals.has_parameterization)
+					{
+						fallback_[e] = std::make_unique<ElementAssemblyValues>(vals);
+						continue;
+					}
+
+					const int offset = offsets_[e];
+					const int n = offsets_[e + 1] - offset;
+					assert(vals.quadrature.weights.size() == n);
+
+					tabulations_[e] = vals.tabulation;
+					weights_.segment(offset, n) = vals.quadrature.weights;
+					det_.segment(offset, n) = vals.det;
+					points_.middleRows(offset, n) = vals.val;
+					for (int k = 0; k < n; ++k)
+					{
+						for (int r = 0; r < dim_; ++r)
+							for (int c = 0; c < dim_; ++c)
+								jac_it_(offset + k, r * dim_ + c) = vals.jac_it[k](r, c);
+					}
 				}
 			});
 		}
 
+		void AssemblyValsCache::restore(const int el_index, const ElementBases &basis, ElementAssemblyValues &vals) const
+		{
+			const int offset = offsets_[el_index];
+			const int n = offsets_[el_index + 1] - offset;
+			const auto &tabulation = tabulations_[el_index];
+			assert(tabulation);
+
+			vals.element_id = el_index;
+			vals.has_parameterization = true;
+			vals.tabulation = tabulation;
+			vals.quadrature.points = tabulation->points;
+			vals.quadrature.weights = weights_.segment(offset, n);
+			vals.val = points_.middleRows(offset, n);
+			vals.det = det_.segment(offset, n);
+
+			vals.jac_it.resize(n);
+			for (int k = 0; k < n; ++k)
+			{
+				vals.jac_it[k].resize(dim_, dim_);
+				for (int r = 0; r < dim_; ++r)
+					for (int c = 0; c < dim_; ++c)
+						vals.jac_it[k](r, c) = jac_it_(offset + k, r * dim_ + c);
+			}
+
+			tabulation->copy_to(vals.basis_values);
+			assert(vals.basis_values.size() == basis.bases.size());
+			for (size_t j = 0; j < vals.basis_values.size(); ++j)
+			{
+				AssemblyValues &v = vals.basis_values[j];
+				v.global = basis.bases[j].global();
+				v.finalize();
+				for (int k = 0; k < n; ++k)
+					v.grad_t_m.row(k) = v.grad.row(k) * vals.jac_it[k];
+			}
+
+			vals.tensor_basis.reset();
+			if (const auto &tp = basis.tensor_product_basis())
+			{
+				tp->tabulate(vals.quadrature.points, vals.tensor_tabulation);
+				if (vals.tensor_tabulation.is_grid)
+					vals.tensor_basis = tp;
+			}
+		}
+
+		void AssemblyValsCache::clear_compact()
+		{
+			dim_ = 0;
+			offsets_.clear();
+			tabulations_.clear();
+			weights_.resize(0);
+			det_.resize(0);
+			points_.resize(0, 0);
+			jac_it_.resize(0, 0);
+			fallback_.clear();
+		}
+
+		size_t AssemblyValsCache::memory() const
+		{
+			size_t mem = 0;
+			for (const auto &vals : cache)
+				mem += element_memory(vals);
+
+			if (offsets_.empty())
+				return mem;
+
+			mem += offsets_.size() * sizeof(int);
+			mem += tabulations_.size() * sizeof(tabulations_.front()) + fallback_.size() * sizeof(fallback_.front());
+			mem += (weights_.size() + det_.size()) * sizeof(double);
+			mem += matrix_memory(points_) + matrix_memory(jac_it_);
+
+			std::set<const BasisTabulation *> tabulations;
+			for (const auto &tab : tabulations_)
+			{
+				if (tab && tabulations.insert(tab.get()).second)
+					mem += matrix_memory(tab->points) + matrix_memory(tab->val) + matrix_memory(tab->grad);
+			}
+
+			for (const auto &vals : fallback_)
+			{
+				if (vals)
+					mem += element_memory(*vals);
+			}
+
+			return mem;
+		}
+
+		void AssemblyValsCache::set_bases(const std::vector<ElementBases> *bases) const
+		{
+			static std::atomic<size_t> n_generations(0);
+
+			bases_ = bases;
+			generation_ = bases ? ++n_generations : 0;
+			has_schedule_ = false;
+			has_coloring_ = false;
+		}
+
+		bool AssemblyValsCache::is_current(const std::vector<ElementBases> &bases) const
+		{
+			if (bases_ == nullptr)
+				set_bases(&bases);
+			return bases_ == &bases;
+		}
+
+		void AssemblyValsCache::init_schedule(const std::vector<ElementBases> &bases)
+		{
+			std::lock_guard<std::mutex> lock(schedule_mutex_);
+			set_bases(&bases);
+			schedule_.init(bases);
+			coloring_.init(bases);
+			has_schedule_ = true;
+			has_coloring_ = true;
+		}
+
+		const AssemblySchedule &AssemblyValsCache::schedule(const std::vector<ElementBases> &bases, AssemblySchedule &tmp) const
+		{
+			std::lock_guard<std::mutex> lock(schedule_mutex_);
+			if (!is_current(bases))
+			{
+				tmp.init(bases);
+				return tmp;
+			}
+
+			if (!has_schedule_)
+			{
+				schedule_.init(bases);
+				has_schedule_ = true;
+			}
+			assert(schedule_.size() == bases.size());
+			return schedule_;
+		}
+
+		const mesh::ElementColoring &AssemblyValsCache::coloring(const std::vector<ElementBases> &bases, mesh::ElementColoring &tmp) const
+		{
+			std::lock_guard<std::mutex> lock(schedule_mutex_);
+			if (!is_current(bases))
+			{
+				tmp.init(bases);
+				return tmp;
+			}
+
+			if (!has_coloring_)
+			{
+				coloring_.init(bases);
+				has_coloring_ = true;
+			}
+			assert(coloring_.size() == bases.size());
+			return coloring_;
+		}
+
 		void AssemblyValsCache::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
 		{
-			if (cache.empty())
-				vals.compute(el_index, is_volume, basis, gbasis);
-			else
-				vals = cache[el_index];
+			const ElementAssemblyValues &cached = get(el_index, is_volume, basis, gbasis, vals);
+			if (&cached != &vals)
+				vals = cached;
+		}
+
+		const ElementAssemblyValues &AssemblyValsCache::get(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &tmp) const
+		{
+			if (!cache.empty())
+				return cache[el_index];
+
+			if (!offsets_.empty())
+			{
+				if (fallback_[el_index])
+					return *fallback_[el_index];
+
+				restore(el_index, basis, tmp);
+				return tmp;
+			}
+
+			tmp.compute(el_index, is_volume, basis, gbasis);
+			return tmp;
 		}
 	} // namespace assembler
 
@@ -1,6 +1,12 @@
 #pragma once
 
 #include <polyfem/assembler/ElementAssemblyValues.hpp>
+#include <polyfem/assembler/AssemblySchedule.hpp>
+#include <polyfem/mesh/ElementColoring.hpp>
+
+#include <memory>
+#include <mutex>
+#include <string>
 
 namespace polyfem
 {
@@ -9,16 +15,90 @@ namespace polyfem
 		class AssemblyValsCache
 		{
 		public:
-			void init(const bool is_volume, const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases);
+			// how the per element values are stored
+			enum class StorageMode
+			{
+				// full ElementAssemblyValues per element
+				Full,
+				// only the geometric mapping (J^{-T}, det, mapped points and weights) per quadrature point in
+				// contiguous arrays, the bases values come from the shared reference tabulations (see basis::BasisTabulation),
+				// elements without a reference tabulation (eg, polygons) are stored in full
+				Compact,
+				// nothing is stored, the values are recomputed on demand
+				None
+			};
+
+			// parses "full", "compact" or "none"
+			static StorageMode storage_mode_from_string(const std::string &mode);
+			static std::string to_string(const StorageMode mode);
+
+			void init(const bool is_volume, const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases, const StorageMode mode = StorageMode::Full);
+			// copies the values of el_index into vals, prefer get in assembly loops
 			void compute(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis, ElementAssemblyValues &vals) const;
+			// returns the cached values of el_index without copying them,
+			// if they are not stored in full they are restored (compact) or computed (none) into tmp and tmp is returned
+			const ElementAssemblyValues &get(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis, ElementAssemblyValues &tmp) const;
+
+			// builds only the assembly schedule and the element coloring, used when the values are not cached
+			void init_schedule(const std::vector<basis::ElementBases> &bases);
+			// returns the assembly schedule of bases, it is built once per basis set (init, init_schedule, or
+			// the first call if the cache was never initialized), for another basis set it is built into tmp and tmp is returned
+			const AssemblySchedule &schedule(const std::vector<basis::ElementBases> &bases, AssemblySchedule &tmp) const;
+			// returns the element coloring of bases, built and cached as the schedule
+			const mesh::ElementColoring &coloring(const std::vector<basis::ElementBases> &bases, mesh::ElementColoring &tmp) const;
+			// changes every time the cache is (re)built for a basis set, 0 if it never was
+			size_t generation() const { return generation_; }
+
+			StorageMode storage_mode() const { return mode_; }
+			// approximated memory used by the stored values in bytes
+			size_t memory() const;
 
 			void clear()
 			{
+				mode_ = StorageMode::None;
 				cache.clear();
+				clear_compact();
+				schedule_.clear();
+				coloring_.clear();
+				set_bases(nullptr);
 			}
 
 		private:
+			StorageMode mode_ = StorageMode::None;
+
+			// full storage
 			std::vector<ElementAssemblyValues> cache;
+
+			// compact storage, element e owns the quadrature points offsets_[e] to offsets_[e+1] of the arrays
+			int dim_ = 0;
+			std::vector<int> offsets_;
+			std::vector<std::shared_ptr<const basis::BasisTabulation>> tabulations_;
+			Eigen::VectorXd weights_;
+			Eigen::VectorXd det_;
+			Eigen::MatrixXd points_; // mapped quadrature points, #points x dim
+			Eigen::MatrixXd jac_it_; // #points x (dim * dim), entry (r, c) of J^{-T} in column r * dim + c
+			// elements without a reference tabulation, null for the others
+			std::vector<std::unique_ptr<ElementAssemblyValues>> fallback_;
+
+			void init_compact(const bool is_volume, const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases, const std::vector<int> &n_quadrature_points);
+			// rebuilds the values of el_index from the compact storage
+			void restore(const int el_index, const basis::ElementBases &basis, ElementAssemblyValues &vals) const;
+			void clear_compact();
+
+			// the schedule and the coloring belong to the basis set bases_ of generation generation_,
+			// they are built lazily (under schedule_mutex_) when the cache was not initialized
+			mutable std::mutex schedule_mutex_;
+			mutable const std::vector<basis::ElementBases> *bases_ = nullptr;
+			mutable size_t generation_ = 0;
+			mutable AssemblySchedule schedule_;
+			mutable mesh::ElementColoring coloring_;
+			mutable bool has_schedule_ = false;
+			mutable bool has_coloring_ = false;
+
+			// starts a new generation for bases, the schedule and the coloring are not built
+			void set_bases(const std::vector<basis::ElementBases> *bases) const;
+			// true if the schedule and coloring are (or can be) kept for bases, claims bases if the cache was never initialized
+			bool is_current(const std::vector<basis::ElementBases> &bases) const;
 		};
 	} // namespace assembler
 } // namespace polyfem
@@ -199,10 +199,21 @@ namespace polyfem
 		void ElementAssemblyValues::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis)
 		{
 			basis.compute_quadrature(quadrature);
-			compute(el_index, is_volume, quadrature.points, basis, gbasis);
+			compute(el_index, is_volume, quadrature.points, basis, gbasis, basis.quadrature_order());
+		}
+
+		void ElementAssemblyValues::compute_mass(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis)
+		{
+			basis.compute_mass_quadrature(quadrature);
+			compute(el_index, is_volume, quadrature.points, basis, gbasis, basis.mass_quadrature_order());
 		}
 
 		void ElementAssemblyValues::compute(const int el_index, const bool is_volume, const Eigen::MatrixXd &pts, const ElementBases &basis, const ElementBases &gbasis)
+		{
+			compute(el_index, is_volume, pts, basis, gbasis, -1);
+		}
+
+		void ElementAssemblyValues::compute(const int el_index, const bool is_volume, const Eigen::MatrixXd &pts, const ElementBases &basis, const ElementBases &gbasis, const int quadrature_order)
 		{
 			element_id = el_index;
 			// const bool poly = !gbasis.has_parameterization;
@@ -256,13 +267,52 @@ namespace polyfem
 			const int n_local_bases = int(basis.bases.size());
 			const int n_local_g_bases = int(gbasis.bases.size());
 
-			basis.evaluate_bases(pts, basis_values);
-			basis.evaluate_grads(pts, basis_values);
+			// the reference values at the quadrature points are the same for all the elements of a type and order
+			tabulation.reset();
+			if (quadrature_order >= 0 && basis.reference_key())
+				tabulation = BasisTabulation::get(*basis.reference_key(), quadrature_order, pts, basis);
+
+			tensor_basis.reset();
+			if (basis.tensor_product_basis())
+			{
+				// 1D tables shared by the values and the gradients
+				const auto &tp = basis.tensor_product_basis();
+				tp->tabulate(pts, tensor_tabulation);
+				if (tabulation)
+				{
+					tabulation->copy_to(basis_values);
+				}
+				else
+				{
+					tp->evaluate_bases(tensor_tabulation, basis_values);
+					tp->evaluate_grads(tensor_tabulation, basis_values);
+				}
+				if (tensor_tabulation.is_grid && gbasis.has_parameterization)
+					tensor_basis = tp;
+			}
+			else if (tabulation)
+			{
+				tabulation->copy_to(basis_values);
+			}
+			else
+			{
+				basis.evaluate_bases(pts, basis_values);
+				basis.evaluate_grads(pts, basis_values);
+			}
+			assert(basis_values.size() == n_local_bases);
 
 			if (&basis != &gbasis)
 			{
-				gbasis.evaluate_bases(pts, g_basis_values_cache_);
-				gbasis.evaluate_grads(pts, g_basis_values_cache_);
+				// the points are the quadrature of basis, the geometric bases are tabulated under its order
+				if (quadrature_order >= 0 && gbasis.reference_key())
+				{
+					BasisTabulation::get(*gbasis.reference_key(), quadrature_order, pts, gbasis)->copy_to(g_basis_values_cache_);
+				}
+				else
+				{
+					gbasis.evaluate_bases(pts, g_basis_values_cache_);
+					gbasis.evaluate_grads(pts, g_basis_values_cache_);
+				}
 			}
 
 			for (int j = 0; j < n_local_bases; ++j)
@@ -350,6 +400,69 @@ namespace polyfem
 				finalize2d(gbasis, gbasis_values);
 		}
 
+		bool ElementAssemblyValues::compute_tensor_product(const int el_index, const Eigen::MatrixXd &pts, const ElementBases &basis, const ElementBases &gbasis)
+		{
+			const auto &tp = basis.tensor_product_basis();
+			const auto &gtp = gbasis.tensor_product_basis();
+			if (!tp || !gtp || !gbasis.has_parameterization)
+				return false;
+
+			tp->tabulate(pts, tensor_tabulation);
+			if (!tensor_tabulation.is_grid)
+				return false;
+			// the geometry is often of lower order than the bases
+			const TensorProductBasis::Tabulation *gtab = &tensor_tabulation;
+			if (gtp != tp)
+			{
+				gtp->tabulate(pts, g_tensor_tabulation_);
+				gtab = &g_tensor_tabulation_;
+			}
+
+			element_id = el_index;
+			has_parameterization = true;
+			tabulation.reset();
+			tensor_basis = tp;
+
+			basis_values.resize(basis.bases.size());
+			for (size_t j = 0; j < basis_values.size(); ++j)
+			{
+				AssemblyValues &ass_val = basis_values[j];
+				ass_val.global = basis.bases[j].global();
+				ass_val.val.resize(0, 1);
+				ass_val.grad.resize(0, pts.cols());
+				ass_val.grad_t_m.resize(0, pts.cols());
+			}
+
+			// x = Σ node_j φj, ∇x = Σ node_j ∇φj
+			const int dim = int(pts.cols());
+			Eigen::MatrixXd nodes = Eigen::MatrixXd::Zero(gbasis.bases.size(), dim);
+			for (size_t j = 0; j < gbasis.bases.size(); ++j)
+			{
+				const Basis &b = gbasis.bases[j];
+				for (std::size_t ii = 0; ii < b.global().size(); ++ii)
+					nodes.row(j) += b.global()[ii].node * b.global()[ii].val;
+			}
+
+			Eigen::MatrixXd ref_grad;
+			gtp->interpolate(*gtab, nodes, &val, &ref_grad);
+
+			det.resize(val.rows(), 1);
+			jac_it.resize(val.rows());
+			Eigen::MatrixXd jac(dim, dim);
+			for (long k = 0; k < val.rows(); ++k)
+			{
+				// same layout as in finalize2d/3d, jac(r, d) = ∂x_d/∂r
+				for (int d = 0; d < dim; ++d)
+					for (int r = 0; r < dim; ++r)
+						jac(r, d) = ref_grad(k, d * dim + r);
+
+				det(k) = jac.determinant();
+				jac_it[k] = jac.inverse().transpose();
+			}
+
+			return true;
+		}
+
 		bool ElementAssemblyValues::is_geom_mapping_positive(const bool is_volume, const ElementBases &gbasis) const
 		{
 			if (!gbasis.has_parameterization)
@@ -3,6 +3,7 @@
 #include <polyfem/assembler/AssemblyValues.hpp>
 #include <polyfem/basis/ElementBases.hpp>
 
+#include <memory>
 #include <vector>
 
 namespace polyfem
@@ -30,15 +31,35 @@ namespace polyfem
 			//only poly elements have no parameterization
 			bool has_parameterization = true;
 
+			// tensor product bases tabulated on a grid of points (eg, Q elements on HexQuadrature/QuadQuadrature),
+			// null otherwise, kernels use it for sum factorization (see basis::TensorProductBasis)
+			std::shared_ptr<const basis::TensorProductBasis> tensor_basis;
+			basis::TensorProductBasis::Tabulation tensor_tabulation;
+			bool has_tensor_product() const { return tensor_basis != nullptr; }
+
+			// reference values and gradients of the bases at the quadrature points, shared by all the elements
+			// with the same reference bases, null if the bases have no reference key or the points are not a quadrature of known order
+			std::shared_ptr<const basis::BasisTabulation> tabulation;
+
 			//computes the per element values at the quadrature points
 			void compute(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis);
+			//computes the per element values at the mass quadrature points
+			void compute_mass(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis);
 			//computes the per element values at the local (ref el) points (pts)
 			void compute(const int el_index, const bool is_volume, const Eigen::MatrixXd &pts, const basis::ElementBases &basis, const basis::ElementBases &gbasis);
+			// computes only the geometric mapping (val, det, jac_it) and the tensor tabulation at the local points pts by sum factorization,
+			// the bases get their global nodes but no val, grad, or grad_t_m; returns false (and computes nothing) if the bases or the
+			// geometric bases have no tensor product structure or pts is not a grid, evaluations that only interpolate coefficients use it
+			bool compute_tensor_product(const int el_index, const Eigen::MatrixXd &pts, const basis::ElementBases &basis, const basis::ElementBases &gbasis);
 			//check if the element is flipped
 			bool is_geom_mapping_positive(const bool is_volume, const basis::ElementBases &gbasis) const;
 
 		private:
 			std::vector<AssemblyValues> g_basis_values_cache_;
+			basis::TensorProductBasis::Tabulation g_tensor_tabulation_;
+
+			// quadrature_order is the order of pts if they are a quadrature, -1 otherwise (the values are not shared)
+			void compute(const int el_index, const bool is_volume, const Eigen::MatrixXd &pts, const basis::ElementBases &basis, const basis::ElementBases &gbasis, const int quadrature_order);
 
 			void finalize_global_element(const Eigen::MatrixXd &v);
 
@@ -37,6 +37,34 @@ namespace polyfem
 
 				return j_boundary;
 			}
+
+			/// groups the first n_pts global_ids by the index in ids of their boundary id, points not on any boundary in ids are skipped
+			std::vector<std::vector<int>> group_by_boundary(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const long n_pts, const std::vector<int> &ids)
+			{
+				std::vector<std::vector<int>> groups(ids.size());
+				for (long i = 0; i < n_pts; ++i)
+				{
+					const int id = mesh.get_boundary_id(global_ids(i));
+					for (size_t b = 0; b < ids.size(); ++b)
+					{
+						if (id == ids[b])
+						{
+							groups[b].push_back(i);
+							break;
+						}
+					}
+				}
+
+				return groups;
+			}
+
+			Eigen::MatrixXd gather_rows(const Eigen::MatrixXd &pts, const std::vector<int> &rows)
+			{
+				Eigen::MatrixXd res(rows.size(), pts.cols());
+				for (size_t i = 0; i < rows.size(); ++i)
+					res.row(i) = pts.row(rows[i]);
+				return res;
+			}
 		} // namespace
 
 		std::shared_ptr<Interpolation> Interpolation::build(const json &params)
@@ -85,7 +113,7 @@ namespace polyfem
 		{
 		}
 
-		void GenericTensorProblem::rhs(const assembler::AssemblerUtils &assembler, const std::string &formulation, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
+		void GenericTensorProblem::rhs(const assembler::AssemblerUtils &assembler, const assembler::Formulation &formulation, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
 		{
 			val.resize(pts.rows(), pts.cols());
 
@@ -95,14 +123,11 @@ namespace polyfem
 				return;
 			}
 
-			const bool planar = pts.cols() == 2;
-			for (int i = 0; i < pts.rows(); ++i)
+			Eigen::VectorXd tmp;
+			for (int j = 0; j < pts.cols(); ++j)
 			{
-				for (int j = 0; j < pts.cols(); ++j)
-				{
-					double x = pts(i, 0), y = pts(i, 1), z = planar ? 0 : pts(i, 2);
-					val(i, j) = rhs_[j](x, y, z, t);
-				}
+				rhs_[j].evaluate(pts, t, tmp);
+				val.col(j) = tmp;
 			}
 		}
 
@@ -133,35 +158,34 @@ namespace polyfem
 		void GenericTensorProblem::dirichlet_bc(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
 		{
 			val = Eigen::MatrixXd::Zero(pts.rows(), mesh.dimension());
+			Eigen::VectorXd tmp;
 
-			for (long i = 0; i < pts.rows(); ++i)
+			if (is_all_)
 			{
-				if (is_all_)
+				assert(displacements_.size() == 1);
+				for (int d = 0; d < val.cols(); ++d)
 				{
-					assert(displacements_.size() == 1);
-					double x = pts(i, 0), y = pts(i, 1), z = pts.cols() == 2 ? 0 : pts(i, 2);
-					for (int d = 0; d < val.cols(); ++d)
-					{
-						val(i, d) = displacements_[0][d](x, y, z, t);
-					}
-					val.row(i) *= displacements_interpolation_[0]->eval(t);
+					displacements_[0][d].evaluate(pts, t, tmp);
+					val.col(d) = tmp;
 				}
-				else
+				val *= displacements_interpolation_[0]->eval(t);
+				return;
+			}
+
+			const auto groups = group_by_boundary(mesh, global_ids, pts.rows(), boundary_ids_);
+			for (size_t b = 0; b < groups.size(); ++b)
+			{
+				const auto &rows = groups[b];
+				if (rows.empty())
+					continue;
+
+				const Eigen::MatrixXd b_pts = gather_rows(pts, rows);
+				const double interp = displacements_interpolation_[b]->eval(t);
+				for (int d = 0; d < val.cols(); ++d)
 				{
-					const int id = mesh.get_boundary_id(global_ids(i));
-					for (size_t b = 0; b < boundary_ids_.size(); ++b)
-					{
-						if (id == boundary_ids_[b])
-						{
-							double x = pts(i, 0), y = pts(i, 1), z = pts.cols() == 2 ? 0 : pts(i, 2);
-							for (int d = 0; d < val.cols(); ++d)
-							{
-								val(i, d) = displacements_[b][d](x, y, z, t);
-							}
-							val.row(i) *= displacements_interpolation_[b]->eval(t);
-							break;
-						}
-					}
+					displacements_[b][d].evaluate(b_pts, t, tmp);
+					for (size_t i = 0; i < rows.size(); ++i)
+						val(rows[i], d) = tmp(i) * interp;
 				}
 			}
 		}
@@ -169,38 +193,39 @@ namespace polyfem
 		void GenericTensorProblem::neumann_bc(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &normals, const double t, Eigen::MatrixXd &val) const
 		{
 			val = Eigen::MatrixXd::Zero(pts.rows(), mesh.dimension());
+			Eigen::VectorXd tmp;
 
-			for (long i = 0; i < pts.rows(); ++i)
+			const auto force_groups = group_by_boundary(mesh, global_ids, pts.rows(), neumann_boundary_ids_);
+			for (size_t b = 0; b < force_groups.size(); ++b)
 			{
-				const int id = mesh.get_boundary_id(global_ids(i));
+				const auto &rows = force_groups[b];
+				if (rows.empty())
+					continue;
 
-				for (size_t b = 0; b < neumann_boundary_ids_.size(); ++b)
+				const Eigen::MatrixXd b_pts = gather_rows(pts, rows);
+				const double interp = forces_interpolation_[b]->eval(t);
+				for (int d = 0; d < val.cols(); ++d)
 				{
-					if (id == neumann_boundary_ids_[b])
-					{
-						for (int d = 0; d < val.cols(); ++d)
-						{
-							double x = pts(i, 0), y = pts(i, 1), z = pts.cols() == 2 ? 0 : pts(i, 2);
-							val(i, d) = forces_[b][d](x, y, z, t);
-						}
-						val.row(i) *= forces_interpolation_[b]->eval(t);
-						break;
-					}
+					forces_[b][d].evaluate(b_pts, t, tmp);
+					for (size_t i = 0; i < rows.size(); ++i)
+						val(rows[i], d) = tmp(i) * interp;
 				}
+			}
 
-				for (size_t b = 0; b < pressure_boundary_ids_.size(); ++b)
-				{
-					if (id == pressure_boundary_ids_[b])
-					{
-						for (int d = 0; d < val.cols(); ++d)
-						{
-							double x = pts(i, 0), y = pts(i, 1), z = pts.cols() == 2 ? 0 : pts(i, 2);
-							val(i, d) = pressures_[b](x, y, z, t) * normals(i, d);
-						}
-						val.row(i) *= pressure_interpolation_[b]->eval(t);
-						break;
-					}
-				}
+			// pressure is applied after the forces, it overrides them on shared ids
+			const auto pressure_groups = group_by_boundary(mesh, global_ids, pts.rows(), pressure_boundary_ids_);
+			for (size_t b = 0; b < pressure_groups.size(); ++b)
+			{
+				const auto &rows = pressure_groups[b];
+				if (rows.empty())
+					continue;
+
+				const Eigen::MatrixXd b_pts = gather_rows(pts, rows);
+				const double interp = pressure_interpolation_[b]->eval(t);
+				pressures_[b].evaluate(b_pts, t, tmp);
+				for (size_t i = 0; i < rows.size(); ++i)
+					for (int d = 0; d < val.cols(); ++d)
+						val(rows[i], d) = tmp(i) * normals(rows[i], d) * interp;
 			}
 		}
 
@@ -919,7 +944,7 @@ namespace polyfem
 		{
 		}
 
-		void GenericScalarProblem::rhs(const assembler::AssemblerUtils &assembler, const std::string &formulation, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
+		void GenericScalarProblem::rhs(const assembler::AssemblerUtils &assembler, const assembler::Formulation &formulation, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
 		{
 			val.resize(pts.rows(), 1);
 			if (is_rhs_zero())
@@ -927,62 +952,54 @@ namespace polyfem
 				val.setZero();
 				return;
 			}
-			const bool planar = pts.cols() == 2;
-			for (int i = 0; i < pts.rows(); ++i)
-			{
-				double x = pts(i, 0), y = pts(i, 1), z = planar ? 0 : pts(i, 2);
-				val(i) = rhs_(x, y, z, t);
-			}
+			Eigen::VectorXd tmp;
+			rhs_.evaluate(pts, t, tmp);
+			val.col(0) = tmp;
 		}
 
 		void GenericScalarProblem::dirichlet_bc(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const
 		{
 			val = Eigen::MatrixXd::Zero(pts.rows(), 1);
+			Eigen::VectorXd tmp;
 
-			for (long i = 0; i < pts.rows(); ++i)
+			if (is_all_)
 			{
-				const int id = mesh.get_boundary_id(global_ids(i));
-				if (is_all_)
-				{
-					assert(dirichlet_.size() == 1);
-					double x = pts(i, 0), y = pts(i, 1), z = pts.cols() == 2 ? 0 : pts(i, 2);
-					val(i) = dirichlet_[0](x, y, z, t);
-					val(i) *= dirichlet_interpolation_[0]->eval(t);
-				}
-				else
-				{
-					for (size_t b = 0; b < boundary_ids_.size(); ++b)
-					{
-						if (id == boundary_ids_[b])
-						{
-							double x = pts(i, 0), y = pts(i, 1), z = pts.cols() == 2 ? 0 : pts(i, 2);
-							val(i) = dirichlet_[b](x, y, z, t);
-							val(i) *= dirichlet_interpolation_[b]->eval(t);
-							break;
-						}
-					}
-				}
+				assert(dirichlet_.size() == 1);
+				dirichlet_[0].evaluate(pts, t, tmp);
+				val.col(0) = tmp * dirichlet_interpolation_[0]->eval(t);
+				return;
+			}
+
+			const auto groups = group_by_boundary(mesh, global_ids, pts.rows(), boundary_ids_);
+			for (size_t b = 0; b < groups.size(); ++b)
+			{
+				const auto &rows = groups[b];
+				if (rows.empty())
+					continue;
+
+				dirichlet_[b].evaluate(gather_rows(pts, rows), t, tmp);
+				const double interp = dirichlet_interpolation_[b]->eval(t);
+				for (size_t i = 0; i < rows.size(); ++i)
+					val(rows[i]) = tmp(i) * interp;
 			}
 		}
 
 		void GenericScalarProblem::neumann_bc(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &normals, const double t, Eigen::MatrixXd &val) const
 		{
 			val = Eigen::MatrixXd::Zero(pts.rows(), 1);
+			Eigen::VectorXd tmp;
 
-			for (long i = 0; i < pts.rows(); ++i)
+			const auto groups = group_by_boundary(mesh, global_ids, pts.rows(), neumann_boundary_ids_);
+			for (size_t b = 0; b < groups.size(); ++b)
 			{
-				const int id = mesh.get_boundary_id(global_ids(i));
+				const auto &rows = groups[b];
+				if (rows.empty())
+					continue;
 
-				for (size_t b = 0; b < neumann_boundary_ids_.size(); ++b)
-				{
-					if (id == neumann_boundary_ids_[b])
-					{
-						double x = pts(i, 0), y = pts(i, 1), z = pts.cols() == 2 ? 0 : pts(i, 2);
-						val(i) = neumann_[b](x, y, z, t);
-						val(i) *= neumann_interpolation_[b]->eval(t);
-						break;
-					}
-				}
+				neumann_[b].evaluate(gather_rows(pts, rows), t, tmp);
+				const double interp = neumann_interpolation_[b]->eval(t);
+				for (size_t i = 0; i < rows.size(); ++i)
+					val(rows[i]) = tmp(i) * interp;
 			}
 		}
 
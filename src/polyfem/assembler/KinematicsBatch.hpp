@@ -0,0 +1,352 @@
+#pragma once
+
+#include "AssemblerData.hpp"
+
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+
+#include <vector>
+
+// structure-of-arrays kinematics of a batch of elements, used by the fast constitutive kernels
+namespace polyfem::assembler
+{
+	// Every per-point quantity is stored as a column over the quadrature points of a batch of elements
+	// with the same number of bases (eg, column d * dim + c of F is F(d, c) at all the points, the points
+	// of the element el are the rows offset(el) to offset(el + 1)), so the constitutive laws are evaluated
+	// for all the points at once with array expressions that Eigen vectorizes with the instruction set the
+	// library is compiled for (see POLYFEM_WITH_NATIVE_ARCH). Batching several elements keeps the columns
+	// long enough to vectorize when the elements have few points (eg, P1). For tensor product bases on a
+	// grid of points the gradients are interpolated and integrated by sum factorization (see basis::TensorProductBasis).
+	template <int n_basis, int dim>
+	class KinematicsBatch
+	{
+	public:
+		// column of the component (i, j) of a dim x dim tensor
+		static constexpr int idx(const int i, const int j) { return i * dim + j; }
+		// column of the component (ij, kl) of a dim² x dim² tensor
+		static constexpr int idx(const int i, const int j, const int k, const int l) { return idx(i, j) * dim * dim + idx(k, l); }
+
+		// computes the local displacement and F at the quadrature points of the n_elements elements of data,
+		// which must have the same number of bases and stay alive while the batch is used
+		void compute(const NonLinearAssemblerData *const *data, const int n_elements)
+		{
+			assert(n_elements > 0);
+			data_.assign(data, data + n_elements);
+			n_bases_ = n_basis == Eigen::Dynamic ? int(data[0]->vals.basis_values.size()) : n_basis;
+
+			offsets_.resize(n_elements + 1);
+			offsets_[0] = 0;
+			for (int el = 0; el < n_elements; ++el)
+			{
+				assert(data[el]->vals.basis_values.size() == n_bases_);
+				offsets_[el + 1] = offsets_[el] + int(data[el]->da.size());
+			}
+
+			F.resize(offsets_.back(), dim * dim);
+			disp_.resize(n_elements);
+			for (int el = 0; el < n_elements; ++el)
+			{
+				gather(el, data[el]->x, disp_[el]);
+				// Id + grad d
+				physical_gradient(el, disp_[el], F, offset(el));
+			}
+			for (int d = 0; d < dim; ++d)
+				F.col(idx(d, d)) += 1;
+		}
+
+		// computes the local displacement and F at the quadrature points of one element
+		void compute(const NonLinearAssemblerData &data)
+		{
+			const NonLinearAssemblerData *element = &data;
+			compute(&element, 1);
+		}
+
+		// computes J and the cofactor matrix of F from F
+		void compute_determinant()
+		{
+			const int n_pts = n_points();
+
+			dJ.resize(n_pts, dim * dim);
+			if (dim == 2)
+			{
+				dJ.col(idx(0, 0)) = F.col(idx(1, 1));
+				dJ.col(idx(0, 1)) = -F.col(idx(1, 0));
+				dJ.col(idx(1, 0)) = -F.col(idx(0, 1));
+				dJ.col(idx(1, 1)) = F.col(idx(0, 0));
+			}
+			else
+			{
+				// column c of the cofactor is the cross product of the other two columns of F
+				for (int c = 0; c < dim; ++c)
+				{
+					const int c1 = (c + 1) % 3;
+					const int c2 = (c + 2) % 3;
+					for (int d = 0; d < dim; ++d)
+					{
+						const int d1 = (d + 1) % 3;
+						const int d2 = (d + 2) % 3;
+						dJ.col(idx(d, c)) = F.col(idx(d1, c1)) * F.col(idx(d2, c2)) - F.col(idx(d2, c1)) * F.col(idx(d1, c2));
+					}
+				}
+			}
+
+			J = F.col(idx(0, 0)) * dJ.col(idx(0, 0));
+			for (int d = 1; d < dim; ++d)
+				J += F.col(idx(d, 0)) * dJ.col(idx(d, 0));
+		}
+
+		// out += w ∂²J/∂F(d, c)∂F(e, f) at all the points
+		template <typename Weight, typename Out>
+		void add_d2J(const int d, const int c, const int e, const int f, const Weight &w, Out &&out) const
+		{
+			if (d == e || c == f)
+				return;
+
+			if (dim == 2)
+			{
+				if (d == c)
+					out += w;
+				else
+					out -= w;
+				return;
+			}
+
+			// ε_{d e g} ε_{c f h} F(g, h)
+			const int g = 3 - d - e;
+			const int h = 3 - c - f;
+			const bool even_deg = (e - d + 3) % 3 == 1;
+			const bool even_cfh = (f - c + 3) % 3 == 1;
+			if (even_deg == even_cfh)
+				out += w * F.col(idx(g, h));
+			else
+				out -= w * F.col(idx(g, h));
+		}
+
+		// Σ_p da(p) f(p) over the points of the element el
+		double integrate(const Eigen::ArrayXd &f, const int el) const
+		{
+			return (f.segment(offset(el), n_points(el)) * data_[el]->da.array()).sum();
+		}
+
+		// gradient of Σ_p da(p) ψ(F(p)) over the points of the element el wrt its local displacement given P = ∂ψ/∂F
+		void integrate_gradient(const Eigen::ArrayXXd &P, const int el, Eigen::VectorXd &G)
+		{
+			integrate_gradient(P, offset(el), el, G);
+		}
+
+		// Hessian of Σ_p da(p) ψ(F(p)) over the points of the element el wrt its local displacement
+		// given A = ∂²ψ/∂F², A must be symmetric
+		void integrate_hessian(const Eigen::ArrayXXd &A, const int el, Eigen::MatrixXd &H)
+		{
+			const auto &bases = data_[el]->vals.basis_values;
+			const int p0 = offset(el);
+			const int n_pts = n_points(el);
+			const auto da = data_[el]->da.array();
+
+			H.resize(n_bases_ * dim, n_bases_ * dim);
+			AdGradj_.resize(n_pts, dim * dim);
+
+			for (int j = 0; j < n_bases_; ++j)
+			{
+				const auto &gradj = bases[j].grad_t_m;
+				for (int e = 0; e < dim; ++e)
+				{
+					// da Σ_f A(dc, ef) ∂φj/∂x_f
+					for (int d = 0; d < dim; ++d)
+					{
+						for (int c = 0; c < dim; ++c)
+						{
+							auto col = AdGradj_.col(idx(d, c));
+							col = A.col(idx(d, c, e, 0)).segment(p0, n_pts) * gradj.col(0).array();
+							for (int f = 1; f < dim; ++f)
+								col += A.col(idx(d, c, e, f)).segment(p0, n_pts) * gradj.col(f).array();
+							col *= da;
+						}
+					}
+
+					// the Hessian is symmetric, only the blocks i <= j are integrated
+					for (int i = 0; i <= j; ++i)
+					{
+						const auto &gradi = bases[i].grad_t_m;
+						for (int d = 0; d < dim; ++d)
+						{
+							double v = 0;
+							for (int c = 0; c < dim; ++c)
+								v += (gradi.col(c).array() * AdGradj_.col(idx(d, c))).sum();
+							H(i * dim + d, j * dim + e) = v;
+							H(j * dim + e, i * dim + d) = v;
+						}
+					}
+				}
+			}
+		}
+
+		// product of the Hessian of Σ_p da(p) ψ(F(p)) over the points of the element el wrt its local displacement
+		// with the global direction, given A = ∂²ψ/∂F², without forming the local Hessian
+		void apply_hessian(const Eigen::ArrayXXd &A, const int el, const Eigen::MatrixXd &direction, Eigen::VectorXd &Hv)
+		{
+			const int p0 = offset(el);
+			const int n_pts = n_points(el);
+
+			gather(el, direction, dir_);
+
+			// grad v
+			dF_.resize(n_pts, dim * dim);
+			physical_gradient(el, dir_, dF_, 0);
+
+			// A : grad v
+			AdF_.resize(n_pts, dim * dim);
+			for (int d = 0; d < dim; ++d)
+			{
+				for (int c = 0; c < dim; ++c)
+				{
+					auto col = AdF_.col(idx(d, c));
+					col = A.col(idx(d, c, 0, 0)).segment(p0, n_pts) * dF_.col(idx(0, 0));
+					for (int ef = 1; ef < dim * dim; ++ef)
+						col += A.col(idx(d, c) * dim * dim + ef).segment(p0, n_pts) * dF_.col(ef);
+				}
+			}
+
+			integrate_gradient(AdF_, 0, el, Hv);
+		}
+
+		int n_bases() const { return n_bases_; }
+		int n_elements() const { return int(data_.size()); }
+		// number of points of the batch
+		int n_points() const { return int(F.rows()); }
+		// number of points of the element el, they are the rows offset(el) to offset(el) + n_points(el)
+		int n_points(const int el) const { return offsets_[el + 1] - offsets_[el]; }
+		int offset(const int el) const { return offsets_[el]; }
+		const NonLinearAssemblerData &data(const int el) const { return *data_[el]; }
+
+		Eigen::ArrayXXd F;  ///< deformation gradient
+		Eigen::ArrayXXd dJ; ///< ∂J/∂F, ie the cofactor matrix of F
+		Eigen::ArrayXd J;   ///< det(F)
+
+	private:
+		// gradient of Σ_p da(p) ψ(F(p)) over the points of the element el wrt its local displacement given P = ∂ψ/∂F,
+		// the points of el are the rows p0 to p0 + n_points(el) of P
+		void integrate_gradient(const Eigen::ArrayXXd &P, const int p0, const int el, Eigen::VectorXd &G)
+		{
+			const auto &vals = data_[el]->vals;
+			const auto &bases = vals.basis_values;
+			const auto da = data_[el]->da.array();
+			const int n_pts = n_points(el);
+
+			G.resize(n_bases_ * dim);
+
+			if (vals.has_tensor_product())
+			{
+				// P : ∇φi = (P J^{-1}) : ∇_ref φi, the reference part is the transpose of the sum factorization
+				ref_grad_.resize(n_pts, dim * dim);
+				for (int p = 0; p < n_pts; ++p)
+				{
+					const auto &jac_it = vals.jac_it[p];
+					for (int d = 0; d < dim; ++d)
+					{
+						for (int r = 0; r < dim; ++r)
+						{
+							double v = 0;
+							for (int c = 0; c < dim; ++c)
+								v += P(p0 + p, idx(d, c)) * jac_it(r, c);
+							ref_grad_(p, idx(d, r)) = v * da(p);
+						}
+					}
+				}
+
+				vals.tensor_basis->integrate(vals.tensor_tabulation, Eigen::MatrixXd(), ref_grad_, local_);
+				for (int i = 0; i < n_bases_; ++i)
+					for (int d = 0; d < dim; ++d)
+						G(i * dim + d) = local_(i, d);
+				return;
+			}
+
+			for (int d = 0; d < dim; ++d)
+			{
+				for (int c = 0; c < dim; ++c)
+				{
+					const Eigen::ArrayXd w = P.col(idx(d, c)).segment(p0, n_pts) * da;
+					for (int i = 0; i < n_bases_; ++i)
+					{
+						const double v = (w * bases[i].grad_t_m.col(c).array()).sum();
+						G(i * dim + d) = c == 0 ? v : G(i * dim + d) + v;
+					}
+				}
+			}
+		}
+
+		// gradient of the local values of the element el at its quadrature points (same layout as F) into the rows
+		// p0 to p0 + n_points(el) of grad, by sum factorization for tensor product bases on a grid
+		void physical_gradient(const int el, const Eigen::Matrix<double, n_basis, dim> &local, Eigen::ArrayXXd &grad, const int p0)
+		{
+			const auto &vals = data_[el]->vals;
+			const auto &bases = vals.basis_values;
+			const int n_pts = n_points(el);
+
+			if (vals.has_tensor_product())
+			{
+				// ∇x = ∇_ref J^{-T}
+				local_ = local;
+				vals.tensor_basis->interpolate(vals.tensor_tabulation, local_, nullptr, &ref_grad_);
+				for (int p = 0; p < n_pts; ++p)
+				{
+					const auto &jac_it = vals.jac_it[p];
+					for (int d = 0; d < dim; ++d)
+					{
+						for (int c = 0; c < dim; ++c)
+						{
+							double v = 0;
+							for (int r = 0; r < dim; ++r)
+								v += ref_grad_(p, idx(d, r)) * jac_it(r, c);
+							grad(p0 + p, idx(d, c)) = v;
+						}
+					}
+				}
+				return;
+			}
+
+			for (int d = 0; d < dim; ++d)
+			{
+				for (int c = 0; c < dim; ++c)
+				{
+					auto g = grad.col(idx(d, c)).segment(p0, n_pts);
+					g.setZero();
+					for (int i = 0; i < n_bases_; ++i)
+						g += local(i, d) * bases[i].grad_t_m.col(c).array();
+				}
+			}
+		}
+
+		// local values of the global vector x on the element el, row i is the value of the i-th basis
+		void gather(const int el, const Eigen::MatrixXd &x, Eigen::Matrix<double, n_basis, dim> &local) const
+		{
+			const auto &bases = data_[el]->vals.basis_values;
+
+			local.resize(n_bases_, dim);
+			local.setZero();
+			for (int i = 0; i < n_bases_; ++i)
+			{
+				const auto &bs = bases[i];
+				for (size_t ii = 0; ii < bs.global.size(); ++ii)
+				{
+					for (int d = 0; d < dim; ++d)
+					{
+						local(i, d) += bs.global[ii].val * x(bs.global[ii].index * dim + d);
+					}
+				}
+			}
+		}
+
+		int n_bases_ = 0;
+		std::vector<const NonLinearAssemblerData *> data_; ///< elements of the batch
+		std::vector<int> offsets_;                         ///< first point of each element, and the number of points
+		/// local displacements, row i is the displacement of the i-th basis
+		std::vector<Eigen::Matrix<double, n_basis, dim>, Eigen::aligned_allocator<Eigen::Matrix<double, n_basis, dim>>> disp_;
+		Eigen::Matrix<double, n_basis, dim> dir_; ///< local direction of apply_hessian
+		Eigen::ArrayXXd AdGradj_;                  ///< contraction of A with the gradient of one basis
+		Eigen::ArrayXXd dF_;                       ///< gradient of the direction of apply_hessian
+		Eigen::ArrayXXd AdF_;                      ///< contraction of A with dF_
+		Eigen::MatrixXd local_;                    ///< local coefficients of the sum factorization
+		Eigen::MatrixXd ref_grad_;                 ///< reference gradients of the sum factorization
+	};
+} // namespace polyfem::assembler
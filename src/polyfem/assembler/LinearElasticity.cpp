@@ -2,6 +2,7 @@
 
 #include <polyfem/basis/Basis.hpp>
 #include <polyfem/assembler/ElementAssemblyValues.hpp>
+#include <polyfem/assembler/KinematicsBatch.hpp>
 
 #include <polyfem/autogen/auto_elasticity_rhs.hpp>
 
@@ -55,117 +56,104 @@ namespace polyfem
 
 		double LinearElasticity::compute_energy(const NonLinearAssemblerData &data) const
 		{
-			return compute_energy_aux<double>(data);
+			double energy;
+			compute_fast(data, &energy, nullptr, nullptr);
+			return energy;
 		}
 
 		Eigen::VectorXd LinearElasticity::assemble_grad(const NonLinearAssemblerData &data) const
 		{
-			const int n_bases = data.vals.basis_values.size();
-			return polyfem::gradient_from_energy(
-				size(), n_bases, data,
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 6, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 8, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 12, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 18, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 24, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 30, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 60, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 81, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, BIG_N, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::VectorXd>>(data); });
+			Eigen::VectorXd grad;
+			compute_fast(data, nullptr, &grad, nullptr);
+			return grad;
 		}
 
 		Eigen::MatrixXd LinearElasticity::assemble_hessian(const NonLinearAssemblerData &data) const
 		{
-			const int n_bases = data.vals.basis_values.size();
-			return polyfem::hessian_from_energy(
-				size(), n_bases, data,
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(data); });
+			Eigen::MatrixXd hessian;
+			compute_fast(data, nullptr, nullptr, &hessian);
+			return hessian;
 		}
 
-		// Compute \int mu eps : eps + lambda/2 tr(eps)^2 = \int mu tr(eps^2) + lambda/2 tr(eps)^2
-		template <typename T>
-		T LinearElasticity::compute_energy_aux(const NonLinearAssemblerData &data) const
+		void LinearElasticity::compute_fast(const NonLinearAssemblerData &data, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian) const
 		{
-			typedef Eigen::Matrix<T, Eigen::Dynamic, 1> AutoDiffVect;
-			typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> AutoDiffGradMat;
+			if (size() == 2)
+				compute_energy_gradient_hessian_fast<2>(data, energy, grad, hessian);
+			else
+				compute_energy_gradient_hessian_fast<3>(data, energy, grad, hessian);
+		}
 
+		// Compute \int mu eps : eps + lambda/2 tr(eps)^2 = \int mu tr(eps^2) + lambda/2 tr(eps)^2
+		// and its derivatives wrt the local displacement
+		template <int dim>
+		void LinearElasticity::compute_energy_gradient_hessian_fast(const NonLinearAssemblerData &data, double *energy, Eigen::VectorXd *G_flattened, Eigen::MatrixXd *H) const
+		{
 			assert(data.x.cols() == 1);
+			assert(size() == dim);
 
-			const int n_pts = data.da.size();
+			using Kinematics = KinematicsBatch<Eigen::Dynamic, dim>;
 
-			Eigen::Matrix<double, Eigen::Dynamic, 1> local_dispv(data.vals.basis_values.size() * size(), 1);
-			local_dispv.setZero();
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
+			// buffers of the previous elements assembled by this thread, see LocalWorkspace
+			struct Workspace
 			{
-				const auto &bs = data.vals.basis_values[i];
-				for (size_t ii = 0; ii < bs.global.size(); ++ii)
-				{
-					for (int d = 0; d < size(); ++d)
-					{
-						local_dispv(i * size() + d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					}
-				}
+				Kinematics kin;
+				Eigen::ArrayXd lambda, mu, tr;
+				Eigen::ArrayXXd strain, P, A;
+			};
+			LocalWorkspace fallback;
+			Workspace &workspace = (data.workspace ? *data.workspace : fallback).get<Workspace>();
+			Kinematics &kin = workspace.kin;
+			Eigen::ArrayXd &lambda = workspace.lambda, &mu = workspace.mu, &tr = workspace.tr;
+			Eigen::ArrayXXd &strain = workspace.strain, &P = workspace.P, &A = workspace.A;
+
+			kin.compute(data);
+			const int n_pts = kin.n_points();
+
+			lambda.resize(n_pts);
+			mu.resize(n_pts);
+			for (int p = 0; p < n_pts; ++p)
+				params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.vals.element_id, lambda(p), mu(p));
+
+			// eps = (grad u + grad u^T) / 2, with grad u = F - Id
+			strain.resize(n_pts, dim * dim);
+			for (int d = 0; d < dim; ++d)
+			{
+				for (int c = 0; c < dim; ++c)
+					strain.col(Kinematics::idx(d, c)) = (kin.F.col(Kinematics::idx(d, c)) + kin.F.col(Kinematics::idx(c, d))) / 2 - (d == c ? 1. : 0.);
 			}
+			tr = strain.col(Kinematics::idx(0, 0));
+			for (int d = 1; d < dim; ++d)
+				tr += strain.col(Kinematics::idx(d, d));
 
-			DiffScalarBase::setVariableCount(local_dispv.rows());
-			AutoDiffVect local_disp(local_dispv.rows(), 1);
-			T energy = T(0.0);
+			if (energy)
+				*energy = ((mu * strain.square().rowwise().sum() + lambda / 2 * tr.square()) * data.da.array()).sum();
 
-			const AutoDiffAllocator<T> allocate_auto_diff_scalar;
-
-			for (long i = 0; i < local_dispv.rows(); ++i)
+			if (G_flattened)
 			{
-				local_disp(i) = allocate_auto_diff_scalar(i, local_dispv(i));
-			}
+				// P = 2 mu eps + lambda tr(eps) Id
+				P = strain.colwise() * (2 * mu);
+				for (int d = 0; d < dim; ++d)
+					P.col(Kinematics::idx(d, d)) += lambda * tr;
 
-			AutoDiffGradMat def_grad(size(), size());
+				kin.integrate_gradient(P, 0, *G_flattened);
+			}
 
-			for (long p = 0; p < n_pts; ++p)
+			if (H)
 			{
-				for (long k = 0; k < def_grad.size(); ++k)
-					def_grad(k) = T(0);
-
-				for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
+				// A(dc, ef) = mu (δde δcf + δdf δce) + lambda δdc δef
+				A.setZero(n_pts, dim * dim * dim * dim);
+				for (int d = 0; d < dim; ++d)
 				{
-					const auto &bs = data.vals.basis_values[i];
-					const Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> grad = bs.grad.row(p);
-					assert(grad.size() == size());
-
-					for (int d = 0; d < size(); ++d)
+					for (int c = 0; c < dim; ++c)
 					{
-						for (int c = 0; c < size(); ++c)
-						{
-							def_grad(d, c) += grad(c) * local_disp(i * size() + d);
-						}
+						A.col(Kinematics::idx(d, c, d, c)) += mu;
+						A.col(Kinematics::idx(d, c, c, d)) += mu;
+						A.col(Kinematics::idx(d, d, c, c)) += lambda;
 					}
 				}
 
-				AutoDiffGradMat jac_it(size(), size());
-				for (long k = 0; k < jac_it.size(); ++k)
-					jac_it(k) = T(data.vals.jac_it[p](k));
-				def_grad = def_grad * jac_it;
-
-				const AutoDiffGradMat strain = (def_grad + def_grad.transpose()) / T(2);
-
-				double lambda, mu;
-				params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.vals.element_id, lambda, mu);
-
-				const T val = mu * (strain.transpose() * strain).trace() + lambda / 2 * strain.trace() * strain.trace();
-
-				energy += val * data.da(p);
+				kin.integrate_hessian(A, 0, *H);
 			}
-			return energy;
 		}
 
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1>
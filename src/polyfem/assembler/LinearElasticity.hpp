@@ -65,10 +65,9 @@ namespace polyfem::assembler
 
 		void assign_stress_tensor(const int el_id, const basis::ElementBases &bs, const basis::ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &displacement, const int all_size, Eigen::MatrixXd &all, const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const;
 
-		// aux function that computes energy
-		// double compute_energy is the same with T=double
-		// assemble_grad is the same with T=DScalar1 and return .getGradient()
-		template <typename T>
-		T compute_energy_aux(const NonLinearAssemblerData &data) const;
+		// energy, gradient and hessian of the element, only the non-null outputs are computed
+		void compute_fast(const NonLinearAssemblerData &data, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian) const;
+		template <int dim>
+		void compute_energy_gradient_hessian_fast(const NonLinearAssemblerData &data, double *energy, Eigen::VectorXd *G_flattened, Eigen::MatrixXd *H) const;
 	};
 } // namespace polyfem::assembler
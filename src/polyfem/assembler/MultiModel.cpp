@@ -13,7 +13,7 @@ namespace polyfem::assembler
 	void MultiModel::set_size(const int size)
 	{
 		size_ = size;
-		// saint_venant_.set_size(size);
+		saint_venant_.set_size(size);
 		neo_hookean_.set_size(size);
 		linear_elasticity_.set_size(size);
 	}
@@ -22,7 +22,7 @@ namespace polyfem::assembler
 	{
 		assert(size_ == 2 || size_ == 3);
 
-		// saint_venant_.add_multimaterial(index, params);
+		saint_venant_.add_multimaterial(index, params);
 		neo_hookean_.add_multimaterial(index, params);
 		linear_elasticity_.add_multimaterial(index, params);
 	}
@@ -93,6 +93,63 @@ namespace polyfem::assembler
 		}
 	}
 
+	void MultiModel::assemble_energy_gradient_hessian(const NonLinearAssemblerData &data, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian) const
+	{
+		const int el_id = data.vals.element_id;
+		const std::string &model = multi_material_models_[el_id];
+
+		if (model == "SaintVenant")
+		{
+			saint_venant_.assemble_energy_gradient_hessian(data, energy, grad, hessian);
+			return;
+		}
+		else if (model == "NeoHookean")
+		{
+			neo_hookean_.assemble_energy_gradient_hessian(data, energy, grad, hessian);
+			return;
+		}
+
+		if (energy)
+			*energy = compute_energy(data);
+		if (grad)
+			*grad = assemble_grad(data);
+		if (hessian)
+			*hessian = assemble_hessian(data);
+	}
+
+	void MultiModel::assemble_hessian_apply(const NonLinearAssemblerData &data, const Eigen::MatrixXd &direction, Eigen::VectorXd &hv) const
+	{
+		const int el_id = data.vals.element_id;
+		const std::string &model = multi_material_models_[el_id];
+
+		if (model == "SaintVenant")
+		{
+			saint_venant_.assemble_hessian_apply(data, direction, hv);
+			return;
+		}
+		else if (model == "NeoHookean")
+		{
+			neo_hookean_.assemble_hessian_apply(data, direction, hv);
+			return;
+		}
+
+		const int n_bases = int(data.vals.basis_values.size());
+		Eigen::VectorXd local_direction = Eigen::VectorXd::Zero(n_bases * size());
+		for (int i = 0; i < n_bases; ++i)
+		{
+			const auto &bs = data.vals.basis_values[i];
+			for (size_t ii = 0; ii < bs.global.size(); ++ii)
+			{
+				for (int d = 0; d < size(); ++d)
+				{
+					local_direction(i * size() + d) += bs.global[ii].val * direction(bs.global[ii].index * size() + d);
+				}
+			}
+		}
+
+		hv = assemble_hessian(data) * local_direction;
+	}
+
 	void MultiModel::compute_stress_tensor(const int el_id, const ElementBases &bs, const ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &displacement, Eigen::MatrixXd &stresses) const
 	{
 		const std::string model = multi_material_models_[el_id];
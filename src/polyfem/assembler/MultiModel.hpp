@@ -23,6 +23,10 @@ namespace polyfem::assembler
 		Eigen::VectorXd assemble_grad(const NonLinearAssemblerData &data) const;
 		// compute elastic energy
 		double compute_energy(const NonLinearAssemblerData &data) const;
+		// compute any combination of energy, gradient, and hessian (null outputs are skipped) in one pass
+		void assemble_energy_gradient_hessian(const NonLinearAssemblerData &data, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian) const;
+		// product of the hessian with the global direction, only the non-linear models avoid forming the hessian
+		void assemble_hessian_apply(const NonLinearAssemblerData &data, const Eigen::MatrixXd &direction, Eigen::VectorXd &hv) const;
 
 		// uses autodiff to compute the rhs for a fabbricated solution
 		// uses autogenerated code to compute div(sigma)
@@ -27,6 +27,15 @@ namespace polyfem::assembler
 
 		double compute_energy(const NonLinearAssemblerData &data) const;
 
+		// any combination of energy, gradient, and hessian (null outputs are skipped) in one pass,
+		// the deformation gradient and its determinant are computed once per quadrature point
+		void assemble_energy_gradient_hessian(const NonLinearAssemblerData &data, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian) const;
+		// same for n_elements elements with the same number of local bases, their quadrature points are evaluated together;
+		// the non null outputs point to one output per element
+		void assemble_energy_gradient_hessian(const NonLinearAssemblerData *const *data, const int n_elements, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian) const;
+		// product of the hessian with the global direction, without forming the hessian
+		void assemble_hessian_apply(const NonLinearAssemblerData &data, const Eigen::MatrixXd &direction, Eigen::VectorXd &hv) const;
+
 		// rhs for fabbricated solution, compute with automatic sympy code
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1>
 		compute_rhs(const AutodiffHessianPt &pt) const;
@@ -50,13 +59,14 @@ namespace polyfem::assembler
 
 		LameParameters params_;
 
-		// utulity function that computes energy, the template is used for double, DScalar1, and DScalar2 in energy, gradient and hessian
-		template <typename T>
-		T compute_energy_aux(const NonLinearAssemblerData &data) const;
-		template <int n_basis, int dim>
-		void compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, Eigen::MatrixXd &H) const;
+		// dispatches to compute_energy_gradient_hessian_fast for the number of local bases
+		void compute_fast(const NonLinearAssemblerData *const *data, const int n_elements, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian, const Eigen::MatrixXd *direction, Eigen::VectorXd *hv) const;
+
+		// energy, gradient, hessian, and hessian-vector product (null outputs are skipped, the others point to one output
+		// per element) for all the quadrature points of the n_elements elements at once (structure-of-arrays),
+		// n_basis is the number of local bases if known at compile time
 		template <int n_basis, int dim>
-		void compute_energy_aux_gradient_fast(const NonLinearAssemblerData &data, Eigen::VectorXd &G_flattened) const;
+		void compute_energy_gradient_hessian_fast(const NonLinearAssemblerData *const *data, const int n_elements, double *energy, Eigen::VectorXd *G_flattened, Eigen::MatrixXd *H, const Eigen::MatrixXd *direction, Eigen::VectorXd *Hv) const;
 
 		void assign_stress_tensor(const int el_id, const basis::ElementBases &bs, const basis::ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &displacement, const int all_size, Eigen::MatrixXd &all, const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const;
 	};
@@ -27,7 +27,10 @@ namespace polyfem
 
 			virtual bool is_scalar() const = 0;
 
-			virtual void rhs(const assembler::AssemblerUtils &assembler, const std::string &formulation, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const = 0;
+			/// evaluates the volume forcing term at the points pts (one per row) at time t
+			/// @note RhsAssembler::assemble calls it concurrently for the elements of a color, so it must not modify
+			/// shared state; utils::ExpressionValue and the autodiff of the assemblers (thread local variable count) are safe to use
+			virtual void rhs(const assembler::AssemblerUtils &assembler, const assembler::Formulation &formulation, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const = 0;
 			virtual bool is_rhs_zero() const = 0;
 
 			virtual void dirichlet_bc(const mesh::Mesh &mesh, const Eigen::MatrixXi &global_ids, const Eigen::MatrixXd &uv, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const = 0;
@@ -34,12 +34,19 @@ namespace polyfem
 					val = 0;
 				}
 			};
+
+			class LocalThreadElementStorage
+			{
+			public:
+				ElementAssemblyValues vals;
+				Eigen::MatrixXd rhs_fun;
+			};
 		} // namespace
 
 		RhsAssembler::RhsAssembler(const AssemblerUtils &assembler, const Mesh &mesh, const Obstacle &obstacle, const std::vector<Eigen::MatrixXd> &input_dirichlet,
 								   const int n_basis, const int size,
 								   const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases, const AssemblyValsCache &ass_vals_cache,
-								   const std::string &formulation, const Problem &problem,
+								   const Formulation &formulation, const Problem &problem,
 								   const std::string bc_method,
 								   const std::string &solver, const std::string &preconditioner, const json &solver_params)
 			: assembler_(assembler), mesh_(mesh), obstacle_(obstacle),
@@ -57,42 +64,53 @@ namespace polyfem
 			rhs = Eigen::MatrixXd::Zero(n_basis_ * size_, 1);
 			if (!problem_.is_rhs_zero())
 			{
-				Eigen::MatrixXd rhs_fun;
+				auto storage = create_thread_storage(LocalThreadElementStorage());
 
-				const int n_elements = int(bases_.size());
-				ElementAssemblyValues vals;
-				for (int e = 0; e < n_elements; ++e)
+				// elements of the same color share no node, so they are scattered directly into rhs
+				mesh::ElementColoring tmp_coloring;
+				const mesh::ElementColoring &coloring = ass_vals_cache_.coloring(bases_, tmp_coloring);
+
+				for (int c = 0; c < coloring.n_colors(); ++c)
 				{
-					// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-					ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
+					maybe_parallel_for(coloring.color_size(c), [&](int start, int end, int thread_id) {
+						LocalThreadElementStorage &local_storage = get_local_thread_storage(storage, thread_id);
+						Eigen::MatrixXd &rhs_fun = local_storage.rhs_fun;
 
-					const Quadrature &quadrature = vals.quadrature;
+						for (int k = start; k < end; ++k)
+						{
+							const int e = coloring.element(c, k);
+							// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
+							const ElementAssemblyValues &vals = ass_vals_cache_.get(e, mesh_.is_volume(), bases_[e], gbases_[e], local_storage.vals);
 
-					problem_.rhs(assembler_, formulation_, vals.val, t, rhs_fun);
+							const Quadrature &quadrature = vals.quadrature;
 
-					for (int d = 0; d < size_; ++d)
-					{
-						// rhs_fun.col(d) = rhs_fun.col(d).array() * vals.det.array() * quadrature.weights.array();
-						for (int q = 0; q < quadrature.weights.size(); ++q)
-						{
-							// const double rho = problem_.is_time_dependent() ? density(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id) : 1;
-							const double rho = density(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id);
-							rhs_fun(q, d) *= vals.det(q) * quadrature.weights(q) * rho;
-						}
-					}
+							problem_.rhs(assembler_, formulation_, vals.val, t, rhs_fun);
 
-					const int n_loc_bases_ = int(vals.basis_values.size());
-					for (int i = 0; i < n_loc_bases_; ++i)
-					{
-						const AssemblyValues &v = vals.basis_values[i];
+							for (int d = 0; d < size_; ++d)
+							{
+								// rhs_fun.col(d) = rhs_fun.col(d).array() * vals.det.array() * quadrature.weights.array();
+								for (int q = 0; q < quadrature.weights.size(); ++q)
+								{
+									// const double rho = problem_.is_time_dependent() ? density(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id) : 1;
+									const double rho = density(vals.quadrature.points.row(q), vals.val.row(q), vals.element_id);
+									rhs_fun(q, d) *= vals.det(q) * quadrature.weights(q) * rho;
+								}
+							}
 
-						for (int d = 0; d < size_; ++d)
-						{
-							const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
-							for (std::size_t ii = 0; ii < v.global.size(); ++ii)
-								rhs(v.global[ii].index * size_ + d) += rhs_value * v.global[ii].val;
+							const int n_loc_bases_ = int(vals.basis_values.size());
+							for (int i = 0; i < n_loc_bases_; ++i)
+							{
+								const AssemblyValues &v = vals.basis_values[i];
+
+								for (int d = 0; d < size_; ++d)
+								{
+									const double rhs_value = (rhs_fun.col(d).array() * v.val.array()).sum();
+									for (std::size_t ii = 0; ii < v.global.size(); ++ii)
+										rhs(v.global[ii].index * size_ + d) += rhs_value * v.global[ii].val;
+								}
+							}
 						}
-					}
+					});
 				}
 			}
 		}
@@ -127,7 +145,7 @@ namespace polyfem
 			Eigen::MatrixXd loc_sol;
 
 			const int n_elements = int(bases_.size());
-			ElementAssemblyValues vals;
+			ElementAssemblyValues tmp_vals;
 			Eigen::MatrixXi ids;
 
 			if (bc_method_ == "sample")
@@ -135,8 +153,6 @@ namespace polyfem
 				for (int e = 0; e < n_elements; ++e)
 				{
 					const basis::ElementBases &bs = bases_[e];
-					// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-					ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
 					ids.resize(1, 1);
 					ids.setConstant(e);
 
@@ -163,7 +179,7 @@ namespace polyfem
 				for (int e = 0; e < n_elements; ++e)
 				{
 					// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-					ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
+					const ElementAssemblyValues &vals = ass_vals_cache_.get(e, mesh_.is_volume(), bases_[e], gbases_[e], tmp_vals);
 					ids.resize(vals.val.rows(), 1);
 					ids.setConstant(e);
 
@@ -212,20 +228,56 @@ namespace polyfem
 			}
 		}
 
-		void RhsAssembler::lsq_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
-								  const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const
+		bool RhsAssembler::LsqBCCache::matches(const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution) const
 		{
-			const int n_el = int(bases_.size());
+			if (resolution != this->resolution || bounday_nodes != this->boundary_nodes)
+				return false;
+
+			// same layout as boundary_signature
+			size_t k = 0;
+			for (const auto &lb : local_boundary)
+			{
+				if (k + 2 + lb.size() > this->local_boundary.size())
+					return false;
+				if (this->local_boundary[k++] != lb.element_id() || this->local_boundary[k++] != lb.size())
+					return false;
+				for (int i = 0; i < lb.size(); ++i)
+				{
+					if (this->local_boundary[k++] != lb.global_primitive_id(i))
+						return false;
+				}
+			}
+
+			return k == this->local_boundary.size();
+		}
+
+		std::vector<int> RhsAssembler::LsqBCCache::boundary_signature(const std::vector<LocalBoundary> &local_boundary)
+		{
+			std::vector<int> res;
+			for (const auto &lb : local_boundary)
+			{
+				res.push_back(lb.element_id());
+				res.push_back(lb.size());
+				for (int i = 0; i < lb.size(); ++i)
+					res.push_back(lb.global_primitive_id(i));
+			}
+
+			return res;
+		}
 
-			Eigen::MatrixXd uv, samples, gtmp, rhs_fun;
+		std::shared_ptr<RhsAssembler::LsqBCCache> RhsAssembler::build_lsq_bc_cache(const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution) const
+		{
+			const auto cache_ptr = std::make_shared<LsqBCCache>();
+			LsqBCCache &cache = *cache_ptr;
+			cache.resolution = resolution;
+			cache.boundary_nodes = bounday_nodes;
+			cache.local_boundary = LsqBCCache::boundary_signature(local_boundary);
+			cache.is_boundary_dof = boundary_dof_mask(bounday_nodes);
+
+			Eigen::MatrixXd uv, samples;
 			Eigen::VectorXi global_primitive_ids;
 
 			int index = 0;
-			std::vector<int> indices;
-			indices.reserve(n_el * 10);
-			// std::map<int, int> global_index_to_col;
-
-			long total_size = 0;
 
 			Eigen::Matrix<bool, Eigen::Dynamic, 1> is_boundary(n_basis_);
 			is_boundary.setConstant(false);
@@ -234,8 +286,6 @@ namespace polyfem
 
 			const int actual_dim = problem_.is_scalar() ? 1 : mesh_.dimension();
 
-			// assert((bounday_nodes.size()/actual_dim)*actual_dim == bounday_nodes.size());
-
 			int skipped_count = 0;
 			for (int b : bounday_nodes)
 			{
@@ -259,7 +309,7 @@ namespace polyfem
 				const basis::ElementBases &bs = bases_[e];
 				const int n_local_bases = int(bs.bases.size());
 
-				total_size += samples.rows();
+				cache.total_size += samples.rows();
 
 				for (int j = 0; j < n_local_bases; ++j)
 				{
@@ -267,32 +317,17 @@ namespace polyfem
 
 					for (std::size_t ii = 0; ii < b.global().size(); ++ii)
 					{
-						// pt found
-						// if(std::find(bounday_nodes.begin(), bounday_nodes.end(), size_ * b.global()[ii].index) != bounday_nodes.end())
-						if (is_boundary[b.global()[ii].index])
+						if (is_boundary[b.global()[ii].index] && global_index_to_col(b.global()[ii].index) == -1)
 						{
-							// if(!global_index_to_col.contains(b.global()[ii].index))
-							if (global_index_to_col(b.global()[ii].index) == -1)
-							{
-								// global_index_to_col[b.global()[ii].index] = index++;
-								global_index_to_col(b.global()[ii].index) = index++;
-								indices.push_back(b.global()[ii].index);
-								assert(indices.size() == size_t(index));
-							}
+							global_index_to_col(b.global()[ii].index) = index++;
+							cache.indices.push_back(b.global()[ii].index);
+							assert(cache.indices.size() == size_t(index));
 						}
 					}
 				}
 			}
 
-			// Eigen::MatrixXd global_mat = Eigen::MatrixXd::Zero(total_size, indices.size());
-			Eigen::MatrixXd global_rhs = Eigen::MatrixXd::Zero(total_size, size_);
-
-			const long buffer_size = total_size * long(indices.size());
-			std::vector<Eigen::Triplet<double>> entries, entries_t;
-			// entries.reserve(buffer_size);
-			// entries_t.reserve(buffer_size);
-
-			index = 0;
+			std::vector<Eigen::Triplet<double>> entries_t;
 
 			int global_counter = 0;
 			Eigen::MatrixXd mapped;
@@ -321,87 +356,120 @@ namespace polyfem
 
 					for (std::size_t ii = 0; ii < b.global().size(); ++ii)
 					{
-						// auto item = global_index_to_col.find(b.global()[ii].index);
-						// if(item != global_index_to_col.end()){
 						auto item = global_index_to_col(b.global()[ii].index);
 						if (item != -1)
 						{
 							for (int k = 0; k < int(tmp.size()); ++k)
-							{
-								// entries.push_back(Eigen::Triplet<double>(global_counter+k, item->second, tmp(k, j) * b.global()[ii].val));
-								// entries_t.push_back(Eigen::Triplet<double>(item->second, global_counter+k, tmp(k, j) * b.global()[ii].val));
-								entries.push_back(Eigen::Triplet<double>(global_counter + k, item, tmp(k) * b.global()[ii].val));
 								entries_t.push_back(Eigen::Triplet<double>(item, global_counter + k, tmp(k) * b.global()[ii].val));
-							}
-							// global_mat.block(global_counter, item->second, tmp.size(), 1) = tmp;
 						}
 					}
 				}
 
-				// problem_.dirichlet_bc(mesh_, global_primitive_ids, mapped, t, rhs_fun);
-				df(global_primitive_ids, uv, mapped, rhs_fun);
-				global_rhs.block(global_counter, 0, rhs_fun.rows(), rhs_fun.cols()) = rhs_fun;
-				global_counter += rhs_fun.rows();
+				cache.sample_offsets.push_back(global_counter);
+				cache.global_primitive_ids.push_back(global_primitive_ids);
+				cache.uv.push_back(uv);
+				cache.mapped.push_back(mapped);
+				global_counter += mapped.rows();
+			}
+
+			assert(global_counter == cache.total_size);
+
+			cache.mat_t.resize(int(cache.indices.size()), int(cache.total_size));
+			cache.mat_t.setFromTriplets(entries_t.begin(), entries_t.end());
+
+			const StiffnessMatrix mat = cache.mat_t.transpose();
+			cache.A = cache.mat_t * mat;
+
+			return cache_ptr;
+		}
+
+		std::vector<bool> RhsAssembler::boundary_dof_mask(const std::vector<int> &bounday_nodes) const
+		{
+			std::vector<bool> mask(n_basis_ * size_, false);
+			for (int b : bounday_nodes)
+			{
+				// the pressure node of mixed formulations is past the end
+				if (b < int(mask.size()))
+					mask[b] = true;
+			}
 
-				// UIState::ui_state().debug_data().add_points(mapped, Eigen::MatrixXd::Constant(1, 3, 0));
+			return mask;
+		}
 
-				// Eigen::MatrixXd asd(mapped.rows(), 3);
-				// asd.col(0)=mapped.col(0);
-				// asd.col(1)=mapped.col(1);
-				// asd.col(2)=rhs_fun;
-				// UIState::ui_state().debug_data().add_points(asd, Eigen::MatrixXd::Constant(1, 3, 0));
+		void RhsAssembler::lsq_bc(const std::function<void(const Eigen::MatrixXi &, const Eigen::MatrixXd &, const Eigen::MatrixXd &, Eigen::MatrixXd &)> &df,
+								  const std::vector<LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution, Eigen::MatrixXd &rhs) const
+		{
+			std::shared_ptr<LsqBCCache> cache_ptr;
+			{
+				std::lock_guard<std::mutex> lock(lsq_bc_mutex_);
+				if (!lsq_bc_cache_ || !lsq_bc_cache_->matches(local_boundary, bounday_nodes, resolution))
+					lsq_bc_cache_ = build_lsq_bc_cache(local_boundary, bounday_nodes, resolution);
+				cache_ptr = lsq_bc_cache_;
 			}
 
-			assert(global_counter == total_size);
+			LsqBCCache &cache = *cache_ptr;
+			if (cache.total_size <= 0)
+				return;
+
+			Eigen::MatrixXd global_rhs = Eigen::MatrixXd::Zero(cache.total_size, size_);
+			Eigen::MatrixXd rhs_fun;
 
-			if (total_size > 0)
+			for (size_t k = 0; k < cache.mapped.size(); ++k)
 			{
-				const double mmin = global_rhs.minCoeff();
-				const double mmax = global_rhs.maxCoeff();
+				df(cache.global_primitive_ids[k], cache.uv[k], cache.mapped[k], rhs_fun);
+				global_rhs.block(cache.sample_offsets[k], 0, rhs_fun.rows(), rhs_fun.cols()) = rhs_fun;
+			}
+
+			const auto &indices = cache.indices;
+			const double mmin = global_rhs.minCoeff();
+			const double mmax = global_rhs.maxCoeff();
 
-				if (fabs(mmin) < 1e-8 && fabs(mmax) < 1e-8)
+			if (fabs(mmin) < 1e-8 && fabs(mmax) < 1e-8)
+			{
+				for (size_t i = 0; i < indices.size(); ++i)
 				{
-					// std::cout<<"is all zero, skipping"<<std::endl;
-					for (size_t i = 0; i < indices.size(); ++i)
+					for (int d = 0; d < size_; ++d)
 					{
-						for (int d = 0; d < size_; ++d)
-						{
-							if (problem_.all_dimensions_dirichlet() || std::find(bounday_nodes.begin(), bounday_nodes.end(), indices[i] * size_ + d) != bounday_nodes.end())
-								rhs(indices[i] * size_ + d) = 0;
-						}
+						if (problem_.all_dimensions_dirichlet() || cache.is_boundary_dof[indices[i] * size_ + d])
+							rhs(indices[i] * size_ + d) = 0;
 					}
 				}
-				else
-				{
-					StiffnessMatrix mat(int(total_size), int(indices.size()));
-					mat.setFromTriplets(entries.begin(), entries.end());
 
-					StiffnessMatrix mat_t(int(indices.size()), int(total_size));
-					mat_t.setFromTriplets(entries_t.begin(), entries_t.end());
+				return;
+			}
 
-					StiffnessMatrix A = mat_t * mat;
-					Eigen::MatrixXd b = mat_t * global_rhs;
+			// the projection only depends on the boundary, factorize it the first time it is needed
+			{
+				std::lock_guard<std::mutex> lock(lsq_bc_mutex_);
+				if (!cache.solver)
+				{
+					logger().debug("Factorizing the Dirichlet least-squares projection ({} dofs)", cache.A.rows());
+					cache.solver = LinearSolver::create(solver_, preconditioner_);
+					cache.solver->setParameters(solver_params_);
+					cache.solver->analyzePattern(cache.A, cache.A.rows());
+					cache.solver->factorize(cache.A);
+				}
+			}
 
-					Eigen::MatrixXd coeffs(b.rows(), b.cols());
-					auto solver = LinearSolver::create(solver_, preconditioner_);
-					solver->setParameters(solver_params_);
-					solver->analyzePattern(A, A.rows());
-					solver->factorize(A);
-					coeffs.setZero();
-					for (long i = 0; i < b.cols(); ++i)
-					{
-						solver->solve(b.col(i), coeffs.col(i));
-					}
-					logger().trace("RHS solve error {}", (A * coeffs - b).norm());
+			const Eigen::MatrixXd b = cache.mat_t * global_rhs;
 
-					for (long i = 0; i < coeffs.rows(); ++i)
-					{
-						for (int d = 0; d < size_; ++d)
-						{
-							if (problem_.all_dimensions_dirichlet() || std::find(bounday_nodes.begin(), bounday_nodes.end(), indices[i] * size_ + d) != bounday_nodes.end())
-								rhs(indices[i] * size_ + d) = coeffs(i, d);
-						}
-					}
+			Eigen::MatrixXd coeffs(b.rows(), b.cols());
+			coeffs.setZero();
+			{
+				std::lock_guard<std::mutex> lock(cache.solve_mutex);
+				for (long i = 0; i < b.cols(); ++i)
+				{
+					cache.solver->solve(b.col(i), coeffs.col(i));
+				}
+			}
+			logger().trace("RHS solve error {}", (cache.A * coeffs - b).norm());
+
+			for (long i = 0; i < coeffs.rows(); ++i)
+			{
+				for (int d = 0; d < size_; ++d)
+				{
+					if (problem_.all_dimensions_dirichlet() || cache.is_boundary_dof[indices[i] * size_ + d])
+						rhs(indices[i] * size_ + d) = coeffs(i, d);
 				}
 			}
 		}
@@ -416,6 +484,8 @@ namespace polyfem
 			Eigen::MatrixXd nans(1, 1);
 			nans(0) = std::nan("");
 
+			const std::vector<bool> is_boundary_dof = boundary_dof_mask(bounday_nodes);
+
 #ifndef NDEBUG
 			Eigen::Matrix<bool, Eigen::Dynamic, 1> is_boundary(n_basis_);
 			is_boundary.setConstant(false);
@@ -459,7 +529,7 @@ namespace polyfem
 
 							for (int d = 0; d < size_; ++d)
 							{
-								if (problem_.all_dimensions_dirichlet() || std::find(bounday_nodes.begin(), bounday_nodes.end(), glob[ii].index * size_ + d) != bounday_nodes.end())
+								if (problem_.all_dimensions_dirichlet() || is_boundary_dof[glob[ii].index * size_ + d])
 									rhs(glob[ii].index * size_ + d) = rhs_fun(0, d);
 							}
 						}
@@ -497,6 +567,7 @@ namespace polyfem
 					skipped_count++;
 			}
 			assert(skipped_count <= 1);
+			const std::vector<bool> is_boundary_dof = boundary_dof_mask(bounday_nodes);
 			ElementAssemblyValues vals;
 
 			for (const auto &lb : local_boundary)
@@ -534,7 +605,7 @@ namespace polyfem
 							for (size_t g = 0; g < v.global.size(); ++g)
 							{
 								const int g_index = v.global[g].index * size_ + d;
-								if (problem_.all_dimensions_dirichlet() || std::find(bounday_nodes.begin(), bounday_nodes.end(), g_index) != bounday_nodes.end())
+								if (problem_.all_dimensions_dirichlet() || is_boundary_dof[g_index])
 								{
 									rhs(g_index) += rhs_value * v.global[g].val;
 									areas(g_index) += area * v.global[g].val;
@@ -592,6 +663,7 @@ namespace polyfem
 			Eigen::MatrixXd points, normals;
 			Eigen::VectorXd weights;
 
+			const std::vector<bool> is_boundary_dof = boundary_dof_mask(bounday_nodes);
 			ElementAssemblyValues vals;
 
 			for (const auto &lb : local_neumann_boundary)
@@ -663,7 +735,7 @@ namespace polyfem
 							for (size_t g = 0; g < v.global.size(); ++g)
 							{
 								const int g_index = v.global[g].index * size_ + d;
-								const bool is_neumann = std::find(bounday_nodes.begin(), bounday_nodes.end(), g_index) == bounday_nodes.end();
+								const bool is_neumann = !is_boundary_dof[g_index];
 
 								if (is_neumann)
 								{
@@ -732,9 +804,8 @@ namespace polyfem
 
 					for (int e = start; e < end; ++e)
 					{
-						ElementAssemblyValues &vals = local_storage.vals;
 						// vals.compute(e, mesh_.is_volume(), bases_[e], gbases_[e]);
-						ass_vals_cache_.compute(e, mesh_.is_volume(), bases_[e], gbases_[e], vals);
+						const ElementAssemblyValues &vals = ass_vals_cache_.get(e, mesh_.is_volume(), bases_[e], gbases_[e], local_storage.vals);
 
 						const Quadrature &quadrature = vals.quadrature;
 						const Eigen::VectorXd da = vals.det.array() * quadrature.weights.array();
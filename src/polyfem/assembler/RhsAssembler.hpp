@@ -9,7 +9,11 @@
 #include <polyfem/utils/ElasticityUtils.hpp>
 #include <polyfem/utils/Types.hpp>
 
+#include <polysolve/LinearSolver.hpp>
+
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace polyfem
@@ -27,7 +31,7 @@ namespace polyfem
 			RhsAssembler(const AssemblerUtils &assembler, const mesh::Mesh &mesh, const mesh::Obstacle &obstacle, const std::vector<Eigen::MatrixXd> &input_dirichlet,
 						 const int n_basis, const int size,
 						 const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases, const AssemblyValsCache &ass_vals_cache,
-						 const std::string &formulation, const Problem &problem,
+						 const Formulation &formulation, const Problem &problem,
 						 const std::string bc_method,
 						 const std::string &solver, const std::string &preconditioner, const json &solver_params);
 
@@ -53,7 +57,7 @@ namespace polyfem
 			void compute_energy_grad(const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const Density &density, const int resolution, const std::vector<mesh::LocalBoundary> &local_neumann_boundary, const Eigen::MatrixXd &final_rhs, const double t, Eigen::MatrixXd &rhs) const;
 
 			// return the formulation
-			inline const std::string &formulation() const { return formulation_; }
+			inline const Formulation &formulation() const { return formulation_; }
 
 		private:
 			// leastsquares fit bc
@@ -89,12 +93,54 @@ namespace polyfem
 			const std::vector<basis::ElementBases> &bases_;
 			const std::vector<basis::ElementBases> &gbases_;
 			const AssemblyValsCache &ass_vals_cache_;
-			const std::string formulation_;
+			const Formulation formulation_;
 			const Problem &problem_;
 			const std::string bc_method_;
 			const std::string solver_, preconditioner_;
 			const json solver_params_;
 			const std::vector<Eigen::MatrixXd> &input_dirichlet_;
+
+			// the Dirichlet least-squares projection only depends on the mesh and the boundary,
+			// it is built once and reused, only the bc function is evaluated at every call
+			struct LsqBCCache
+			{
+				int resolution = -1;
+				std::vector<int> boundary_nodes;
+				// element id, size, and global primitive ids of every local boundary
+				std::vector<int> local_boundary;
+
+				// dof -> is in boundary_nodes
+				std::vector<bool> is_boundary_dof;
+				// global basis index of every column of the projection
+				std::vector<int> indices;
+
+				// samples of every boundary element and their offset in the stacked rhs
+				std::vector<Eigen::VectorXi> global_primitive_ids;
+				std::vector<Eigen::MatrixXd> uv;
+				std::vector<Eigen::MatrixXd> mapped;
+				std::vector<int> sample_offsets;
+				long total_size = 0;
+
+				StiffnessMatrix mat_t;
+				StiffnessMatrix A;
+				// factorization of A, created (under lsq_bc_mutex_) the first time a non-zero bc is projected
+				std::unique_ptr<polysolve::LinearSolver> solver;
+				// the solvers are not thread safe, only the solves with the factorization are serialized
+				std::mutex solve_mutex;
+
+				// compares in place with the boundary of the cache, the boundary is not copied
+				bool matches(const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution) const;
+				static std::vector<int> boundary_signature(const std::vector<mesh::LocalBoundary> &local_boundary);
+			};
+
+			std::shared_ptr<LsqBCCache> build_lsq_bc_cache(const std::vector<mesh::LocalBoundary> &local_boundary, const std::vector<int> &bounday_nodes, const int resolution) const;
+			// dof -> is in bounday_nodes, replaces linear searches
+			std::vector<bool> boundary_dof_mask(const std::vector<int> &bounday_nodes) const;
+
+			// set_bc can be called from several threads, the lock is held to match and build the cache and to
+			// factorize it, a call keeps its cache alive while it projects even if another boundary replaces it
+			mutable std::mutex lsq_bc_mutex_;
+			mutable std::shared_ptr<LsqBCCache> lsq_bc_cache_;
 		};
 	} // namespace assembler
 } // namespace polyfem
@@ -1,6 +1,7 @@
 // #define EIGEN_STACK_ALLOCATION_LIMIT 0
 
 #include "SaintVenantElasticity.hpp"
+#include "KinematicsBatch.hpp"
 
 #include <polyfem/basis/Basis.hpp>
 #include <polyfem/autogen/auto_elasticity_rhs.hpp>
@@ -104,43 +105,75 @@ namespace polyfem::assembler
 	Eigen::VectorXd
 	SaintVenantElasticity::assemble_grad(const NonLinearAssemblerData &data) const
 	{
-		// igl::Timer time; time.start();
-
-		const int n_bases = data.vals.basis_values.size();
-
-		return polyfem::gradient_from_energy(
-			size(), n_bases, data,
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 6, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 8, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 12, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 18, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 24, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 30, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 60, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 81, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, BIG_N, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::VectorXd>>(data); });
+		Eigen::VectorXd gradient;
+		assemble_energy_gradient_hessian(data, nullptr, &gradient, nullptr);
+		return gradient;
 	}
 
 	Eigen::MatrixXd
 	SaintVenantElasticity::assemble_hessian(const NonLinearAssemblerData &data) const
 	{
-		// igl::Timer time; time.start();
-
-		const int n_bases = data.vals.basis_values.size();
-		return polyfem::hessian_from_energy(
-			size(), n_bases, data,
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(data); });
+		Eigen::MatrixXd hessian;
+		assemble_energy_gradient_hessian(data, nullptr, nullptr, &hessian);
+		return hessian;
+	}
+
+	void SaintVenantElasticity::assemble_energy_gradient_hessian(const NonLinearAssemblerData &data, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian) const
+	{
+		const NonLinearAssemblerData *element = &data;
+		compute_fast(&element, 1, energy, grad, hessian, nullptr, nullptr);
+	}
+
+	void SaintVenantElasticity::assemble_energy_gradient_hessian(const NonLinearAssemblerData *const *data, const int n_elements, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian) const
+	{
+		compute_fast(data, n_elements, energy, grad, hessian, nullptr, nullptr);
+	}
+
+	void SaintVenantElasticity::assemble_hessian_apply(const NonLinearAssemblerData &data, const Eigen::MatrixXd &direction, Eigen::VectorXd &hv) const
+	{
+		const NonLinearAssemblerData *element = &data;
+		compute_fast(&element, 1, nullptr, nullptr, nullptr, &direction, &hv);
+	}
+
+	void SaintVenantElasticity::compute_fast(const NonLinearAssemblerData *const *data, const int n_elements, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian, const Eigen::MatrixXd *direction, Eigen::VectorXd *hv) const
+	{
+		if (size() == 2)
+		{
+			switch (data[0]->vals.basis_values.size())
+			{
+			case 3:
+				compute_energy_gradient_hessian_fast<3, 2>(data, n_elements, energy, grad, hessian, direction, hv);
+				break;
+			case 6:
+				compute_energy_gradient_hessian_fast<6, 2>(data, n_elements, energy, grad, hessian, direction, hv);
+				break;
+			case 10:
+				compute_energy_gradient_hessian_fast<10, 2>(data, n_elements, energy, grad, hessian, direction, hv);
+				break;
+			default:
+				compute_energy_gradient_hessian_fast<Eigen::Dynamic, 2>(data, n_elements, energy, grad, hessian, direction, hv);
+				break;
+			}
+		}
+		else // if (size() == 3)
+		{
+			assert(size() == 3);
+			switch (data[0]->vals.basis_values.size())
+			{
+			case 4:
+				compute_energy_gradient_hessian_fast<4, 3>(data, n_elements, energy, grad, hessian, direction, hv);
+				break;
+			case 10:
+				compute_energy_gradient_hessian_fast<10, 3>(data, n_elements, energy, grad, hessian, direction, hv);
+				break;
+			case 20:
+				compute_energy_gradient_hessian_fast<20, 3>(data, n_elements, energy, grad, hessian, direction, hv);
+				break;
+			default:
+				compute_energy_gradient_hessian_fast<Eigen::Dynamic, 3>(data, n_elements, energy, grad, hessian, direction, hv);
+				break;
+			}
+		}
 	}
 
 	void SaintVenantElasticity::compute_stress_tensor(const int el_id, const basis::ElementBases &bs, const basis::ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &displacement, Eigen::MatrixXd &stresses) const
@@ -212,103 +245,168 @@ namespace polyfem::assembler
 
 	double SaintVenantElasticity::compute_energy(const NonLinearAssemblerData &data) const
 	{
-		return compute_energy_aux<double>(data);
+		double energy;
+		assemble_energy_gradient_hessian(data, &energy, nullptr, nullptr);
+		return energy;
 	}
 
-	// Compute \int \sigma : E
-	template <typename T>
-	T SaintVenantElasticity::compute_energy_aux(const NonLinearAssemblerData &data) const
+	// Compute ½ ∫ S : E, with E = ½(FᵀF - I) and S = C : E, and its derivatives
+	// for all the quadrature points at once
+	template <int n_basis, int dim>
+	void SaintVenantElasticity::compute_energy_gradient_hessian_fast(const NonLinearAssemblerData *const *data, const int n_elements, double *energy, Eigen::VectorXd *G_flattened, Eigen::MatrixXd *H, const Eigen::MatrixXd *direction, Eigen::VectorXd *Hv) const
 	{
-		typedef Eigen::Matrix<T, Eigen::Dynamic, 1> AutoDiffVect;
-		typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> AutoDiffGradMat;
-
-		assert(data.x.cols() == 1);
+		assert(data[0]->x.cols() == 1);
+		assert(size() == dim);
 
-		const int n_pts = data.da.size();
+		using Kinematics = KinematicsBatch<n_basis, dim>;
+		constexpr int n_voigt = dim == 2 ? 3 : 6;
 
-		Eigen::Matrix<double, Eigen::Dynamic, 1> local_dispv(data.vals.basis_values.size() * size(), 1);
-		local_dispv.setZero();
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
+		// scratch buffers of the thread, owned by the assembler (see LocalWorkspace)
+		struct Workspace
 		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
+			Kinematics kin;
+			Eigen::ArrayXXd E, S, P, CF, A;
+		};
+		LocalWorkspace fallback;
+		Workspace &workspace = (data[0]->workspace ? *data[0]->workspace : fallback).get<Workspace>();
+		Kinematics &kin = workspace.kin;
+		Eigen::ArrayXXd &E = workspace.E, &S = workspace.S, &P = workspace.P, &CF = workspace.CF, &A = workspace.A;
+
+		kin.compute(data, n_elements);
+		const int n_pts = kin.n_points();
+
+		// Green strain
+		E.resize(n_pts, dim * dim);
+		for (int d = 0; d < dim; ++d)
+		{
+			for (int c = d; c < dim; ++c)
 			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_dispv(i * size() + d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-				}
+				auto e = E.col(Kinematics::idx(d, c));
+				e = kin.F.col(Kinematics::idx(0, d)) * kin.F.col(Kinematics::idx(0, c));
+				for (int k = 1; k < dim; ++k)
+					e += kin.F.col(Kinematics::idx(k, d)) * kin.F.col(Kinematics::idx(k, c));
+				if (d == c)
+					e -= 1;
+				e *= 0.5;
+				if (c != d)
+					E.col(Kinematics::idx(c, d)) = e;
 			}
 		}
 
-		DiffScalarBase::setVariableCount(local_dispv.rows());
-		AutoDiffVect local_disp(local_dispv.rows(), 1);
-		T energy = T(0.0);
-
-		const AutoDiffAllocator<T> allocate_auto_diff_scalar;
+		// second Piola-Kirchhoff stress, using the Voigt notation of the elasticity tensor
+		// (same ordering as in assign_stress_tensor)
+		static constexpr int voigt_2d[3][2] = {{0, 0}, {1, 1}, {0, 1}};
+		static constexpr int voigt_3d[6][2] = {{0, 0}, {1, 1}, {2, 2}, {1, 2}, {0, 2}, {0, 1}};
+		const auto voigt = [](const int j, const int k) { return dim == 2 ? voigt_2d[j][k] : voigt_3d[j][k]; };
 
-		for (long i = 0; i < local_dispv.rows(); ++i)
+		S.resize(n_pts, dim * dim);
+		for (int j = 0; j < n_voigt; ++j)
 		{
-			local_disp(i) = allocate_auto_diff_scalar(i, local_dispv(i));
+			auto s = S.col(Kinematics::idx(voigt(j, 0), voigt(j, 1)));
+			s.setZero();
+			for (int k = 0; k < n_voigt; ++k)
+			{
+				const double c = elasticity_tensor_(j, k) * (k < dim ? 1 : 2);
+				s += c * E.col(Kinematics::idx(voigt(k, 0), voigt(k, 1)));
+			}
+			if (j >= dim)
+				S.col(Kinematics::idx(voigt(j, 1), voigt(j, 0))) = s;
 		}
 
-		AutoDiffGradMat displacement_grad(size(), size());
+		if (energy)
+		{
+			const Eigen::ArrayXd psi = 0.5 * (S * E).rowwise().sum();
+			for (int el = 0; el < n_elements; ++el)
+				energy[el] = kin.integrate(psi, el);
+		}
 
-		for (long p = 0; p < n_pts; ++p)
+		if (G_flattened)
 		{
-			for (long k = 0; k < displacement_grad.size(); ++k)
-				displacement_grad(k) = T(0);
+			P.resize(n_pts, dim * dim);
+			for (int d = 0; d < dim; ++d)
+			{
+				for (int c = 0; c < dim; ++c)
+				{
+					auto pc = P.col(Kinematics::idx(d, c));
+					pc = kin.F.col(Kinematics::idx(d, 0)) * S.col(Kinematics::idx(0, c));
+					for (int k = 1; k < dim; ++k)
+						pc += kin.F.col(Kinematics::idx(d, k)) * S.col(Kinematics::idx(k, c));
+				}
+			}
 
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
+			for (int el = 0; el < n_elements; ++el)
+				kin.integrate_gradient(P, el, G_flattened[el]);
+		}
+
+		if (H || Hv)
+		{
+			// full stiffness tensor, C(ij, kl)
+			Eigen::Matrix<double, dim * dim, dim * dim> C;
+			for (int j = 0; j < n_voigt; ++j)
 			{
-				const auto &bs = data.vals.basis_values[i];
-				const Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> grad = bs.grad.row(p);
-				assert(grad.size() == size());
+				for (int k = 0; k < n_voigt; ++k)
+				{
+					const double c = elasticity_tensor_(j, k);
+					const int j0 = voigt(j, 0), j1 = voigt(j, 1);
+					const int k0 = voigt(k, 0), k1 = voigt(k, 1);
+					C(Kinematics::idx(j0, j1), Kinematics::idx(k0, k1)) = c;
+					C(Kinematics::idx(j1, j0), Kinematics::idx(k0, k1)) = c;
+					C(Kinematics::idx(j0, j1), Kinematics::idx(k1, k0)) = c;
+					C(Kinematics::idx(j1, j0), Kinematics::idx(k1, k0)) = c;
+				}
+			}
 
-				for (int d = 0; d < size(); ++d)
+			// ∂P(d, c)/∂F(e, f) = δ(d, e) S(f, c) + Σ_k Σ_b F(d, k) C(kc, fb) F(e, b)
+			CF.resize(n_pts, dim * dim * dim * dim);
+			for (int k = 0; k < dim; ++k)
+			{
+				for (int c = 0; c < dim; ++c)
 				{
-					for (int c = 0; c < size(); ++c)
+					for (int e = 0; e < dim; ++e)
 					{
-						displacement_grad(d, c) += grad(c) * local_disp(i * size() + d);
+						for (int f = 0; f < dim; ++f)
+						{
+							// Σ_b C(kc, fb) F(e, b)
+							auto cf = CF.col(Kinematics::idx(k, c, e, f));
+							cf.setZero();
+							for (int b = 0; b < dim; ++b)
+							{
+								const double cc = C(Kinematics::idx(k, c), Kinematics::idx(f, b));
+								if (cc != 0)
+									cf += cc * kin.F.col(Kinematics::idx(e, b));
+							}
+						}
 					}
 				}
 			}
 
-			AutoDiffGradMat jac_it(size(), size());
-			for (long k = 0; k < jac_it.size(); ++k)
-				jac_it(k) = T(data.vals.jac_it[p](k));
-			displacement_grad = displacement_grad * jac_it;
-
-			AutoDiffGradMat strain = strain_from_disp_grad(displacement_grad);
-			AutoDiffGradMat stress_tensor(size(), size());
-
-			if (size() == 2)
+			A.resize(n_pts, dim * dim * dim * dim);
+			for (int d = 0; d < dim; ++d)
 			{
-				std::array<T, 3> eps;
-				eps[0] = strain(0, 0);
-				eps[1] = strain(1, 1);
-				eps[2] = 2 * strain(0, 1);
-
-				stress_tensor << stress(eps, 0), stress(eps, 2),
-					stress(eps, 2), stress(eps, 1);
+				for (int c = 0; c < dim; ++c)
+				{
+					for (int e = 0; e < dim; ++e)
+					{
+						for (int f = 0; f < dim; ++f)
+						{
+							auto a = A.col(Kinematics::idx(d, c, e, f));
+							a = kin.F.col(Kinematics::idx(d, 0)) * CF.col(Kinematics::idx(0, c, e, f));
+							for (int k = 1; k < dim; ++k)
+								a += kin.F.col(Kinematics::idx(d, k)) * CF.col(Kinematics::idx(k, c, e, f));
+							if (d == e)
+								a += S.col(Kinematics::idx(f, c));
+						}
+					}
+				}
 			}
-			else
-			{
-				std::array<T, 6> eps;
-				eps[0] = strain(0, 0);
-				eps[1] = strain(1, 1);
-				eps[2] = strain(2, 2);
-				eps[3] = 2 * strain(1, 2);
-				eps[4] = 2 * strain(0, 2);
-				eps[5] = 2 * strain(0, 1);
 
-				stress_tensor << stress(eps, 0), stress(eps, 5), stress(eps, 4),
-					stress(eps, 5), stress(eps, 1), stress(eps, 3),
-					stress(eps, 4), stress(eps, 3), stress(eps, 2);
+			for (int el = 0; el < n_elements; ++el)
+			{
+				if (H)
+					kin.integrate_hessian(A, el, H[el]);
+				if (Hv)
+					kin.apply_hessian(A, el, *direction, Hv[el]);
 			}
-
-			energy += (stress_tensor * strain).trace() * data.da(p);
 		}
-
-		return energy * 0.5;
 	}
 } // namespace polyfem::assembler
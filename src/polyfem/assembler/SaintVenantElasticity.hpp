@@ -22,6 +22,13 @@ namespace polyfem::assembler
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const;
 		Eigen::VectorXd assemble_grad(const NonLinearAssemblerData &data) const;
 		double compute_energy(const NonLinearAssemblerData &data) const;
+		// compute any combination of energy, gradient, and hessian (null outputs are skipped) in one pass
+		void assemble_energy_gradient_hessian(const NonLinearAssemblerData &data, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian) const;
+		// same for n_elements elements with the same number of local bases, their quadrature points are evaluated together;
+		// the non null outputs point to one output per element
+		void assemble_energy_gradient_hessian(const NonLinearAssemblerData *const *data, const int n_elements, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian) const;
+		// product of the hessian with the global direction, without forming the hessian
+		void assemble_hessian_apply(const NonLinearAssemblerData &data, const Eigen::MatrixXd &direction, Eigen::VectorXd &hv) const;
 
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1>
 		compute_rhs(const AutodiffHessianPt &pt) const;
@@ -45,8 +52,14 @@ namespace polyfem::assembler
 		template <typename T, unsigned long N>
 		T stress(const std::array<T, N> &strain, const int j) const;
 
-		template <typename T>
-		T compute_energy_aux(const NonLinearAssemblerData &data) const;
+		// dispatches to compute_energy_gradient_hessian_fast for the number of local bases
+		void compute_fast(const NonLinearAssemblerData *const *data, const int n_elements, double *energy, Eigen::VectorXd *grad, Eigen::MatrixXd *hessian, const Eigen::MatrixXd *direction, Eigen::VectorXd *hv) const;
+
+		// energy, gradient, hessian, and hessian-vector product (null outputs are skipped, the others point to one output
+		// per element) for all the quadrature points of the n_elements elements at once (structure-of-arrays),
+		// n_basis is the number of local bases if known at compile time
+		template <int n_basis, int dim>
+		void compute_energy_gradient_hessian_fast(const NonLinearAssemblerData *const *data, const int n_elements, double *energy, Eigen::VectorXd *G_flattened, Eigen::MatrixXd *H, const Eigen::MatrixXd *direction, Eigen::VectorXd *Hv) const;
 
 		void assign_stress_tensor(const int el_id, const basis::ElementBases &bs, const basis::ElementBases &gbs, const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &displacement, const int all_size, Eigen::MatrixXd &all, const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const;
 	};
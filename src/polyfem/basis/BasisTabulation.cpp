@@ -0,0 +1,102 @@
+#include "BasisTabulation.hpp"
+
+#include <polyfem/basis/ElementBases.hpp>
+
+#include <cassert>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+namespace polyfem
+{
+	using namespace assembler;
+
+	namespace basis
+	{
+		namespace
+		{
+			struct TabulationCache
+			{
+				std::shared_mutex mutex;
+				// keyed by the reference bases and the quadrature order
+				std::map<std::pair<BasisTabulation::Key, int>, std::shared_ptr<const BasisTabulation>> tabulations;
+			};
+
+			TabulationCache &tabulation_cache()
+			{
+				static TabulationCache cache;
+				return cache;
+			}
+		} // namespace
+
+		void BasisTabulation::copy_to(std::vector<AssemblyValues> &basis_values) const
+		{
+			const int d = dim();
+			basis_values.resize(n_bases());
+			for (int i = 0; i < n_bases(); ++i)
+			{
+				basis_values[i].val = val.col(i);
+				basis_values[i].grad = grad.middleCols(i * d, d);
+			}
+		}
+
+		void BasisTabulation::compute(const Eigen::MatrixXd &pts, const ElementBases &bases)
+		{
+			points = pts;
+
+			std::vector<AssemblyValues> basis_values;
+			bases.evaluate_bases(pts, basis_values);
+			bases.evaluate_grads(pts, basis_values);
+
+			const int n_bases = int(basis_values.size());
+			const int d = int(pts.cols());
+			val.resize(pts.rows(), n_bases);
+			grad.resize(pts.rows(), n_bases * d);
+			for (int i = 0; i < n_bases; ++i)
+			{
+				val.col(i) = basis_values[i].val;
+				grad.middleCols(i * d, d) = basis_values[i].grad;
+			}
+		}
+
+		std::shared_ptr<const BasisTabulation> BasisTabulation::get(const Key &key, const int quadrature_order, const Eigen::MatrixXd &pts, const ElementBases &bases)
+		{
+			assert(quadrature_order >= 0);
+			const std::pair<Key, int> cache_key(key, quadrature_order);
+
+			TabulationCache &cache = tabulation_cache();
+			{
+				std::shared_lock<std::shared_mutex> lock(cache.mutex);
+				const auto it = cache.tabulations.find(cache_key);
+				if (it != cache.tabulations.end())
+				{
+					assert(it->second->points.rows() == pts.rows() && it->second->points.cols() == pts.cols());
+					return it->second;
+				}
+			}
+
+			// evaluated outside of the lock, another thread might insert the same tabulation in the meantime
+			auto tab = std::make_shared<BasisTabulation>();
+			tab->compute(pts, bases);
+
+			std::unique_lock<std::shared_mutex> lock(cache.mutex);
+			// keeps the tabulation of the thread that inserted first
+			return cache.tabulations.emplace(cache_key, tab).first->second;
+		}
+
+		size_t BasisTabulation::cache_size()
+		{
+			TabulationCache &cache = tabulation_cache();
+			std::shared_lock<std::shared_mutex> lock(cache.mutex);
+			return cache.tabulations.size();
+		}
+
+		void BasisTabulation::clear_cache()
+		{
+			TabulationCache &cache = tabulation_cache();
+			std::unique_lock<std::shared_mutex> lock(cache.mutex);
+			cache.tabulations.clear();
+		}
+	} // namespace basis
+} // namespace polyfem
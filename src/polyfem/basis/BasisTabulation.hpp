@@ -0,0 +1,70 @@
+#pragma once
+
+#include <polyfem/assembler/AssemblyValues.hpp>
+
+#include <Eigen/Dense>
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		class ElementBases;
+
+		/// @brief Values and gradients of the bases of a reference element at a set of points (usually a
+		/// quadrature), stored contiguously and shared by all the elements with the same reference bases.
+		///
+		/// The tabulations live in a global cache keyed by the reference bases and the order of the quadrature,
+		/// so every element of the same type and order evaluates its bases once per quadrature instead of once
+		/// per element. The cache holds at most one tabulation per element type, basis order, and quadrature order.
+		class BasisTabulation
+		{
+		public:
+			/// @brief Reference bases of an element: the Lagrange bases of an order on the reference simplex or cube
+			/// (order -2 are the serendipity bases of the cube)
+			struct Key
+			{
+				bool is_simplex;
+				int dim;
+				int order;
+
+				bool operator<(const Key &other) const
+				{
+					return std::tie(is_simplex, dim, order) < std::tie(other.is_simplex, other.dim, other.order);
+				}
+			};
+
+			Eigen::MatrixXd points; ///< #P x dim
+			Eigen::MatrixXd val;    ///< #P x #bases
+			Eigen::MatrixXd grad;   ///< #P x (#bases * dim), column i * dim + d is the derivative of the i-th basis along d
+
+			int n_bases() const { return int(val.cols()); }
+			int dim() const { return int(points.cols()); }
+
+			/// @brief Copies the tables into the per basis values (val and grad)
+			void copy_to(std::vector<assembler::AssemblyValues> &basis_values) const;
+
+			/// @brief Tabulates the bases of an element at the points, without going through the cache
+			/// @param[in] pts #P x dim points in the reference element
+			/// @param[in] bases bases of the element
+			void compute(const Eigen::MatrixXd &pts, const ElementBases &bases);
+
+			/// @brief Returns the shared tabulation of the reference bases at the points of a quadrature
+			///
+			/// @param[in] key reference bases
+			/// @param[in] quadrature_order order of the quadrature of pts on the reference element of key
+			/// @param[in] pts #P x dim quadrature points, the same for every call with that key and order
+			/// @param[in] bases bases of an element with that reference bases, evaluated only if the tabulation is not cached
+			/// @return tabulation, thread safe
+			static std::shared_ptr<const BasisTabulation> get(const Key &key, const int quadrature_order, const Eigen::MatrixXd &pts, const ElementBases &bases);
+
+			/// @brief Number of cached tabulations
+			static size_t cache_size();
+			/// @brief Removes all the cached tabulations
+			static void clear_cache();
+		};
+	} // namespace basis
+} // namespace polyfem
@@ -1,11 +1,15 @@
 #pragma once
 
 #include <polyfem/basis/Basis.hpp>
+#include <polyfem/basis/BasisTabulation.hpp>
+#include <polyfem/basis/TensorProductBasis.hpp>
 #include <polyfem/quadrature/Quadrature.hpp>
 #include <polyfem/mesh/Mesh.hpp>
 
 #include <polyfem/assembler/AssemblyValues.hpp>
 
+#include <memory>
+#include <optional>
 #include <vector>
 
 namespace polyfem
@@ -57,8 +61,20 @@ namespace polyfem
 				return os;
 			}
 
-			void set_quadrature(const QuadratureFunction &fun) { quadrature_builder_ = fun; }
-			void set_mass_quadrature(const QuadratureFunction &fun) { mass_quadrature_builder_ = fun; }
+			// order is the order of the quadrature built by fun, it identifies the points when the values are tabulated
+			// (see reference_key), -1 if unknown
+			void set_quadrature(const QuadratureFunction &fun, const int order = -1)
+			{
+				quadrature_builder_ = fun;
+				quadrature_order_ = order;
+			}
+			void set_mass_quadrature(const QuadratureFunction &fun, const int order = -1)
+			{
+				mass_quadrature_builder_ = fun;
+				mass_quadrature_order_ = order;
+			}
+			int quadrature_order() const { return quadrature_order_; }
+			int mass_quadrature_order() const { return mass_quadrature_order_; }
 
 			// evaluation functions
 			void evaluate_bases(const Eigen::MatrixXd &uv, std::vector<assembler::AssemblyValues> &basis_values) const
@@ -67,6 +83,12 @@ namespace polyfem
 				{
 					eval_bases_func_(uv, basis_values);
 				}
+				else if (tensor_product_basis_)
+				{
+					TensorProductBasis::Tabulation tab;
+					tensor_product_basis_->tabulate(uv, tab);
+					tensor_product_basis_->evaluate_bases(tab, basis_values);
+				}
 				else
 				{
 					evaluate_bases_default(uv, basis_values);
@@ -78,6 +100,12 @@ namespace polyfem
 				{
 					eval_grads_func_(uv, basis_values);
 				}
+				else if (tensor_product_basis_)
+				{
+					TensorProductBasis::Tabulation tab;
+					tensor_product_basis_->tabulate(uv, tab);
+					tensor_product_basis_->evaluate_grads(tab, basis_values);
+				}
 				else
 				{
 					evaluate_grads_default(uv, basis_values);
@@ -87,6 +115,16 @@ namespace polyfem
 			void set_bases_func(EvalBasesFunc fun) { eval_bases_func_ = fun; }
 			void set_grads_func(EvalBasesFunc fun) { eval_grads_func_ = fun; }
 
+			// tensor product structure of the bases (Q elements), if set the bases are evaluated from 1D tables
+			// and ElementAssemblyValues exposes it for sum factorization
+			void set_tensor_product_basis(const std::shared_ptr<const TensorProductBasis> &basis) { tensor_product_basis_ = basis; }
+			const std::shared_ptr<const TensorProductBasis> &tensor_product_basis() const { return tensor_product_basis_; }
+
+			// reference bases of the element (FE Lagrange bases), if set the values at the quadrature points of known
+			// order are tabulated once and shared by all the elements with the same key and order (see BasisTabulation)
+			void set_reference_key(const BasisTabulation::Key &key) { reference_key_ = key; }
+			const std::optional<BasisTabulation::Key> &reference_key() const { return reference_key_; }
+
 			// sets mapping from local nodes to global nodes
 			void set_local_node_from_primitive_func(LocalNodeFromPrimitiveFunc fun) { local_node_from_primitive_ = fun; }
 
@@ -97,8 +135,12 @@ namespace polyfem
 		private:
 			EvalBasesFunc eval_bases_func_;
 			EvalBasesFunc eval_grads_func_;
+			std::shared_ptr<const TensorProductBasis> tensor_product_basis_;
+			std::optional<BasisTabulation::Key> reference_key_;
 			QuadratureFunction quadrature_builder_;
 			QuadratureFunction mass_quadrature_builder_;
+			int quadrature_order_ = -1;
+			int mass_quadrature_order_ = -1;
 
 			LocalNodeFromPrimitiveFunc local_node_from_primitive_;
 		};
@@ -10,6 +10,8 @@
 
 #include <cassert>
 #include <array>
+#include <map>
+#include <memory>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -727,6 +729,9 @@ int FEBasis2d::build_bases(
 	std::vector<int> interface_elements;
 	interface_elements.reserve(mesh.n_faces());
 
+	// Lagrange Q bases are tensor products, one shared instance per order
+	std::map<int, std::shared_ptr<const TensorProductBasis>> tensor_product_bases;
+
 	for (int e = 0; e < mesh.n_faces(); ++e)
 	{
 		ElementBases &b = bases[e];
@@ -758,11 +763,11 @@ int FEBasis2d::build_bases(
 			b.set_quadrature([real_order](Quadrature &quad) {
 				QuadQuadrature quad_quadrature;
 				quad_quadrature.get_quadrature(real_order, quad);
-			});
+			}, real_order);
 			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
 				QuadQuadrature quad_quadrature;
 				quad_quadrature.get_quadrature(real_mass_order, quad);
-			});
+			}, real_mass_order);
 			// quad_quadrature.get_quadrature(real_order, b.quadrature);
 
 			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
@@ -791,6 +796,16 @@ int FEBasis2d::build_bases(
 				b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_2d(dtmp, j, uv, val); });
 				b.bases[j].set_grad([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_2d(dtmp, j, uv, val); });
 			}
+
+			b.set_reference_key({false, 2, serendipity ? -2 : discr_order});
+
+			if (!serendipity)
+			{
+				auto &tensor_product_basis = tensor_product_bases[discr_order];
+				if (!tensor_product_basis)
+					tensor_product_basis = std::make_shared<const TensorProductBasis>(2, discr_order);
+				b.set_tensor_product_basis(tensor_product_basis);
+			}
 		}
 		else if (mesh.is_simplex(e))
 		{
@@ -799,11 +814,11 @@ int FEBasis2d::build_bases(
 			b.set_quadrature([real_order](Quadrature &quad) {
 				TriQuadrature tri_quadrature;
 				tri_quadrature.get_quadrature(real_order, quad);
-			});
+			}, real_order);
 			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
 				TriQuadrature tri_quadrature;
 				tri_quadrature.get_quadrature(real_mass_order, quad);
-			});
+			}, real_mass_order);
 
 			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
 				const auto &mesh2d = dynamic_cast<const Mesh2D &>(mesh);
@@ -880,6 +895,9 @@ int FEBasis2d::build_bases(
 					b.bases[j].set_grad([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_2d(discr_order, j, uv, val); });
 				}
 			}
+
+			if (!rational)
+				b.set_reference_key({true, 2, discr_order});
 		}
 		else
 		{
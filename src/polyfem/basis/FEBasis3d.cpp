@@ -13,6 +13,8 @@
 
 #include <cassert>
 #include <array>
+#include <map>
+#include <memory>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -1438,6 +1440,9 @@ int FEBasis3d::build_bases(
 	std::vector<int> interface_elements;
 	interface_elements.reserve(mesh.n_faces());
 
+	// Lagrange Q bases are tensor products, one shared instance per order
+	std::map<int, std::shared_ptr<const TensorProductBasis>> tensor_product_bases;
+
 	for (int e = 0; e < mesh.n_cells(); ++e)
 	{
 		ElementBases &b = bases[e];
@@ -1469,11 +1474,11 @@ int FEBasis3d::build_bases(
 			b.set_quadrature([real_order](Quadrature &quad) {
 				HexQuadrature hex_quadrature;
 				hex_quadrature.get_quadrature(real_order, quad);
-			});
+			}, real_order);
 			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
 				HexQuadrature hex_quadrature;
 				hex_quadrature.get_quadrature(real_mass_order, quad);
-			});
+			}, real_mass_order);
 
 			b.set_local_node_from_primitive_func([serendipity, discr_order, e](const int primitive_id, const Mesh &mesh) {
 				const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
@@ -1500,6 +1505,16 @@ int FEBasis3d::build_bases(
 				b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_3d(dtmp, j, uv, val); });
 				b.bases[j].set_grad([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_3d(dtmp, j, uv, val); });
 			}
+
+			b.set_reference_key({false, 3, serendipity ? -2 : discr_order});
+
+			if (!serendipity)
+			{
+				auto &tensor_product_basis = tensor_product_bases[discr_order];
+				if (!tensor_product_basis)
+					tensor_product_basis = std::make_shared<const TensorProductBasis>(3, discr_order);
+				b.set_tensor_product_basis(tensor_product_basis);
+			}
 		}
 		else if (mesh.is_simplex(e))
 		{
@@ -1509,11 +1524,11 @@ int FEBasis3d::build_bases(
 			b.set_quadrature([real_order](Quadrature &quad) {
 				TetQuadrature tet_quadrature;
 				tet_quadrature.get_quadrature(real_order, quad);
-			});
+			}, real_order);
 			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
 				TetQuadrature tet_quadrature;
 				tet_quadrature.get_quadrature(real_mass_order, quad);
-			});
+			}, real_mass_order);
 
 			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
 				const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
@@ -1543,6 +1558,8 @@ int FEBasis3d::build_bases(
 				b.bases[j].set_basis([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_basis_value_3d(discr_order, j, uv, val); });
 				b.bases[j].set_grad([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_3d(discr_order, j, uv, val); });
 			}
+
+			b.set_reference_key({true, 3, discr_order});
 		}
 		else
 		{
@@ -339,7 +339,7 @@ namespace polyfem
 		}
 
 		int MVPolygonalBasis2d::build_bases(
-			const std::string &assembler_name,
+			const assembler::Formulation &assembler_name,
 			const Mesh2D &mesh,
 			const int n_bases,
 			const int quadrature_order,
@@ -4,6 +4,7 @@
 #include <polyfem/mesh/mesh2D/NCMesh2D.hpp>
 #include <polyfem/basis/ElementBases.hpp>
 #include <polyfem/assembler/ElementAssemblyValues.hpp>
+#include <polyfem/assembler/AssemblerUtils.hpp>
 #include <polyfem/basis/InterfaceData.hpp>
 #include <polyfem/mesh/LocalBoundary.hpp>
 
@@ -19,7 +20,7 @@ namespace polyfem
 		{
 		public:
 			static int build_bases(
-				const std::string &assembler_name,
+				const assembler::Formulation &assembler_name,
 				const mesh::Mesh2D &mesh,
 				const int n_bases,
 				const int quadrature_order,
@@ -171,7 +171,7 @@ namespace polyfem
 		////////////////////////////////////////////////////////////////////////////////
 
 		// Compute the integral constraints for each basis of the mesh
-		void PolygonalBasis2d::compute_integral_constraints(const AssemblerUtils &assembler, const std::string &assembler_name, const Mesh2D &mesh, const int n_bases,
+		void PolygonalBasis2d::compute_integral_constraints(const AssemblerUtils &assembler, const assembler::Formulation &assembler_name, const Mesh2D &mesh, const int n_bases,
 															const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases, Eigen::MatrixXd &basis_integrals)
 		{
 			assert(!mesh.is_volume());
@@ -341,7 +341,7 @@ namespace polyfem
 		// } // anonymous namespace
 		// -----------------------------------------------------------------------------
 
-		int PolygonalBasis2d::build_bases(const AssemblerUtils &assembler, const std::string &assembler_name, const int n_samples_per_edge, const Mesh2D &mesh, const int n_bases,
+		int PolygonalBasis2d::build_bases(const AssemblerUtils &assembler, const assembler::Formulation &assembler_name, const int n_samples_per_edge, const Mesh2D &mesh, const int n_bases,
 										  const int quadrature_order, const int mass_quadrature_order, const int integral_constraints, std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases,
 										  const std::map<int, InterfaceData> &poly_edge_to_data, std::map<int, Eigen::MatrixXd> &mapped_boundary)
 		{
@@ -393,7 +393,7 @@ namespace polyfem
 		// Compute the integral constraints for each basis of the mesh
 		void PolygonalBasis3d::compute_integral_constraints(
 			const AssemblerUtils &assembler,
-			const std::string &assembler_name,
+			const assembler::Formulation &assembler_name,
 			const Mesh3D &mesh,
 			const int n_bases,
 			const std::vector<ElementBases> &bases,
@@ -568,7 +568,7 @@ namespace polyfem
 
 		int PolygonalBasis3d::build_bases(
 			const AssemblerUtils &assembler,
-			const std::string &assembler_name,
+			const assembler::Formulation &assembler_name,
 			const int nn_samples_per_edge,
 			const Mesh3D &mesh,
 			const int n_bases,
@@ -30,7 +30,7 @@ namespace polyfem
 			//
 			static void compute_integral_constraints(
 				const assembler::AssemblerUtils &assembler,
-				const std::string &assembler_name,
+				const assembler::Formulation &assembler_name,
 				const mesh::Mesh3D &mesh,
 				const int n_bases,
 				const std::vector<ElementBases> &bases,
@@ -56,7 +56,7 @@ namespace polyfem
 			///
 			static int build_bases(
 				const assembler::AssemblerUtils &assembler,
-				const std::string &assembler_name,
+				const assembler::Formulation &assembler_name,
 				const int n_samples_per_edge,
 				const mesh::Mesh3D &mesh,
 				const int n_bases,
@@ -0,0 +1,319 @@
+#include "TensorProductBasis.hpp"
+
+#include <polyfem/autogen/auto_q_bases.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace polyfem
+{
+	using namespace assembler;
+
+	namespace basis
+	{
+		namespace
+		{
+			// contracts the direction axis of the tensor in (m fields as columns, first direction fastest) with M
+			void contract(const Eigen::MatrixXd &M, const bool transpose, const int axis, std::array<int, 3> &sizes, const Eigen::MatrixXd &in, Eigen::MatrixXd &out)
+			{
+				const int n_in = sizes[axis];
+				const int n_out = int(transpose ? M.cols() : M.rows());
+				assert(n_in == (transpose ? M.rows() : M.cols()));
+
+				int inner = 1;
+				for (int a = 0; a < axis; ++a)
+					inner *= sizes[a];
+				int outer = 1;
+				for (int a = axis + 1; a < 3; ++a)
+					outer *= sizes[a];
+				assert(in.rows() == inner * n_in * outer);
+
+				out.setZero(inner * n_out * outer, in.cols());
+				for (long f = 0; f < in.cols(); ++f)
+				{
+					for (int o = 0; o < outer; ++o)
+					{
+						for (int k = 0; k < n_out; ++k)
+						{
+							auto res = out.col(f).segment(inner * (k + n_out * o), inner);
+							for (int j = 0; j < n_in; ++j)
+							{
+								const double m = transpose ? M(j, k) : M(k, j);
+								if (m != 0)
+									res += m * in.col(f).segment(inner * (j + n_in * o), inner);
+							}
+						}
+					}
+				}
+
+				sizes[axis] = n_out;
+			}
+
+			// sorted abscissae of the values (up to a tolerance) and the abscissa of every value
+			void unique_abscissae(const Eigen::VectorXd &x, Eigen::VectorXd &t, Eigen::VectorXi &rows)
+			{
+				const int n = int(x.size());
+				std::vector<int> order(n);
+				std::iota(order.begin(), order.end(), 0);
+				std::sort(order.begin(), order.end(), [&](const int a, const int b) { return x(a) < x(b); });
+
+				std::vector<double> values;
+				rows.resize(n);
+				for (const int p : order)
+				{
+					if (values.empty() || x(p) - values.back() > 1e-12)
+						values.push_back(x(p));
+					rows(p) = int(values.size()) - 1;
+				}
+
+				t = Eigen::Map<const Eigen::VectorXd>(values.data(), values.size());
+			}
+		} // namespace
+
+		TensorProductBasis::TensorProductBasis(const int dim, const int order)
+			: dim_(dim), order_(order)
+		{
+			assert(dim == 2 || dim == 3);
+			assert(order >= 0);
+
+			Eigen::MatrixXd nodes;
+			if (dim == 3)
+				autogen::q_nodes_3d(order, nodes);
+			else
+				autogen::q_nodes_2d(order, nodes);
+
+			const int n_1d = order + 1;
+			nodes_.resize(n_1d);
+			for (int k = 0; k < n_1d; ++k)
+				nodes_(k) = order == 0 ? nodes(0, 0) : double(k) / order;
+
+			lex_.resize(nodes.rows(), dim);
+			for (long i = 0; i < nodes.rows(); ++i)
+			{
+				for (int a = 0; a < dim; ++a)
+				{
+					lex_(i, a) = int(std::lround(nodes(i, a) * order));
+					assert(std::abs(nodes_(lex_(i, a)) - nodes(i, a)) < 1e-12);
+				}
+			}
+			assert(lex_.rows() == (dim == 3 ? n_1d * n_1d * n_1d : n_1d * n_1d));
+		}
+
+		void TensorProductBasis::eval_1d(const Eigen::VectorXd &t, Eigen::MatrixXd &val, Eigen::MatrixXd &grad) const
+		{
+			const int n_1d = int(nodes_.size());
+			val.resize(t.size(), n_1d);
+			grad.resize(t.size(), n_1d);
+
+			for (long p = 0; p < t.size(); ++p)
+			{
+				for (int k = 0; k < n_1d; ++k)
+				{
+					double v = 1;
+					double g = 0;
+					for (int j = 0; j < n_1d; ++j)
+					{
+						if (j == k)
+							continue;
+						const double s = 1. / (nodes_(k) - nodes_(j));
+						// (v * l_j)' = v' l_j + v l_j'
+						g = g * (t(p) - nodes_(j)) * s + v * s;
+						v *= (t(p) - nodes_(j)) * s;
+					}
+					val(p, k) = v;
+					grad(p, k) = g;
+				}
+			}
+		}
+
+		void TensorProductBasis::tabulate(const Eigen::MatrixXd &uv, Tabulation &tab) const
+		{
+			assert(uv.cols() == dim_);
+			const int n_pts = int(uv.rows());
+
+			tab.rows.resize(n_pts, dim_);
+			std::array<int, 3> sizes = {{1, 1, 1}};
+			for (int a = 0; a < dim_; ++a)
+			{
+				Eigen::VectorXd t;
+				Eigen::VectorXi rows;
+				unique_abscissae(uv.col(a), t, rows);
+				eval_1d(t, tab.val[a], tab.grad[a]);
+				tab.rows.col(a) = rows;
+				sizes[a] = int(t.size());
+			}
+
+			tab.is_grid = sizes[0] * sizes[1] * sizes[2] == n_pts;
+			tab.grid_index.resize(tab.is_grid ? n_pts : 0);
+			if (!tab.is_grid)
+				return;
+
+			std::vector<bool> taken(n_pts, false);
+			for (int p = 0; p < n_pts; ++p)
+			{
+				int index = 0;
+				for (int a = dim_ - 1; a >= 0; --a)
+					index = index * sizes[a] + tab.rows(p, a);
+
+				if (taken[index])
+				{
+					tab.is_grid = false;
+					tab.grid_index.resize(0);
+					return;
+				}
+				taken[index] = true;
+				tab.grid_index(p) = index;
+			}
+		}
+
+		void TensorProductBasis::evaluate_bases(const Tabulation &tab, std::vector<AssemblyValues> &basis_values) const
+		{
+			basis_values.resize(n_bases());
+			for (int i = 0; i < n_bases(); ++i)
+			{
+				Eigen::MatrixXd &val = basis_values[i].val;
+				val.resize(tab.n_points(), 1);
+				for (int p = 0; p < tab.n_points(); ++p)
+				{
+					double v = 1;
+					for (int a = 0; a < dim_; ++a)
+						v *= tab.val[a](tab.rows(p, a), lex_(i, a));
+					val(p) = v;
+				}
+			}
+		}
+
+		void TensorProductBasis::evaluate_grads(const Tabulation &tab, std::vector<AssemblyValues> &basis_values) const
+		{
+			basis_values.resize(n_bases());
+			for (int i = 0; i < n_bases(); ++i)
+			{
+				Eigen::MatrixXd &grad = basis_values[i].grad;
+				grad.resize(tab.n_points(), dim_);
+				for (int p = 0; p < tab.n_points(); ++p)
+				{
+					for (int r = 0; r < dim_; ++r)
+					{
+						double g = 1;
+						for (int a = 0; a < dim_; ++a)
+							g *= (a == r ? tab.grad[a] : tab.val[a])(tab.rows(p, a), lex_(i, a));
+						grad(p, r) = g;
+					}
+				}
+			}
+		}
+
+		void TensorProductBasis::apply(const std::array<const Eigen::MatrixXd *, 3> &ops, const bool transpose, const Eigen::MatrixXd &in, Eigen::MatrixXd &out) const
+		{
+			std::array<int, 3> sizes = {{1, 1, 1}};
+			for (int a = 0; a < dim_; ++a)
+				sizes[a] = int(transpose ? ops[a]->rows() : ops[a]->cols());
+
+			Eigen::MatrixXd tmp = in;
+			for (int a = 0; a < dim_; ++a)
+			{
+				contract(*ops[a], transpose, a, sizes, tmp, out);
+				if (a + 1 < dim_)
+					tmp.swap(out);
+			}
+		}
+
+		void TensorProductBasis::interpolate(const Tabulation &tab, const Eigen::MatrixXd &coeffs, Eigen::MatrixXd *val, Eigen::MatrixXd *grad) const
+		{
+			assert(tab.is_grid);
+			assert(coeffs.rows() == n_bases());
+
+			const int n_1d = order_ + 1;
+			const int n_pts = tab.n_points();
+			const long m = coeffs.cols();
+
+			// coefficients in lexicographic order
+			Eigen::MatrixXd lex_coeffs(coeffs.rows(), m);
+			for (int i = 0; i < n_bases(); ++i)
+			{
+				int index = 0;
+				for (int a = dim_ - 1; a >= 0; --a)
+					index = index * n_1d + lex_(i, a);
+				lex_coeffs.row(index) = coeffs.row(i);
+			}
+
+			Eigen::MatrixXd grid_values;
+			if (val)
+			{
+				apply({{&tab.val[0], &tab.val[1], &tab.val[2]}}, false, lex_coeffs, grid_values);
+				val->resize(n_pts, m);
+				for (int p = 0; p < n_pts; ++p)
+					val->row(p) = grid_values.row(tab.grid_index(p));
+			}
+
+			if (grad)
+			{
+				grad->resize(n_pts, m * dim_);
+				for (int r = 0; r < dim_; ++r)
+				{
+					std::array<const Eigen::MatrixXd *, 3> ops;
+					for (int a = 0; a < 3; ++a)
+						ops[a] = a == r ? &tab.grad[a] : &tab.val[a];
+					apply(ops, false, lex_coeffs, grid_values);
+
+					for (int p = 0; p < n_pts; ++p)
+					{
+						for (long k = 0; k < m; ++k)
+							(*grad)(p, k * dim_ + r) = grid_values(tab.grid_index(p), k);
+					}
+				}
+			}
+		}
+
+		void TensorProductBasis::integrate(const Tabulation &tab, const Eigen::MatrixXd &val, const Eigen::MatrixXd &grad, Eigen::MatrixXd &coeffs) const
+		{
+			assert(tab.is_grid);
+			assert(val.size() > 0 || grad.size() > 0);
+
+			const int n_1d = order_ + 1;
+			const int n_pts = tab.n_points();
+			const long m = val.size() > 0 ? val.cols() : grad.cols() / dim_;
+
+			Eigen::MatrixXd lex_coeffs = Eigen::MatrixXd::Zero(n_bases(), m);
+			Eigen::MatrixXd grid_values(n_pts, m), tmp;
+
+			if (val.size() > 0)
+			{
+				assert(val.rows() == n_pts);
+				for (int p = 0; p < n_pts; ++p)
+					grid_values.row(tab.grid_index(p)) = val.row(p);
+				apply({{&tab.val[0], &tab.val[1], &tab.val[2]}}, true, grid_values, tmp);
+				lex_coeffs += tmp;
+			}
+
+			if (grad.size() > 0)
+			{
+				assert(grad.rows() == n_pts && grad.cols() == m * dim_);
+				for (int r = 0; r < dim_; ++r)
+				{
+					for (int p = 0; p < n_pts; ++p)
+					{
+						for (long k = 0; k < m; ++k)
+							grid_values(tab.grid_index(p), k) = grad(p, k * dim_ + r);
+					}
+
+					std::array<const Eigen::MatrixXd *, 3> ops;
+					for (int a = 0; a < 3; ++a)
+						ops[a] = a == r ? &tab.grad[a] : &tab.val[a];
+					apply(ops, true, grid_values, tmp);
+					lex_coeffs += tmp;
+				}
+			}
+
+			coeffs.resize(n_bases(), m);
+			for (int i = 0; i < n_bases(); ++i)
+			{
+				int index = 0;
+				for (int a = dim_ - 1; a >= 0; --a)
+					index = index * n_1d + lex_(i, a);
+				coeffs.row(i) = lex_coeffs.row(index);
+			}
+		}
+	} // namespace basis
+} // namespace polyfem
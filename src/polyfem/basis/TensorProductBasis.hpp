@@ -0,0 +1,87 @@
+#pragma once
+
+#include <polyfem/assembler/AssemblyValues.hpp>
+
+#include <Eigen/Dense>
+
+#include <array>
+#include <vector>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		/// @brief Lagrange bases of the reference quad/hex written as products of the 1D Lagrange
+		/// polynomials on the equispaced nodes of the order, the local ordering of the bases is the
+		/// one of autogen::q_nodes_2d/q_nodes_3d.
+		///
+		/// On a tensor grid of points (eg, HexQuadrature/QuadQuadrature) the bases only need the
+		/// 1D tables, the interpolation of local coefficients and its transpose are computed one
+		/// direction at a time (sum factorization) in O(p^{dim+1}) per point instead of O(p^{2 dim}).
+		class TensorProductBasis
+		{
+		public:
+			/// @brief 1D polynomials evaluated along every direction of a set of points
+			class Tabulation
+			{
+			public:
+				/// per direction, row r is the value (gradient) of the 1D polynomials at the r-th abscissa
+				std::array<Eigen::MatrixXd, 3> val, grad;
+				/// per point, row in the tables of every direction
+				Eigen::MatrixXi rows;
+				/// true if the points are the full tensor product of the abscissae
+				bool is_grid = false;
+				/// grid index of every point (only for grids, the first direction is the fastest)
+				Eigen::VectorXi grid_index;
+
+				int n_points() const { return int(rows.rows()); }
+			};
+
+			/// @param[in] dim dimension of the element (2 for quads, 3 for hexes)
+			/// @param[in] order order of the Lagrange bases
+			TensorProductBasis(const int dim, const int order);
+
+			int dim() const { return dim_; }
+			int order() const { return order_; }
+			int n_bases() const { return int(lex_.rows()); }
+
+			/// @brief Tabulates the 1D polynomials at the points, detecting if they form a tensor grid
+			///
+			/// @param[in] uv #P x dim points in the reference element
+			/// @param[out] tab tabulation
+			void tabulate(const Eigen::MatrixXd &uv, Tabulation &tab) const;
+
+			/// @brief Evaluates the bases (gradients) from the 1D tables
+			void evaluate_bases(const Tabulation &tab, std::vector<assembler::AssemblyValues> &basis_values) const;
+			void evaluate_grads(const Tabulation &tab, std::vector<assembler::AssemblyValues> &basis_values) const;
+
+			/// @brief Sum-factorized interpolation of local coefficients on a grid
+			///
+			/// @param[in] tab tabulation of a grid
+			/// @param[in] coeffs #bases x m local coefficients
+			/// @param[out] val if not null, #P x m values
+			/// @param[out] grad if not null, #P x (m * dim) reference gradients, column k * dim + r is the derivative of field k along r
+			void interpolate(const Tabulation &tab, const Eigen::MatrixXd &coeffs, Eigen::MatrixXd *val, Eigen::MatrixXd *grad) const;
+
+			/// @brief Transpose of interpolate: coeffs(i, k) = Σ_p val(p, k) φi(p) + Σ_p Σ_r grad(p, k * dim + r) ∂φi/∂r(p)
+			///
+			/// @param[in] tab tabulation of a grid
+			/// @param[in] val #P x m values, can be empty
+			/// @param[in] grad #P x (m * dim) values paired with the reference gradients, can be empty
+			/// @param[out] coeffs #bases x m
+			void integrate(const Tabulation &tab, const Eigen::MatrixXd &val, const Eigen::MatrixXd &grad, Eigen::MatrixXd &coeffs) const;
+
+		private:
+			// values and derivatives of the 1D polynomials at t
+			void eval_1d(const Eigen::VectorXd &t, Eigen::MatrixXd &val, Eigen::MatrixXd &grad) const;
+
+			// applies the 1D operator of every direction to a tensor of m fields (entries ordered with the first direction fastest)
+			void apply(const std::array<const Eigen::MatrixXd *, 3> &ops, const bool transpose, const Eigen::MatrixXd &in, Eigen::MatrixXd &out) const;
+
+			int dim_;
+			int order_;
+			Eigen::VectorXd nodes_; ///< 1D nodes
+			Eigen::MatrixXi lex_;   ///< #bases x dim, index of the 1D polynomial of every basis along every direction
+		};
+	} // namespace basis
+} // namespace polyfem
@@ -80,7 +80,7 @@ namespace
 ////////////////////////////////////////////////////////////////////////////////
 
 //output is std::array<Eigen::MatrixXd, 5> &strong rhs(q(x_i) er)
-void RBFWithQuadratic::setup_monomials_strong_2d(const int dim, const AssemblerUtils &assembler, const std::string &assembler_name, const Eigen::MatrixXd &pts, const QuadratureVector &da, std::array<Eigen::MatrixXd, 5> &strong)
+void RBFWithQuadratic::setup_monomials_strong_2d(const int dim, const AssemblerUtils &assembler, const assembler::Formulation &assembler_name, const Eigen::MatrixXd &pts, const QuadratureVector &da, std::array<Eigen::MatrixXd, 5> &strong)
 {
 	//a(u,v) = a(q er, phi_j es) = <rhs(q(x_i) er) , phi_j(x_i) es >
 	// (not a(phi_j es, q er))
@@ -184,7 +184,7 @@ void RBFWithQuadratic::setup_monomials_vals_2d(const int star_index, const Eigen
 
 RBFWithQuadratic::RBFWithQuadratic(
 	const AssemblerUtils &assembler,
-	const std::string &assembler_name,
+	const assembler::Formulation &assembler_name,
 	const Eigen::MatrixXd &centers,
 	const Eigen::MatrixXd &collocation_points,
 	const Eigen::MatrixXd &local_basis_integral,
@@ -503,7 +503,7 @@ void RBFWithQuadratic::compute_constraints_matrix_2d_old(
 
 void RBFWithQuadratic::compute_constraints_matrix_2d(
 	const AssemblerUtils &assembler,
-	const std::string &assembler_name,
+	const assembler::Formulation &assembler_name,
 	const int num_bases,
 	const Quadrature &quadr,
 	const Eigen::MatrixXd &local_basis_integral,
@@ -613,7 +613,7 @@ void RBFWithQuadratic::compute_constraints_matrix_2d(
 
 void RBFWithQuadratic::compute_constraints_matrix_3d(
 	const AssemblerUtils &assembler,
-	const std::string &assembler_name,
+	const assembler::Formulation &assembler_name,
 	const int num_bases,
 	const Quadrature &quadr,
 	const Eigen::MatrixXd &local_basis_integral,
@@ -712,7 +712,7 @@ void RBFWithQuadratic::compute_constraints_matrix_3d(
 
 // -----------------------------------------------------------------------------
 
-void RBFWithQuadratic::compute_weights(const AssemblerUtils &assembler, const std::string &assembler_name, const Eigen::MatrixXd &samples,
+void RBFWithQuadratic::compute_weights(const AssemblerUtils &assembler, const assembler::Formulation &assembler_name, const Eigen::MatrixXd &samples,
 									   const Eigen::MatrixXd &local_basis_integral, const Quadrature &quadr,
 									   Eigen::MatrixXd &rhs, bool with_constraints)
 {
@@ -78,7 +78,7 @@ namespace
 
 RBFWithQuadraticLagrange::RBFWithQuadraticLagrange(
 	const AssemblerUtils &assembler,
-	const std::string &assembler_name,
+	const assembler::Formulation &assembler_name,
 	const Eigen::MatrixXd &centers,
 	const Eigen::MatrixXd &collocation_points,
 	const Eigen::MatrixXd &local_basis_integral,
@@ -262,7 +262,7 @@ void RBFWithQuadraticLagrange::compute_constraints_matrix_2d_old(
 	// std::cout << L.bottomRightCorner(10, 10) << std::endl;
 }
 
-void RBFWithQuadraticLagrange::compute_constraints_matrix_2d(const AssemblerUtils &assembler, const std::string &assembler_name,
+void RBFWithQuadraticLagrange::compute_constraints_matrix_2d(const AssemblerUtils &assembler, const assembler::Formulation &assembler_name,
 															 const int num_bases, const Quadrature &quadr, Eigen::MatrixXd &C) const
 {
 	const int num_kernels = centers_.rows();
@@ -454,7 +454,7 @@ void RBFWithQuadraticLagrange::compute_constraints_matrix_3d(
 
 // -----------------------------------------------------------------------------
 
-void RBFWithQuadraticLagrange::compute_weights(const AssemblerUtils &assembler, const std::string &assembler_name, const Eigen::MatrixXd &samples,
+void RBFWithQuadraticLagrange::compute_weights(const AssemblerUtils &assembler, const assembler::Formulation &assembler_name, const Eigen::MatrixXd &samples,
 											   const Eigen::MatrixXd &local_basis_integral, const Quadrature &quadr,
 											   Eigen::MatrixXd &b, bool with_constraints)
 {
@@ -25,7 +25,7 @@ namespace polyfem
 			/// @param[in]  rhs                   #S x #B of boundary conditions. Each column defines how the i-th basis of the mesh should evaluate on the collocation points sampled on the boundary of the polytope
 			/// @param[in]  with_constraints      Impose integral constraints to guarantee linear reproduction for the Poisson equation
 			///
-			RBFWithQuadraticLagrange(const assembler::AssemblerUtils &assembler, const std::string &assembler_name, const Eigen::MatrixXd &centers, const Eigen::MatrixXd &collocation_points,
+			RBFWithQuadraticLagrange(const assembler::AssemblerUtils &assembler, const assembler::Formulation &assembler_name, const Eigen::MatrixXd &centers, const Eigen::MatrixXd &collocation_points,
 									 const Eigen::MatrixXd &local_basis_integral, const quadrature::Quadrature &quadr,
 									 Eigen::MatrixXd &rhs, bool with_constraints = true);
 
@@ -72,13 +72,13 @@ namespace polyfem
 
 			// Computes the constraint matrix C that we want to impose (C w = d)
 			void compute_constraints_matrix_2d_old(const int num_bases, const quadrature::Quadrature &quadr, Eigen::MatrixXd &C) const;
-			void compute_constraints_matrix_2d(const assembler::AssemblerUtils &assembler, const std::string &assembler_name, const int num_bases, const quadrature::Quadrature &quadr, Eigen::MatrixXd &C) const;
+			void compute_constraints_matrix_2d(const assembler::AssemblerUtils &assembler, const assembler::Formulation &assembler_name, const int num_bases, const quadrature::Quadrature &quadr, Eigen::MatrixXd &C) const;
 
 			// Computes the constraint matrix C that we want to impose (C w = d)
 			void compute_constraints_matrix_3d(const int num_bases, const quadrature::Quadrature &quadr, Eigen::MatrixXd &C) const;
 
 			// Computes the weights by solving a (possibly constrained) linear least square
-			void compute_weights(const assembler::AssemblerUtils &assembler, const std::string &assembler_name, const Eigen::MatrixXd &collocation_points,
+			void compute_weights(const assembler::AssemblerUtils &assembler, const assembler::Formulation &assembler_name, const Eigen::MatrixXd &collocation_points,
 								 const Eigen::MatrixXd &local_basis_integral, const quadrature::Quadrature &quadr,
 								 Eigen::MatrixXd &rhs, bool with_constraints);
 
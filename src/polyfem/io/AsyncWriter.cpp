@@ -0,0 +1,133 @@
+#include "AsyncWriter.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+
+namespace polyfem
+{
+	namespace io
+	{
+		namespace
+		{
+			void log_error(const std::exception_ptr &error)
+			{
+				try
+				{
+					std::rethrow_exception(error);
+				}
+				catch (const std::exception &e)
+				{
+					logger().error("Asynchronous write failed: {}", e.what());
+				}
+				catch (...)
+				{
+					logger().error("Asynchronous write failed");
+				}
+			}
+		} // namespace
+
+		AsyncWriter::AsyncWriter(const int max_pending)
+			: max_pending_(std::max(1, max_pending))
+		{
+			worker_ = std::thread(&AsyncWriter::run, this);
+		}
+
+		AsyncWriter::~AsyncWriter()
+		{
+			// a destructor cannot throw, call close to get the error
+			try
+			{
+				close();
+			}
+			catch (...)
+			{
+				log_error(std::current_exception());
+			}
+		}
+
+		void AsyncWriter::push(std::function<void()> task)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			assert(!stop_);
+			space_cv_.wait(lock, [&] { return tasks_.size() < max_pending_; });
+			tasks_.push_back(std::move(task));
+			lock.unlock();
+			task_cv_.notify_one();
+		}
+
+		void AsyncWriter::flush()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			space_cv_.wait(lock, [&] { return tasks_.empty() && !busy_; });
+			rethrow_error();
+		}
+
+		void AsyncWriter::close()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				stop_ = true;
+			}
+			task_cv_.notify_one();
+			if (worker_.joinable())
+				worker_.join();
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			rethrow_error();
+		}
+
+		void AsyncWriter::rethrow_error()
+		{
+			if (!error_)
+				return;
+
+			const std::exception_ptr error = error_;
+			error_ = nullptr;
+			std::rethrow_exception(error);
+		}
+
+		void AsyncWriter::run()
+		{
+			while (true)
+			{
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> lock(mutex_);
+					// the remaining tasks are written before stopping
+					task_cv_.wait(lock, [&] { return stop_ || !tasks_.empty(); });
+					if (tasks_.empty())
+						return;
+
+					task = std::move(tasks_.front());
+					tasks_.pop_front();
+					busy_ = true;
+				}
+				space_cv_.notify_all();
+
+				std::exception_ptr error;
+				try
+				{
+					task();
+				}
+				catch (...)
+				{
+					error = std::current_exception();
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					busy_ = false;
+					// only the first error is rethrown, the following ones are logged
+					if (error && error_)
+						log_error(error);
+					else if (error)
+						error_ = error;
+				}
+				space_cv_.notify_all();
+			}
+		}
+	} // namespace io
+} // namespace polyfem
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace polyfem
+{
+	namespace io
+	{
+		/// @brief Runs write tasks in order on a background thread.
+		///
+		/// At most max_pending tasks wait in the queue, push blocks while it is full so that a slow
+		/// disk slows down the simulation instead of accumulating frames in memory. The tasks must
+		/// only read data that does not change until they are done (see ExportFrame).
+		/// The first exception thrown by a task is kept and rethrown by flush or close, the
+		/// following tasks are still written.
+		class AsyncWriter
+		{
+		public:
+			/// @param[in] max_pending maximum number of tasks waiting to be written (at least 1)
+			explicit AsyncWriter(const int max_pending);
+			/// waits for the pending tasks, a task error that was not rethrown is logged
+			~AsyncWriter();
+
+			AsyncWriter(const AsyncWriter &) = delete;
+			AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+			/// @brief Queues a task, blocks while the queue is full
+			void push(std::function<void()> task);
+			/// @brief Waits until all the queued tasks are done
+			/// @throws the first exception thrown by a task since the last flush
+			void flush();
+			/// @brief Writes the queued tasks and stops the worker, nothing can be pushed afterwards
+			/// @throws the first exception thrown by a task since the last flush
+			void close();
+
+		private:
+			void run();
+			/// rethrows and clears error_, mutex_ must be held
+			void rethrow_error();
+
+			const size_t max_pending_;
+			std::deque<std::function<void()>> tasks_;
+			bool busy_ = false;
+			bool stop_ = false;
+			std::exception_ptr error_;
+
+			std::mutex mutex_;
+			std::condition_variable task_cv_;  ///< a task was queued or stop was requested
+			std::condition_variable space_cv_; ///< a task was started or finished
+
+			std::thread worker_;
+		};
+	} // namespace io
+} // namespace polyfem
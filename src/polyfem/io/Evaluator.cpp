@@ -14,6 +14,7 @@
 #include <polyfem/autogen/auto_q_bases.hpp>
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <igl/AABB.h>
 #include <igl/per_face_normals.h>
@@ -365,7 +366,7 @@ namespace polyfem::io
 		const std::vector<basis::ElementBases> &bases,
 		const std::vector<basis::ElementBases> &gbases,
 		const assembler::AssemblerUtils &assembler,
-		const std::string &formulation,
+		const assembler::Formulation &formulation,
 		const Eigen::MatrixXd &pts,
 		const Eigen::MatrixXi &faces,
 		const Eigen::MatrixXd &fun,
@@ -388,7 +389,7 @@ namespace polyfem::io
 		const std::vector<basis::ElementBases> &bases,
 		const std::vector<basis::ElementBases> &gbases,
 		const assembler::AssemblerUtils &assembler,
-		const std::string &formulation,
+		const assembler::Formulation &formulation,
 		const Eigen::MatrixXd &pts,
 		const Eigen::MatrixXi &faces,
 		const Eigen::MatrixXd &fun,
@@ -574,11 +575,12 @@ namespace polyfem::io
 		const int n_bases,
 		const std::vector<basis::ElementBases> &bases,
 		const std::vector<basis::ElementBases> &gbases,
+		const mesh::ElementColoring &coloring,
 		const Eigen::VectorXi &disc_orders,
 		const std::map<int, Eigen::MatrixXd> &polys,
 		const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
 		const assembler::AssemblerUtils &assembler,
-		const std::string &formulation,
+		const assembler::Formulation &formulation,
 		const utils::RefElementSampler &sampler,
 		const int n_points,
 		const Eigen::MatrixXd &fun,
@@ -609,51 +611,69 @@ namespace polyfem::io
 		// avg_tensor.setZero();
 		areas.setZero();
 
-		Eigen::MatrixXd local_val;
+		assert(coloring.size() == bases.size());
 
-		ElementAssemblyValues vals;
-		for (int i = 0; i < int(bases.size()); ++i)
+		struct LocalStorage
 		{
-			const ElementBases &bs = bases[i];
-			const ElementBases &gbs = gbases[i];
+			Eigen::MatrixXd local_val;
 			Eigen::MatrixXd local_pts;
+			ElementAssemblyValues vals;
+		};
+		auto storage = utils::create_thread_storage(LocalStorage());
 
-			if (mesh.is_simplex(i))
-			{
-				if (mesh.dimension() == 3)
-					autogen::p_nodes_3d(disc_orders(i), local_pts);
-				else
-					autogen::p_nodes_2d(disc_orders(i), local_pts);
-			}
-			else
-			{
-				if (mesh.dimension() == 3)
-					autogen::q_nodes_3d(disc_orders(i), local_pts);
-				else
-					autogen::q_nodes_2d(disc_orders(i), local_pts);
-			}
-			// else if(mesh.is_cube(i))
-			// 	local_pts = sampler.cube_points();
-			// // else
-			// 	// local_pts = vis_pts_poly[i];
+		// elements of the same color share no node, so they are accumulated directly
+		for (int c = 0; c < coloring.n_colors(); ++c)
+		{
+			utils::maybe_parallel_for(coloring.color_size(c), [&](int start, int end, int thread_id) {
+				LocalStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+				Eigen::MatrixXd &local_val = local_storage.local_val;
+				Eigen::MatrixXd &local_pts = local_storage.local_pts;
+				ElementAssemblyValues &vals = local_storage.vals;
 
-			vals.compute(i, actual_dim == 3, bases[i], gbases[i]);
-			const quadrature::Quadrature &quadrature = vals.quadrature;
-			const double area = (vals.det.array() * quadrature.weights.array()).sum();
+				for (int k = start; k < end; ++k)
+				{
+					const int i = coloring.element(c, k);
+					const ElementBases &bs = bases[i];
+					const ElementBases &gbs = gbases[i];
 
-			assembler.compute_scalar_value(formulation, i, bs, gbs, local_pts, fun, local_val);
-			// assembler.compute_tensor_value(formulation, i, bs, gbs, local_pts, fun, local_val);
+					if (mesh.is_simplex(i))
+					{
+						if (mesh.dimension() == 3)
+							autogen::p_nodes_3d(disc_orders(i), local_pts);
+						else
+							autogen::p_nodes_2d(disc_orders(i), local_pts);
+					}
+					else
+					{
+						if (mesh.dimension() == 3)
+							autogen::q_nodes_3d(disc_orders(i), local_pts);
+						else
+							autogen::q_nodes_2d(disc_orders(i), local_pts);
+					}
+					// else if(mesh.is_cube(i))
+					// 	local_pts = sampler.cube_points();
+					// // else
+					// 	// local_pts = vis_pts_poly[i];
 
-			for (size_t j = 0; j < bs.bases.size(); ++j)
-			{
-				const Basis &b = bs.bases[j];
-				if (b.global().size() > 1)
-					continue;
+					vals.compute(i, actual_dim == 3, bases[i], gbases[i]);
+					const quadrature::Quadrature &quadrature = vals.quadrature;
+					const double area = (vals.det.array() * quadrature.weights.array()).sum();
 
-				auto &global = b.global().front();
-				areas(global.index) += area;
-				avg_scalar(global.index) += local_val(j) * area;
-			}
+					assembler.compute_scalar_value(formulation, i, bs, gbs, local_pts, fun, local_val);
+					// assembler.compute_tensor_value(formulation, i, bs, gbs, local_pts, fun, local_val);
+
+					for (size_t j = 0; j < bs.bases.size(); ++j)
+					{
+						const Basis &b = bs.bases[j];
+						if (b.global().size() > 1)
+							continue;
+
+						auto &global = b.global().front();
+						areas(global.index) += area;
+						avg_scalar(global.index) += local_val(j) * area;
+					}
+				}
+			});
 		}
 
 		avg_scalar.array() /= areas.array();
@@ -754,7 +774,7 @@ namespace polyfem::io
 		const std::vector<basis::ElementBases> &gbases,
 		const Eigen::VectorXi &disc_orders,
 		const assembler::AssemblerUtils &assembler,
-		const std::string &formulation,
+		const assembler::Formulation &formulation,
 		const Eigen::MatrixXd &fun,
 		Eigen::MatrixXd &result,
 		Eigen::VectorXd &von_mises)
@@ -1005,7 +1025,37 @@ namespace polyfem::io
 		const ElementBases &bs = bases[el_index];
 
 		ElementAssemblyValues vals;
+		if (vals.compute_tensor_product(el_index, local_pts, bs, gbs))
+		{
+			// sum factorization of the local coefficients on the grid, then grad = grad_ref J^{-T},
+			// the bases are never evaluated at the points
+			const int n_loc_bases = int(vals.basis_values.size());
+			const int dim = mesh.dimension();
+			Eigen::MatrixXd coeffs = Eigen::MatrixXd::Zero(n_loc_bases, actual_dim);
+			for (int i = 0; i < n_loc_bases; ++i)
+			{
+				const auto &val = vals.basis_values[i];
+				for (size_t ii = 0; ii < val.global.size(); ++ii)
+				{
+					for (int d = 0; d < actual_dim; ++d)
+						coeffs(i, d) += val.global[ii].val * fun(val.global[ii].index * actual_dim + d);
+				}
+			}
+
+			Eigen::MatrixXd ref_grad;
+			vals.tensor_basis->interpolate(vals.tensor_tabulation, coeffs, &result, &ref_grad);
+
+			result_grad.resize(result.rows(), dim * actual_dim);
+			for (long p = 0; p < result.rows(); ++p)
+			{
+				for (int d = 0; d < actual_dim; ++d)
+					result_grad.block(p, d * dim, 1, dim) = ref_grad.block(p, d * dim, 1, dim) * vals.jac_it[p];
+			}
+			return;
+		}
+
 		vals.compute(el_index, mesh.is_volume(), local_pts, bs, gbs);
+		const int n_loc_bases = int(vals.basis_values.size());
 
 		result.resize(vals.val.rows(), actual_dim);
 		result.setZero();
@@ -1013,8 +1063,6 @@ namespace polyfem::io
 		result_grad.resize(vals.val.rows(), mesh.dimension() * actual_dim);
 		result_grad.setZero();
 
-		const int n_loc_bases = int(vals.basis_values.size());
-
 		for (int i = 0; i < n_loc_bases; ++i)
 		{
 			const auto &val = vals.basis_values[i];
@@ -1039,7 +1087,7 @@ namespace polyfem::io
 		const std::map<int, Eigen::MatrixXd> &polys,
 		const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
 		const assembler::AssemblerUtils &assembler,
-		const std::string &formulation,
+		const assembler::Formulation &formulation,
 		const utils::RefElementSampler &sampler,
 		const Eigen::MatrixXd &fun,
 		const bool use_sampler,
@@ -1124,7 +1172,7 @@ namespace polyfem::io
 		const std::map<int, Eigen::MatrixXd> &polys,
 		const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
 		const assembler::AssemblerUtils &assembler,
-		const std::string &formulation,
+		const assembler::Formulation &formulation,
 		const utils::RefElementSampler &sampler,
 		const int n_points,
 		const Eigen::MatrixXd &fun,
@@ -1212,7 +1260,7 @@ namespace polyfem::io
 		const std::map<int, Eigen::MatrixXd> &polys,
 		const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
 		const assembler::AssemblerUtils &assembler,
-		const std::string &formulation,
+		const assembler::Formulation &formulation,
 		const utils::RefElementSampler &sampler,
 		const int n_points,
 		const Eigen::MatrixXd &fun,
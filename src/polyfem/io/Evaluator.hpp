@@ -5,6 +5,7 @@
 #include <polyfem/basis/ElementBases.hpp>
 #include <polyfem/assembler/AssemblerUtils.hpp>
 #include <polyfem/mesh/Mesh.hpp>
+#include <polyfem/mesh/ElementColoring.hpp>
 
 #include <polyfem/utils/RefElementSampler.hpp>
 
@@ -49,7 +50,7 @@ namespace polyfem::io
 			const std::vector<basis::ElementBases> &gbases,
 			const Eigen::VectorXi &disc_orders,
 			const assembler::AssemblerUtils &assembler,
-			const std::string &formulation,
+			const assembler::Formulation &formulation,
 			const Eigen::MatrixXd &fun,
 			Eigen::MatrixXd &result,
 			Eigen::VectorXd &von_mises);
@@ -175,7 +176,7 @@ namespace polyfem::io
 			const std::map<int, Eigen::MatrixXd> &polys,
 			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
 			const assembler::AssemblerUtils &assembler,
-			const std::string &formulation,
+			const assembler::Formulation &formulation,
 			const utils::RefElementSampler &sampler,
 			const Eigen::MatrixXd &fun,
 			const bool use_sampler,
@@ -206,7 +207,7 @@ namespace polyfem::io
 			const std::map<int, Eigen::MatrixXd> &polys,
 			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
 			const assembler::AssemblerUtils &assembler,
-			const std::string &formulation,
+			const assembler::Formulation &formulation,
 			const utils::RefElementSampler &sampler,
 			const int n_points,
 			const Eigen::MatrixXd &fun,
@@ -221,6 +222,7 @@ namespace polyfem::io
 		/// @param[in] n_bases number of bases
 		/// @param[in] bases bases
 		/// @param[in] gbases geom bases
+		/// @param[in] coloring coloring of bases, the elements of one color are averaged in parallel
 		/// @param[in] disc_orders discretization orders
 		/// @param[in] polys polygons
 		/// @param[in] polys_3d polyhedra
@@ -239,11 +241,12 @@ namespace polyfem::io
 			const int n_bases,
 			const std::vector<basis::ElementBases> &bases,
 			const std::vector<basis::ElementBases> &gbases,
+			const mesh::ElementColoring &coloring,
 			const Eigen::VectorXi &disc_orders,
 			const std::map<int, Eigen::MatrixXd> &polys,
 			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
 			const assembler::AssemblerUtils &assembler,
-			const std::string &formulation,
+			const assembler::Formulation &formulation,
 			const utils::RefElementSampler &sampler,
 			const int n_points,
 			const Eigen::MatrixXd &fun,
@@ -277,7 +280,7 @@ namespace polyfem::io
 			const std::map<int, Eigen::MatrixXd> &polys,
 			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
 			const assembler::AssemblerUtils &assembler,
-			const std::string &formulation,
+			const assembler::Formulation &formulation,
 			const utils::RefElementSampler &sampler,
 			const int n_points,
 			const Eigen::MatrixXd &fun,
@@ -348,7 +351,7 @@ namespace polyfem::io
 			const std::vector<basis::ElementBases> &bases,
 			const std::vector<basis::ElementBases> &gbases,
 			const assembler::AssemblerUtils &assembler,
-			const std::string &formulation,
+			const assembler::Formulation &formulation,
 			const Eigen::MatrixXd &pts,
 			const Eigen::MatrixXi &faces,
 			const Eigen::MatrixXd &fun,
@@ -380,7 +383,7 @@ namespace polyfem::io
 			const std::vector<basis::ElementBases> &bases,
 			const std::vector<basis::ElementBases> &gbases,
 			const assembler::AssemblerUtils &assembler,
-			const std::string &formulation,
+			const assembler::Formulation &formulation,
 			const Eigen::MatrixXd &pts,
 			const Eigen::MatrixXi &faces,
 			const Eigen::MatrixXd &fun,
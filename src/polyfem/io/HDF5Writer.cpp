@@ -0,0 +1,326 @@
+#include "HDF5Writer.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+#include <highfive/H5File.hpp>
+#include <highfive/H5DataSet.hpp>
+#include <highfive/H5DataSpace.hpp>
+#include <H5Zpublic.h>
+
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+
+namespace polyfem
+{
+	namespace io
+	{
+		namespace
+		{
+			typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMajorMatrixXd;
+			typedef Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMajorMatrixXi;
+
+			/// rows of the chunks of the fields, 64k points of a vector field are a 1.5MB chunk
+			static const size_t CHUNK_ROWS = 1 << 16;
+
+			std::string field_path(const std::string &mesh, const std::string &name)
+			{
+				return "/" + mesh + "/fields/" + name;
+			}
+
+			std::string topology_type(const int dim, const int cell_size)
+			{
+				switch (cell_size)
+				{
+				case 1:
+					return "Polyvertex";
+				case 2:
+					return "Polyline";
+				case 3:
+					return "Triangle";
+				case 4:
+					return dim == 3 ? "Tetrahedron" : "Quadrilateral";
+				case 8:
+					return "Hexahedron";
+				default:
+					log_and_throw_error(fmt::format("Unsupported cells with {} vertices in the XDMF output", cell_size));
+					return "";
+				}
+			}
+
+			std::string attribute_type(const int n_components)
+			{
+				switch (n_components)
+				{
+				case 1:
+					return "Scalar";
+				case 3:
+					return "Vector";
+				case 6:
+					return "Tensor6";
+				case 9:
+					return "Tensor";
+				default:
+					return "Matrix";
+				}
+			}
+		} // namespace
+
+		HDF5Writer::HDF5Writer(const std::string &path, const int compression_level)
+			: path_(path), compression_level_(compression_level)
+		{
+			file_ = std::make_unique<HighFive::File>(path, HighFive::File::Overwrite);
+
+			if (compression_level_ > 0 && H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0)
+			{
+				logger().warn("HDF5 has been compiled without the deflate filter, {} is not compressed", path);
+				compression_level_ = 0;
+			}
+
+			HighFive::DataSetCreateProps time_props;
+			time_props.add(HighFive::Chunking(std::vector<hsize_t>{1024}));
+			file_->createDataSet<double>("/time", HighFive::DataSpace({0}, {HighFive::DataSpace::UNLIMITED}), time_props);
+
+			const std::string xdmf_path = std::filesystem::path(path).replace_extension(".xdmf").string();
+			xdmf_.open(xdmf_path, std::ios::out | std::ios::trunc | std::ios::binary);
+			if (!xdmf_.good())
+			{
+				logger().error("Unable to open {} for writing", xdmf_path);
+				return;
+			}
+
+			xdmf_ << "<?xml version=\"1.0\" ?>\n";
+			xdmf_ << "<Xdmf Version=\"3.0\">\n";
+			xdmf_ << "  <Domain>\n";
+			xdmf_ << "    <Grid Name=\"TimeSeries\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+			xdmf_footer_pos_ = xdmf_.tellp();
+			write_xdmf_footer();
+		}
+
+		// the HighFive file is complete here
+		HDF5Writer::~HDF5Writer() = default;
+
+		void HDF5Writer::write_mesh(const std::string &mesh, const Eigen::MatrixXd &points, const Eigen::MatrixXi &cells)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (meshes_.count(mesh))
+				log_and_throw_error(fmt::format("Mesh {} already written to {}", mesh, path_));
+
+			const RowMajorMatrixXd row_points = points;
+			const RowMajorMatrixXi row_cells = cells;
+
+			file_->createDataSet<double>("/" + mesh + "/points", HighFive::DataSpace({size_t(points.rows()), size_t(points.cols())}))
+				.write_raw(row_points.data());
+			file_->createDataSet<int>("/" + mesh + "/cells", HighFive::DataSpace({size_t(cells.rows()), size_t(cells.cols())}))
+				.write_raw(row_cells.data());
+
+			meshes_[mesh] = {int(points.rows()), int(points.cols()), int(cells.rows()), int(cells.cols())};
+		}
+
+		bool HDF5Writer::has_mesh(const std::string &mesh) const
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return meshes_.count(mesh) > 0;
+		}
+
+		int HDF5Writer::n_time_steps() const
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return n_steps_;
+		}
+
+		void HDF5Writer::begin_time_step(const double t)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			assert(!in_step_);
+
+			current_time_ = t;
+			current_fields_.clear();
+			in_step_ = true;
+		}
+
+		void HDF5Writer::add_field(const std::string &mesh, const std::string &name, const Eigen::MatrixXd &data)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			assert(in_step_);
+
+			try
+			{
+				append_field(mesh, name, data);
+			}
+			catch (...)
+			{
+				abort_time_step();
+				throw;
+			}
+		}
+
+		void HDF5Writer::append_field(const std::string &mesh, const std::string &name, const Eigen::MatrixXd &data)
+		{
+			const auto it = meshes_.find(mesh);
+			if (it == meshes_.end())
+				log_and_throw_error(fmt::format("Write the mesh {} before its field {}", mesh, name));
+			if (data.rows() != it->second.n_points)
+				log_and_throw_error(fmt::format("Field {} has {} values for the {} points of mesh {}", name, data.rows(), it->second.n_points, mesh));
+
+			const size_t rows = data.rows();
+			const size_t cols = data.cols();
+			const std::string path = field_path(mesh, name);
+
+			if (datasets_.insert(path).second)
+			{
+				HighFive::DataSetCreateProps props;
+				props.add(HighFive::Chunking(std::vector<hsize_t>{1, std::max<hsize_t>(1, std::min(rows, CHUNK_ROWS)), std::max<hsize_t>(1, cols)}));
+				if (compression_level_ > 0)
+				{
+					props.add(HighFive::Shuffle());
+					props.add(HighFive::Deflate(compression_level_));
+				}
+
+				file_->createDataSet<double>(path, HighFive::DataSpace({0, rows, cols}, {HighFive::DataSpace::UNLIMITED, rows, cols}), props);
+			}
+
+			HighFive::DataSet dataset = file_->getDataSet(path);
+			const std::vector<size_t> dims = dataset.getDimensions();
+			if (dims[1] != rows || dims[2] != cols)
+				log_and_throw_error(fmt::format("Field {} changed size from {}x{} to {}x{}", name, dims[1], dims[2], rows, cols));
+
+			// the steps where the field is not written are left to the fill value
+			dataset.resize({size_t(n_steps_ + 1), rows, cols});
+
+			const RowMajorMatrixXd row_data = data;
+			dataset.select({size_t(n_steps_), 0, 0}, {1, rows, cols}).write_raw(row_data.data());
+
+			current_fields_[mesh].emplace_back(name, int(cols));
+		}
+
+		void HDF5Writer::end_time_step()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			assert(in_step_);
+
+			// the time is appended once the step is complete, /time has as many entries as the fields
+			try
+			{
+				HighFive::DataSet time = file_->getDataSet("/time");
+				time.resize({size_t(n_steps_ + 1)});
+				time.select({size_t(n_steps_)}, {1}).write_raw(&current_time_);
+			}
+			catch (...)
+			{
+				abort_time_step();
+				throw;
+			}
+			in_step_ = false;
+
+			++n_steps_;
+			file_->flush();
+
+			if (!xdmf_.good())
+				return;
+
+			xdmf_.seekp(xdmf_footer_pos_);
+			if (meshes_.size() == 1)
+			{
+				const auto &[name, mesh] = *meshes_.begin();
+				write_xdmf_grid(name, mesh, current_fields_[name], xdmf_);
+			}
+			else
+			{
+				xdmf_ << "      <Grid Name=\"step" << n_steps_ - 1 << "\" GridType=\"Collection\" CollectionType=\"Spatial\">\n";
+				xdmf_ << "        <Time Value=\"" << fmt::format("{}", current_time_) << "\"/>\n";
+				for (const auto &[name, mesh] : meshes_)
+					write_xdmf_grid(name, mesh, current_fields_[name], xdmf_);
+				xdmf_ << "      </Grid>\n";
+			}
+			xdmf_footer_pos_ = xdmf_.tellp();
+			write_xdmf_footer();
+
+			if (!xdmf_.good())
+				logger().error("Unable to write the XDMF file of {}", path_);
+		}
+
+		void HDF5Writer::abort_time_step()
+		{
+			in_step_ = false;
+
+			// drops the slices appended by the step, the errors are ignored to report the one that aborted the step
+			for (const auto &[mesh, fields] : current_fields_)
+			{
+				for (const auto &field : fields)
+				{
+					try
+					{
+						HighFive::DataSet dataset = file_->getDataSet(field_path(mesh, field.first));
+						const std::vector<size_t> dims = dataset.getDimensions();
+						dataset.resize({size_t(n_steps_), dims[1], dims[2]});
+					}
+					catch (...)
+					{
+					}
+				}
+			}
+			current_fields_.clear();
+		}
+
+		void HDF5Writer::write_matrix(const std::string &name, const Eigen::MatrixXd &mat)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			if (!datasets_.insert(name).second)
+				file_->unlink(name);
+
+			const RowMajorMatrixXd row_mat = mat;
+			file_->createDataSet<double>(name, HighFive::DataSpace({size_t(mat.rows()), size_t(mat.cols())}))
+				.write_raw(row_mat.data());
+			file_->flush();
+		}
+
+		void HDF5Writer::write_xdmf_grid(const std::string &name, const Mesh &mesh, const std::vector<std::pair<std::string, int>> &fields, std::ostream &os) const
+		{
+			const std::string file = std::filesystem::path(path_).filename().string();
+			// the grids of the meshes are nested in the collection of the step if there are several
+			const std::string indent = meshes_.size() == 1 ? "      " : "        ";
+
+			os << indent << "<Grid Name=\"" << name << "\" GridType=\"Uniform\">\n";
+			if (meshes_.size() == 1)
+				os << indent << "  <Time Value=\"" << fmt::format("{}", current_time_) << "\"/>\n";
+
+			os << indent << "  <Topology TopologyType=\"" << topology_type(mesh.dim, mesh.cell_size) << "\" NumberOfElements=\"" << mesh.n_cells << "\"";
+			if (mesh.cell_size <= 2)
+				os << " NodesPerElement=\"" << mesh.cell_size << "\"";
+			os << ">\n";
+			os << indent << "    <DataItem Dimensions=\"" << mesh.n_cells << " " << mesh.cell_size << "\" NumberType=\"Int\" Precision=\"4\" Format=\"HDF\">"
+			   << file << ":/" << name << "/cells</DataItem>\n";
+			os << indent << "  </Topology>\n";
+
+			os << indent << "  <Geometry GeometryType=\"" << (mesh.dim == 3 ? "XYZ" : "XY") << "\">\n";
+			os << indent << "    <DataItem Dimensions=\"" << mesh.n_points << " " << mesh.dim << "\" NumberType=\"Float\" Precision=\"8\" Format=\"HDF\">"
+			   << file << ":/" << name << "/points</DataItem>\n";
+			os << indent << "  </Geometry>\n";
+
+			// the step of every field is a hyperslab of the dataset, as large as the steps written so far
+			for (const auto &[field, n_components] : fields)
+			{
+				os << indent << "  <Attribute Name=\"" << field << "\" AttributeType=\"" << attribute_type(n_components) << "\" Center=\"Node\">\n";
+				os << indent << "    <DataItem ItemType=\"HyperSlab\" Dimensions=\"1 " << mesh.n_points << " " << n_components << "\">\n";
+				os << indent << "      <DataItem Dimensions=\"3 3\" Format=\"XML\">"
+				   << n_steps_ - 1 << " 0 0 1 1 1 1 " << mesh.n_points << " " << n_components << "</DataItem>\n";
+				os << indent << "      <DataItem Dimensions=\"" << n_steps_ << " " << mesh.n_points << " " << n_components << "\" NumberType=\"Float\" Precision=\"8\" Format=\"HDF\">"
+				   << file << ":" << field_path(name, field) << "</DataItem>\n";
+				os << indent << "    </DataItem>\n";
+				os << indent << "  </Attribute>\n";
+			}
+
+			os << indent << "</Grid>\n";
+		}
+
+		void HDF5Writer::write_xdmf_footer()
+		{
+			xdmf_ << "    </Grid>\n";
+			xdmf_ << "  </Domain>\n";
+			xdmf_ << "</Xdmf>\n";
+			xdmf_.flush();
+		}
+	} // namespace io
+} // namespace polyfem
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace HighFive
+{
+	class File;
+}
+
+namespace polyfem
+{
+	namespace io
+	{
+		/// @brief Time series in an HDF5 file, with an XDMF sidecar to open it in ParaView.
+		///
+		/// The meshes are written once (/<mesh>/points and /<mesh>/cells) and every field is an
+		/// extendible chunked dataset /<mesh>/fields/<name> of size #steps x #points x #components,
+		/// a time step appends one slice to the fields written in it. The XDMF file is appended
+		/// like the PVDWriter, it references the meshes and the slices of the fields and is valid
+		/// after every time step.
+		///
+		/// All the functions are serialized, the writer can be shared with the AsyncWriter.
+		class HDF5Writer
+		{
+		public:
+			/// @brief Creates (or truncates) the HDF5 file and its XDMF sidecar (same path with the .xdmf extension)
+			/// @param[in] path path of the HDF5 file
+			/// @param[in] compression_level deflate level (1 to 9) of the fields, 0 to disable the compression
+			explicit HDF5Writer(const std::string &path, const int compression_level = 0);
+			~HDF5Writer();
+
+			HDF5Writer(const HDF5Writer &) = delete;
+			HDF5Writer &operator=(const HDF5Writer &) = delete;
+
+			/// @brief Writes a mesh, the fields of the mesh are sampled at its points
+			/// @param[in] mesh name of the mesh
+			/// @param[in] points #P x dim points
+			/// @param[in] cells #C x n cells, tetrahedra, triangles, or edges
+			void write_mesh(const std::string &mesh, const Eigen::MatrixXd &points, const Eigen::MatrixXi &cells);
+			/// @brief if the mesh has been written
+			bool has_mesh(const std::string &mesh) const;
+
+			/// @brief Starts a new time step
+			/// @param[in] t time of the step, appended to /time when the step ends
+			void begin_time_step(const double t);
+			/// @brief Writes a field of the current time step, if it fails the step is aborted and its fields are discarded
+			/// @param[in] mesh name of the mesh, it has to be written first
+			/// @param[in] name name of the field
+			/// @param[in] data #P x #components values at the points of the mesh, the size must not change between the steps
+			void add_field(const std::string &mesh, const std::string &name, const Eigen::MatrixXd &data);
+			/// @brief Appends the time of the current step to /time and the step to the XDMF file, and flushes both files
+			void end_time_step();
+
+			/// @brief Writes (or overwrites) a matrix outside of the time series, eg to restart the simulation
+			/// @param[in] name path of the dataset in the file
+			/// @param[in] mat matrix
+			void write_matrix(const std::string &name, const Eigen::MatrixXd &mat);
+
+			const std::string &path() const { return path_; }
+			/// number of time steps
+			int n_time_steps() const;
+
+		private:
+			struct Mesh
+			{
+				int n_points;
+				int dim;
+				int n_cells;
+				int cell_size;
+			};
+
+			// add_field without the lock and the abort
+			void append_field(const std::string &mesh, const std::string &name, const Eigen::MatrixXd &data);
+			// ends the current step without appending it, the fields written in it are truncated to the previous steps
+			void abort_time_step();
+
+			void write_xdmf_grid(const std::string &mesh, const Mesh &m, const std::vector<std::pair<std::string, int>> &fields, std::ostream &os) const;
+			// writes the footer at the current position of the XDMF file and flushes it
+			void write_xdmf_footer();
+
+			mutable std::mutex mutex_;
+
+			std::string path_;
+			int compression_level_;
+			std::unique_ptr<HighFive::File> file_;
+
+			std::map<std::string, Mesh> meshes_;
+			/// datasets created in the file, the fields and matrices
+			std::set<std::string> datasets_;
+			int n_steps_ = 0;
+			double current_time_ = 0;
+			bool in_step_ = false;
+			/// fields (and number of components) written in the current step, by mesh
+			std::map<std::string, std::vector<std::pair<std::string, int>>> current_fields_;
+
+			std::ofstream xdmf_;
+			/// position of the footer of the XDMF file, overwritten by the next step
+			std::streampos xdmf_footer_pos_;
+		};
+	} // namespace io
+} // namespace polyfem
@@ -0,0 +1,155 @@
+#include "InterpolationOperator.hpp"
+
+#include <polyfem/assembler/ElementAssemblyValues.hpp>
+#include <polyfem/basis/BasisTabulation.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+
+namespace polyfem
+{
+	using namespace assembler;
+	using namespace basis;
+
+	namespace io
+	{
+		void InterpolationOperator::init(
+			const bool is_volume,
+			const int n_bases,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			const Eigen::VectorXi &elements,
+			const Eigen::MatrixXd &local_pts,
+			const bool with_grad)
+		{
+			assert(elements.size() == local_pts.rows());
+			const int n_points = int(elements.size());
+			dim_ = is_volume ? 3 : 2;
+
+			std::vector<Eigen::Triplet<double>> val_entries, grad_entries;
+			ElementAssemblyValues vals;
+			std::vector<AssemblyValues> basis_values;
+			// the reference elements share the points of the sampler, their bases are tabulated once per distinct points
+			// here rather than in the cache of BasisTabulation, which only holds quadratures
+			std::map<BasisTabulation::Key, std::vector<BasisTabulation>> tabulations;
+
+			// consecutive points in the same element are evaluated together
+			int start = 0;
+			while (start < n_points)
+			{
+				const int e = elements(start);
+				int end = start + 1;
+				while (end < n_points && elements(end) == e)
+					++end;
+
+				if (e >= 0)
+				{
+					const ElementBases &bs = bases[e];
+					const Eigen::MatrixXd pts = local_pts.middleRows(start, end - start);
+					assert(pts.cols() == dim_);
+
+					const Eigen::MatrixXd *val = nullptr;
+					if (with_grad)
+					{
+						vals.compute(e, is_volume, pts, bs, gbases[e]);
+					}
+					else if (bs.reference_key())
+					{
+						std::vector<BasisTabulation> &key_tabulations = tabulations[*bs.reference_key()];
+						auto it = std::find_if(key_tabulations.begin(), key_tabulations.end(), [&](const BasisTabulation &tab) {
+							return tab.points.rows() == pts.rows() && tab.points == pts;
+						});
+						if (it == key_tabulations.end())
+						{
+							key_tabulations.emplace_back();
+							key_tabulations.back().compute(pts, bs);
+							it = key_tabulations.end() - 1;
+						}
+						val = &it->val;
+					}
+					else
+						bs.evaluate_bases(pts, basis_values);
+
+					for (size_t j = 0; j < bs.bases.size(); ++j)
+					{
+						for (const Local2Global &g : bs.bases[j].global())
+						{
+							for (int k = 0; k < pts.rows(); ++k)
+							{
+								const double v = val ? (*val)(k, j) : (with_grad ? vals.basis_values[j].val(k) : basis_values[j].val(k));
+								if (v != 0)
+									val_entries.emplace_back(start + k, g.index, g.val * v);
+
+								if (!with_grad)
+									continue;
+
+								const auto &grad = vals.basis_values[j].grad_t_m;
+								for (int d = 0; d < dim_; ++d)
+								{
+									if (grad(k, d) != 0)
+										grad_entries.emplace_back((start + k) * dim_ + d, g.index, g.val * grad(k, d));
+								}
+							}
+						}
+					}
+				}
+
+				start = end;
+			}
+
+			val_.resize(n_points, n_bases);
+			val_.setFromTriplets(val_entries.begin(), val_entries.end());
+
+			grad_.resize(with_grad ? n_points * dim_ : 0, with_grad ? n_bases : 0);
+			if (with_grad)
+				grad_.setFromTriplets(grad_entries.begin(), grad_entries.end());
+		}
+
+		void InterpolationOperator::interpolate(const Eigen::MatrixXd &fun, const int actual_dim, Eigen::MatrixXd &result) const
+		{
+			if (fun.size() <= 0)
+			{
+				logger().error("Solve the problem first!");
+				return;
+			}
+
+			assert(fun.size() == n_bases() * actual_dim);
+			const Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> nodal(fun.data(), n_bases(), actual_dim);
+			result = val_ * nodal;
+		}
+
+		void InterpolationOperator::interpolate_grad(const Eigen::MatrixXd &fun, const int actual_dim, Eigen::MatrixXd &result_grad) const
+		{
+			assert(has_grad());
+			if (fun.size() <= 0)
+			{
+				logger().error("Solve the problem first!");
+				return;
+			}
+
+			assert(fun.size() == n_bases() * actual_dim);
+			const Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> nodal(fun.data(), n_bases(), actual_dim);
+			const Eigen::MatrixXd grad = grad_ * nodal;
+
+			result_grad.resize(n_points(), actual_dim * dim_);
+			for (int p = 0; p < n_points(); ++p)
+			{
+				for (int k = 0; k < actual_dim; ++k)
+				{
+					for (int d = 0; d < dim_; ++d)
+						result_grad(p, k * dim_ + d) = grad(p * dim_ + d, k);
+				}
+			}
+		}
+
+		size_t InterpolationOperator::memory() const
+		{
+			const auto matrix_memory = [](const RowMajorMatrix &m) {
+				return m.nonZeros() * (sizeof(double) + sizeof(RowMajorMatrix::StorageIndex)) + (m.outerSize() + 1) * sizeof(RowMajorMatrix::StorageIndex);
+			};
+			return matrix_memory(val_) + matrix_memory(grad_);
+		}
+	} // namespace io
+} // namespace polyfem
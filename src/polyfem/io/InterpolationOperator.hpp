@@ -0,0 +1,69 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include <vector>
+
+namespace polyfem
+{
+	namespace io
+	{
+		/// @brief Sparse operators mapping the nodal values of a discretization to the values (and
+		/// gradients) at fixed points of the elements, eg the vertices of the visualization mesh.
+		///
+		/// The bases are evaluated once when the operators are built, interpolating a field at the
+		/// points is then a sparse matrix product, independently of the number of components of the field.
+		class InterpolationOperator
+		{
+		public:
+			/// @brief Builds the operators
+			///
+			/// @param[in] is_volume if the mesh is 3d
+			/// @param[in] n_bases number of nodes of the discretization
+			/// @param[in] bases bases
+			/// @param[in] gbases geometric bases, used for the gradients
+			/// @param[in] elements #P element of every point, negative for points outside of the mesh (interpolated as 0)
+			/// @param[in] local_pts #P x dim points in the reference element of their element
+			/// @param[in] with_grad if the gradient operator is built
+			void init(
+				const bool is_volume,
+				const int n_bases,
+				const std::vector<basis::ElementBases> &bases,
+				const std::vector<basis::ElementBases> &gbases,
+				const Eigen::VectorXi &elements,
+				const Eigen::MatrixXd &local_pts,
+				const bool with_grad);
+
+			int n_points() const { return int(val_.rows()); }
+			int n_bases() const { return int(val_.cols()); }
+			bool has_grad() const { return grad_.size() > 0; }
+
+			/// @brief Interpolates a field
+			/// @param[in] fun #nodes * actual_dim nodal values, flattened
+			/// @param[in] actual_dim number of components of the field
+			/// @param[out] result #P x actual_dim values
+			void interpolate(const Eigen::MatrixXd &fun, const int actual_dim, Eigen::MatrixXd &result) const;
+
+			/// @brief Interpolates the gradient of a field, requires the gradient operator
+			/// @param[in] fun #nodes * actual_dim nodal values, flattened
+			/// @param[in] actual_dim number of components of the field
+			/// @param[out] result_grad #P x (actual_dim * dim), column k * dim + d is the derivative of component k along d (as Evaluator::interpolate_at_local_vals)
+			void interpolate_grad(const Eigen::MatrixXd &fun, const int actual_dim, Eigen::MatrixXd &result_grad) const;
+
+			/// @brief Memory used by the operators in bytes
+			size_t memory() const;
+
+		private:
+			typedef Eigen::SparseMatrix<double, Eigen::RowMajor> RowMajorMatrix;
+
+			int dim_ = 0;
+			/// #P x #nodes
+			RowMajorMatrix val_;
+			/// (#P * dim) x #nodes, row p * dim + d is the derivative along d at point p
+			RowMajorMatrix grad_;
+		};
+	} // namespace io
+} // namespace polyfem
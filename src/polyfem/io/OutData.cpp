@@ -18,6 +18,7 @@
 #include <polyfem/solver/forms/FrictionForm.hpp>
 #include <polyfem/solver/NLProblem.hpp>
 
+#include <polyfem/io/HDF5Writer.hpp>
 #include <polyfem/io/VTUWriter.hpp>
 
 #include <polyfem/utils/EdgeSampler.hpp>
@@ -64,6 +65,75 @@ namespace ipc
 
 namespace polyfem::io
 {
+	namespace
+	{
+		// points in the reference elements of the vertices of a visualization mesh, el_id is the element of every vertex
+		Eigen::MatrixXd vis_local_points(
+			const mesh::Mesh &mesh,
+			const Eigen::VectorXi &disc_orders,
+			const std::map<int, Eigen::MatrixXd> &polys,
+			const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d,
+			const utils::RefElementSampler &sampler,
+			const bool use_sampler,
+			const Eigen::MatrixXi &el_id)
+		{
+			Eigen::MatrixXd local_pts(el_id.size(), mesh.dimension());
+			Eigen::MatrixXd pts;
+			Eigen::MatrixXi vis_faces_poly;
+
+			int index = 0;
+			while (index < el_id.size())
+			{
+				const int e = el_id(index);
+				if (use_sampler)
+				{
+					if (mesh.is_simplex(e))
+						pts = sampler.simplex_points();
+					else if (mesh.is_cube(e))
+						pts = sampler.cube_points();
+					else if (mesh.is_volume())
+						sampler.sample_polyhedron(polys_3d.at(e).first, polys_3d.at(e).second, pts, vis_faces_poly);
+					else
+						sampler.sample_polygon(polys.at(e), pts, vis_faces_poly);
+				}
+				else
+				{
+					assert(mesh.is_simplex(e) || mesh.is_cube(e));
+					if (mesh.is_volume())
+					{
+						if (mesh.is_simplex(e))
+							autogen::p_nodes_3d(disc_orders(e), pts);
+						else
+							autogen::q_nodes_3d(disc_orders(e), pts);
+					}
+					else
+					{
+						if (mesh.is_simplex(e))
+							autogen::p_nodes_2d(disc_orders(e), pts);
+						else
+							autogen::q_nodes_2d(disc_orders(e), pts);
+					}
+				}
+
+				assert(index + pts.rows() <= el_id.size());
+				local_pts.middleRows(index, pts.rows()) = pts;
+				index += pts.rows();
+			}
+
+			return local_pts;
+		}
+
+		// pads 2d vectors with a zero z component, ParaView expects 3d vectors
+		Eigen::MatrixXd to_3d_vectors(const Eigen::MatrixXd &vectors)
+		{
+			if (vectors.cols() != 2)
+				return vectors;
+
+			Eigen::MatrixXd res(vectors.rows(), 3);
+			res << vectors, Eigen::VectorXd::Zero(vectors.rows());
+			return res;
+		}
+	} // namespace
 
 	void OutGeometryData::extract_boundary_mesh(
 		const mesh::Mesh &mesh,
@@ -895,12 +965,69 @@ namespace polyfem::io
 
 		reorder_output = args["output"]["data"]["advanced"]["reorder_nodes"];
 
+		vtu_compression = VTUWriter::compression_from_string(args["output"]["paraview"]["compression"]);
+		vtu_float32 = args["output"]["paraview"]["float32"];
+
 		this->solve_export_to_file = solve_export_to_file;
 	}
 
+	void SolutionFrame::write(HDF5Writer &writer, const std::string &mesh) const
+	{
+		if (!writer.has_mesh(mesh))
+			writer.write_mesh(mesh, points, connectivity);
+
+		const int n_points = points.rows();
+		const auto add_field = [&](const std::string &field, const Eigen::MatrixXd &data, const bool is_vector) {
+			if (data.size() <= 0)
+				return;
+
+			// the vertices of the obstacles are appended to the fields but not to the points
+			const Eigen::MatrixXd tmp = data.topRows(n_points);
+			writer.add_field(mesh, field, is_vector ? to_3d_vectors(tmp) : tmp);
+		};
+
+		add_field("solution", solution, true);
+		add_field("velocity", velocity, true);
+		add_field("acceleration", acceleration, true);
+		add_field("pressure", pressure, false);
+		add_field("exact", exact, true);
+		add_field("error", error, false);
+		add_field("scalar_value", scalar_value, false);
+		add_field("scalar_value_avg", scalar_value_avg, false);
+		add_field("tensor_value", tensor_value, false);
+	}
+
+	ExportFrame::ExportFrame(const State &state)
+		: sol(state.sol), pressure(state.pressure)
+	{
+		if (state.solve_data.time_integrator)
+		{
+			const time_integrator::ImplicitTimeIntegrator &time_integrator = *state.solve_data.time_integrator;
+			velocity = time_integrator.v_prev();
+			acceleration = time_integrator.a_prev();
+		}
+		if (state.solve_data.contact_form)
+			barrier_stiffness = state.solve_data.contact_form->barrier_stiffness();
+		if (state.solve_data.friction_form)
+			displaced_surface_prev = state.solve_data.friction_form->displaced_surface_prev();
+	}
+
+	void OutGeometryData::save_vtu(
+		const std::string &path,
+		const State &state,
+		const double t,
+		const double dt,
+		const ExportOptions &opts,
+		const bool is_contact_enabled,
+		std::vector<SolutionFrame> &solution_frames) const
+	{
+		save_vtu(path, state, ExportFrame(state), t, dt, opts, is_contact_enabled, solution_frames);
+	}
+
 	void OutGeometryData::save_vtu(
 		const std::string &path,
 		const State &state,
+		const ExportFrame &frame,
 		const double t,
 		const double dt,
 		const ExportOptions &opts,
@@ -913,7 +1040,7 @@ namespace polyfem::io
 			return;
 		}
 		const mesh::Mesh &mesh = *state.mesh;
-		const Eigen::MatrixXd &sol = state.sol;
+		const Eigen::MatrixXd &sol = frame.sol;
 		const Eigen::MatrixXd &rhs = state.rhs;
 
 		if (state.n_bases <= 0)
@@ -939,18 +1066,18 @@ namespace polyfem::io
 
 		if (opts.volume)
 		{
-			save_volume(path, state, t, opts, solution_frames);
+			save_volume(path, state, frame, t, opts, solution_frames);
 		}
 
 		if (opts.surface)
 		{
-			save_surface(base_path + "_surf.vtu", state, dt, opts,
+			save_surface(base_path + "_surf.vtu", state, frame, dt, opts,
 						 is_contact_enabled, solution_frames);
 		}
 
 		if (opts.wire)
 		{
-			save_wire(base_path + "_wire.vtu", state, t, opts, solution_frames);
+			save_wire(base_path + "_wire.vtu", state, frame, t, opts, solution_frames);
 		}
 
 		if (!opts.solve_export_to_file)
@@ -1014,6 +1141,7 @@ namespace polyfem::io
 	void OutGeometryData::save_volume(
 		const std::string &path,
 		const State &state,
+		const ExportFrame &frame,
 		const double t,
 		const ExportOptions &opts,
 		std::vector<SolutionFrame> &solution_frames) const
@@ -1021,74 +1149,55 @@ namespace polyfem::io
 		const Eigen::VectorXi &disc_orders = state.disc_orders;
 		const Density &density = state.assembler.density();
 		const std::vector<basis::ElementBases> &bases = state.bases;
-		const std::vector<basis::ElementBases> &pressure_bases = state.pressure_bases;
 		const std::vector<basis::ElementBases> &gbases = state.geom_bases();
 		const std::map<int, Eigen::MatrixXd> &polys = state.polys;
 		const std::map<int, std::pair<Eigen::MatrixXd, Eigen::MatrixXi>> &polys_3d = state.polys_3d;
 		const assembler::AssemblerUtils &assembler = state.assembler;
-		const std::shared_ptr<time_integrator::ImplicitTimeIntegrator> &time_integrator = state.solve_data.time_integrator;
-		const std::string &formulation = state.formulation();
+		const assembler::Formulation &formulation = state.formulation();
 		const mesh::Mesh &mesh = *state.mesh;
 		const mesh::Obstacle &obstacle = state.obstacle;
-		const Eigen::MatrixXd &sol = state.sol;
-		const Eigen::MatrixXd &pressure = state.pressure;
+		const Eigen::MatrixXd &sol = frame.sol;
+		const Eigen::MatrixXd &pressure = frame.pressure;
 		const assembler::Problem &problem = *state.problem;
 
-		Eigen::MatrixXd points;
-		Eigen::MatrixXi tets;
-		Eigen::MatrixXi el_id;
-		Eigen::MatrixXd discr;
-		std::vector<std::vector<int>> elements;
+		const int actual_dim = problem.is_scalar() ? 1 : mesh.dimension();
 
-		if (opts.use_sampler)
-			build_vis_mesh(mesh, disc_orders, gbases,
-						   state.polys, state.polys_3d, opts.boundary_only,
-						   points, tets, el_id, discr);
-		else
-			build_high_oder_vis_mesh(mesh, disc_orders, bases,
-									 points, elements, el_id, discr);
+		// the topology and the interpolation operators are built at the first frame, every field is a sparse product
+		const std::shared_ptr<const VolumeVisMesh> vis_mesh = volume_vis_mesh(state, opts);
+		Eigen::MatrixXd points = vis_mesh->points;
+		const Eigen::MatrixXi &tets = vis_mesh->tets;
+		const Eigen::MatrixXi &el_id = vis_mesh->el_id;
+		Eigen::MatrixXd discr = vis_mesh->discr;
+		std::vector<std::vector<int>> elements = vis_mesh->elements;
 
 		Eigen::MatrixXd fun, exact_fun, err;
 
 		if (opts.sol_on_grid)
 		{
-			const int problem_dim = problem.is_scalar() ? 1 : mesh.dimension();
-			Eigen::MatrixXd tmp, tmp_grad;
-			Eigen::MatrixXd tmp_p, tmp_grad_p;
-			Eigen::MatrixXd res(grid_points_to_elements.size(), problem_dim);
-			res.setConstant(std::numeric_limits<double>::quiet_NaN());
-			Eigen::MatrixXd res_grad(grid_points_to_elements.size(), problem_dim * problem_dim);
-			res_grad.setConstant(std::numeric_limits<double>::quiet_NaN());
+			const std::shared_ptr<const GridOperators> grid_ops = grid_operators(state);
 
-			Eigen::MatrixXd res_p(grid_points_to_elements.size(), 1);
-			res_p.setConstant(std::numeric_limits<double>::quiet_NaN());
-			Eigen::MatrixXd res_grad_p(grid_points_to_elements.size(), problem_dim);
-			res_grad_p.setConstant(std::numeric_limits<double>::quiet_NaN());
+			Eigen::MatrixXd res, res_grad;
+			grid_ops->sol_op.interpolate(sol, actual_dim, res);
+			grid_ops->sol_op.interpolate_grad(sol, actual_dim, res_grad);
+
+			Eigen::MatrixXd res_p, res_grad_p;
+			if (assembler.is_mixed(formulation))
+			{
+				grid_ops->pressure_op.interpolate(pressure, 1, res_p);
+				grid_ops->pressure_op.interpolate_grad(pressure, 1, res_grad_p);
+			}
 
 			for (int i = 0; i < grid_points_to_elements.size(); ++i)
 			{
-				const int el_id = grid_points_to_elements(i);
-				if (el_id < 0)
+				if (grid_points_to_elements(i) >= 0)
 					continue;
-				assert(mesh.is_simplex(el_id));
-				const Eigen::MatrixXd bc = grid_points_bc.row(i);
-				Eigen::MatrixXd pt(1, bc.cols() - 1);
-				for (int d = 1; d < bc.cols(); ++d)
-					pt(d - 1) = bc(d);
-				Evaluator::interpolate_at_local_vals(
-					mesh, problem.is_scalar(), bases, gbases,
-					el_id, pt, sol, tmp, tmp_grad);
-
-				res.row(i) = tmp;
-				res_grad.row(i) = tmp_grad;
 
+				res.row(i).setConstant(std::numeric_limits<double>::quiet_NaN());
+				res_grad.row(i).setConstant(std::numeric_limits<double>::quiet_NaN());
 				if (assembler.is_mixed(formulation))
 				{
-					Evaluator::interpolate_at_local_vals(
-						mesh, 1, pressure_bases, gbases,
-						el_id, pt, pressure, tmp_p, tmp_grad_p);
-					res_p.row(i) = tmp_p;
-					res_grad_p.row(i) = tmp_grad_p;
+					res_p.row(i).setConstant(std::numeric_limits<double>::quiet_NaN());
+					res_grad_p.row(i).setConstant(std::numeric_limits<double>::quiet_NaN());
 				}
 			}
 
@@ -1111,10 +1220,7 @@ namespace polyfem::io
 			}
 		}
 
-		Evaluator::interpolate_function(
-			mesh, problem.is_scalar(), bases, state.disc_orders,
-			state.polys, state.polys_3d, ref_element_sampler,
-			points.rows(), sol, fun, opts.use_sampler, opts.boundary_only);
+		vis_mesh->sol_op.interpolate(sol, actual_dim, fun);
 
 		if (obstacle.n_vertices() > 0)
 		{
@@ -1137,7 +1243,7 @@ namespace polyfem::io
 			}
 		}
 
-		io::VTUWriter writer;
+		io::VTUWriter writer(true, opts.vtu_compression, opts.vtu_float32);
 
 		if (opts.solve_export_to_file && fun.cols() != 1 && !mesh.is_volume())
 		{
@@ -1158,22 +1264,13 @@ namespace polyfem::io
 
 		if (problem.is_time_dependent())
 		{
-			bool is_time_integrator_valid = time_integrator != nullptr;
 			const Eigen::VectorXd zero_tmp = Eigen::VectorXd::Zero(sol.rows());
 			if (opts.velocity)
 			{
-				Eigen::VectorXd vel = zero_tmp;
-				if (is_time_integrator_valid)
-				{
-					const auto &tmp_ti = *static_cast<time_integrator::ImplicitTimeIntegrator *>(time_integrator.get());
-					vel = tmp_ti.v_prev();
-				}
+				const Eigen::VectorXd &vel = frame.velocity.size() > 0 ? frame.velocity : zero_tmp;
 
 				Eigen::MatrixXd interp_vel;
-				Evaluator::interpolate_function(
-					mesh, problem.is_scalar(), bases, state.disc_orders,
-					state.polys, state.polys_3d, ref_element_sampler,
-					points.rows(), vel, interp_vel, opts.use_sampler, opts.boundary_only);
+				vis_mesh->sol_op.interpolate(vel, actual_dim, interp_vel);
 				if (obstacle.n_vertices() > 0)
 				{
 					interp_vel.conservativeResize(interp_vel.rows() + obstacle.n_vertices(), interp_vel.cols());
@@ -1187,26 +1284,17 @@ namespace polyfem::io
 				}
 
 				if (opts.solve_export_to_file)
-				{
 					writer.add_field("velocity", interp_vel);
-				}
-				// TODO: else save to solution frames
+				else
+					solution_frames.back().velocity = interp_vel;
 			}
 
 			if (opts.acceleration)
 			{
-				Eigen::VectorXd acc = zero_tmp;
-				if (is_time_integrator_valid)
-				{
-					const auto &tmp_ti = *static_cast<time_integrator::ImplicitTimeIntegrator *>(time_integrator.get());
-					acc = tmp_ti.a_prev();
-				}
+				const Eigen::VectorXd &acc = frame.acceleration.size() > 0 ? frame.acceleration : zero_tmp;
 
 				Eigen::MatrixXd interp_acc;
-				Evaluator::interpolate_function(
-					mesh, problem.is_scalar(), bases, state.disc_orders,
-					state.polys, state.polys_3d, ref_element_sampler,
-					points.rows(), acc, interp_acc, opts.use_sampler, opts.boundary_only);
+				vis_mesh->sol_op.interpolate(acc, actual_dim, interp_acc);
 				if (obstacle.n_vertices() > 0)
 				{
 					interp_acc.conservativeResize(interp_acc.rows() + obstacle.n_vertices(), interp_acc.cols());
@@ -1220,10 +1308,9 @@ namespace polyfem::io
 				}
 
 				if (opts.solve_export_to_file)
-				{
 					writer.add_field("acceleration", interp_acc);
-				}
-				// TODO: else save to solution frames
+				else
+					solution_frames.back().acceleration = interp_acc;
 			}
 		}
 
@@ -1231,10 +1318,7 @@ namespace polyfem::io
 		if (assembler.is_mixed(formulation))
 		{
 			Eigen::MatrixXd interp_p;
-			Evaluator::interpolate_function(
-				mesh, 1, // FIXME: state.disc_orders should use pressure discr orders, works only with sampler
-				pressure_bases, state.disc_orders, state.polys, state.polys_3d, ref_element_sampler,
-				points.rows(), pressure, interp_p, opts.use_sampler, opts.boundary_only);
+			vis_mesh->pressure_op.interpolate(pressure, 1, interp_p);
 
 			if (obstacle.n_vertices() > 0)
 			{
@@ -1290,32 +1374,35 @@ namespace polyfem::io
 			else
 				solution_frames.back().scalar_value = vals;
 
+			Evaluator::compute_tensor_value(
+				mesh, problem.is_scalar(), bases, gbases,
+				state.disc_orders, state.polys, state.polys_3d,
+				state.assembler, state.formulation(),
+				ref_element_sampler, points.rows(), sol, tvals, opts.use_sampler, opts.boundary_only);
+			if (obstacle.n_vertices() > 0)
+			{
+				tvals.conservativeResize(tvals.rows() + obstacle.n_vertices(), tvals.cols());
+				tvals.bottomRows(obstacle.n_vertices()).setZero();
+			}
+
 			if (opts.solve_export_to_file)
 			{
-				Evaluator::compute_tensor_value(
-					mesh, problem.is_scalar(), bases, gbases,
-					state.disc_orders, state.polys, state.polys_3d,
-					state.assembler, state.formulation(),
-					ref_element_sampler, points.rows(), sol, tvals, opts.use_sampler, opts.boundary_only);
 				for (int i = 0; i < tvals.cols(); ++i)
 				{
-					Eigen::MatrixXd tmp = tvals.col(i);
-					if (obstacle.n_vertices() > 0)
-					{
-						tmp.conservativeResize(tmp.size() + obstacle.n_vertices(), 1);
-						tmp.bottomRows(obstacle.n_vertices()).setZero();
-					}
-
 					const int ii = (i / mesh.dimension()) + 1;
 					const int jj = (i % mesh.dimension()) + 1;
-					writer.add_field(fmt::format("tensor_value_{:d}{:d}", ii, jj), tmp);
+					writer.add_field(fmt::format("tensor_value_{:d}{:d}", ii, jj), tvals.col(i));
 				}
 			}
+			else
+				solution_frames.back().tensor_value = tvals;
 
 			if (!opts.use_spline)
 			{
+				mesh::ElementColoring tmp_coloring;
 				Evaluator::average_grad_based_function(
 					mesh, problem.is_scalar(), state.n_bases, bases, gbases,
+					state.ass_vals_cache.coloring(bases, tmp_coloring),
 					state.disc_orders, state.polys, state.polys_3d,
 					state.assembler, state.formulation(),
 					ref_element_sampler, points.rows(), sol, vals, tvals, opts.use_sampler, opts.boundary_only);
@@ -1521,101 +1608,128 @@ namespace polyfem::io
 		}
 	}
 
+	void OutGeometryData::compute_contact_forces(
+		const State &state,
+		const ExportFrame &frame,
+		const double dt_in,
+		const ExportOptions &opts,
+		Eigen::MatrixXd &displacement,
+		Eigen::MatrixXd &contact_forces,
+		Eigen::MatrixXd &friction_forces)
+	{
+		const ipc::CollisionMesh &collision_mesh = state.collision_mesh;
+		const Eigen::MatrixXd &boundary_nodes_pos = state.boundary_nodes_pos;
+		const double dhat = state.args["contact"]["dhat"];
+		const double friction_coefficient = state.args["contact"]["friction_coefficient"];
+		const double epsv = state.args["contact"]["epsv"];
+		const int problem_dim = state.mesh->dimension();
+
+		Eigen::MatrixXd displaced = utils::unflatten(frame.sol, problem_dim);
+		displacement = collision_mesh.vertices(displaced);
+
+		displaced += boundary_nodes_pos;
+		Eigen::MatrixXd displaced_surface = collision_mesh.vertices(displaced);
+
+		ipc::Constraints constraint_set;
+		constraint_set.build(
+			collision_mesh, displaced_surface, dhat,
+			/*dmin=*/0, state.args["solver"]["contact"]["CCD"]["broad_phase"]);
+
+		const double barrier_stiffness = frame.barrier_stiffness;
+
+		contact_forces.resize(0, 0);
+		if (opts.contact_forces)
+		{
+			Eigen::MatrixXd forces = -barrier_stiffness * ipc::compute_barrier_potential_gradient(collision_mesh, displaced_surface, constraint_set, dhat);
+			// forces = collision_mesh.to_full_dof(forces);
+			// assert(forces.size() == sol.size());
+
+			contact_forces = utils::unflatten(forces, problem_dim);
+
+			assert(contact_forces.rows() == displacement.rows());
+			assert(contact_forces.cols() == displacement.cols());
+		}
+
+		friction_forces.resize(0, 0);
+		if (opts.friction_forces)
+		{
+			const Eigen::MatrixXd &displaced_surface_prev = frame.displaced_surface_prev.size() > 0 ? frame.displaced_surface_prev : displaced_surface;
+
+			ipc::FrictionConstraints friction_constraint_set;
+			ipc::construct_friction_constraint_set(
+				collision_mesh, displaced_surface, constraint_set,
+				dhat, barrier_stiffness, friction_coefficient,
+				friction_constraint_set);
+
+			double dt = 1;
+			if (dt_in > 0)
+				dt = dt_in;
+			Eigen::MatrixXd forces = -ipc::compute_friction_potential_gradient(
+				collision_mesh, displaced_surface_prev, displaced_surface,
+				friction_constraint_set, epsv * dt);
+			// forces = collision_mesh.to_full_dof(forces);
+			// assert(forces.size() == sol.size());
+
+			friction_forces = utils::unflatten(forces, problem_dim);
+
+			assert(friction_forces.rows() == displacement.rows());
+			assert(friction_forces.cols() == displacement.cols());
+		}
+	}
+
 	void OutGeometryData::save_surface(
 		const std::string &export_surface,
 		const State &state,
+		const ExportFrame &frame,
 		const double dt_in,
 		const ExportOptions &opts,
 		const bool is_contact_enabled,
 		std::vector<SolutionFrame> &solution_frames) const
 	{
 
-		const Eigen::VectorXi &disc_orders = state.disc_orders;
 		const Density &density = state.assembler.density();
 		const std::vector<basis::ElementBases> &bases = state.bases;
-		const std::vector<basis::ElementBases> &pressure_bases = state.pressure_bases;
 		const std::vector<basis::ElementBases> &gbases = state.geom_bases();
 		const assembler::AssemblerUtils &assembler = state.assembler;
-		const std::string &formulation = state.formulation();
+		const assembler::Formulation &formulation = state.formulation();
 		const mesh::Mesh &mesh = *state.mesh;
 		const ipc::CollisionMesh &collision_mesh = state.collision_mesh;
 		const Eigen::MatrixXd &boundary_nodes_pos = state.boundary_nodes_pos;
-		const double dhat = state.args["contact"]["dhat"];
-		const double friction_coefficient = state.args["contact"]["friction_coefficient"];
-		const double epsv = state.args["contact"]["epsv"];
-		const std::shared_ptr<solver::ContactForm> &contact_form = state.solve_data.contact_form;
-		const std::shared_ptr<solver::FrictionForm> &friction_form = state.solve_data.friction_form;
-		const Eigen::MatrixXd &sol = state.sol;
-		const Eigen::MatrixXd &pressure = state.pressure;
+		const Eigen::MatrixXd &sol = frame.sol;
+		const Eigen::MatrixXd &pressure = frame.pressure;
 		const assembler::Problem &problem = *state.problem;
 
-		Eigen::MatrixXd boundary_vis_vertices;
-		Eigen::MatrixXd boundary_vis_local_vertices;
-		Eigen::MatrixXi boundary_vis_elements;
-		Eigen::MatrixXi boundary_vis_elements_ids;
-		Eigen::MatrixXi boundary_vis_primitive_ids;
-		Eigen::MatrixXd boundary_vis_normals;
-
-		build_vis_boundary_mesh(mesh, bases, gbases, state.total_local_boundary,
-								boundary_vis_vertices, boundary_vis_local_vertices, boundary_vis_elements,
-								boundary_vis_elements_ids, boundary_vis_primitive_ids, boundary_vis_normals);
-
-		Eigen::MatrixXd fun, interp_p, discr, vect, b_sidesets;
+		const std::shared_ptr<const SurfaceVisMesh> vis_mesh = surface_vis_mesh(state);
+		const Eigen::MatrixXd &boundary_vis_vertices = vis_mesh->vertices;
+		const Eigen::MatrixXd &boundary_vis_local_vertices = vis_mesh->local_vertices;
+		const Eigen::MatrixXi &boundary_vis_elements = vis_mesh->elements;
+		const Eigen::MatrixXi &boundary_vis_elements_ids = vis_mesh->elements_ids;
+		const Eigen::MatrixXd &boundary_vis_normals = vis_mesh->normals;
+		const Eigen::MatrixXd &discr = vis_mesh->discr;
+		const Eigen::MatrixXd &b_sidesets = vis_mesh->sidesets;
 
-		Eigen::MatrixXd lsol, lp, lgrad, lpgrad;
+		Eigen::MatrixXd fun, interp_p, vect;
 
 		int actual_dim = 1;
 		if (!problem.is_scalar())
 			actual_dim = mesh.dimension();
 
-		discr.resize(boundary_vis_vertices.rows(), 1);
-		fun.resize(boundary_vis_vertices.rows(), actual_dim);
-		interp_p.resize(boundary_vis_vertices.rows(), 1);
-		vect.resize(boundary_vis_vertices.rows(), mesh.dimension());
-
-		b_sidesets.resize(boundary_vis_vertices.rows(), 1);
-		b_sidesets.setZero();
+		vis_mesh->sol_op.interpolate(sol, actual_dim, fun);
+		if (assembler.is_mixed(formulation))
+			vis_mesh->pressure_op.interpolate(pressure, 1, interp_p);
 
-		for (int i = 0; i < boundary_vis_vertices.rows(); ++i)
+		if (actual_dim == 1)
 		{
-			const auto s_id = mesh.get_boundary_id(boundary_vis_primitive_ids(i));
-			if (s_id > 0)
-			{
-				b_sidesets(i) = s_id;
-			}
-
-			const int el_index = boundary_vis_elements_ids(i);
-			Evaluator::interpolate_at_local_vals(
-				mesh, problem.is_scalar(), bases, gbases,
-				el_index, boundary_vis_local_vertices.row(i), sol, lsol, lgrad);
-			assert(lsol.size() == actual_dim);
-			if (assembler.is_mixed(formulation))
-			{
-				Evaluator::interpolate_at_local_vals(
-					mesh, 1, pressure_bases, gbases,
-					el_index, boundary_vis_local_vertices.row(i), pressure, lp, lpgrad);
-				assert(lp.size() == 1);
-				interp_p(i) = lp(0);
-			}
-
-			discr(i) = disc_orders(el_index);
-			for (int j = 0; j < actual_dim; ++j)
-			{
-				fun(i, j) = lsol(j);
-			}
-
-			if (actual_dim == 1)
-			{
-				assert(lgrad.size() == mesh.dimension());
-				for (int j = 0; j < mesh.dimension(); ++j)
-				{
-					vect(i, j) = lgrad(j);
-				}
-			}
-			else
+			vis_mesh->sol_op.interpolate_grad(sol, 1, vect);
+			assert(vect.cols() == mesh.dimension());
+		}
+		else
+		{
+			vect.resize(boundary_vis_vertices.rows(), mesh.dimension());
+			Eigen::MatrixXd tensor_flat;
+			for (int i = 0; i < boundary_vis_vertices.rows(); ++i)
 			{
-				assert(lgrad.size() == actual_dim * actual_dim);
-				Eigen::MatrixXd tensor_flat;
+				const int el_index = boundary_vis_elements_ids(i);
 				const basis::ElementBases &gbs = gbases[el_index];
 				const basis::ElementBases &bs = bases[el_index];
 				assembler.compute_tensor_value(formulation, el_index, bs, gbs, boundary_vis_local_vertices.row(i), sol, tensor_flat);
@@ -1627,62 +1741,17 @@ namespace polyfem::io
 
 		if (is_contact_enabled && (opts.contact_forces || opts.friction_forces) && opts.solve_export_to_file)
 		{
-			io::VTUWriter writer;
+			io::VTUWriter writer(true, opts.vtu_compression, opts.vtu_float32);
 
 			const int problem_dim = mesh.dimension();
-			Eigen::MatrixXd displaced = utils::unflatten(sol, problem_dim);
+			Eigen::MatrixXd real_vertices, contact_forces, friction_forces;
+			compute_contact_forces(state, frame, dt_in, opts, real_vertices, contact_forces, friction_forces);
 
-			Eigen::MatrixXd real_vertices = collision_mesh.vertices(displaced);
 			writer.add_field("solution", real_vertices);
-
-			displaced += boundary_nodes_pos;
-			Eigen::MatrixXd displaced_surface = collision_mesh.vertices(displaced);
-
-			ipc::Constraints constraint_set;
-			constraint_set.build(
-				collision_mesh, displaced_surface, dhat,
-				/*dmin=*/0, state.args["solver"]["contact"]["CCD"]["broad_phase"]);
-
-			const double barrier_stiffness = contact_form != nullptr ? contact_form->barrier_stiffness() : 1;
-
 			if (opts.contact_forces)
-			{
-				Eigen::MatrixXd forces = -barrier_stiffness * ipc::compute_barrier_potential_gradient(collision_mesh, displaced_surface, constraint_set, dhat);
-				// forces = collision_mesh.to_full_dof(forces);
-				// assert(forces.size() == sol.size());
-
-				Eigen::MatrixXd forces_reshaped = utils::unflatten(forces, problem_dim);
-
-				assert(forces_reshaped.rows() == real_vertices.rows());
-				assert(forces_reshaped.cols() == real_vertices.cols());
-				writer.add_field("contact_forces", forces_reshaped);
-			}
-
+				writer.add_field("contact_forces", contact_forces);
 			if (opts.friction_forces)
-			{
-				Eigen::MatrixXd displaced_surface_prev = (friction_form != nullptr) ? friction_form->displaced_surface_prev() : displaced_surface;
-
-				ipc::FrictionConstraints friction_constraint_set;
-				ipc::construct_friction_constraint_set(
-					collision_mesh, displaced_surface, constraint_set,
-					dhat, barrier_stiffness, friction_coefficient,
-					friction_constraint_set);
-
-				double dt = 1;
-				if (dt_in > 0)
-					dt = dt_in;
-				Eigen::MatrixXd forces = -ipc::compute_friction_potential_gradient(
-					collision_mesh, displaced_surface_prev, displaced_surface,
-					friction_constraint_set, epsv * dt);
-				// forces = collision_mesh.to_full_dof(forces);
-				// assert(forces.size() == sol.size());
-
-				Eigen::MatrixXd forces_reshaped = utils::unflatten(forces, problem_dim);
-
-				assert(forces_reshaped.rows() == real_vertices.rows());
-				assert(forces_reshaped.cols() == real_vertices.cols());
-				writer.add_field("friction_forces", forces_reshaped);
-			}
+				writer.add_field("friction_forces", friction_forces);
 
 			assert(collision_mesh.vertices(boundary_nodes_pos).rows() == real_vertices.rows());
 			assert(collision_mesh.vertices(boundary_nodes_pos).cols() == real_vertices.cols());
@@ -1693,7 +1762,7 @@ namespace polyfem::io
 				problem_dim == 3 ? collision_mesh.faces() : collision_mesh.edges());
 		}
 
-		io::VTUWriter writer;
+		io::VTUWriter writer(true, opts.vtu_compression, opts.vtu_float32);
 
 		if (opts.solve_export_to_file)
 		{
@@ -1779,119 +1848,26 @@ namespace polyfem::io
 	void OutGeometryData::save_wire(
 		const std::string &name,
 		const State &state,
+		const ExportFrame &frame,
 		const double t,
 		const ExportOptions &opts,
 		std::vector<SolutionFrame> &solution_frames) const
 	{
 		const std::vector<basis::ElementBases> &gbases = state.geom_bases();
 		const mesh::Mesh &mesh = *state.mesh;
-		const Eigen::MatrixXd &sol = state.sol;
+		const Eigen::MatrixXd &sol = frame.sol;
 		const assembler::Problem &problem = *state.problem;
 
 		if (!opts.solve_export_to_file) // TODO?
 			return;
-		const auto &sampler = ref_element_sampler;
-
-		const auto &current_bases = gbases;
-		int seg_total_size = 0;
-		int pts_total_size = 0;
-		int faces_total_size = 0;
 
-		for (size_t i = 0; i < current_bases.size(); ++i)
-		{
-			const auto &bs = current_bases[i];
-
-			if (mesh.is_simplex(i))
-			{
-				pts_total_size += sampler.simplex_points().rows();
-				seg_total_size += sampler.simplex_edges().rows();
-				faces_total_size += sampler.simplex_faces().rows();
-			}
-			else if (mesh.is_cube(i))
-			{
-				pts_total_size += sampler.cube_points().rows();
-				seg_total_size += sampler.cube_edges().rows();
-			}
-			// TODO add edges for poly
-		}
-
-		Eigen::MatrixXd points(pts_total_size, mesh.dimension());
-		Eigen::MatrixXi edges(seg_total_size, 2);
-		Eigen::MatrixXi faces(faces_total_size, 3);
-		points.setZero();
-
-		Eigen::MatrixXd mapped, tmp;
-		int seg_index = 0, pts_index = 0, face_index = 0;
-		for (size_t i = 0; i < current_bases.size(); ++i)
-		{
-			const auto &bs = current_bases[i];
-
-			if (mesh.is_simplex(i))
-			{
-				bs.eval_geom_mapping(sampler.simplex_points(), mapped);
-				edges.block(seg_index, 0, sampler.simplex_edges().rows(), edges.cols()) = sampler.simplex_edges().array() + pts_index;
-				seg_index += sampler.simplex_edges().rows();
-
-				faces.block(face_index, 0, sampler.simplex_faces().rows(), 3) = sampler.simplex_faces().array() + pts_index;
-				face_index += sampler.simplex_faces().rows();
-
-				points.block(pts_index, 0, mapped.rows(), points.cols()) = mapped;
-				pts_index += mapped.rows();
-			}
-			else if (mesh.is_cube(i))
-			{
-				bs.eval_geom_mapping(sampler.cube_points(), mapped);
-				edges.block(seg_index, 0, sampler.cube_edges().rows(), edges.cols()) = sampler.cube_edges().array() + pts_index;
-				seg_index += sampler.cube_edges().rows();
-
-				points.block(pts_index, 0, mapped.rows(), points.cols()) = mapped;
-				pts_index += mapped.rows();
-			}
-		}
-
-		assert(pts_index == points.rows());
-		assert(face_index == faces.rows());
-
-		if (mesh.is_volume())
-		{
-			// reverse all faces
-			for (long i = 0; i < faces.rows(); ++i)
-			{
-				const int v0 = faces(i, 0);
-				const int v1 = faces(i, 1);
-				const int v2 = faces(i, 2);
-
-				int tmpc = faces(i, 2);
-				faces(i, 2) = faces(i, 1);
-				faces(i, 1) = tmpc;
-			}
-		}
-		else
-		{
-			Eigen::Matrix2d mmat;
-			for (long i = 0; i < faces.rows(); ++i)
-			{
-				const int v0 = faces(i, 0);
-				const int v1 = faces(i, 1);
-				const int v2 = faces(i, 2);
-
-				mmat.row(0) = points.row(v2) - points.row(v0);
-				mmat.row(1) = points.row(v1) - points.row(v0);
-
-				if (mmat.determinant() > 0)
-				{
-					int tmpc = faces(i, 2);
-					faces(i, 2) = faces(i, 1);
-					faces(i, 1) = tmpc;
-				}
-			}
-		}
+		const std::shared_ptr<const WireVisMesh> vis_mesh = wire_vis_mesh(state);
+		Eigen::MatrixXd points = vis_mesh->points;
+		const Eigen::MatrixXi &edges = vis_mesh->edges;
+		const int pts_index = points.rows();
 
 		Eigen::MatrixXd fun;
-		Evaluator::interpolate_function(
-			mesh, problem.is_scalar(), state.bases, state.disc_orders,
-			state.polys, state.polys_3d, ref_element_sampler,
-			pts_index, sol, fun, /*use_sampler*/ true, false);
+		vis_mesh->sol_op.interpolate(sol, problem.is_scalar() ? 1 : mesh.dimension(), fun);
 
 		Eigen::MatrixXd exact_fun, err;
 
@@ -1916,7 +1892,7 @@ namespace polyfem::io
 			points.col(2).setZero();
 		}
 
-		io::VTUWriter writer;
+		io::VTUWriter writer(true, opts.vtu_compression, opts.vtu_float32);
 		writer.add_field("solution", fun);
 		if (problem.has_exact_sol())
 		{
@@ -1938,40 +1914,82 @@ namespace polyfem::io
 		writer.write_mesh(name, points, edges);
 	}
 
+	void OutGeometryData::save_hdf5(
+		HDF5Writer &writer,
+		const State &state,
+		const ExportFrame &frame,
+		const double t,
+		const double dt,
+		const ExportOptions &opts,
+		const bool is_contact_enabled) const
+	{
+		if (state.obstacle.n_vertices() > 0 && writer.n_time_steps() == 0)
+			logger().warn("The obstacles are not exported to HDF5");
+
+		// the fields of save_volume on the linear mesh of the sampler (a single cell type), without the files of the other outputs
+		ExportOptions volume_opts = opts;
+		volume_opts.use_sampler = true;
+		volume_opts.solve_export_to_file = false;
+		volume_opts.velocity = true;
+		volume_opts.acceleration = true;
+		volume_opts.material_params = false;
+		volume_opts.body_ids = false;
+		volume_opts.sol_on_grid = false;
+
+		std::vector<SolutionFrame> frames(1);
+		save_volume("volume", state, frame, t, volume_opts, frames);
+
+		writer.begin_time_step(t);
+		frames.back().write(writer, "volume");
+
+		if (is_contact_enabled && (opts.contact_forces || opts.friction_forces))
+		{
+			const ipc::CollisionMesh &collision_mesh = state.collision_mesh;
+			if (!writer.has_mesh("contact"))
+				writer.write_mesh(
+					"contact", collision_mesh.vertices(state.boundary_nodes_pos),
+					state.mesh->dimension() == 3 ? collision_mesh.faces() : collision_mesh.edges());
+
+			Eigen::MatrixXd displacement, contact_forces, friction_forces;
+			compute_contact_forces(state, frame, dt, opts, displacement, contact_forces, friction_forces);
+
+			writer.add_field("contact", "solution", to_3d_vectors(displacement));
+			if (opts.contact_forces)
+				writer.add_field("contact", "contact_forces", to_3d_vectors(contact_forces));
+			if (opts.friction_forces)
+				writer.add_field("contact", "friction_forces", to_3d_vectors(friction_forces));
+		}
+
+		writer.end_time_step();
+	}
+
 	void OutGeometryData::save_pvd(
 		const std::string &name,
 		const std::function<std::string(int)> &vtu_names,
 		int time_steps, double t0, double dt, int skip_frame) const
 	{
-		// https://www.paraview.org/Wiki/ParaView/Data_formats#PVD_File_Format
+		std::lock_guard<std::mutex> lock(pvd_mutex);
 
-		tinyxml2::XMLDocument pvd;
-		pvd.InsertEndChild(pvd.NewDeclaration());
-
-		tinyxml2::XMLElement *root = pvd.NewElement("VTKFile");
-		pvd.InsertEndChild(root);
-		root->SetAttribute("type", "Collection");
-		root->SetAttribute("version", "0.1");
-		root->SetAttribute("byte_order", "LittleEndian");
-		root->SetAttribute("compressor", "vtkZLibDataCompressor");
-
-		tinyxml2::XMLElement *collection = root->InsertNewChildElement("Collection");
-
-		for (int i = 0; i <= time_steps; i += skip_frame)
+		// appending is linear in the number of new frames instead of rewriting the whole collection
+		if (!pvd_writer || pvd_writer->path() != name || time_steps <= pvd_last_frame)
 		{
-			tinyxml2::XMLElement *dataset = collection->InsertNewChildElement("DataSet");
-			dataset->SetAttribute("timestep", fmt::format("{:g}", t0 + i * dt).c_str());
-			dataset->SetAttribute("group", "");
-			dataset->SetAttribute("part", "0");
-			dataset->SetAttribute("file", vtu_names(i).c_str());
+			pvd_writer = std::make_unique<PVDWriter>(name);
+			pvd_last_frame = -1;
 		}
 
-		pvd.SaveFile(name.c_str());
+		const int first = pvd_last_frame < 0 ? 0 : (pvd_last_frame + skip_frame);
+		for (int i = first; i <= time_steps; i += skip_frame)
+		{
+			if (!pvd_writer->add_dataset(t0 + i * dt, vtu_names(i)))
+				return;
+			pvd_last_frame = i;
+		}
 	}
 
 	void OutGeometryData::init_sampler(const polyfem::mesh::Mesh &mesh, const double vismesh_rel_area)
 	{
 		ref_element_sampler.init(mesh.is_volume(), mesh.n_elements(), vismesh_rel_area);
+		clear_vis_meshes();
 	}
 
 	void OutGeometryData::build_grid(const polyfem::mesh::Mesh &mesh, const double spacing)
@@ -2072,6 +2090,181 @@ namespace polyfem::io
 		}
 	}
 
+	void OutGeometryData::clear_vis_meshes()
+	{
+		std::lock_guard<std::mutex> lock(vis_meshes_mutex);
+		cached_volume_meshes.clear();
+		cached_surface_mesh.reset();
+		cached_wire_mesh.reset();
+		cached_grid_operators.reset();
+	}
+
+	std::shared_ptr<const OutGeometryData::VolumeVisMesh> OutGeometryData::volume_vis_mesh(const State &state, const ExportOptions &opts) const
+	{
+		std::lock_guard<std::mutex> lock(vis_meshes_mutex);
+		std::shared_ptr<const VolumeVisMesh> &cached = cached_volume_meshes[std::make_pair(opts.use_sampler, opts.boundary_only)];
+		if (cached)
+			return cached;
+
+		POLYFEM_SCOPED_TIMER("Building volume visualization mesh");
+
+		const mesh::Mesh &mesh = *state.mesh;
+		const std::vector<basis::ElementBases> &gbases = state.geom_bases();
+		auto vis_mesh = std::make_shared<VolumeVisMesh>();
+
+		if (opts.use_sampler)
+			build_vis_mesh(mesh, state.disc_orders, gbases,
+						   state.polys, state.polys_3d, opts.boundary_only,
+						   vis_mesh->points, vis_mesh->tets, vis_mesh->el_id, vis_mesh->discr);
+		else
+			build_high_oder_vis_mesh(mesh, state.disc_orders, state.bases,
+									 vis_mesh->points, vis_mesh->elements, vis_mesh->el_id, vis_mesh->discr);
+
+		const Eigen::VectorXi el_id = vis_mesh->el_id.col(0);
+		const Eigen::MatrixXd local_pts = vis_local_points(
+			mesh, state.disc_orders, state.polys, state.polys_3d,
+			ref_element_sampler, opts.use_sampler, vis_mesh->el_id);
+
+		vis_mesh->sol_op.init(mesh.is_volume(), state.n_bases, state.bases, gbases, el_id, local_pts, false);
+		// FIXME: the points of the high-order mesh use the discr orders of the solution
+		if (state.assembler.is_mixed(state.formulation()))
+			vis_mesh->pressure_op.init(mesh.is_volume(), state.n_pressure_bases, state.pressure_bases, gbases, el_id, local_pts, false);
+
+		cached = vis_mesh;
+		return cached;
+	}
+
+	std::shared_ptr<const OutGeometryData::SurfaceVisMesh> OutGeometryData::surface_vis_mesh(const State &state) const
+	{
+		std::lock_guard<std::mutex> lock(vis_meshes_mutex);
+		if (cached_surface_mesh)
+			return cached_surface_mesh;
+
+		POLYFEM_SCOPED_TIMER("Building surface visualization mesh");
+
+		const mesh::Mesh &mesh = *state.mesh;
+		const std::vector<basis::ElementBases> &gbases = state.geom_bases();
+		auto vis_mesh = std::make_shared<SurfaceVisMesh>();
+
+		build_vis_boundary_mesh(mesh, state.bases, gbases, state.total_local_boundary,
+								vis_mesh->vertices, vis_mesh->local_vertices, vis_mesh->elements,
+								vis_mesh->elements_ids, vis_mesh->primitive_ids, vis_mesh->normals);
+
+		const int n_vertices = vis_mesh->vertices.rows();
+		vis_mesh->discr.resize(n_vertices, 1);
+		vis_mesh->sidesets.setZero(n_vertices, 1);
+		for (int i = 0; i < n_vertices; ++i)
+		{
+			const auto s_id = mesh.get_boundary_id(vis_mesh->primitive_ids(i));
+			if (s_id > 0)
+				vis_mesh->sidesets(i) = s_id;
+
+			vis_mesh->discr(i) = state.disc_orders(vis_mesh->elements_ids(i));
+		}
+
+		// the gradient of scalar solutions is exported
+		const Eigen::VectorXi el_id = vis_mesh->elements_ids.col(0);
+		vis_mesh->sol_op.init(mesh.is_volume(), state.n_bases, state.bases, gbases, el_id, vis_mesh->local_vertices, state.problem->is_scalar());
+		if (state.assembler.is_mixed(state.formulation()))
+			vis_mesh->pressure_op.init(mesh.is_volume(), state.n_pressure_bases, state.pressure_bases, gbases, el_id, vis_mesh->local_vertices, false);
+
+		cached_surface_mesh = vis_mesh;
+		return cached_surface_mesh;
+	}
+
+	std::shared_ptr<const OutGeometryData::WireVisMesh> OutGeometryData::wire_vis_mesh(const State &state) const
+	{
+		std::lock_guard<std::mutex> lock(vis_meshes_mutex);
+		if (cached_wire_mesh)
+			return cached_wire_mesh;
+
+		POLYFEM_SCOPED_TIMER("Building wire visualization mesh");
+
+		const mesh::Mesh &mesh = *state.mesh;
+		const std::vector<basis::ElementBases> &gbases = state.geom_bases();
+		const auto &sampler = ref_element_sampler;
+		auto vis_mesh = std::make_shared<WireVisMesh>();
+
+		int seg_total_size = 0;
+		int pts_total_size = 0;
+
+		for (size_t i = 0; i < gbases.size(); ++i)
+		{
+			if (mesh.is_simplex(i))
+			{
+				pts_total_size += sampler.simplex_points().rows();
+				seg_total_size += sampler.simplex_edges().rows();
+			}
+			else if (mesh.is_cube(i))
+			{
+				pts_total_size += sampler.cube_points().rows();
+				seg_total_size += sampler.cube_edges().rows();
+			}
+			// TODO add edges for poly
+		}
+
+		Eigen::MatrixXd &points = vis_mesh->points;
+		Eigen::MatrixXi &edges = vis_mesh->edges;
+		points.setZero(pts_total_size, mesh.dimension());
+		edges.resize(seg_total_size, 2);
+
+		Eigen::VectorXi el_id(pts_total_size);
+		Eigen::MatrixXd local_pts(pts_total_size, mesh.dimension());
+
+		Eigen::MatrixXd mapped;
+		int seg_index = 0, pts_index = 0;
+		for (size_t i = 0; i < gbases.size(); ++i)
+		{
+			const auto &bs = gbases[i];
+
+			if (!mesh.is_simplex(i) && !mesh.is_cube(i))
+				continue;
+
+			const Eigen::MatrixXd &ref_pts = mesh.is_simplex(i) ? sampler.simplex_points() : sampler.cube_points();
+			const Eigen::MatrixXi &ref_edges = mesh.is_simplex(i) ? sampler.simplex_edges() : sampler.cube_edges();
+
+			bs.eval_geom_mapping(ref_pts, mapped);
+			edges.block(seg_index, 0, ref_edges.rows(), edges.cols()) = ref_edges.array() + pts_index;
+			seg_index += ref_edges.rows();
+
+			points.block(pts_index, 0, mapped.rows(), points.cols()) = mapped;
+			local_pts.block(pts_index, 0, mapped.rows(), local_pts.cols()) = ref_pts;
+			el_id.segment(pts_index, mapped.rows()).setConstant(i);
+			pts_index += mapped.rows();
+		}
+
+		assert(pts_index == points.rows());
+		assert(seg_index == edges.rows());
+
+		vis_mesh->sol_op.init(mesh.is_volume(), state.n_bases, state.bases, gbases, el_id, local_pts, false);
+
+		cached_wire_mesh = vis_mesh;
+		return cached_wire_mesh;
+	}
+
+	std::shared_ptr<const OutGeometryData::GridOperators> OutGeometryData::grid_operators(const State &state) const
+	{
+		std::lock_guard<std::mutex> lock(vis_meshes_mutex);
+		if (cached_grid_operators)
+			return cached_grid_operators;
+
+		const mesh::Mesh &mesh = *state.mesh;
+		const std::vector<basis::ElementBases> &gbases = state.geom_bases();
+		auto grid_ops = std::make_shared<GridOperators>();
+
+		// the local coordinates are the barycentric coordinates without the first one
+		const Eigen::VectorXi el_id = grid_points_to_elements.col(0);
+		const Eigen::MatrixXd local_pts = grid_points_bc.rightCols(grid_points_bc.cols() - 1);
+		assert(local_pts.cols() == mesh.dimension());
+
+		grid_ops->sol_op.init(mesh.is_volume(), state.n_bases, state.bases, gbases, el_id, local_pts, true);
+		if (state.assembler.is_mixed(state.formulation()))
+			grid_ops->pressure_op.init(mesh.is_volume(), state.n_pressure_bases, state.pressure_bases, gbases, el_id, local_pts, true);
+
+		cached_grid_operators = grid_ops;
+		return cached_grid_operators;
+	}
+
 	void OutStatsData::compute_mesh_size(const polyfem::mesh::Mesh &mesh_in, const std::vector<polyfem::basis::ElementBases> &bases_in, const int n_samples, const bool use_curved_mesh_size)
 	{
 		Eigen::MatrixXd samples_simplex, samples_cube, mapped, p0, p1, p;
@@ -2480,7 +2673,7 @@ namespace polyfem::io
 		const Eigen::VectorXi &disc_orders,
 		const assembler::Problem &problem,
 		const OutRuntimeData &runtime,
-		const std::string &formulation,
+		const assembler::Formulation &formulation,
 		const bool isoparametric,
 		const int sol_at_node_id,
 		nlohmann::json &j)
@@ -2537,9 +2730,16 @@ namespace polyfem::io
 		j["time_assembling_stiffness_mat"] = runtime.assembling_stiffness_mat_time;
 		j["time_assigning_rhs"] = runtime.assigning_rhs_time;
 		j["time_solving"] = runtime.solving_time;
+		if (!runtime.time_step_solving_times.empty())
+		{
+			j["time_factorizing"] = runtime.factorizing_time;
+			j["num_factorizations"] = runtime.n_factorizations;
+			j["time_steps_solving"] = runtime.time_step_solving_times;
+		}
 		// j["time_computing_errors"] = runtime.computing_errors_time;
 
 		j["solver_info"] = solver_info;
+		j["assembly_cache"] = assembly_cache_info;
 
 		j["count_simplex"] = simplex_count;
 		j["count_regular"] = regular_count;
@@ -2600,7 +2800,7 @@ namespace polyfem::io
 		j["num_threads"] = 1;
 #endif
 
-		j["formulation"] = formulation;
+		j["formulation"] = formulation.name();
 
 		logger().info("done");
 	}
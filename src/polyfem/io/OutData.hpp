@@ -6,12 +6,19 @@
 
 #include <polyfem/basis/ElementBases.hpp>
 
+#include <polyfem/io/InterpolationOperator.hpp>
+#include <polyfem/io/PVDWriter.hpp>
+
 #include <polyfem/mesh/Mesh.hpp>
 
 #include <polyfem/utils/RefElementSampler.hpp>
 
 #include <Eigen/Dense>
 
+#include <map>
+#include <memory>
+#include <mutex>
+
 namespace polyfem
 {
 	class State;
@@ -19,6 +26,9 @@ namespace polyfem
 
 namespace polyfem::io
 {
+	enum class VTKCompression;
+	class HDF5Writer;
+
 	/// class used to save the solution of time dependent problems in code instead of saving it to the disc
 	class SolutionFrame
 	{
@@ -32,6 +42,35 @@ namespace polyfem::io
 		Eigen::MatrixXd error;
 		Eigen::MatrixXd scalar_value;
 		Eigen::MatrixXd scalar_value_avg;
+		Eigen::MatrixXd velocity;
+		Eigen::MatrixXd acceleration;
+		/// flattened stress tensor, column i * dim + j is the entry (i, j)
+		Eigen::MatrixXd tensor_value;
+
+		/// @brief writes the fields of the frame in the current time step of an HDF5 time series
+		/// @param[in] writer time series, the points and connectivity are written as the mesh at the first frame
+		/// @param[in] mesh name of the mesh of the frame in the file
+		void write(HDF5Writer &writer, const std::string &mesh) const;
+	};
+
+	/// values of the state that change at every time step, copied when a frame is exported
+	/// so that the frame can be written while the simulation continues (see AsyncWriter)
+	class ExportFrame
+	{
+	public:
+		/// @brief copies the current values of the state
+		/// @param[in] state state to get the data
+		explicit ExportFrame(const State &state);
+
+		Eigen::MatrixXd sol;
+		Eigen::MatrixXd pressure;
+		/// velocity and acceleration of the time integrator, empty if there is none
+		Eigen::VectorXd velocity;
+		Eigen::VectorXd acceleration;
+		/// barrier stiffness of the contact form, 1 if there is none
+		double barrier_stiffness = 1;
+		/// displaced surface at the start of the time step of the friction form, empty if there is none
+		Eigen::MatrixXd displaced_surface_prev;
 	};
 
 	/// Utilies related to export of geometry
@@ -58,6 +97,11 @@ namespace polyfem::io
 			bool use_spline;
 			bool reorder_output;
 
+			/// compression of the binary arrays of the vtu files
+			VTKCompression vtu_compression;
+			/// if the fields of the vtu files are in single precision
+			bool vtu_float32;
+
 			bool solve_export_to_file;
 
 			/// @brief initialize the flags based on the input args
@@ -98,6 +142,10 @@ namespace polyfem::io
 		/// @param[in] spacing grid spacing, <=0 mean no grid
 		void build_grid(const polyfem::mesh::Mesh &mesh, const double spacing);
 
+		/// @brief removes the visualization meshes and interpolation operators built by the exports,
+		/// they are rebuilt at the next export (call it when the bases change)
+		void clear_vis_meshes();
+
 		/// @brief exports everytihng, txt, vtu, etc
 		/// @param[in] state state to get the data
 		/// @param[in] is_time_dependent if the sim is time dependent
@@ -141,14 +189,34 @@ namespace polyfem::io
 					  const bool is_contact_enabled,
 					  std::vector<SolutionFrame> &solution_frames) const;
 
+		/// saves the vtu file for time t of a frame copied from the state
+		/// @param[in] path filename
+		/// @param[in] state state to get the data that does not change in time (mesh, bases, etc)
+		/// @param[in] frame values of the time step
+		/// @param[in] t time
+		/// @param[in] dt delta t
+		/// @param[in] opts export options
+		/// @param[in] is_contact_enabled if contact is enabled
+		/// @param[out] solution_frames saves the output here instead of vtu
+		void save_vtu(const std::string &path,
+					  const State &state,
+					  const ExportFrame &frame,
+					  const double t,
+					  const double dt,
+					  const ExportOptions &opts,
+					  const bool is_contact_enabled,
+					  std::vector<SolutionFrame> &solution_frames) const;
+
 		/// saves the volume vtu file
 		/// @param[in] path filename
 		/// @param[in] state state to get the data
+		/// @param[in] frame values of the time step
 		/// @param[in] t time
 		/// @param[in] opts export options
 		/// @param[out] solution_frames saves the output here instead of vtu
 		void save_volume(const std::string &path,
 						 const State &state,
+						 const ExportFrame &frame,
 						 const double t,
 						 const ExportOptions &opts,
 						 std::vector<SolutionFrame> &solution_frames) const;
@@ -156,12 +224,14 @@ namespace polyfem::io
 		/// saves the surface vtu file for for surface quantites, eg traction forces
 		/// @param[in] export_surface filename
 		/// @param[in] state state to get the data
+		/// @param[in] frame values of the time step
 		/// @param[in] dt_in delta_t
 		/// @param[in] opts export options
 		/// @param[in] is_contact_enabled if contact is enabled
 		/// @param[out] solution_frames saves the output here instead of vtu
 		void save_surface(const std::string &export_surface,
 						  const State &state,
+						  const ExportFrame &frame,
 						  const double dt_in,
 						  const ExportOptions &opts,
 						  const bool is_contact_enabled,
@@ -170,16 +240,38 @@ namespace polyfem::io
 		/// saves the wireframe
 		/// @param[in] name filename
 		/// @param[in] state state to get the data
+		/// @param[in] frame values of the time step
 		/// @param[in] t time
 		/// @param[in] opts export options
 		/// @param[out] solution_frames saves the output here instead of vtu
 		void save_wire(const std::string &name,
 					   const State &state,
+					   const ExportFrame &frame,
 					   const double t,
 					   const ExportOptions &opts,
 					   std::vector<SolutionFrame> &solution_frames) const;
 
-		/// save a PVD of a time dependent simulation
+		/// appends the time step t to an HDF5 time series, the meshes are written at the first step.
+		/// The volume is sampled on the linear visualization mesh (the fields of save_volume), the
+		/// contact and friction forces are written on the collision mesh
+		/// @param[in] writer time series
+		/// @param[in] state state to get the data that does not change in time (mesh, bases, etc)
+		/// @param[in] frame values of the time step
+		/// @param[in] t time
+		/// @param[in] dt delta t
+		/// @param[in] opts export options
+		/// @param[in] is_contact_enabled if contact is enabled
+		void save_hdf5(HDF5Writer &writer,
+					   const State &state,
+					   const ExportFrame &frame,
+					   const double t,
+					   const double dt,
+					   const ExportOptions &opts,
+					   const bool is_contact_enabled) const;
+
+		/// save a PVD of a time dependent simulation, the frames 0 to time_steps are listed.
+		/// The collection stays open between the calls and only the new frames are appended,
+		/// it is rewritten if the file changes or time_steps restarts
 		/// @param[in] name filename
 		/// @param[in] vtu_names names of the vtu files
 		/// @param[in] time_steps total time stesp
@@ -190,6 +282,23 @@ namespace polyfem::io
 					  int time_steps, double t0, double dt, int skip_frame = 1) const;
 
 	private:
+		/// computes the contact and friction forces at the vertices of the collision mesh
+		/// @param[in] state state to get the collision mesh and the contact parameters
+		/// @param[in] frame values of the time step
+		/// @param[in] dt_in delta t, used by the friction
+		/// @param[in] opts export options, only the requested forces are computed
+		/// @param[out] displacement #V x dim displacement of the vertices
+		/// @param[out] contact_forces #V x dim contact forces, empty if not requested
+		/// @param[out] friction_forces #V x dim friction forces, empty if not requested
+		static void compute_contact_forces(
+			const State &state,
+			const ExportFrame &frame,
+			const double dt_in,
+			const ExportOptions &opts,
+			Eigen::MatrixXd &displacement,
+			Eigen::MatrixXd &contact_forces,
+			Eigen::MatrixXd &friction_forces);
+
 		/// used to sample the solution
 		utils::RefElementSampler ref_element_sampler;
 
@@ -200,6 +309,77 @@ namespace polyfem::io
 		/// grid mesh boundaries
 		Eigen::MatrixXd grid_points_bc;
 
+		/// visualization mesh of the volume and the operators sampling the fields at its vertices
+		struct VolumeVisMesh
+		{
+			Eigen::MatrixXd points;
+			Eigen::MatrixXi tets;
+			/// high-order cells, empty if the mesh is built with the sampler
+			std::vector<std::vector<int>> elements;
+			Eigen::MatrixXi el_id;
+			Eigen::MatrixXd discr;
+			InterpolationOperator sol_op;
+			/// empty if the formulation is not mixed
+			InterpolationOperator pressure_op;
+		};
+
+		/// visualization mesh of the boundary and the operators sampling the fields at its vertices
+		struct SurfaceVisMesh
+		{
+			Eigen::MatrixXd vertices;
+			Eigen::MatrixXd local_vertices;
+			Eigen::MatrixXi elements;
+			Eigen::MatrixXi elements_ids;
+			Eigen::MatrixXi primitive_ids;
+			Eigen::MatrixXd normals;
+			Eigen::MatrixXd discr;
+			Eigen::MatrixXd sidesets;
+			/// with the gradients for scalar problems
+			InterpolationOperator sol_op;
+			InterpolationOperator pressure_op;
+		};
+
+		/// wireframe of the elements and the operator sampling the solution at its vertices
+		struct WireVisMesh
+		{
+			Eigen::MatrixXd points;
+			Eigen::MatrixXi edges;
+			InterpolationOperator sol_op;
+		};
+
+		/// operators sampling the fields and their gradients at the grid points
+		struct GridOperators
+		{
+			InterpolationOperator sol_op;
+			InterpolationOperator pressure_op;
+		};
+
+		/// collection of the time steps, appended by save_pvd
+		mutable std::mutex pvd_mutex;
+		mutable std::unique_ptr<PVDWriter> pvd_writer;
+		/// last frame in the collection
+		mutable int pvd_last_frame = -1;
+
+		/// the meshes and operators do not change in time, they are built at the first export
+		/// (possibly on the thread of the AsyncWriter) and reused by the following frames
+		mutable std::mutex vis_meshes_mutex;
+		/// volume meshes by use_sampler and boundary_only
+		mutable std::map<std::pair<bool, bool>, std::shared_ptr<const VolumeVisMesh>> cached_volume_meshes;
+		mutable std::shared_ptr<const SurfaceVisMesh> cached_surface_mesh;
+		mutable std::shared_ptr<const WireVisMesh> cached_wire_mesh;
+		mutable std::shared_ptr<const GridOperators> cached_grid_operators;
+
+		/// @brief returns the cached visualization mesh of the volume, builds it if needed
+		/// @param[in] state state to get the mesh and bases
+		/// @param[in] opts export options (use_sampler and boundary_only)
+		std::shared_ptr<const VolumeVisMesh> volume_vis_mesh(const State &state, const ExportOptions &opts) const;
+		/// @brief returns the cached visualization mesh of the boundary, builds it if needed
+		std::shared_ptr<const SurfaceVisMesh> surface_vis_mesh(const State &state) const;
+		/// @brief returns the cached wireframe, builds it if needed
+		std::shared_ptr<const WireVisMesh> wire_vis_mesh(const State &state) const;
+		/// @brief returns the cached grid operators, builds them if needed
+		std::shared_ptr<const GridOperators> grid_operators(const State &state) const;
+
 		/// @brief builds the boundary mesh for visualization
 		/// @param[in] mesh mesh
 		/// @param[in] bases bases
@@ -285,6 +465,12 @@ namespace polyfem::io
 		double assigning_rhs_time;
 		/// time to solve
 		double solving_time;
+		/// time to factorize the system of the transient linear problems, summed over the factorizations
+		double factorizing_time = 0;
+		/// number of factorizations of the system of the transient linear problems
+		int n_factorizations = 0;
+		/// time to solve every time step of the transient linear problems
+		std::vector<double> time_step_solving_times;
 
 		/// @brief computes total time
 		/// @return total time
@@ -305,6 +491,9 @@ namespace polyfem::io
 		/// the informations varies depending on the solver
 		json solver_info;
 
+		/// storage mode, memory (in bytes) and building time of the assembly values cache
+		json assembly_cache_info;
+
 		/// max edge lenght
 		double mesh_size;
 		/// min edge lenght
@@ -408,7 +597,7 @@ namespace polyfem::io
 					   const Eigen::VectorXi &disc_orders,
 					   const assembler::Problem &problem,
 					   const OutRuntimeData &runtime,
-					   const std::string &formulation,
+					   const assembler::Formulation &formulation,
 					   const bool isoparametric,
 					   const int sol_at_node_id,
 					   nlohmann::json &j);
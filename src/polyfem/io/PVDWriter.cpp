@@ -0,0 +1,84 @@
+#include "PVDWriter.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+namespace polyfem
+{
+	namespace io
+	{
+		namespace
+		{
+			std::string escape_attribute(const std::string &value)
+			{
+				std::string res;
+				res.reserve(value.size());
+				for (const char c : value)
+				{
+					switch (c)
+					{
+					case '&':
+						res += "&amp;";
+						break;
+					case '<':
+						res += "&lt;";
+						break;
+					case '>':
+						res += "&gt;";
+						break;
+					case '"':
+						res += "&quot;";
+						break;
+					default:
+						res += c;
+					}
+				}
+				return res;
+			}
+		} // namespace
+
+		PVDWriter::PVDWriter(const std::string &path)
+			: path_(path), file_(path, std::ios::out | std::ios::trunc | std::ios::binary)
+		{
+			if (!file_.good())
+			{
+				logger().error("Unable to open {} for writing", path);
+				return;
+			}
+
+			file_ << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+			file_ << "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+			file_ << "    <Collection>\n";
+			footer_pos_ = file_.tellp();
+			write_footer();
+		}
+
+		bool PVDWriter::add_dataset(const double time, const std::string &file)
+		{
+			if (!file_.good())
+				return false;
+
+			// the entry and the new footer are longer than the old footer, nothing is left of it
+			file_.seekp(footer_pos_);
+			file_ << "        <DataSet timestep=\"" << fmt::format("{:g}", time)
+				  << "\" group=\"\" part=\"0\" file=\"" << escape_attribute(file) << "\"/>\n";
+			footer_pos_ = file_.tellp();
+			write_footer();
+
+			if (!file_.good())
+			{
+				logger().error("Unable to write to {}", path_);
+				return false;
+			}
+
+			++size_;
+			return true;
+		}
+
+		void PVDWriter::write_footer()
+		{
+			file_ << "    </Collection>\n";
+			file_ << "</VTKFile>\n";
+			file_.flush();
+		}
+	} // namespace io
+} // namespace polyfem
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+namespace polyfem
+{
+	namespace io
+	{
+		/// @brief Append-only writer of a ParaView collection (.pvd) of time steps.
+		///
+		/// Every dataset is written over the footer of the collection followed by a new footer, so
+		/// adding a time step costs the size of one entry and the file is a valid collection after
+		/// every call (https://www.paraview.org/Wiki/ParaView/Data_formats#PVD_File_Format).
+		class PVDWriter
+		{
+		public:
+			/// @brief Creates (or truncates) the collection and writes an empty collection
+			/// @param[in] path path of the .pvd file
+			explicit PVDWriter(const std::string &path);
+
+			PVDWriter(const PVDWriter &) = delete;
+			PVDWriter &operator=(const PVDWriter &) = delete;
+
+			/// @brief Appends a dataset to the collection
+			/// @param[in] time time of the dataset
+			/// @param[in] file file of the dataset, relative to the collection
+			/// @return false if the file could not be written
+			bool add_dataset(const double time, const std::string &file);
+
+			const std::string &path() const { return path_; }
+			/// number of datasets in the collection
+			int size() const { return size_; }
+			bool good() const { return file_.good(); }
+
+		private:
+			// writes the footer at the current position and flushes
+			void write_footer();
+
+			std::string path_;
+			std::ofstream file_;
+			/// position of the footer, overwritten by the next dataset
+			std::streampos footer_pos_;
+			int size_ = 0;
+		};
+	} // namespace io
+} // namespace polyfem
@@ -1,6 +1,19 @@
 #include "VTUWriter.hpp"
 
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/base64Layer.hpp>
+
+#ifdef POLYFEM_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef POLYFEM_WITH_LZ4
+#include <lz4.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 
 namespace polyfem
 {
@@ -64,11 +77,164 @@ namespace polyfem
 						return VTK_LAGRANGE_QUADRILATERAL;
 				}
 			}
+
+			// default block size of vtkXMLWriter
+			static const size_t VTK_BLOCK_SIZE = 32768;
+
+			size_t compress_bound(const size_t n_bytes, const VTKCompression compression)
+			{
+				switch (compression)
+				{
+#ifdef POLYFEM_WITH_ZLIB
+				case VTKCompression::ZLib:
+					return compressBound(n_bytes);
+#endif
+#ifdef POLYFEM_WITH_LZ4
+				case VTKCompression::LZ4:
+					return LZ4_compressBound(int(n_bytes));
+#endif
+				default:
+					return n_bytes;
+				}
+			}
+
+			// compresses a block as vtkZLibDataCompressor/vtkLZ4DataCompressor, returns the compressed size
+			size_t compress_block(const char *data, const size_t n_bytes, char *out, const size_t capacity, const VTKCompression compression)
+			{
+				switch (compression)
+				{
+#ifdef POLYFEM_WITH_ZLIB
+				case VTKCompression::ZLib:
+				{
+					uLongf size = capacity;
+					if (compress2(reinterpret_cast<Bytef *>(out), &size, reinterpret_cast<const Bytef *>(data), n_bytes, Z_DEFAULT_COMPRESSION) != Z_OK)
+						log_and_throw_error("Unable to compress a VTU data array with zlib");
+					return size;
+				}
+#endif
+#ifdef POLYFEM_WITH_LZ4
+				case VTKCompression::LZ4:
+				{
+					const int size = LZ4_compress_default(data, out, int(n_bytes), int(capacity));
+					if (size <= 0)
+						log_and_throw_error("Unable to compress a VTU data array with LZ4");
+					return size;
+				}
+#endif
+				default:
+					assert(n_bytes <= capacity);
+					std::copy(data, data + n_bytes, out);
+					return n_bytes;
+				}
+			}
+
+			const char *compressor_name(const VTKCompression compression)
+			{
+				switch (compression)
+				{
+				case VTKCompression::ZLib:
+					return "vtkZLibDataCompressor";
+				case VTKCompression::LZ4:
+					return "vtkLZ4DataCompressor";
+				default:
+					return "";
+				}
+			}
 		} // namespace
 
-		VTUWriter::VTUWriter(bool binary)
-			: binary_(binary)
+		void write_binary_data(std::ostream &os, const char *data, const size_t n_bytes, const VTKCompression compression)
 		{
+			utils::base64Layer base64(os);
+
+			if (compression == VTKCompression::None)
+			{
+				const uint64_t size = n_bytes;
+				base64.write(size);
+				base64.write(data, n_bytes);
+				base64.close();
+				return;
+			}
+
+			const size_t n_blocks = (n_bytes + VTK_BLOCK_SIZE - 1) / VTK_BLOCK_SIZE;
+			const size_t capacity = compress_bound(VTK_BLOCK_SIZE, compression);
+
+			std::vector<uint64_t> header(3 + n_blocks);
+			header[0] = n_blocks;
+			header[1] = VTK_BLOCK_SIZE;
+			header[2] = n_bytes % VTK_BLOCK_SIZE;
+
+			std::vector<char> blocks(n_blocks * capacity);
+			utils::maybe_parallel_for(int(n_blocks), [&](int start, int end, int thread_id) {
+				for (int b = start; b < end; ++b)
+				{
+					const size_t offset = b * VTK_BLOCK_SIZE;
+					const size_t size = std::min(VTK_BLOCK_SIZE, n_bytes - offset);
+					header[3 + b] = compress_block(data + offset, size, &blocks[b * capacity], capacity, compression);
+				}
+			});
+
+			// the header and the blocks are two separate base64 sequences, as written by VTK
+			base64.write(reinterpret_cast<const char *>(header.data()), header.size() * sizeof(uint64_t));
+			base64.close();
+			for (size_t b = 0; b < n_blocks; ++b)
+				base64.write(&blocks[b * capacity], header[3 + b]);
+			base64.close();
+		}
+
+		VTUWriter::VTUWriter(bool binary, const VTKCompression compression, const bool float32)
+			: binary_(binary), compression_(compression), float32_(float32)
+		{
+			if (!is_compression_available(compression_))
+			{
+				static std::atomic<bool> warned(false);
+				if (!warned.exchange(true))
+					logger().warn("Polyfem has been compiled without {}, the VTU output is not compressed", compression_ == VTKCompression::ZLib ? "zlib" : "LZ4");
+				compression_ = VTKCompression::None;
+			}
+
+			if (!binary_)
+				compression_ = VTKCompression::None;
+		}
+
+		VTKCompression VTUWriter::compression_from_string(const std::string &compression)
+		{
+			if (compression == "none")
+				return VTKCompression::None;
+			if (compression == "zlib")
+				return VTKCompression::ZLib;
+			if (compression == "lz4")
+				return VTKCompression::LZ4;
+
+			log_and_throw_error("Unknown VTU compression " + compression);
+			return VTKCompression::None;
+		}
+
+		bool VTUWriter::is_compression_available(const VTKCompression compression)
+		{
+			switch (compression)
+			{
+			case VTKCompression::None:
+				return true;
+			case VTKCompression::ZLib:
+#ifdef POLYFEM_WITH_ZLIB
+				return true;
+#else
+				return false;
+#endif
+			case VTKCompression::LZ4:
+#ifdef POLYFEM_WITH_LZ4
+				return true;
+#else
+				return false;
+#endif
+			}
+			return false;
+		}
+
+		void VTUWriter::write_binary(const char *data, const size_t n_bytes, std::ostream &os) const
+		{
+			write_binary_data(os, data, n_bytes, compression_);
+			os << "\n";
 		}
 		void VTUWriter::write_point_data(std::ostream &os)
 		{
@@ -84,7 +250,7 @@ namespace polyfem
 
 			for (auto it = point_data_.begin(); it != point_data_.end(); ++it)
 			{
-				it->write(os);
+				it->write(os, compression_);
 			}
 
 			os << "</PointData>\n";
@@ -92,7 +258,10 @@ namespace polyfem
 
 		void VTUWriter::write_header(const int n_vertices, const int n_elements, std::ostream &os)
 		{
-			os << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" header_type=\"UInt64\">\n";
+			os << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" header_type=\"UInt64\"";
+			if (compression_ != VTKCompression::None)
+				os << " compressor=\"" << compressor_name(compression_) << "\"";
+			os << ">\n";
 			os << "<UnstructuredGrid>\n";
 			os << "<Piece NumberOfPoints=\"" << n_vertices << "\" NumberOfCells=\"" << n_elements << "\">\n";
 		}
@@ -117,15 +286,8 @@ namespace polyfem
 					tmp.row(2).setZero();
 				}
 
-				utils::base64Layer base64(os);
-
 				os << "<DataArray type=\"Float64\" NumberOfComponents=\"3\" format=\"binary\">\n";
-				const uint64_t size = tmp.size() * sizeof(double);
-				base64.write(size);
-
-				base64.write(tmp.data(), tmp.size());
-				base64.close();
-				os << "\n";
+				write_binary(reinterpret_cast<const char *>(tmp.data()), tmp.size() * sizeof(double), os);
 			}
 			else
 			{
@@ -159,19 +321,13 @@ namespace polyfem
 			const int n_cells = cells.rows();
 			const int n_cell_vertices = cells.cols();
 			os << "<Cells>\n";
-			utils::base64Layer base64(os);
 
 			///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 			if (binary_)
 			{
 				os << "<DataArray type=\"Int64\" Name=\"connectivity\" format=\"binary\" >\n";
-				const uint64_t size = cells.size() * sizeof(int64_t);
-				base64.write(size);
-
 				Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic> tmp = cells.transpose().template cast<int64_t>();
-				base64.write(tmp.data(), tmp.size());
-				base64.close();
-				os << "\n";
+				write_binary(reinterpret_cast<const char *>(tmp.data()), tmp.size() * sizeof(int64_t), os);
 			}
 			else
 			{
@@ -200,24 +356,18 @@ namespace polyfem
 			if (binary_)
 			{
 				os << "<DataArray type=\"Int8\" Name=\"types\" format=\"binary\">\n";
-				const uint64_t size = n_cells * sizeof(int8_t);
-				base64.write(size);
+				const std::vector<int8_t> tags(n_cells, int_tag);
+				write_binary(reinterpret_cast<const char *>(tags.data()), tags.size() * sizeof(int8_t), os);
 			}
 			else
+			{
 				os << "<DataArray type=\"Int8\" Name=\"types\" format=\"ascii\">\n";
 
-			for (int i = 0; i < n_cells; ++i)
-			{
-				const int8_t tag = int_tag;
-				if (binary_)
-					base64.write(tag);
-				else
+				for (int i = 0; i < n_cells; ++i)
+				{
+					const int8_t tag = int_tag;
 					os << tag << "\n";
-			}
-			if (binary_)
-			{
-				base64.close();
-				os << "\n";
+				}
 			}
 			os << "</DataArray>\n";
 
@@ -225,25 +375,21 @@ namespace polyfem
 			if (binary_)
 			{
 				os << "<DataArray type=\"Int64\" Name=\"offsets\" format=\"binary\">\n";
-				const uint64_t size = n_cells * sizeof(int64_t);
-				base64.write(size);
+				std::vector<int64_t> offsets(n_cells);
+				for (int i = 0; i < n_cells; ++i)
+					offsets[i] = int64_t(i + 1) * n_cell_vertices;
+				write_binary(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(int64_t), os);
 			}
 			else
+			{
 				os << "<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\">\n";
 
-			int64_t acc = n_cell_vertices;
-			for (int i = 0; i < n_cells; ++i)
-			{
-				if (binary_)
-					base64.write(acc);
-				else
+				int64_t acc = n_cell_vertices;
+				for (int i = 0; i < n_cells; ++i)
+				{
 					os << acc << "\n";
-				acc += n_cell_vertices;
-			}
-			if (binary_)
-			{
-				base64.close();
-				os << "\n";
+					acc += n_cell_vertices;
+				}
 			}
 
 			os << "</DataArray>\n";
@@ -255,7 +401,6 @@ namespace polyfem
 		{
 			const int n_cells = cells.size();
 			os << "<Cells>\n";
-			utils::base64Layer base64(os);
 
 			int n_cells_indices = 0;
 			for (const auto &c : cells)
@@ -267,8 +412,6 @@ namespace polyfem
 			if (binary_)
 			{
 				os << "<DataArray type=\"Int64\" Name=\"connectivity\" format=\"binary\" >\n";
-				const uint64_t size = n_cells_indices * sizeof(int64_t);
-				base64.write(size);
 
 				Eigen::Matrix<int64_t, Eigen::Dynamic, 1> tmp(n_cells_indices);
 				int index = 0;
@@ -277,9 +420,7 @@ namespace polyfem
 					for (const int i : c)
 						tmp(index++) = i;
 				}
-				base64.write(tmp.data(), tmp.size());
-				base64.close();
-				os << "\n";
+				write_binary(reinterpret_cast<const char *>(tmp.data()), tmp.size() * sizeof(int64_t), os);
 			}
 			else
 			{
@@ -306,26 +447,20 @@ namespace polyfem
 			if (binary_)
 			{
 				os << "<DataArray type=\"UInt8\" Name=\"types\" format=\"binary\">\n";
-				const uint64_t size = n_cells * sizeof(uint8_t);
-				base64.write(size);
+				std::vector<uint8_t> tags(n_cells);
+				for (int i = 0; i < n_cells; ++i)
+					tags[i] = is_volume_ ? VTKTagVolume(cells[i].size(), is_simplex) : VTKTagPlanar(cells[i].size(), is_simplex);
+				write_binary(reinterpret_cast<const char *>(tags.data()), tags.size() * sizeof(uint8_t), os);
 			}
 			else
-				os << "<DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\">\n";
-
-			for (int i = 0; i < n_cells; ++i)
 			{
-				const int int_tag = is_volume_ ? VTKTagVolume(cells[i].size(), is_simplex) : VTKTagPlanar(cells[i].size(), is_simplex);
-				const uint8_t tag = int_tag;
+				os << "<DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\">\n";
 
-				if (binary_)
-					base64.write(tag);
-				else
+				for (int i = 0; i < n_cells; ++i)
+				{
+					const int int_tag = is_volume_ ? VTKTagVolume(cells[i].size(), is_simplex) : VTKTagPlanar(cells[i].size(), is_simplex);
 					os << int_tag << "\n";
-			}
-			if (binary_)
-			{
-				base64.close();
-				os << "\n";
+				}
 			}
 			os << "</DataArray>\n";
 
@@ -333,25 +468,25 @@ namespace polyfem
 			if (binary_)
 			{
 				os << "<DataArray type=\"Int64\" Name=\"offsets\" format=\"binary\">\n";
-				const uint64_t size = n_cells * sizeof(int64_t);
-				base64.write(size);
+				std::vector<int64_t> offsets(n_cells);
+				int64_t acc = 0;
+				for (int i = 0; i < n_cells; ++i)
+				{
+					acc += cells[i].size();
+					offsets[i] = acc;
+				}
+				write_binary(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(int64_t), os);
 			}
 			else
+			{
 				os << "<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\">\n";
 
-			int64_t acc = 0;
-			for (int i = 0; i < n_cells; ++i)
-			{
-				acc += cells[i].size();
-				if (binary_)
-					base64.write(acc);
-				else
+				int64_t acc = 0;
+				for (int i = 0; i < n_cells; ++i)
+				{
+					acc += cells[i].size();
 					os << acc << "\n";
-			}
-			if (binary_)
-			{
-				base64.close();
-				os << "\n";
+				}
 			}
 
 			os << "</DataArray>\n";
@@ -384,7 +519,7 @@ namespace polyfem
 		void VTUWriter::add_scalar_field(const std::string &name, const Eigen::MatrixXd &data)
 		{
 			point_data_.push_back(VTKDataNode<double>(binary_));
-			point_data_.back().initialize(name, "Float64", data);
+			point_data_.back().initialize(name, float32_ ? "Float32" : "Float64", data);
 			current_scalar_point_data_ = name;
 		}
 
@@ -403,7 +538,7 @@ namespace polyfem
 			//  point_data_.back().initialize(name, "Float32", data3, 3);
 			// } else
 
-			point_data_.back().initialize(name, "Float64", data, data.cols());
+			point_data_.back().initialize(name, float32_ ? "Float32" : "Float64", data, data.cols());
 			current_vector_point_data_ = name;
 		}
 
@@ -1,19 +1,37 @@
 #pragma once
 
 #include <polyfem/utils/Logger.hpp>
-#include <polyfem/utils/base64Layer.hpp>
 
 #include <Eigen/Dense>
 
 #include <fstream>
 #include <string>
 #include <iostream>
+#include <type_traits>
 #include <vector>
 
 namespace polyfem
 {
 	namespace io
 	{
+		/// Compression of the binary DataArrays, with the block layout of vtkZLibDataCompressor/vtkLZ4DataCompressor
+		enum class VTKCompression
+		{
+			None,
+			ZLib,
+			LZ4
+		};
+
+		/// @brief Writes the binary (base64) payload of a DataArray
+		///
+		/// Uncompressed data is prefixed by its size, compressed data is split in blocks compressed
+		/// in parallel and prefixed by the header [#blocks, block size, last block size, compressed sizes...]
+		/// @param[in] os output stream
+		/// @param[in] data data of the array
+		/// @param[in] n_bytes size of the data
+		/// @param[in] compression compression of the array
+		void write_binary_data(std::ostream &os, const char *data, const size_t n_bytes, const VTKCompression compression);
+
 		namespace
 		{
 			template <typename T>
@@ -41,19 +59,18 @@ namespace polyfem
 					n_components_ = n_components;
 				}
 
-				void write(std::ostream &os) const
+				void write(std::ostream &os, const VTKCompression compression) const
 				{
-
 					if (binary_)
 					{
-						utils::base64Layer base64(os);
-
 						os << "<DataArray type=\"" << numeric_type_ << "\" Name=\"" << name_ << "\" NumberOfComponents=\"" << n_components_ << "\" format=\"binary\">\n";
-						const uint64_t size = data_.size() * sizeof(T);
-						base64.write(size);
-
-						base64.write(data_.data(), data_.size());
-						base64.close();
+						if (numeric_type_ == "Float32" && !std::is_same<T, float>::value)
+						{
+							const Eigen::MatrixXf tmp = data_.template cast<float>();
+							write_binary_data(os, reinterpret_cast<const char *>(tmp.data()), tmp.size() * sizeof(float), compression);
+						}
+						else
+							write_binary_data(os, reinterpret_cast<const char *>(data_.data()), data_.size() * sizeof(T), compression);
 						os << "\n";
 					}
 					else
@@ -79,7 +96,10 @@ namespace polyfem
 		class VTUWriter
 		{
 		public:
-			VTUWriter(bool binary = true);
+			/// @param[in] binary base64 binary or ascii output
+			/// @param[in] compression compression of the binary arrays, falls back to none if not available
+			/// @param[in] float32 if the fields are written in single precision (the points are always in double)
+			VTUWriter(bool binary = true, const VTKCompression compression = VTKCompression::None, const bool float32 = false);
 
 			bool write_mesh(const std::string &path, const Eigen::MatrixXd &points, const Eigen::MatrixXi &cells);
 			bool write_mesh(const std::string &path, const Eigen::MatrixXd &points, const std::vector<std::vector<int>> &cells, const bool is_simplicial);
@@ -90,9 +110,16 @@ namespace polyfem
 
 			void clear();
 
+			/// @brief Parses the compression of the arguments ("none", "zlib", or "lz4")
+			static VTKCompression compression_from_string(const std::string &compression);
+			/// @brief If polyfem has been compiled with the library of the compression
+			static bool is_compression_available(const VTKCompression compression);
+
 		private:
 			bool is_volume_;
 			bool binary_;
+			VTKCompression compression_;
+			bool float32_;
 
 			std::vector<VTKDataNode<double>> point_data_;
 			std::vector<VTKDataNode<double>> cell_data_;
@@ -100,6 +127,7 @@ namespace polyfem
 			std::string current_vector_point_data_;
 
 			void write_point_data(std::ostream &os);
+			void write_binary(const char *data, const size_t n_bytes, std::ostream &os) const;
 			void write_header(const int n_vertices, const int n_elements, std::ostream &os);
 			void write_footer(std::ostream &os);
 			void write_points(const Eigen::MatrixXd &points, std::ostream &os);
@@ -0,0 +1,83 @@
+#include "ElementColoring.hpp"
+
+#include <algorithm>
+
+namespace polyfem::mesh
+{
+	void ElementColoring::init(const std::vector<basis::ElementBases> &bases)
+	{
+		const int n_elements = int(bases.size());
+
+		// element -> global nodes
+		std::vector<int> element_offsets(n_elements + 1, 0);
+		std::vector<int> element_nodes;
+		int n_nodes = 0;
+		for (int e = 0; e < n_elements; ++e)
+		{
+			for (const auto &b : bases[e].bases)
+			{
+				for (const auto &g : b.global())
+				{
+					element_nodes.push_back(g.index);
+					n_nodes = std::max(n_nodes, g.index + 1);
+				}
+			}
+			element_offsets[e + 1] = int(element_nodes.size());
+		}
+
+		// global node -> elements
+		std::vector<int> node_offsets(n_nodes + 1, 0);
+		for (const int n : element_nodes)
+			++node_offsets[n + 1];
+		for (int n = 0; n < n_nodes; ++n)
+			node_offsets[n + 1] += node_offsets[n];
+
+		std::vector<int> node_elements(element_nodes.size());
+		{
+			std::vector<int> fill = node_offsets;
+			for (int e = 0; e < n_elements; ++e)
+			{
+				for (int k = element_offsets[e]; k < element_offsets[e + 1]; ++k)
+					node_elements[fill[element_nodes[k]]++] = e;
+			}
+		}
+
+		// every element takes the smallest color not used by an already colored neighbour
+		colors_.assign(n_elements, -1);
+		// used_by[c] == e if color c is taken by a neighbour of e
+		std::vector<int> used_by;
+		for (int e = 0; e < n_elements; ++e)
+		{
+			for (int k = element_offsets[e]; k < element_offsets[e + 1]; ++k)
+			{
+				const int n = element_nodes[k];
+				for (int l = node_offsets[n]; l < node_offsets[n + 1]; ++l)
+				{
+					const int c = colors_[node_elements[l]];
+					if (c >= 0)
+						used_by[c] = e;
+				}
+			}
+
+			int c = 0;
+			while (c < used_by.size() && used_by[c] == e)
+				++c;
+			if (c == used_by.size())
+				used_by.push_back(-1);
+
+			colors_[e] = c;
+		}
+
+		// group the elements by color
+		color_offsets_.assign(used_by.size() + 1, 0);
+		for (const int c : colors_)
+			++color_offsets_[c + 1];
+		for (size_t c = 0; c < used_by.size(); ++c)
+			color_offsets_[c + 1] += color_offsets_[c];
+
+		elements_.resize(n_elements);
+		std::vector<int> fill(color_offsets_.begin(), color_offsets_.end() - 1);
+		for (int e = 0; e < n_elements; ++e)
+			elements_[fill[colors_[e]]++] = e;
+	}
+} // namespace polyfem::mesh
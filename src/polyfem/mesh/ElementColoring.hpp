@@ -0,0 +1,45 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+
+#include <vector>
+
+namespace polyfem
+{
+	namespace mesh
+	{
+		// greedy coloring of the elements such that two elements of the same color never share
+		// a global node, the elements of one color can be scattered concurrently into shared
+		// global vectors/matrices without any synchronization
+		class ElementColoring
+		{
+		public:
+			// colors the elements using the global nodes of their bases
+			void init(const std::vector<basis::ElementBases> &bases);
+
+			void clear()
+			{
+				colors_.clear();
+				elements_.clear();
+				color_offsets_.assign(1, 0);
+			}
+
+			// number of colored elements
+			size_t size() const { return colors_.size(); }
+			// number of colors
+			int n_colors() const { return int(color_offsets_.size()) - 1; }
+
+			// color of element e
+			int color(const int e) const { return colors_[e]; }
+			// number of elements of color c
+			int color_size(const int c) const { return color_offsets_[c + 1] - color_offsets_[c]; }
+			// i-th element of color c, the elements of a color are sorted
+			int element(const int c, const int i) const { return elements_[color_offsets_[c] + i]; }
+
+		private:
+			std::vector<int> colors_;
+			std::vector<int> elements_;
+			std::vector<int> color_offsets_ = {0};
+		};
+	} // namespace mesh
+} // namespace polyfem
@@ -11,6 +11,8 @@
 
 #include <Eigen/Core>
 
+#include <algorithm>
+
 #include <igl/edges.h>
 #include <igl/boundary_facets.h>
 
@@ -21,15 +23,32 @@ namespace polyfem::mesh
 	std::unique_ptr<Mesh> read_fem_mesh(
 		const json &j_mesh,
 		const std::string &root_path,
-		const bool non_conforming)
+		const bool non_conforming,
+		const std::vector<std::string> &names,
+		const std::vector<Eigen::MatrixXd> &vertices,
+		const std::vector<Eigen::MatrixXi> &cells)
 	{
+		assert(names.size() == vertices.size());
+		assert(names.size() == cells.size());
+
 		if (!is_param_valid(j_mesh, "mesh"))
 			log_and_throw_error(fmt::format("Mesh {} is mising a \"mesh\" field!", j_mesh));
 
 		if (j_mesh["extract"].get<std::string>() != "volume")
 			log_and_throw_error("Only volumetric elements are implemented for FEM meshes!");
 
-		std::unique_ptr<Mesh> mesh = Mesh::create(resolve_path(j_mesh["mesh"], root_path), non_conforming);
+		std::unique_ptr<Mesh> mesh = nullptr;
+		const auto name = std::find(names.begin(), names.end(), j_mesh["mesh"].get<std::string>());
+		if (name != names.end())
+		{
+			const int index = std::distance(names.begin(), name);
+			mesh = Mesh::create(vertices[index], cells[index], non_conforming);
+		}
+		else
+			mesh = Mesh::create(resolve_path(j_mesh["mesh"], root_path), non_conforming);
+
+		if (mesh == nullptr)
+			log_and_throw_error(fmt::format("Unable to load the mesh {}!", j_mesh["mesh"].get<std::string>()));
 
 		// --------------------------------------------------------------------
 
@@ -205,28 +224,6 @@ namespace polyfem::mesh
 		const std::vector<Eigen::MatrixXi> &_cells,
 		const bool non_conforming)
 	{
-		// TODO: fix me for hdf5
-		// {
-		// 	int index = -1;
-		// 	for (int i = 0; i < names.size(); ++i)
-		// 	{
-		// 		if (names[i] == args["meshes"])
-		// 		{
-		// 			index = i;
-		// 			break;
-		// 		}
-		// 	}
-		// 	assert(index >= 0);
-		// 	if (vertices[index].cols() == 2)
-		// 		mesh = std::make_unique<polyfem::CMesh2D>();
-		// 	else
-		// 		mesh = std::make_unique<polyfem::Mesh3D>();
-		// 	mesh->build_from_matrices(vertices[index], cells[index]);
-		// }
-		assert(_names.empty());
-		assert(_vertices.empty());
-		assert(_cells.empty());
-
 		// --------------------------------------------------------------------
 
 		if (geometry.empty())
@@ -255,9 +252,9 @@ namespace polyfem::mesh
 					fmt::format("Invalid geometry type \"{}\" for FEM mesh!", geometry["type"]));
 
 			if (mesh == nullptr)
-				mesh = read_fem_mesh(geometry, root_path, non_conforming);
+				mesh = read_fem_mesh(geometry, root_path, non_conforming, _names, _vertices, _cells);
 			else
-				mesh->append(read_fem_mesh(geometry, root_path, non_conforming));
+				mesh->append(read_fem_mesh(geometry, root_path, non_conforming, _names, _vertices, _cells));
 		}
 
 		// --------------------------------------------------------------------
@@ -364,27 +361,7 @@ namespace polyfem::mesh
 		const std::vector<Eigen::MatrixXi> &_cells,
 		const bool non_conforming)
 	{
-		// TODO: fix me for hdf5
-		// {
-		// 	int index = -1;
-		// 	for (int i = 0; i < names.size(); ++i)
-		// 	{
-		// 		if (names[i] == args["meshes"])
-		// 		{
-		// 			index = i;
-		// 			break;
-		// 		}
-		// 	}
-		// 	assert(index >= 0);
-		// 	if (vertices[index].cols() == 2)
-		// 		mesh = std::make_unique<polyfem::CMesh2D>();
-		// 	else
-		// 		mesh = std::make_unique<polyfem::Mesh3D>();
-		// 	mesh->build_from_matrices(vertices[index], cells[index]);
-		// }
-		assert(_names.empty());
-		assert(_vertices.empty());
-		assert(_cells.empty());
+		// in-memory meshes (_names, _vertices, _cells) are only supported for the FEM meshes
 
 		Obstacle obstacle;
 
@@ -414,6 +391,9 @@ namespace polyfem::mesh
 
 			if (complete_geometry["type"] == "mesh")
 			{
+				if (std::find(_names.begin(), _names.end(), complete_geometry["mesh"].get<std::string>()) != _names.end())
+					log_and_throw_error(fmt::format("In-memory mesh {} cannot be used as an obstacle!", complete_geometry["mesh"].get<std::string>()));
+
 				Eigen::MatrixXd vertices;
 				Eigen::VectorXi codim_vertices;
 				Eigen::MatrixXi codim_edges;
@@ -14,19 +14,29 @@ namespace polyfem::mesh
 	/// @param[in]  j_mesh           geometry JSON
 	/// @param[in]  root_path       root path of JSON
 	/// @param[in]  non_conforming  if true, the mesh will be non-conforming
+	/// @param[in]  names           names of in-memory meshes, a "mesh" field equal to names[i] is built from vertices[i] and cells[i] instead of read from a file
+	/// @param[in]  vertices        vertices of the in-memory meshes (#vertices x dim)
+	/// @param[in]  cells           cells of the in-memory meshes
 	///
 	/// @return created Mesh object
 	///
 	std::unique_ptr<Mesh> read_fem_mesh(
 		const json &j_mesh,
 		const std::string &root_path,
-		const bool non_conforming = false);
+		const bool non_conforming = false,
+		const std::vector<std::string> &names = std::vector<std::string>(),
+		const std::vector<Eigen::MatrixXd> &vertices = std::vector<Eigen::MatrixXd>(),
+		const std::vector<Eigen::MatrixXi> &cells = std::vector<Eigen::MatrixXi>());
 
 	///
 	/// @brief      read FEM meshes from a geometry JSON array (or single)
 	///
 	/// @param[in]  geometry        geometry JSON object(s)
 	/// @param[in]  root_path       root path of JSON
+	/// @param[in]  names           names of in-memory meshes, see read_fem_mesh
+	/// @param[in]  vertices        vertices of the in-memory meshes
+	/// @param[in]  cells           cells of the in-memory meshes
+	/// @param[in]  non_conforming  if true, the mesh will be non-conforming
 	///
 	/// @return created Mesh object
 	///
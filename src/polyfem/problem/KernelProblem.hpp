@@ -2,6 +2,8 @@
 
 #include "ProblemWithSolution.hpp"
 
+#include <polyfem/assembler/AssemblerUtils.hpp>
+
 #include <Eigen/Dense>
 
 #include <vector>
@@ -25,14 +27,14 @@ namespace polyfem
 				return AutodiffHessianPt(1);
 			}
 
-			void rhs(const assembler::AssemblerUtils &assembler, const std::string &formulation, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override;
+			void rhs(const assembler::AssemblerUtils &assembler, const assembler::Formulation &formulation, const Eigen::MatrixXd &pts, const double t, Eigen::MatrixXd &val) const override;
 
 			void set_parameters(const json &params) override;
 			bool is_scalar() const override;
 
 		private:
 			const assembler::AssemblerUtils &assembler_;
-			std::string formulation_ = "Laplacian";
+			assembler::Formulation formulation_ = "Laplacian";
 			int n_kernels_ = 5;
 			double kernel_distance_ = 0.05;
 			Eigen::VectorXd kernel_weights_;
@@ -1,32 +1,39 @@
 #include "FullNLProblem.hpp"
 
+#include <limits>
+
 namespace polyfem::solver
 {
 	FullNLProblem::FullNLProblem(std::vector<std::shared_ptr<Form>> &forms)
 		: forms_(forms)
 	{
+		clear_apply_hessians();
 	}
 
 	void FullNLProblem::init(const TVector &x)
 	{
+		clear_apply_hessians();
 		for (auto &f : forms_)
 			f->init(x);
 	}
 
 	void FullNLProblem::set_project_to_psd(bool project_to_psd)
 	{
+		clear_apply_hessians();
 		for (auto &f : forms_)
 			f->set_project_to_psd(project_to_psd);
 	}
 
 	void FullNLProblem::init_lagging(const TVector &x)
 	{
+		clear_apply_hessians();
 		for (auto &f : forms_)
 			f->init_lagging(x);
 	}
 
 	void FullNLProblem::update_lagging(const TVector &x, const int iter_num)
 	{
+		clear_apply_hessians();
 		for (auto &f : forms_)
 			f->update_lagging(x, iter_num);
 	}
@@ -49,6 +56,7 @@ namespace polyfem::solver
 
 	void FullNLProblem::line_search_begin(const TVector &x0, const TVector &x1)
 	{
+		clear_apply_hessians();
 		for (auto &f : forms_)
 			f->line_search_begin(x0, x1);
 	}
@@ -108,6 +116,13 @@ namespace polyfem::solver
 
 	void FullNLProblem::hessian(const TVector &x, THessian &hessian)
 	{
+		if (use_fixed_hessian_pattern_)
+		{
+			assemble_fixed_pattern_hessian(x, &hessian);
+			hessian_pattern_.swap_out(hessian);
+			return;
+		}
+
 		hessian.resize(x.size(), x.size());
 		for (auto &f : forms_)
 		{
@@ -119,14 +134,108 @@ namespace polyfem::solver
 		}
 	}
 
+	void FullNLProblem::hessian_apply(const TVector &x, const TVector &v, TVector &hv)
+	{
+		if (apply_hessians_x_.size() != x.size() || apply_hessians_x_ != x)
+		{
+			clear_apply_hessians();
+			apply_hessians_x_ = x;
+		}
+
+		hv = TVector::Zero(x.size());
+		for (size_t i = 0; i < forms_.size(); ++i)
+		{
+			const auto &f = forms_[i];
+			if (!f->enabled())
+				continue;
+
+			if (f->has_matrix_free_second_derivative())
+			{
+				TVector tmp;
+				f->second_derivative_apply(x, v, tmp);
+				hv += tmp;
+				continue;
+			}
+
+			if (apply_hessians_weight_[i] != f->weight())
+			{
+				f->second_derivative(x, apply_hessians_[i]);
+				apply_hessians_weight_[i] = f->weight();
+			}
+			hv += apply_hessians_[i] * v;
+		}
+	}
+
+	void FullNLProblem::clear_apply_hessians()
+	{
+		apply_hessians_x_.resize(0);
+		apply_hessians_.assign(forms_.size(), THessian());
+		apply_hessians_weight_.assign(forms_.size(), std::numeric_limits<double>::quiet_NaN());
+	}
+
+	void FullNLProblem::assemble_fixed_pattern_hessian(const TVector &x, THessian *handed_out)
+	{
+		hessian_pattern_.set_zero(x.size(), x.size(), handed_out);
+		for (auto &f : forms_)
+		{
+			if (!f->enabled())
+				continue;
+			f->add_second_derivative(x, hessian_pattern_);
+		}
+		// the contact pairs that are no longer active are dropped from the pattern
+		hessian_pattern_.shrink();
+	}
+
+	void FullNLProblem::value_gradient_hessian(const TVector &x, double &value, TVector &grad, THessian &hessian)
+	{
+		assemble_value_gradient_hessian(x, value, grad, hessian, &hessian);
+		if (use_fixed_hessian_pattern_)
+			hessian_pattern_.swap_out(hessian);
+	}
+
+	void FullNLProblem::assemble_value_gradient_hessian(const TVector &x, double &value, TVector &grad, THessian &hessian, THessian *handed_out)
+	{
+		value = 0;
+		grad = TVector::Zero(x.size());
+		if (use_fixed_hessian_pattern_)
+			hessian_pattern_.set_zero(x.size(), x.size(), handed_out);
+		else
+			hessian.resize(x.size(), x.size());
+
+		double tmp_value;
+		TVector tmp_grad;
+		THessian tmp_hessian;
+		for (auto &f : forms_)
+		{
+			if (!f->enabled())
+				continue;
+			if (use_fixed_hessian_pattern_)
+			{
+				f->value_and_derivatives(x, &tmp_value, &tmp_grad, hessian_pattern_);
+			}
+			else
+			{
+				f->value_and_derivatives(x, &tmp_value, &tmp_grad, &tmp_hessian);
+				hessian += tmp_hessian;
+			}
+			value += tmp_value;
+			grad += tmp_grad;
+		}
+
+		if (use_fixed_hessian_pattern_)
+			hessian_pattern_.shrink();
+	}
+
 	void FullNLProblem::solution_changed(const TVector &x)
 	{
+		clear_apply_hessians();
 		for (auto &f : forms_)
 			f->solution_changed(x);
 	}
 
 	void FullNLProblem::post_step(const int iter_num, const TVector &x)
 	{
+		clear_apply_hessians();
 		for (auto &f : forms_)
 			f->post_step(iter_num, x);
 	}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <polyfem/solver/forms/Form.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
 
 #include <cppoptlib/problem.h>
 
@@ -23,6 +24,13 @@ namespace polyfem::solver
 		virtual void gradient(const TVector &x, TVector &gradv) override;
 		virtual void hessian(const TVector &x, THessian &hessian);
 
+		/// @brief Compute the product of the Hessian at x with v, forms with a matrix-free product do not assemble their Hessian,
+		/// the Hessians of the other forms are kept for the following products at the same x (e.g., the iterations of a Krylov solve)
+		virtual void hessian_apply(const TVector &x, const TVector &v, TVector &hv);
+
+		/// @brief Compute the value, gradient, and Hessian at x together, each form evaluates the three in a single pass
+		virtual void value_gradient_hessian(const TVector &x, double &value, TVector &gradv, THessian &hessian);
+
 		virtual bool is_step_valid(const TVector &x0, const TVector &x1) const;
 		virtual bool is_step_collision_free(const TVector &x0, const TVector &x1) const;
 		virtual double max_step_size(const TVector &x0, const TVector &x1) const;
@@ -40,7 +48,34 @@ namespace polyfem::solver
 		int max_lagging_iterations() const;
 		bool uses_lagging() const;
 
+		/// @brief If true, the forms' Hessians are accumulated into a persistent matrix whose
+		/// pattern is the union of the patterns seen so far (elastic plus contact pairs),
+		/// the pairs that are no longer active are dropped once they are 10% of the pattern.
+		/// The forms that keep their Hessian scatter it directly into the persistent matrix,
+		/// the contact forms still add a temporary matrix.
+		void set_fixed_hessian_pattern(const bool val) { use_fixed_hessian_pattern_ = val; }
+
 	protected:
+		/// @brief Sum the forms' Hessians into hessian_pattern_.
+		/// @param handed_out Matrix the previous Hessian was swapped into, its storage is reused if unchanged
+		void assemble_fixed_pattern_hessian(const TVector &x, THessian *handed_out = nullptr);
+
+		/// @brief Sum the forms' values, gradients, and Hessians, the Hessians go to hessian_pattern_ instead of hessian if use_fixed_hessian_pattern_.
+		/// @param handed_out Matrix the previous Hessian was swapped into, its storage is reused if unchanged
+		void assemble_value_gradient_hessian(const TVector &x, double &value, TVector &gradv, THessian &hessian, THessian *handed_out = nullptr);
+
 		std::vector<std::shared_ptr<Form>> forms_;
+
+		bool use_fixed_hessian_pattern_ = false;
+		utils::FixedPatternMatrix hessian_pattern_;
+
+		// the Hessians of the forms without a matrix-free product only change with x and the forms' state (lagging, contact set, time step),
+		// they are dropped whenever one of those changes
+		TVector apply_hessians_x_;                 ///< x of apply_hessians_ (empty if none)
+		std::vector<THessian> apply_hessians_;     ///< Weighted Hessian of each form at apply_hessians_x_
+		std::vector<double> apply_hessians_weight_; ///< Weight of each form in apply_hessians_ (nan if not computed)
+
+		/// @brief Drop the Hessians kept by hessian_apply
+		void clear_apply_hessians();
 	};
 } // namespace polyfem::solver
@@ -19,7 +19,7 @@ M (u^{t+1}_h - (u^t_h + \Delta t v^t_h)) - \frac{\Delta t^2} {2} A u^{t+1}_h
 namespace polyfem::solver
 {
 	NLProblem::NLProblem(const int full_size,
-						 const std::string &formulation,
+						 const assembler::Formulation &formulation,
 						 const std::vector<int> &boundary_nodes,
 						 const std::vector<mesh::LocalBoundary> &local_boundary,
 						 const int n_boundary_samples,
@@ -51,6 +51,8 @@ namespace polyfem::solver
 	void NLProblem::update_quantities(const double t, const TVector &x)
 	{
 		t_ = t;
+		hessian_apply_x_.resize(0); // the Dirichlet values depend on t
+		clear_apply_hessians();
 		const TVector full = reduced_to_full(x);
 		for (auto &f : forms_)
 			f->update_quantities(t, full);
@@ -91,13 +93,74 @@ namespace polyfem::solver
 
 	void NLProblem::hessian(const TVector &x, THessian &hessian)
 	{
+		if (use_fixed_hessian_pattern_)
+		{
+			assemble_fixed_pattern_hessian(reduced_to_full(x), &hessian);
+			fixed_pattern_to_reduced_hessian(hessian);
+			return;
+		}
+
 		THessian full_hessian;
 		FullNLProblem::hessian(reduced_to_full(x), full_hessian);
+		full_to_reduced_hessian(full_hessian, hessian);
+	}
+
+	void NLProblem::value_gradient_hessian(const TVector &x, double &value, TVector &grad, THessian &hessian)
+	{
+		TVector full_grad;
+		THessian full_hessian;
+		assemble_value_gradient_hessian(reduced_to_full(x), value, full_grad, full_hessian, &hessian);
+		grad = full_to_reduced(full_grad);
+		if (use_fixed_hessian_pattern_)
+			fixed_pattern_to_reduced_hessian(hessian);
+		else
+			full_to_reduced_hessian(full_hessian, hessian);
+	}
+
+	void NLProblem::hessian_apply(const TVector &x, const TVector &v, TVector &hv)
+	{
+		if (hessian_apply_x_.size() != x.size() || hessian_apply_x_ != x)
+		{
+			hessian_apply_x_ = x;
+			hessian_apply_full_x_ = reduced_to_full(x);
+		}
+
+		// the direction is zero on the Dirichlet nodes
+		TVector full_v;
+		reduced_to_full_aux(boundary_nodes_, full_size(), current_size(), v, Eigen::MatrixXd::Zero(full_size(), 1), full_v);
+
+		TVector full_hv;
+		FullNLProblem::hessian_apply(hessian_apply_full_x_, full_v, full_hv);
+		hv = full_to_reduced(full_hv);
+	}
+
+	void NLProblem::full_to_reduced_hessian(const THessian &full_hessian, THessian &hessian)
+	{
 		assert(full_hessian.rows() == full_size());
 		assert(full_hessian.cols() == full_size());
+
 		utils::full_to_reduced_matrix(full_size(), current_size(), boundary_nodes_, full_hessian, hessian);
 	}
 
+	void NLProblem::fixed_pattern_to_reduced_hessian(THessian &hessian)
+	{
+		assert(hessian_pattern_.mat().rows() == full_size());
+
+		if (current_size() == full_size())
+		{
+			// nothing to remove, the matrix is handed back without a copy
+			hessian_pattern_.swap_out(hessian);
+			return;
+		}
+
+		if (reduced_hessian_map_.pattern_version != hessian_pattern_.pattern_version())
+		{
+			reduced_hessian_map_.init(full_size(), current_size(), boundary_nodes_, hessian_pattern_.mat());
+			reduced_hessian_map_.pattern_version = hessian_pattern_.pattern_version();
+		}
+		reduced_hessian_map_.apply(hessian_pattern_.mat(), hessian);
+	}
+
 	void NLProblem::solution_changed(const TVector &newX)
 	{
 		FullNLProblem::solution_changed(reduced_to_full(newX));
@@ -14,7 +14,7 @@ namespace polyfem::solver
 		using typename FullNLProblem::TVector;
 
 		NLProblem(const int full_size,
-				  const std::string &formulation,
+				  const assembler::Formulation &formulation,
 				  const std::vector<int> &boundary_nodes,
 				  const std::vector<mesh::LocalBoundary> &local_boundary,
 				  const int n_boundary_samples,
@@ -24,6 +24,8 @@ namespace polyfem::solver
 		double value(const TVector &x) override;
 		void gradient(const TVector &x, TVector &gradv) override;
 		void hessian(const TVector &x, THessian &hessian) override;
+		void value_gradient_hessian(const TVector &x, double &value, TVector &gradv, THessian &hessian) override;
+		void hessian_apply(const TVector &x, const TVector &v, TVector &hv) override;
 
 		bool is_step_valid(const TVector &x0, const TVector &x1) const override;
 		bool is_step_collision_free(const TVector &x0, const TVector &x1) const override;
@@ -69,11 +71,23 @@ namespace polyfem::solver
 			REDUCED_SIZE
 		};
 		CurrentSize current_size_; ///< Current size of the problem (either full or reduced size)
+
+		utils::FullToReducedMatrixMap reduced_hessian_map_; ///< Gather map from hessian_pattern_ to the reduced Hessian
+
+		// x is the same for all the products of a Krylov solve, its full vector (that needs the Dirichlet values) is kept
+		TVector hessian_apply_x_;      ///< Last reduced x of hessian_apply
+		TVector hessian_apply_full_x_; ///< Full vector of hessian_apply_x_
 		int current_size() const
 		{
 			return current_size_ == FULL_SIZE ? full_size() : reduced_size();
 		}
 
+		/// @brief Restrict the Hessian of the full problem to the current size
+		void full_to_reduced_hessian(const THessian &full_hessian, THessian &hessian);
+
+		/// @brief Restrict hessian_pattern_ to the current size, swapping it into hessian if nothing is removed
+		void fixed_pattern_to_reduced_hessian(THessian &hessian);
+
 		template <class FullMat, class ReducedMat>
 		static void full_to_reduced_aux(const std::vector<int> &boundary_nodes, const int full_size, const int reduced_size, const FullMat &full, ReducedMat &reduced);
 
@@ -42,12 +42,12 @@ namespace polyfem
 			const assembler::AssemblyValsCache &pressure_ass_vals_cache,
 			const std::vector<int> &boundary_nodes,
 			const bool use_avg_pressure,
-			const std::string &formulation,
+			const assembler::Formulation &formulation,
 			const int problem_dim,
 			const bool is_volume,
 			const Eigen::MatrixXd &rhs, Eigen::VectorXd &x)
 		{
-			assert(formulation == "NavierStokes");
+			assert(formulation.type() == AssemblerType::NavierStokes);
 
 			auto solver = LinearSolver::create(solver_type, precond_type);
 			solver->setParameters(solver_param["linear"]);
@@ -145,7 +145,7 @@ namespace polyfem
 		}
 
 		int NavierStokesSolver::minimize_aux(
-			const std::string &formulation,
+			const assembler::Formulation &formulation,
 			bool is_picard,
 			const std::vector<int> &skipping,
 			const int n_bases,
@@ -170,9 +170,10 @@ namespace polyfem
 			StiffnessMatrix nl_matrix;
 			StiffnessMatrix total_matrix;
 			SpareMatrixCache mat_cache;
+			const Formulation picard_formulation(formulation.name() + "Picard");
 
 			time.start();
-			assembler.assemble_energy_hessian(formulation + "Picard", is_volume, n_bases, false, bases, gbases, ass_vals_cache, 0, x, Eigen::MatrixXd(), mat_cache, nl_matrix);
+			assembler.assemble_energy_hessian(picard_formulation, is_volume, n_bases, false, bases, gbases, ass_vals_cache, 0, x, Eigen::MatrixXd(), mat_cache, nl_matrix);
 			AssemblerUtils::merge_mixed_matrices(n_bases, n_pressure_bases, problem_dim, use_avg_pressure,
 												 velocity_stiffness + nl_matrix, mixed_stiffness, pressure_stiffness,
 												 total_matrix);
@@ -215,7 +216,7 @@ namespace polyfem
 				// TODO check for nans
 
 				time.start();
-				assembler.assemble_energy_hessian(formulation + "Picard", is_volume, n_bases, false, bases, gbases, ass_vals_cache, 0, x, Eigen::MatrixXd(), mat_cache, nl_matrix);
+				assembler.assemble_energy_hessian(picard_formulation, is_volume, n_bases, false, bases, gbases, ass_vals_cache, 0, x, Eigen::MatrixXd(), mat_cache, nl_matrix);
 				AssemblerUtils::merge_mixed_matrices(n_bases, n_pressure_bases, problem_dim, use_avg_pressure,
 													 velocity_stiffness + nl_matrix, mixed_stiffness, pressure_stiffness,
 													 total_matrix);
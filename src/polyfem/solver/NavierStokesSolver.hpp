@@ -30,7 +30,7 @@ namespace polyfem
 						  const assembler::AssemblyValsCache &pressure_ass_vals_cache,
 						  const std::vector<int> &boundary_nodes,
 						  const bool use_avg_pressure,
-						  const std::string &formulation,
+						  const assembler::Formulation &formulation,
 						  const int problem_dim,
 						  const bool is_volume,
 						  const Eigen::MatrixXd &rhs, Eigen::VectorXd &x);
@@ -42,7 +42,7 @@ namespace polyfem
 			int error_code() const { return 0; }
 
 		private:
-			int minimize_aux(const std::string &formulation,
+			int minimize_aux(const assembler::Formulation &formulation,
 							 const bool is_picard,
 							 const std::vector<int> &skipping,
 							 const int n_bases,
@@ -58,6 +58,10 @@ namespace cppoptlib
 		// Reset the solver at the start of a minimization
 		virtual void reset(const int ndof);
 
+		// Compute the energy and the gradient at the beginning of an iteration,
+		// solvers that also need the Hessian at x can compute it in the same pass
+		virtual void compute_energy_and_gradient(ProblemType &objFunc, const TVector &x, double &energy, TVector &grad);
+
 		// Compute the search/update direction
 		virtual bool compute_update_direction(ProblemType &objFunc, const TVector &x_vec, const TVector &grad, TVector &direction) = 0;
 
@@ -29,6 +29,20 @@ namespace cppoptlib
 		solver_info["line_search"] = line_search_name;
 	}
 
+	template <typename ProblemType>
+	void NonlinearSolver<ProblemType>::compute_energy_and_gradient(ProblemType &objFunc, const TVector &x, double &energy, TVector &grad)
+	{
+		{
+			POLYFEM_SCOPED_TIMER("compute objective function", obj_fun_time);
+			energy = objFunc.value(x);
+		}
+
+		{
+			POLYFEM_SCOPED_TIMER("compute gradient", grad_time);
+			objFunc.gradient(x, grad);
+		}
+	}
+
 	template <typename ProblemType>
 	void NonlinearSolver<ProblemType>::minimize(ProblemType &objFunc, TVector &x)
 	{
@@ -97,10 +111,7 @@ namespace cppoptlib
 			}
 
 			double energy;
-			{
-				POLYFEM_SCOPED_TIMER("compute objective function", obj_fun_time);
-				energy = objFunc.value(x);
-			}
+			compute_energy_and_gradient(objFunc, x, energy, grad);
 			if (!std::isfinite(energy))
 			{
 				this->m_status = Status::UserDefined;
@@ -110,11 +121,6 @@ namespace cppoptlib
 				break;
 			}
 
-			{
-				POLYFEM_SCOPED_TIMER("compute gradient", grad_time);
-				objFunc.gradient(x, grad);
-			}
-
 			const double grad_norm = grad.norm();
 			if (std::isnan(grad_norm))
 			{
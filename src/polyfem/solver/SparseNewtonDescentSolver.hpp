@@ -23,11 +23,13 @@ namespace cppoptlib
 		std::string name() const override { return "Newton"; }
 
 	protected:
+		void compute_energy_and_gradient(ProblemType &objFunc, const TVector &x, double &energy, TVector &grad) override;
 		bool compute_update_direction(ProblemType &objFunc, const TVector &x, const TVector &grad, TVector &direction) override;
 
 		void assemble_hessian(ProblemType &objFunc, const TVector &x, polyfem::StiffnessMatrix &hessian);
 		bool solve_linear_system(const polyfem::StiffnessMatrix &hessian, const TVector &grad, TVector &direction);
 		bool check_direction(const polyfem::StiffnessMatrix &hessian, const TVector &grad, const TVector &direction);
+		bool compute_krylov_direction(ProblemType &objFunc, const TVector &x, const TVector &grad, TVector &direction);
 
 		static bool has_hessian_nans(const polyfem::StiffnessMatrix &hessian);
 
@@ -60,6 +62,35 @@ namespace cppoptlib
 		std::unique_ptr<polysolve::LinearSolver> linear_solver; ///< Linear solver used to solve the linear system
 		double reg_weight = 0;                                  ///< Regularization Coefficients
 
+		// The Hessian sparsity only changes when contact/friction constraints add entries,
+		// the symbolic factorization is kept as long as the pattern does not change.
+		// It is kept across solves (e.g., time steps) since the linear solver is.
+		polyfem::utils::SparsityPattern analyzed_pattern; ///< Pattern of the symbolic factorization of linear_solver
+		bool reused_pattern = false;                      ///< Whether the last linear solve reused the symbolic factorization
+		double analyze_pattern_time = 0;                  ///< Time spent in the last symbolic analysis
+		double factorize_time = 0;                        ///< Time spent in the last numeric factorization
+
+		// The energy, gradient, and Hessian of an iterate are computed in one pass over the elements,
+		// the Hessian is kept until the update direction is computed.
+		polyfem::StiffnessMatrix fused_hessian; ///< Hessian computed with the energy and gradient
+		int fused_hessian_strategy = -1;        ///< Descent strategy fused_hessian was computed for (-1 if none)
+
+		// Newton-Krylov (matrix_free): the Hessian is only assembled and factorized every preconditioner_update_interval
+		// iterations (the direction is then the direct solve). In between, the direction is computed with preconditioned CG
+		// using matrix-free Hessian-vector products and the last factorization as preconditioner.
+		bool matrix_free = false;                ///< Whether the Newton-Krylov mode is used
+		double krylov_tolerance = 1e-6;          ///< Relative residual of the Krylov solve
+		int max_krylov_iterations = 1000;        ///< Maximum number of CG iterations before updating the preconditioner
+		int preconditioner_update_interval = 10; ///< Maximum number of Newton iterations a factorization is used as preconditioner
+		int preconditioner_age = -1;             ///< Newton iterations since the factorization was computed (-1 if none)
+		int krylov_iterations = 0;               ///< CG iterations of the last Krylov solve
+
+		/// Whether the Hessian of the current iteration is assembled
+		bool use_hessian() const
+		{
+			return !matrix_free || this->descent_strategy != 0 || preconditioner_age < 0 || preconditioner_age >= preconditioner_update_interval;
+		}
+
 		// ====================================================================
 		//                            Solver info
 		// ====================================================================
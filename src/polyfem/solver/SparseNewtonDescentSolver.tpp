@@ -12,6 +12,12 @@ namespace cppoptlib
 		linear_solver = polysolve::LinearSolver::create(
 			linear_solver_params["solver"], linear_solver_params["precond"]);
 		linear_solver->setParameters(linear_solver_params);
+
+		const json &newton_params = solver_params["Newton"];
+		matrix_free = newton_params["matrix_free"];
+		krylov_tolerance = newton_params["krylov_tolerance"];
+		max_krylov_iterations = newton_params["max_krylov_iterations"];
+		preconditioner_update_interval = newton_params["preconditioner_update_interval"];
 	}
 
 	// =======================================================================
@@ -55,6 +61,30 @@ namespace cppoptlib
 		assert(linear_solver != nullptr);
 		reg_weight = 0;
 		internal_solver_info = json::array();
+		fused_hessian_strategy = -1;
+		preconditioner_age = -1;
+	}
+
+	// =======================================================================
+
+	template <typename ProblemType>
+	void SparseNewtonDescentSolver<ProblemType>::compute_energy_and_gradient(
+		ProblemType &objFunc, const TVector &x, double &energy, TVector &grad)
+	{
+		fused_hessian_strategy = -1;
+
+		if (this->descent_strategy == 2 || !use_hessian())
+		{
+			Superclass::compute_energy_and_gradient(objFunc, x, energy, grad);
+			return;
+		}
+
+		// the Hessian is needed at x anyway, the three are assembled together
+		POLYFEM_SCOPED_TIMER("assembly time", this->assembly_time);
+
+		objFunc.set_project_to_psd(this->descent_strategy == 1);
+		objFunc.value_gradient_hessian(x, energy, grad, fused_hessian);
+		fused_hessian_strategy = this->descent_strategy;
 	}
 
 	// =======================================================================
@@ -72,6 +102,25 @@ namespace cppoptlib
 			return true;
 		}
 
+		if (!use_hessian())
+		{
+			if (compute_krylov_direction(objFunc, x, grad, direction))
+			{
+				++preconditioner_age;
+
+				json info;
+				info["krylov_iterations"] = krylov_iterations;
+				internal_solver_info.push_back(info);
+
+				return true;
+			}
+
+			polyfem::logger().debug(
+				"[{}] Krylov solve did not converge in {} iterations; updating the preconditioner",
+				name(), krylov_iterations);
+			preconditioner_age = -1;
+		}
+
 		polyfem::StiffnessMatrix hessian;
 
 		assemble_hessian(objFunc, x, hessian);
@@ -84,31 +133,103 @@ namespace cppoptlib
 
 		json info;
 		linear_solver->getInfo(info);
+		info["reused_pattern"] = reused_pattern;
+		info["time_analyze_pattern"] = analyze_pattern_time;
+		info["time_factorize"] = factorize_time;
 		internal_solver_info.push_back(info);
 
 		reg_weight /= reg_weight_dec;
 		if (reg_weight < reg_weight_min)
 			reg_weight = 0;
 
+		// the factorization is the preconditioner of the next Krylov solves
+		preconditioner_age = this->descent_strategy == 0 ? 0 : -1;
+
 		return true;
 	}
 
 	// =======================================================================
 
+	template <typename ProblemType>
+	bool SparseNewtonDescentSolver<ProblemType>::compute_krylov_direction(
+		ProblemType &objFunc, const TVector &x, const TVector &grad, TVector &direction)
+	{
+		POLYFEM_SCOPED_TIMER("linear solve", this->inverting_time);
+
+		objFunc.set_project_to_psd(false);
+
+		// preconditioned CG on H Δx = -g starting from Δx = 0, the preconditioner is the factorization of a previous Hessian
+		const double tolerance = krylov_tolerance * grad.norm();
+
+		direction = TVector::Zero(x.size());
+		TVector r = -grad;
+		TVector z = TVector::Zero(x.size());
+		linear_solver->solve(r, z);
+		TVector p = z;
+		TVector hp, r_prev;
+		double rz = r.dot(z);
+
+		for (krylov_iterations = 0; krylov_iterations < max_krylov_iterations;)
+		{
+			objFunc.hessian_apply(x, p, hp);
+			++krylov_iterations;
+
+			const double php = p.dot(hp);
+			if (!(php > 0))
+			{
+				// negative curvature (or nan), the factorized Hessian handles it
+				polyfem::logger().trace("[{}] Krylov solve found a non-positive curvature {}", name(), php);
+				return false;
+			}
+
+			const double alpha = rz / php;
+			direction += alpha * p;
+			r_prev = r;
+			r -= alpha * hp;
+
+			if (r.norm() <= tolerance)
+			{
+				polyfem::logger().trace("Krylov solve residual {} after {} iterations", r.norm(), krylov_iterations);
+				return grad.dot(direction) < 0;
+			}
+
+			z.setZero();
+			linear_solver->solve(r, z);
+
+			// Polak-Ribière update, robust to a preconditioner that changes between iterations (e.g., an iterative linear solver)
+			const double beta = z.dot(r - r_prev) / rz;
+			rz = r.dot(z);
+			p = z + beta * p;
+		}
+
+		return false;
+	}
+
+	// =======================================================================
+
 	template <typename ProblemType>
 	void SparseNewtonDescentSolver<ProblemType>::assemble_hessian(
 		ProblemType &objFunc, const TVector &x, polyfem::StiffnessMatrix &hessian)
 	{
 		POLYFEM_SCOPED_TIMER("assembly time", this->assembly_time);
 
-		if (this->descent_strategy == 1)
-			objFunc.set_project_to_psd(true);
-		else if (this->descent_strategy == 0)
-			objFunc.set_project_to_psd(false);
+		if (fused_hessian_strategy == this->descent_strategy)
+		{
+			// assembled with the energy and gradient of x
+			hessian = std::move(fused_hessian);
+			fused_hessian_strategy = -1;
+		}
 		else
-			assert(false);
-
-		objFunc.hessian(x, hessian);
+		{
+			if (this->descent_strategy == 1)
+				objFunc.set_project_to_psd(true);
+			else if (this->descent_strategy == 0)
+				objFunc.set_project_to_psd(false);
+			else
+				assert(false);
+
+			objFunc.hessian(x, hessian);
+		}
 
 		if (reg_weight > 0)
 		{
@@ -123,11 +244,26 @@ namespace cppoptlib
 		const polyfem::StiffnessMatrix &hessian, const TVector &grad, TVector &direction)
 	{
 		POLYFEM_SCOPED_TIMER("linear solve", this->inverting_time);
-		// TODO: get the correct size
-		linear_solver->analyzePattern(hessian, hessian.rows());
+
+		reused_pattern = analyzed_pattern.matches(hessian);
+		analyze_pattern_time = 0;
+		factorize_time = 0;
+
+		if (!reused_pattern)
+		{
+			POLYFEM_SCOPED_TIMER("analyze pattern", analyze_pattern_time);
+			// TODO: get the correct size
+			linear_solver->analyzePattern(hessian, hessian.rows());
+			analyzed_pattern.assign(hessian);
+		}
+		else
+		{
+			polyfem::logger().trace("Hessian sparsity unchanged, reusing symbolic factorization");
+		}
 
 		try
 		{
+			POLYFEM_SCOPED_TIMER("factorize", factorize_time);
 			linear_solver->factorize(hessian);
 		}
 		catch (const std::runtime_error &err)
@@ -28,7 +28,7 @@ namespace polyfem
 						  const assembler::AssemblyValsCache &ass_vals_cache,
 						  const std::vector<int> &boundary_nodes,
 						  const bool use_avg_pressure,
-						  const std::string &formulation,
+						  const assembler::Formulation &formulation,
 						  const int problem_dim,
 						  const bool is_volume,
 						  const double beta_dt, const Eigen::VectorXd &prev_sol,
@@ -43,7 +43,7 @@ namespace polyfem
 			int error_code() const { return 0; }
 
 		private:
-			int minimize_aux(const std::string &formulation,
+			int minimize_aux(const assembler::Formulation &formulation,
 							 const bool is_picard,
 							 const std::vector<int> &skipping,
 							 const int n_bases,
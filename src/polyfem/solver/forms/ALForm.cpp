@@ -74,6 +74,11 @@ namespace polyfem::solver
 		hessian = masked_lumped_mass_;
 	}
 
+	void ALForm::add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, utils::FixedPatternMatrix &hessian)
+	{
+		hessian.add(masked_lumped_mass_, masked_lumped_mass_scatter_, scale);
+	}
+
 	void ALForm::update_quantities(const double t, const Eigen::VectorXd &)
 	{
 		if (is_time_dependent_)
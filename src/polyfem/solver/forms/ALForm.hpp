@@ -46,6 +46,12 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) override;
 
+		/// @brief Add scale times the second derivative wrt x to a matrix with a fixed pattern, scattering the values of the masked lumped mass
+		/// @param[in] x Current solution
+		/// @param[in] scale Factor of the Hessian
+		/// @param[in,out] hessian Matrix the Hessian is added to
+		void add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, utils::FixedPatternMatrix &hessian) override;
+
 	public:
 		/// @brief Update time dependent quantities
 		/// @param t New time
@@ -61,8 +67,9 @@ namespace polyfem::solver
 		const assembler::RhsAssembler &rhs_assembler_; ///< Reference to the RHS assembler
 		const bool is_time_dependent_;
 
-		StiffnessMatrix masked_lumped_mass_; ///< mass matrix masked by the AL dofs
-		Eigen::MatrixXd target_x_;           ///< actually a vector with the same size as x with target nodal positions
+		StiffnessMatrix masked_lumped_mass_;                               ///< mass matrix masked by the AL dofs
+		utils::FixedPatternMatrix::ScatterMap masked_lumped_mass_scatter_; ///< Positions of the entries of masked_lumped_mass_ in the fixed pattern Hessian
+		Eigen::MatrixXd target_x_;                                         ///< actually a vector with the same size as x with target nodal positions
 
 		void update_target(const double t);
 	};
@@ -47,6 +47,9 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) override { hessian.resize(x.size(), x.size()); }
 
+		/// @brief The Hessian is zero, nothing is added
+		void add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, utils::FixedPatternMatrix &hessian) override {}
+
 	public:
 		/// @brief Update time dependent quantities
 		/// @param t New time
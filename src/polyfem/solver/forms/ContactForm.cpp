@@ -39,24 +39,45 @@ namespace polyfem::solver
 
 	void ContactForm::init(const Eigen::VectorXd &x)
 	{
-		const Eigen::MatrixXd displaced_surface = compute_displaced_surface(x);
-		update_constraint_set(displaced_surface);
+		update_constraint_set(x);
 	}
 
 	void ContactForm::update_quantities(const double t, const Eigen::VectorXd &x)
 	{
-		const Eigen::MatrixXd displaced_surface = compute_displaced_surface(x);
-		update_constraint_set(displaced_surface);
+		update_constraint_set(x);
 	}
 
-	Eigen::MatrixXd ContactForm::compute_displaced_surface(const Eigen::VectorXd &x) const
+	std::shared_ptr<const Eigen::MatrixXd> ContactForm::compute_displaced_surface(const Eigen::VectorXd &x) const
 	{
-		return collision_mesh_.displace_vertices(utils::unflatten(x, boundary_nodes_pos_.cols()));
+		{
+			std::lock_guard<std::mutex> lock(cached_mutex_);
+			for (int i = 0; i < int(cached_x_.size()); ++i)
+			{
+				if (cached_displaced_surface_[i] && cached_x_[i].size() == x.size() && cached_x_[i] == x)
+				{
+					cached_latest_ = i;
+					return cached_displaced_surface_[i];
+				}
+			}
+		}
+
+		// displaced outside of the lock, concurrent misses on the same x compute it twice
+		const auto displaced_surface = std::make_shared<const Eigen::MatrixXd>(
+			collision_mesh_.displace_vertices(utils::unflatten(x, boundary_nodes_pos_.cols())));
+
+		// Replace the least recently used entry
+		std::lock_guard<std::mutex> lock(cached_mutex_);
+		const int i = 1 - cached_latest_;
+		cached_x_[i] = x;
+		cached_displaced_surface_[i] = displaced_surface;
+		cached_latest_ = i;
+		return displaced_surface;
 	}
 
 	void ContactForm::update_barrier_stiffness(const Eigen::VectorXd &x, const Eigen::MatrixXd &grad_energy)
 	{
-		const Eigen::MatrixXd displaced_surface = compute_displaced_surface(x);
+		const auto displaced_surface_ptr = compute_displaced_surface(x);
+		const Eigen::MatrixXd &displaced_surface = *displaced_surface_ptr;
 
 		Eigen::VectorXd grad_barrier = ipc::compute_barrier_potential_gradient(
 			collision_mesh_, displaced_surface, constraint_set_, dhat_);
@@ -69,50 +90,54 @@ namespace polyfem::solver
 		logger().debug("adaptive barrier form stiffness {}", weight_);
 	}
 
-	void ContactForm::update_constraint_set(const Eigen::MatrixXd &displaced_surface)
+	void ContactForm::update_constraint_set(const Eigen::VectorXd &x)
 	{
-		// Store the previous value used to compute the constraint set to avoid duplicate computation.
-		static Eigen::MatrixXd cached_displaced_surface;
-		if (cached_displaced_surface.size() == displaced_surface.size() && cached_displaced_surface == displaced_surface)
+		// Store the solution used to compute the constraint set to avoid duplicate computation.
+		if (constraint_set_x_.size() == x.size() && constraint_set_x_ == x)
 			return;
 
+		const auto displaced_surface_ptr = compute_displaced_surface(x);
+		const Eigen::MatrixXd &displaced_surface = *displaced_surface_ptr;
+
 		if (use_cached_candidates_)
 			constraint_set_.build(
 				candidates_, collision_mesh_, displaced_surface, dhat_);
 		else
 			constraint_set_.build(
 				collision_mesh_, displaced_surface, dhat_, /*dmin=*/0, broad_phase_method_);
-		cached_displaced_surface = displaced_surface;
+		constraint_set_x_ = x;
 	}
 
 	double ContactForm::value_unweighted(const Eigen::VectorXd &x) const
 	{
-		return ipc::compute_barrier_potential(collision_mesh_, compute_displaced_surface(x), constraint_set_, dhat_);
+		return ipc::compute_barrier_potential(collision_mesh_, *compute_displaced_surface(x), constraint_set_, dhat_);
 	}
 
 	void ContactForm::first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
 	{
-		gradv = ipc::compute_barrier_potential_gradient(collision_mesh_, compute_displaced_surface(x), constraint_set_, dhat_);
+		gradv = ipc::compute_barrier_potential_gradient(collision_mesh_, *compute_displaced_surface(x), constraint_set_, dhat_);
 		gradv = collision_mesh_.to_full_dof(gradv);
 	}
 
 	void ContactForm::second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian)
 	{
 		POLYFEM_SCOPED_TIMER("\t\tbarrier hessian");
-		hessian = ipc::compute_barrier_potential_hessian(collision_mesh_, compute_displaced_surface(x), constraint_set_, dhat_, project_to_psd_);
+		hessian = ipc::compute_barrier_potential_hessian(collision_mesh_, *compute_displaced_surface(x), constraint_set_, dhat_, project_to_psd_);
 		hessian = collision_mesh_.to_full_dof(hessian);
 	}
 
 	void ContactForm::solution_changed(const Eigen::VectorXd &new_x)
 	{
-		update_constraint_set(compute_displaced_surface(new_x));
+		update_constraint_set(new_x);
 	}
 
 	double ContactForm::max_step_size(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const
 	{
 		// Extract surface only
-		const Eigen::MatrixXd V0 = compute_displaced_surface(x0);
-		const Eigen::MatrixXd V1 = compute_displaced_surface(x1);
+		const auto V0_ptr = compute_displaced_surface(x0);
+		const auto V1_ptr = compute_displaced_surface(x1);
+		const Eigen::MatrixXd &V0 = *V0_ptr;
+		const Eigen::MatrixXd &V1 = *V1_ptr;
 
 		double max_step;
 		if (use_cached_candidates_ && broad_phase_method_ != ipc::BroadPhaseMethod::SWEEP_AND_TINIEST_QUEUE_GPU)
@@ -146,8 +171,8 @@ namespace polyfem::solver
 	{
 		ipc::construct_collision_candidates(
 			collision_mesh_,
-			compute_displaced_surface(x0),
-			compute_displaced_surface(x1),
+			*compute_displaced_surface(x0),
+			*compute_displaced_surface(x1),
 			candidates_,
 			/*inflation_radius=*/dhat_ / 1.99, // divide by 1.99 instead of 2 to be conservative
 			broad_phase_method_);
@@ -163,7 +188,8 @@ namespace polyfem::solver
 
 	void ContactForm::post_step(const int iter_num, const Eigen::VectorXd &x)
 	{
-		const Eigen::MatrixXd displaced_surface = compute_displaced_surface(x);
+		const auto displaced_surface_ptr = compute_displaced_surface(x);
+		const Eigen::MatrixXd &displaced_surface = *displaced_surface_ptr;
 
 		const double curr_distance = ipc::compute_minimum_distance(collision_mesh_, displaced_surface, constraint_set_);
 
@@ -196,8 +222,10 @@ namespace polyfem::solver
 
 	bool ContactForm::is_step_collision_free(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const
 	{
-		const auto displaced0 = compute_displaced_surface(x0);
-		const auto displaced1 = compute_displaced_surface(x1);
+		const auto displaced0_ptr = compute_displaced_surface(x0);
+		const auto displaced1_ptr = compute_displaced_surface(x1);
+		const Eigen::MatrixXd &displaced0 = *displaced0_ptr;
+		const Eigen::MatrixXd &displaced1 = *displaced1_ptr;
 
 		// Skip CCD if the displacement is zero.
 		if ((displaced1 - displaced0).lpNorm<Eigen::Infinity>() == 0.0)
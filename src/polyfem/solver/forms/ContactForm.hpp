@@ -8,6 +8,10 @@
 #include <ipc/collision_mesh.hpp>
 #include <ipc/broad_phase/broad_phase.hpp>
 
+#include <array>
+#include <memory>
+#include <mutex>
+
 namespace polyfem::solver
 {
 	/// @brief Form representing the contact potential and forces
@@ -118,11 +122,21 @@ namespace polyfem::solver
 		ipc::Constraints constraint_set_;    ///< Cached constraint set for the current solution
 		ipc::Candidates candidates_;         ///< Cached candidate set for the current solution
 
+		Eigen::VectorXd constraint_set_x_; ///< Solution used to build the cached constraint set
+
+		/// @brief Displaced surfaces of the two most recently used solutions (two to support x0/x1 pairs)
+		/// @note The const queries can run concurrently, the slots are guarded by cached_mutex_ and the
+		/// surfaces are shared with the callers, so a slot replaced by another call stays valid for them.
+		mutable std::mutex cached_mutex_;
+		mutable std::array<Eigen::VectorXd, 2> cached_x_;
+		mutable std::array<std::shared_ptr<const Eigen::MatrixXd>, 2> cached_displaced_surface_;
+		mutable int cached_latest_ = 0;
+
 		/// @brief Compute the displaced positions of the surface nodes
-		Eigen::MatrixXd compute_displaced_surface(const Eigen::VectorXd &x) const;
+		std::shared_ptr<const Eigen::MatrixXd> compute_displaced_surface(const Eigen::VectorXd &x) const;
 
-		/// @brief Update the cached candidate set for the current solution
-		/// @param displaced_surface Vertex positions displaced by the current solution
-		void update_constraint_set(const Eigen::MatrixXd &displaced_surface);
+		/// @brief Update the cached constraint set for the current solution
+		/// @param x Current solution
+		void update_constraint_set(const Eigen::VectorXd &x);
 	};
 } // namespace polyfem::solver
@@ -11,7 +11,7 @@ namespace polyfem::solver
 							 const std::vector<basis::ElementBases> &geom_bases,
 							 const assembler::AssemblerUtils &assembler,
 							 const assembler::AssemblyValsCache &ass_vals_cache,
-							 const std::string &formulation,
+							 const assembler::Formulation &formulation,
 							 const double dt,
 							 const bool is_volume)
 		: n_bases_(n_bases),
@@ -63,6 +63,65 @@ namespace polyfem::solver
 		}
 	}
 
+	void ElasticForm::second_derivative_apply_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv)
+	{
+		POLYFEM_SCOPED_TIMER("\telastic hessian apply");
+
+		if (assembler_.is_linear(formulation_))
+		{
+			assert(cached_stiffness_.rows() == x.size() && cached_stiffness_.cols() == x.size());
+			hv = cached_stiffness_ * v;
+			return;
+		}
+
+		Eigen::MatrixXd result;
+		assembler_.assemble_energy_hessian_apply(
+			formulation_, is_volume_, n_bases_, project_to_psd_, bases_, geom_bases_,
+			ass_vals_cache_, dt_, x, x_prev_, v, result);
+		hv = result;
+	}
+
+	void ElasticForm::value_and_derivatives_unweighted(const Eigen::VectorXd &x, double *value, Eigen::VectorXd *gradv, StiffnessMatrix *hessian)
+	{
+		POLYFEM_SCOPED_TIMER("\telastic value and derivatives");
+
+		if (hessian && assembler_.is_linear(formulation_))
+		{
+			assert(cached_stiffness_.rows() == x.size() && cached_stiffness_.cols() == x.size());
+			*hessian = cached_stiffness_;
+			hessian = nullptr;
+		}
+
+		if (!value && !gradv && !hessian)
+			return;
+
+		Eigen::MatrixXd grad;
+		assembler_.assemble_energy_gradient_hessian(
+			formulation_, is_volume_, n_bases_, project_to_psd_, bases_, geom_bases_,
+			ass_vals_cache_, dt_, x, x_prev_, value, gradv ? &grad : nullptr, mat_cache_, hessian);
+		if (gradv)
+			*gradv = grad;
+	}
+
+	void ElasticForm::add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, utils::FixedPatternMatrix &hessian)
+	{
+		value_and_derivatives_fixed_pattern_unweighted(x, nullptr, nullptr, scale, hessian);
+	}
+
+	void ElasticForm::value_and_derivatives_fixed_pattern_unweighted(const Eigen::VectorXd &x, double *value, Eigen::VectorXd *gradv, const double scale, utils::FixedPatternMatrix &hessian)
+	{
+		if (assembler_.is_linear(formulation_))
+		{
+			assert(cached_stiffness_.rows() == x.size() && cached_stiffness_.cols() == x.size());
+			value_and_derivatives_unweighted(x, value, gradv, nullptr);
+			hessian.add(cached_stiffness_, hessian_scatter_, scale);
+			return;
+		}
+
+		value_and_derivatives_unweighted(x, value, gradv, &hessian_);
+		hessian.add(hessian_, hessian_scatter_, scale);
+	}
+
 	bool ElasticForm::is_step_valid(const Eigen::VectorXd &, const Eigen::VectorXd &x1) const
 	{
 		Eigen::VectorXd grad;
@@ -21,10 +21,12 @@ namespace polyfem::solver
 					const std::vector<basis::ElementBases> &geom_bases,
 					const assembler::AssemblerUtils &assembler,
 					const assembler::AssemblyValsCache &ass_vals_cache,
-					const std::string &formulation,
+					const assembler::Formulation &formulation,
 					const double dt,
 					const bool is_volume);
 
+		bool has_matrix_free_second_derivative() const override { return true; }
+
 	protected:
 		/// @brief Compute the elastic potential value
 		/// @param x Current solution
@@ -41,6 +43,34 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) override;
 
+		/// @brief Compute the product of the second derivative wrt x and a direction element by element, without assembling the Hessian
+		/// @param[in] x Current solution
+		/// @param[in] v Direction
+		/// @param[out] hv Output Hessian of the value wrt x times v
+		void second_derivative_apply_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) override;
+
+		/// @brief Compute any combination of the value, gradient, and Hessian in a single pass over the elements
+		/// @param[in] x Current solution
+		/// @param[out] value Output value, skipped if nullptr
+		/// @param[out] gradv Output gradient of the value wrt x, skipped if nullptr
+		/// @param[out] hessian Output Hessian of the value wrt x, skipped if nullptr
+		void value_and_derivatives_unweighted(const Eigen::VectorXd &x, double *value, Eigen::VectorXd *gradv, StiffnessMatrix *hessian) override;
+
+		/// @brief Add scale times the second derivative wrt x to a matrix with a fixed pattern,
+		/// the stiffness (or the Hessian assembled in the storage kept by the form) is scattered with a map computed once
+		/// @param[in] x Current solution
+		/// @param[in] scale Factor of the Hessian
+		/// @param[in,out] hessian Matrix the Hessian is added to
+		void add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, utils::FixedPatternMatrix &hessian) override;
+
+		/// @brief Same as add_second_derivative_unweighted, the value and gradient are computed in the same pass over the elements
+		/// @param[in] x Current solution
+		/// @param[out] value Output value, skipped if nullptr
+		/// @param[out] gradv Output gradient of the value wrt x, skipped if nullptr
+		/// @param[in] scale Factor of the Hessian
+		/// @param[in,out] hessian Matrix the Hessian is added to
+		void value_and_derivatives_fixed_pattern_unweighted(const Eigen::VectorXd &x, double *value, Eigen::VectorXd *gradv, const double scale, utils::FixedPatternMatrix &hessian) override;
+
 	public:
 		/// @brief Determine if a step from solution x0 to solution x1 is allowed
 		/// @param x0 Current solution
@@ -59,12 +89,17 @@ namespace polyfem::solver
 
 		const assembler::AssemblerUtils &assembler_; ///< Reference to the assembler
 		const assembler::AssemblyValsCache &ass_vals_cache_;
-		const std::string formulation_; ///< Elasticity formulation name
+		const assembler::Formulation formulation_; ///< Elasticity formulation
 		const bool is_volume_;
 		const double dt_;
 		StiffnessMatrix cached_stiffness_;  ///< Cached stiffness matrix for linear elasticity
 		utils::SpareMatrixCache mat_cache_; ///< Matrix cache
 
+		// the pattern of the assembled Hessian does not change once mat_cache_ knows it,
+		// its storage and its positions in the fixed pattern Hessian are kept between assemblies
+		StiffnessMatrix hessian_;
+		utils::FixedPatternMatrix::ScatterMap hessian_scatter_;
+
 		/// @brief Compute the stiffness matrix (cached)
 		void compute_cached_stiffness();
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <polyfem/utils/Types.hpp>
+#include <polyfem/utils/MatrixUtils.hpp>
 
 namespace polyfem::solver
 {
@@ -40,6 +41,61 @@ namespace polyfem::solver
 			hessian *= weight_;
 		}
 
+		/// @brief Compute the product of the second derivative wrt x multiplied with the weigth and a direction
+		/// @note Forms with a matrix-free product (e.g., ElasticForm) do not assemble the Hessian.
+		/// @param[in] x Current solution
+		/// @param[in] v Direction
+		/// @param[out] hv Output Hessian of the value wrt x times v
+		inline void second_derivative_apply(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv)
+		{
+			second_derivative_apply_unweighted(x, v, hv);
+			hv *= weight_;
+		}
+
+		/// @brief Determine if second_derivative_apply computes the product without assembling the Hessian
+		/// @return True if the form overrides second_derivative_apply_unweighted with a matrix-free product
+		virtual bool has_matrix_free_second_derivative() const { return false; }
+
+		/// @brief Compute any combination of the value and its first and second derivatives wrt x multiplied with the weigth
+		/// @note Forms that share work between the three (e.g., ElasticForm) compute them in a single pass.
+		/// @param[in] x Current solution
+		/// @param[out] value Output value, skipped if nullptr
+		/// @param[out] gradv Output gradient of the value wrt x, skipped if nullptr
+		/// @param[out] hessian Output Hessian of the value wrt x, skipped if nullptr
+		inline void value_and_derivatives(const Eigen::VectorXd &x, double *value, Eigen::VectorXd *gradv, StiffnessMatrix *hessian)
+		{
+			value_and_derivatives_unweighted(x, value, gradv, hessian);
+			if (value)
+				*value *= weight_;
+			if (gradv)
+				*gradv *= weight_;
+			if (hessian)
+				*hessian *= weight_;
+		}
+
+		/// @brief Add the second derivative of the value wrt x multiplied with the weigth to a matrix with a fixed pattern
+		/// @note Forms that keep their Hessian (e.g., InertiaForm, ElasticForm) scatter its values without a temporary matrix.
+		/// @param[in] x Current solution
+		/// @param[in,out] hessian Matrix the Hessian is added to
+		inline void add_second_derivative(const Eigen::VectorXd &x, utils::FixedPatternMatrix &hessian)
+		{
+			add_second_derivative_unweighted(x, weight_, hessian);
+		}
+
+		/// @brief Same as value_and_derivatives, but the Hessian is added to a matrix with a fixed pattern
+		/// @param[in] x Current solution
+		/// @param[out] value Output value, skipped if nullptr
+		/// @param[out] gradv Output gradient of the value wrt x, skipped if nullptr
+		/// @param[in,out] hessian Matrix the Hessian is added to
+		inline void value_and_derivatives(const Eigen::VectorXd &x, double *value, Eigen::VectorXd *gradv, utils::FixedPatternMatrix &hessian)
+		{
+			value_and_derivatives_fixed_pattern_unweighted(x, value, gradv, weight_, hessian);
+			if (value)
+				*value *= weight_;
+			if (gradv)
+				*gradv *= weight_;
+		}
+
 		/// @brief Determine if a step from solution x0 to solution x1 is allowed
 		/// @param x0 Current solution
 		/// @param x1 Proposed next solution
@@ -111,6 +167,8 @@ namespace polyfem::solver
 		/// @brief Set the form's multiplicative constant weight
 		/// @param weight New weight to use
 		void set_weight(const double weight) { weight_ = weight; }
+		/// @brief Get the form's multiplicative constant weight
+		double weight() const { return weight_; }
 
 		// NOTE: The following functions are really specific to the different form and should be implemented in the derived class.
 
@@ -144,5 +202,58 @@ namespace polyfem::solver
 		/// @param[in] x Current solution
 		/// @param[out] hessian Output Hessian of the value wrt x
 		virtual void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) = 0;
+
+		/// @brief Compute the product of the second derivative wrt x and a direction
+		/// @note The default assembles the Hessian, FullNLProblem::hessian_apply keeps it for the products at the same x.
+		/// @param[in] x Current solution
+		/// @param[in] v Direction
+		/// @param[out] hv Output Hessian of the value wrt x times v
+		virtual void second_derivative_apply_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv)
+		{
+			StiffnessMatrix hessian;
+			second_derivative_unweighted(x, hessian);
+			hv = hessian * v;
+		}
+
+		/// @brief Compute any combination of the value and its first and second derivatives wrt x
+		/// @note The default evaluates them separately.
+		/// @param[in] x Current solution
+		/// @param[out] value Output value, skipped if nullptr
+		/// @param[out] gradv Output gradient of the value wrt x, skipped if nullptr
+		/// @param[out] hessian Output Hessian of the value wrt x, skipped if nullptr
+		virtual void value_and_derivatives_unweighted(const Eigen::VectorXd &x, double *value, Eigen::VectorXd *gradv, StiffnessMatrix *hessian)
+		{
+			if (value)
+				*value = value_unweighted(x);
+			if (gradv)
+				first_derivative_unweighted(x, *gradv);
+			if (hessian)
+				second_derivative_unweighted(x, *hessian);
+		}
+
+		/// @brief Add scale times the second derivative wrt x to a matrix with a fixed pattern
+		/// @note The default goes through a temporary Hessian.
+		/// @param[in] x Current solution
+		/// @param[in] scale Factor of the Hessian
+		/// @param[in,out] hessian Matrix the Hessian is added to
+		virtual void add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, utils::FixedPatternMatrix &hessian)
+		{
+			StiffnessMatrix tmp;
+			second_derivative_unweighted(x, tmp);
+			hessian.add(tmp, scale);
+		}
+
+		/// @brief Compute any combination of the value and its first derivative wrt x and add scale times the second derivative to a matrix with a fixed pattern
+		/// @note The default evaluates them separately.
+		/// @param[in] x Current solution
+		/// @param[out] value Output value, skipped if nullptr
+		/// @param[out] gradv Output gradient of the value wrt x, skipped if nullptr
+		/// @param[in] scale Factor of the Hessian
+		/// @param[in,out] hessian Matrix the Hessian is added to
+		virtual void value_and_derivatives_fixed_pattern_unweighted(const Eigen::VectorXd &x, double *value, Eigen::VectorXd *gradv, const double scale, utils::FixedPatternMatrix &hessian)
+		{
+			value_and_derivatives_unweighted(x, value, gradv, nullptr);
+			add_second_derivative_unweighted(x, scale, hessian);
+		}
 	};
 } // namespace polyfem::solver
@@ -29,4 +29,14 @@ namespace polyfem::solver
 	{
 		hessian = mass_;
 	}
+
+	void InertiaForm::add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, utils::FixedPatternMatrix &hessian)
+	{
+		hessian.add(mass_, mass_scatter_, scale);
+	}
+
+	void InertiaForm::second_derivative_apply_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv)
+	{
+		hv = mass_ * v;
+	}
 } // namespace polyfem::solver
@@ -17,6 +17,8 @@ namespace polyfem::solver
 		InertiaForm(const StiffnessMatrix &mass,
 					const time_integrator::ImplicitTimeIntegrator &time_integrator);
 
+		bool has_matrix_free_second_derivative() const override { return true; }
+
 	protected:
 		/// @brief Compute the value of the form
 		/// @param x Current solution
@@ -33,8 +35,21 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) override;
 
+		/// @brief Add scale times the second derivative wrt x to a matrix with a fixed pattern, scattering the values of the mass matrix
+		/// @param[in] x Current solution
+		/// @param[in] scale Factor of the Hessian
+		/// @param[in,out] hessian Matrix the Hessian is added to
+		void add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, utils::FixedPatternMatrix &hessian) override;
+
+		/// @brief Compute the product of the second derivative wrt x and a direction
+		/// @param[in] x Current solution
+		/// @param[in] v Direction
+		/// @param[out] hv Output mass matrix times v
+		void second_derivative_apply_unweighted(const Eigen::VectorXd &x, const Eigen::VectorXd &v, Eigen::VectorXd &hv) override;
+
 	private:
 		const StiffnessMatrix &mass_;                                    ///< Mass matrix
 		const time_integrator::ImplicitTimeIntegrator &time_integrator_; ///< Time integrator
+		utils::FixedPatternMatrix::ScatterMap mass_scatter_;             ///< Positions of the entries of mass_ in the fixed pattern Hessian
 	};
 } // namespace polyfem::solver
@@ -29,6 +29,17 @@ namespace polyfem::solver
 		hessian.setIdentity();
 	}
 
+	void LaggedRegForm::add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, utils::FixedPatternMatrix &hessian)
+	{
+		if (identity_.rows() != x.size())
+		{
+			second_derivative_unweighted(x, identity_);
+			identity_.makeCompressed();
+			identity_scatter_.clear();
+		}
+		hessian.add(identity_, identity_scatter_, scale);
+	}
+
 	void LaggedRegForm::init_lagging(const Eigen::VectorXd &x)
 	{
 		update_lagging(x, 0);
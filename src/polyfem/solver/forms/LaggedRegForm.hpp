@@ -29,6 +29,12 @@ namespace polyfem::solver
 		/// @param[out] hessian Output Hessian of the value wrt x
 		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) override;
 
+		/// @brief Add scale times the second derivative wrt x to a matrix with a fixed pattern, scattering the values of the identity
+		/// @param[in] x Current solution
+		/// @param[in] scale Factor of the Hessian
+		/// @param[in,out] hessian Matrix the Hessian is added to
+		void add_second_derivative_unweighted(const Eigen::VectorXd &x, const double scale, utils::FixedPatternMatrix &hessian) override;
+
 	public:
 		/// @brief Initialize lagged fields
 		/// @param x Current solution
@@ -46,5 +52,8 @@ namespace polyfem::solver
 	private:
 		int n_lagging_iters_;      ///< Number of iterations to lag for
 		Eigen::VectorXd x_lagged_; ///< The full variables from the previous lagging solve.
+
+		StiffnessMatrix identity_;                               ///< Hessian of the form, built on the first use
+		utils::FixedPatternMatrix::ScatterMap identity_scatter_; ///< Positions of the entries of identity_ in the fixed pattern Hessian
 	};
 } // namespace polyfem::solver
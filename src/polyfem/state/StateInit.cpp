@@ -143,6 +143,9 @@ namespace polyfem
 
 	void State::init(const json &p_args_in, const bool strict_validation, const std::string &output_dir, const bool fallback_solver)
 	{
+		// the timesteps written in the background read the arguments
+		flush_export();
+
 		json args_in = p_args_in; // mutable copy
 
 		apply_common_params(args_in);
@@ -202,6 +205,7 @@ namespace polyfem
 		// end of check
 
 		this->args = jse.inject_defaults(args_in, rules);
+		formulation_ = formulation_from_materials();
 
 		// std::cout << this->args.dump() << std::endl;
 
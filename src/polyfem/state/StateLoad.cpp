@@ -19,6 +19,9 @@ namespace polyfem
 
 	void State::reset_mesh()
 	{
+		// the timesteps written in the background read the mesh
+		flush_export();
+
 		bases.clear();
 		pressure_bases.clear();
 		geom_bases_.clear();
@@ -28,6 +31,8 @@ namespace polyfem
 		polys.clear();
 		poly_edge_to_data.clear();
 		obstacle.clear();
+		ass_vals_cache.clear();
+		pressure_ass_vals_cache.clear();
 
 		stiffness.resize(0, 0);
 		rhs.resize(0, 0);
@@ -52,20 +52,74 @@ namespace polyfem
 			logger().trace("Saving VTU...");
 			POLYFEM_SCOPED_TIMER("Saving VTU");
 			const std::string step_name = args["output"]["advanced"]["timestep_prefix"];
+			const std::string vtu_path = resolve_output_path(fmt::format(step_name + "{:d}.vtu", t));
+			const std::string pvd_path = resolve_output_path(args["output"]["paraview"]["file_name"]);
+			const int skip_frame = args["output"]["paraview"]["skip_frame"].get<int>();
+			const io::OutGeometryData::ExportOptions opts(args, mesh->is_linear(), problem->is_scalar(), solve_export_to_file);
+			const bool contact = is_contact_enabled();
+
+			const int queue_size = args["output"]["advanced"]["export_queue_size"];
+			if (solve_export_to_file && queue_size > 0 && !async_writer)
+				async_writer = std::make_unique<io::AsyncWriter>(queue_size);
+
+			const std::string hdf5_path = resolve_output_path(args["output"]["hdf5"]["file_name"]);
+			if (solve_export_to_file && !hdf5_path.empty())
+			{
+				if (!hdf5_writer || hdf5_writer->path() != hdf5_path || t == 0)
+				{
+					// the previous series has to be closed before the file is truncated
+					flush_export();
+					hdf5_writer.reset();
+					hdf5_writer = std::make_shared<io::HDF5Writer>(hdf5_path, args["output"]["hdf5"]["compression_level"].get<int>());
+				}
+
+				const auto frame = std::make_shared<const io::ExportFrame>(*this);
+				const auto write = [this, writer = hdf5_writer, frame, opts, contact, time, dt]() {
+					out_geom.save_hdf5(*writer, *this, *frame, time, dt, opts, contact);
+				};
+
+				if (async_writer)
+					async_writer->push(write);
+				else
+					write();
+				return;
+			}
+
+			if (solve_export_to_file && queue_size > 0)
+			{
+				// only the values of the timestep are copied, the rest of the state is only changed by
+				// init, load_mesh, build_basis, and assemble_rhs, which wait for the pending timesteps
+				const auto frame = std::make_shared<const io::ExportFrame>(*this);
+				async_writer->push([this, frame, vtu_path, pvd_path, step_name, opts, contact, time, t, t0, dt, skip_frame]() {
+					std::vector<io::SolutionFrame> unused;
+					out_geom.save_vtu(vtu_path, *this, *frame, time, dt, opts, contact, unused);
+
+					out_geom.save_pvd(
+						pvd_path,
+						[step_name](int i) { return fmt::format(step_name + "{:d}.vtm", i); },
+						t, t0, dt, skip_frame);
+				});
+				return;
+			}
 
 			if (!solve_export_to_file)
 				solution_frames.emplace_back();
 
-			out_geom.save_vtu(
-				resolve_output_path(fmt::format(step_name + "{:d}.vtu", t)),
-				*this, time, dt,
-				io::OutGeometryData::ExportOptions(args, mesh->is_linear(), problem->is_scalar(), solve_export_to_file),
-				is_contact_enabled(), solution_frames);
+			out_geom.save_vtu(vtu_path, *this, time, dt, opts, contact, solution_frames);
 
 			out_geom.save_pvd(
-				resolve_output_path(args["output"]["paraview"]["file_name"]),
+				pvd_path,
 				[step_name](int i) { return fmt::format(step_name + "{:d}.vtm", i); },
-				t, t0, dt, args["output"]["paraview"]["skip_frame"].get<int>());
+				t, t0, dt, skip_frame);
+		}
+	}
+
+	void State::flush_export()
+	{
+		if (async_writer)
+		{
+			POLYFEM_SCOPED_TIMER("Waiting for the background export");
+			async_writer->flush();
 		}
 	}
 
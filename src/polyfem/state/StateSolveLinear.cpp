@@ -2,9 +2,12 @@
 
 #include <polyfem/time_integrator/ImplicitTimeIntegrator.hpp>
 #include <polyfem/time_integrator/BDF.hpp>
+#include <polyfem/utils/Timer.hpp>
 
 #include <polysolve/FEMSolver.hpp>
 
+#include <limits>
+
 namespace polyfem
 {
 	using namespace mesh;
@@ -41,6 +44,30 @@ namespace polyfem
 			sol_to_pressure();
 	}
 
+	void State::solve_linear_prefactorized(
+		const std::unique_ptr<polysolve::LinearSolver> &solver,
+		const StiffnessMatrix &A,
+		const StiffnessMatrix &A_bc,
+		Eigen::VectorXd &b)
+	{
+		assert(assembler.is_linear(formulation()) && !is_contact_enabled());
+
+		Eigen::VectorXd x(A.rows());
+		polysolve::dirichlet_solve_prefactorized(*solver, A, b, boundary_nodes, x);
+		sol = x; // Explicit copy because sol is a MatrixXd (with one column)
+
+		solver->getInfo(stats.solver_info);
+
+		const auto error = (A_bc * x - b).norm();
+		if (error > 1e-4)
+			logger().error("Solver error: {}", error);
+		else
+			logger().debug("Solver error: {}", error);
+
+		if (assembler.is_mixed(formulation()))
+			sol_to_pressure();
+	}
+
 	void State::solve_linear()
 	{
 		assert(!problem->is_time_dependent());
@@ -57,7 +84,7 @@ namespace polyfem
 
 		solve_data.rhs_assembler->set_bc(
 			local_boundary, boundary_nodes, n_boundary_samples(),
-			(formulation() != "Bilaplacian") ? local_neumann_boundary : std::vector<LocalBoundary>(), rhs);
+			(formulation().type() != assembler::AssemblerType::Bilaplacian) ? local_neumann_boundary : std::vector<LocalBoundary>(), rhs);
 
 		StiffnessMatrix A = stiffness;
 		Eigen::VectorXd b = rhs;
@@ -109,11 +136,23 @@ namespace polyfem
 
 		// --------------------------------------------------------------------
 
+		// A only changes with the scaling of the time integrator (dt and the BDF order), it is factorized
+		// once and the following steps only back-substitute. The fluids remove the zero columns of A in
+		// dirichlet_solve and are always solved from scratch.
+		const bool reuse_factorization = !assembler.is_fluid(formulation());
+		const int precond_num = (problem->is_scalar() ? 1 : mesh->dimension()) * n_bases;
+		StiffnessMatrix A, A_bc; // A_bc must outlive the factorization, the iterative solvers keep a reference to it
+		double factorized_scaling = std::numeric_limits<double>::quiet_NaN();
+
+		timings.factorizing_time = 0;
+		timings.n_factorizations = 0;
+		timings.time_step_solving_times.clear();
+
 		for (int t = 1; t <= time_steps; ++t)
 		{
 			const double time = t0 + t * dt;
 
-			StiffnessMatrix A;
+			double scaling;
 			Eigen::VectorXd b;
 			bool compute_spectrum = args["output"]["advanced"]["spectrum"];
 
@@ -138,7 +177,9 @@ namespace polyfem
 				}
 
 				std::shared_ptr<BDF> bdf = std::dynamic_pointer_cast<BDF>(time_integrator);
-				A = mass / bdf->beta_dt() + stiffness;
+				scaling = bdf->beta_dt();
+				if (scaling != factorized_scaling)
+					A = mass / scaling + stiffness;
 				b = (mass * bdf->weighted_sum_x_prevs()) / bdf->beta_dt();
 				for (int i : boundary_nodes)
 					b[i] = 0;
@@ -161,13 +202,41 @@ namespace polyfem
 				solve_data.rhs_assembler->set_bc(
 					local_boundary, boundary_nodes, n_b_samples, std::vector<LocalBoundary>(), current_rhs, sol, time);
 
-				A = stiffness * time_integrator->acceleration_scaling() + mass;
+				scaling = time_integrator->acceleration_scaling();
+				if (scaling != factorized_scaling)
+					A = stiffness * scaling + mass;
 				b = current_rhs;
 
 				compute_spectrum &= t == 1;
 			}
 
-			solve_linear(solver, A, b, compute_spectrum); // solution is stored in sol
+			double step_time = 0;
+			{
+				POLYFEM_SCOPED_TIMER(step_time);
+
+				// solution is stored in sol
+				if (!reuse_factorization || compute_spectrum)
+				{
+					// the bcs are applied to A in place, resetting factorized_scaling rebuilds it at the next step
+					solve_linear(solver, A, b, compute_spectrum);
+					factorized_scaling = std::numeric_limits<double>::quiet_NaN();
+					++timings.n_factorizations;
+				}
+				else
+				{
+					if (scaling != factorized_scaling)
+					{
+						POLYFEM_SCOPED_TIMER("Factorize transient system", timings.factorizing_time);
+						A_bc = A;
+						polysolve::prefactorize(*solver, A_bc, boundary_nodes, precond_num, args["output"]["data"]["stiffness_mat"]);
+						factorized_scaling = scaling;
+						++timings.n_factorizations;
+					}
+
+					solve_linear_prefactorized(solver, A, A_bc, b);
+				}
+			}
+			timings.time_step_solving_times.push_back(step_time);
 
 			time_integrator->update_quantities(sol);
 
@@ -179,5 +248,7 @@ namespace polyfem
 			resolve_output_path(args["output"]["data"]["u_path"]),
 			resolve_output_path(args["output"]["data"]["v_path"]),
 			resolve_output_path(args["output"]["data"]["a_path"]));
+		if (hdf5_writer)
+			time_integrator->save_raw(*hdf5_writer);
 	}
 } // namespace polyfem
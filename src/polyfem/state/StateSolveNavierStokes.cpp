@@ -15,7 +15,7 @@ namespace polyfem
 	void State::solve_navier_stokes()
 	{
 		assert(!problem->is_time_dependent());
-		assert(formulation() == "NavierStokes");
+		assert(formulation().type() == assembler::AssemblerType::NavierStokes);
 
 		assert(solve_data.rhs_assembler != nullptr);
 		solve_data.rhs_assembler->set_bc(
@@ -42,7 +42,7 @@ namespace polyfem
 
 	void State::solve_transient_navier_stokes_split(const int time_steps, const double dt)
 	{
-		assert(formulation() == "OperatorSplitting" && problem->is_time_dependent());
+		assert(formulation().type() == assembler::AssemblerType::OperatorSplitting && problem->is_time_dependent());
 
 		Eigen::MatrixXd local_pts;
 		auto &gbases = geom_bases();
@@ -154,7 +154,7 @@ namespace polyfem
 
 	void State::solve_transient_navier_stokes(const int time_steps, const double t0, const double dt)
 	{
-		assert(formulation() == "NavierStokes" && problem->is_time_dependent());
+		assert(formulation().type() == assembler::AssemblerType::NavierStokes && problem->is_time_dependent());
 
 		const auto &gbases = geom_bases();
 		Eigen::MatrixXd current_rhs = rhs;
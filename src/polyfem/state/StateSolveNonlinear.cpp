@@ -137,6 +137,8 @@ namespace polyfem
 			resolve_output_path(args["output"]["data"]["u_path"]),
 			resolve_output_path(args["output"]["data"]["v_path"]),
 			resolve_output_path(args["output"]["data"]["a_path"]));
+		if (hdf5_writer)
+			solve_data.time_integrator->save_raw(*hdf5_writer);
 	}
 
 	void State::init_nonlinear_tensor_solve(const double t)
@@ -282,6 +284,7 @@ namespace polyfem
 			local_boundary,
 			n_boundary_samples(),
 			*solve_data.rhs_assembler, t, forms);
+		solve_data.nl_problem->set_fixed_hessian_pattern(args["solver"]["advanced"]["fixed_hessian_pattern"]);
 
 		///////////////////////////////////////////////////////////////////////
 		// Initialize time integrator
@@ -4,6 +4,7 @@
 #include <polyfem/time_integrator/ImplicitNewmark.hpp>
 #include <polyfem/time_integrator/BDF.hpp>
 
+#include <polyfem/io/HDF5Writer.hpp>
 #include <polyfem/io/MatrixIO.hpp>
 #include <polyfem/utils/Logger.hpp>
 
@@ -41,6 +42,13 @@ namespace polyfem
 				write_matrix(a_path, a_prev());
 		}
 
+		void ImplicitTimeIntegrator::save_raw(HDF5Writer &writer) const
+		{
+			writer.write_matrix("/raw/u", x_prev());
+			writer.write_matrix("/raw/v", v_prev());
+			writer.write_matrix("/raw/a", a_prev());
+		}
+
 		std::shared_ptr<ImplicitTimeIntegrator> ImplicitTimeIntegrator::construct_time_integrator(const json &params)
 		{
 			const std::string type = params.is_object() ? params["type"] : params;
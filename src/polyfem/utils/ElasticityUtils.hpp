@@ -107,6 +107,7 @@ namespace polyfem
 
 		void add_multimaterial(const int index, const json &params);
 
+		// safe to call concurrently, the assemblers evaluate it in parallel
 		double operator()(double px, double py, double pz, double x, double y, double z, int el_id) const;
 		double operator()(const Eigen::MatrixXd &param, const Eigen::MatrixXd &p, int el_id) const
 		{
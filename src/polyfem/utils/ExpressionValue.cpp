@@ -7,6 +7,7 @@
 
 #include <tinyexpr.h>
 #include <filesystem>
+#include <limits>
 
 namespace polyfem
 {
@@ -34,6 +35,61 @@ namespace polyfem
 			return check >= 0 ? ttrue : ffalse;
 		}
 
+		ExpressionValue::Programs::Program::~Program()
+		{
+			te_free(expr);
+		}
+
+		ExpressionValue::Programs::Programs(const std::string &expr)
+			: expr_(expr)
+		{
+			programs_.emplace_back(std::this_thread::get_id(), compile(expr_));
+		}
+
+		ExpressionValue::Programs::Program &ExpressionValue::Programs::local()
+		{
+			const std::thread::id id = std::this_thread::get_id();
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (auto &p : programs_)
+			{
+				if (p.first == id)
+					return *p.second;
+			}
+			programs_.emplace_back(id, compile(expr_));
+			return *programs_.back().second;
+		}
+
+		std::unique_ptr<ExpressionValue::Programs::Program> ExpressionValue::Programs::compile(const std::string &expr)
+		{
+			// tinyexpr reads the variables through the addresses given at compile time,
+			// each thread compiles its own tree bound to the variables of its program
+			auto program = std::make_unique<Program>();
+
+			const std::vector<te_variable> vars = {
+				{"x", &program->vars[0], TE_VARIABLE},
+				{"y", &program->vars[1], TE_VARIABLE},
+				{"z", &program->vars[2], TE_VARIABLE},
+				{"t", &program->vars[3], TE_VARIABLE},
+				{"min", (const void *)min, TE_FUNCTION2},
+				{"max", (const void *)max, TE_FUNCTION2},
+				{"deg2rad", (const void *)deg2rad, TE_FUNCTION1},
+				{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3},
+				{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3},
+				{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3},
+				{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2},
+			};
+
+			int err;
+			program->expr = te_compile(expr.c_str(), vars.data(), vars.size(), &err);
+			if (!program->expr)
+			{
+				logger().error("Unable to parse: {}", expr);
+				logger().error("Error near here: {0: >{1}}", "^", err - 1);
+				log_and_throw_error(fmt::format("Unable to parse expression {}", expr));
+			}
+			return program;
+		}
+
 		ExpressionValue::ExpressionValue()
 		{
 			clear();
@@ -42,6 +98,7 @@ namespace polyfem
 		void ExpressionValue::clear()
 		{
 			expr_ = "";
+			programs_ = nullptr;
 			mat_.resize(0, 0);
 			sfunc_ = nullptr;
 			tfunc_ = nullptr;
@@ -81,31 +138,7 @@ namespace polyfem
 
 			expr_ = expr;
 
-			double x = 0, y = 0, z = 0, t = 0;
-
-			std::vector<te_variable> vars = {
-				{"x", &x, TE_VARIABLE},
-				{"y", &y, TE_VARIABLE},
-				{"z", &z, TE_VARIABLE},
-				{"t", &t, TE_VARIABLE},
-				{"min", (const void *)min, TE_FUNCTION2},
-				{"max", (const void *)max, TE_FUNCTION2},
-				{"deg2rad", (const void *)deg2rad, TE_FUNCTION1},
-				{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3},
-				{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3},
-				{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3},
-				{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2},
-			};
-
-			int err;
-			te_expr *tmp = te_compile(expr.c_str(), vars.data(), vars.size(), &err);
-			if (!tmp)
-			{
-				logger().error("Unable to parse: {}", expr);
-				logger().error("Error near here: {0: >{1}}", "^", err - 1);
-				assert(false);
-			}
-			te_free(tmp);
+			programs_ = std::make_shared<Programs>(expr_);
 		}
 
 		void ExpressionValue::init(const json &vals)
@@ -176,27 +209,49 @@ namespace polyfem
 				return value_;
 			}
 
-			std::vector<te_variable> vars = {
-				{"x", &x, TE_VARIABLE},
-				{"y", &y, TE_VARIABLE},
-				{"z", &z, TE_VARIABLE},
-				{"t", &t, TE_VARIABLE},
-				{"min", (const void *)min, TE_FUNCTION2},
-				{"max", (const void *)max, TE_FUNCTION2},
-				{"deg2rad", (const void *)deg2rad, TE_FUNCTION1},
-				{"rotate_2D_x", (const void *)rotate_2D_x, TE_FUNCTION3},
-				{"rotate_2D_y", (const void *)rotate_2D_y, TE_FUNCTION3},
-				{"if", (const void *)iflargerthanzerothenelse, TE_FUNCTION3},
-				{"smooth_abs", (const void *)smooth_abs, TE_FUNCTION2},
-			};
+			if (!programs_)
+				return std::numeric_limits<double>::quiet_NaN();
+			Programs::Program &program = programs_->local();
+			program.vars[0] = x;
+			program.vars[1] = y;
+			program.vars[2] = z;
+			program.vars[3] = t;
+			return te_eval(program.expr);
+		}
 
-			int err;
-			te_expr *tmp = te_compile(expr_.c_str(), vars.data(), vars.size(), &err);
-			assert(tmp != nullptr);
-			const auto res = te_eval(tmp);
-			te_free(tmp);
+		void ExpressionValue::evaluate(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &out) const
+		{
+			assert(pts.cols() == 2 || pts.cols() == 3);
+			out.resize(pts.rows());
+			const bool planar = pts.cols() == 2;
+
+			if (expr_.empty())
+			{
+				if (mat_.size() == 0 && !sfunc_ && !tfunc_)
+				{
+					out.setConstant(value_);
+					return;
+				}
 
-			return res;
+				for (long i = 0; i < pts.rows(); ++i)
+					out(i) = (*this)(pts(i, 0), pts(i, 1), planar ? 0 : pts(i, 2), t);
+				return;
+			}
+
+			if (!programs_)
+			{
+				out.setConstant(std::numeric_limits<double>::quiet_NaN());
+				return;
+			}
+			Programs::Program &program = programs_->local();
+			program.vars[3] = t;
+			for (long i = 0; i < pts.rows(); ++i)
+			{
+				program.vars[0] = pts(i, 0);
+				program.vars[1] = pts(i, 1);
+				program.vars[2] = planar ? 0 : pts(i, 2);
+				out(i) = te_eval(program.expr);
+			}
 		}
 	} // namespace utils
 } // namespace polyfem
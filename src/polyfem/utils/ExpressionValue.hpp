@@ -2,6 +2,13 @@
 
 #include <polyfem/Common.hpp>
 
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct te_expr;
+
 namespace polyfem
 {
 	namespace utils
@@ -22,6 +29,12 @@ namespace polyfem
 
 			double operator()(double x, double y, double z = 0, double t = 0, int index = -1) const;
 
+			/// evaluates the expression at every row of pts (2 or 3 columns) at time t
+			/// @param[in] pts points, one per row
+			/// @param[in] t time
+			/// @param[out] out values, one per point
+			void evaluate(const Eigen::MatrixXd &pts, const double t, Eigen::VectorXd &out) const;
+
 			void clear();
 
 			bool is_zero() const { return expr_.empty() && fabs(value_) < 1e-10; }
@@ -31,7 +44,33 @@ namespace polyfem
 			std::function<Eigen::MatrixXd(double x, double y, double z, double t)> tfunc_;
 			int tfunc_coo_;
 
+			/// expression compiled by each thread against its own variables, shared between copies
+			class Programs
+			{
+			public:
+				struct Program
+				{
+					double vars[4] = {0, 0, 0, 0}; ///< x, y, z, t bound by the compiled expression
+					te_expr *expr = nullptr;
+					~Program();
+				};
+
+				/// compiles expr on the calling thread, throws if it does not parse
+				Programs(const std::string &expr);
+
+				/// program of the calling thread, compiled on its first use
+				Program &local();
+
+			private:
+				static std::unique_ptr<Program> compile(const std::string &expr);
+
+				const std::string expr_;
+				std::mutex mutex_;
+				std::vector<std::pair<std::thread::id, std::unique_ptr<Program>>> programs_;
+			};
+
 			std::string expr_;
+			std::shared_ptr<Programs> programs_;
 			double value_;
 			Eigen::MatrixXd mat_;
 		};
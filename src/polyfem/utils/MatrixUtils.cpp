@@ -6,6 +6,8 @@
 
 #include <igl/list_to_matrix.h>
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <iomanip> // setprecision
@@ -50,6 +52,26 @@ polyfem::utils::SpareMatrixCache::SpareMatrixCache(const polyfem::utils::SpareMa
 	init(other);
 }
 
+polyfem::utils::SpareMatrixCache &polyfem::utils::SpareMatrixCache::operator=(const polyfem::utils::SpareMatrixCache &other)
+{
+	if (this == &other)
+		return *this;
+
+	entries_.clear();
+	mapping_.clear();
+	inner_index_.clear();
+	outer_index_.clear();
+	second_cache_.clear();
+	second_cache_entries_.clear();
+	use_second_cache_ = true;
+	current_e_ = -1;
+	current_e_index_ = -1;
+	main_cache_ = nullptr;
+
+	init(other);
+	return *this;
+}
+
 void polyfem::utils::SpareMatrixCache::init(const size_t size)
 {
 	assert(mapping().empty() || size_ == size);
@@ -157,7 +179,7 @@ void polyfem::utils::SpareMatrixCache::prune()
 	}
 }
 
-polyfem::StiffnessMatrix polyfem::utils::SpareMatrixCache::get_matrix(const bool compute_mapping)
+const polyfem::StiffnessMatrix &polyfem::utils::SpareMatrixCache::get_matrix(const bool compute_mapping)
 {
 	prune();
 
@@ -234,8 +256,12 @@ polyfem::StiffnessMatrix polyfem::utils::SpareMatrixCache::get_matrix(const bool
 		assert(size_ > 0);
 		const auto &outer_index = main_cache_ == nullptr ? outer_index_ : main_cache_->outer_index_;
 		const auto &inner_index = main_cache_ == nullptr ? inner_index_ : main_cache_->inner_index_;
-		mat_ = Eigen::Map<const StiffnessMatrix>(
-			size_, size_, values_.size(), &outer_index[0], &inner_index[0], &values_[0]);
+		// set_zero emptied mat_ but kept its memory, the pattern and values are copied back into it
+		mat_.resize(size_, size_);
+		mat_.resizeNonZeros(values_.size());
+		std::copy(outer_index.begin(), outer_index.end(), mat_.outerIndexPtr());
+		std::copy(inner_index.begin(), inner_index.end(), mat_.innerIndexPtr());
+		std::copy(values_.begin(), values_.end(), mat_.valuePtr());
 
 		if (use_second_cache_)
 		{
@@ -445,4 +471,320 @@ void polyfem::utils::full_to_reduced_matrix(
 	reduced.resize(reduced_size, reduced_size);
 	reduced.setFromTriplets(entries.begin(), entries.end());
 	reduced.makeCompressed();
-}
\ No newline at end of file
+}
+
+namespace
+{
+	// pattern versions are unique among all the FixedPatternMatrix so that a ScatterMap
+	// built for one matrix is never mistaken for a map of another one
+	std::atomic<size_t> next_pattern_version(0);
+} // namespace
+
+void polyfem::utils::FixedPatternMatrix::pattern_changed()
+{
+	pattern_version_ = next_pattern_version++;
+}
+
+void polyfem::utils::FixedPatternMatrix::set_zero(const int rows, const int cols, StiffnessMatrix *handed_out)
+{
+	if (handed_out_)
+	{
+		// take the storage back if the matrix was not modified, rebuild the pattern otherwise
+		if (handed_out && handed_out_pattern_.matches(*handed_out) && handed_out->isCompressed())
+			mat_.swap(*handed_out);
+		else
+			handed_out_pattern_.zero_matrix(mat_);
+		handed_out_ = false;
+	}
+
+	if (mat_.rows() != rows || mat_.cols() != cols)
+	{
+		mat_.resize(rows, cols);
+		mat_.makeCompressed();
+		used_.clear();
+		pattern_changed();
+		return;
+	}
+
+	assert(mat_.isCompressed());
+	mat_.coeffs().setZero();
+	std::fill(used_.begin(), used_.end(), false);
+}
+
+void polyfem::utils::FixedPatternMatrix::clear()
+{
+	mat_.resize(0, 0);
+	used_.clear();
+	handed_out_ = false;
+	pattern_changed();
+}
+
+void polyfem::utils::FixedPatternMatrix::swap_out(StiffnessMatrix &m)
+{
+	assert(!handed_out_);
+	handed_out_pattern_.assign(mat_);
+	mat_.swap(m);
+	handed_out_ = true;
+}
+
+bool polyfem::utils::FixedPatternMatrix::shrink(const double max_unused)
+{
+	const Eigen::Index nnz = mat_.nonZeros();
+	if (nnz == 0)
+		return false;
+
+	assert(mat_.isCompressed() && used_.size() == size_t(nnz));
+	const Eigen::Index n_unused = std::count(used_.begin(), used_.end(), false);
+	if (n_unused <= max_unused * nnz)
+		return false;
+
+	POLYFEM_SCOPED_TIMER("shrink fixed sparsity pattern");
+	std::vector<StiffnessMatrix::StorageIndex> outer(mat_.outerSize() + 1), inner;
+	std::vector<double> values;
+	inner.reserve(nnz - n_unused);
+	values.reserve(nnz - n_unused);
+	for (int k = 0; k < mat_.outerSize(); ++k)
+	{
+		for (auto j = mat_.outerIndexPtr()[k]; j < mat_.outerIndexPtr()[k + 1]; ++j)
+		{
+			if (!used_[j])
+				continue;
+			inner.push_back(mat_.innerIndexPtr()[j]);
+			values.push_back(mat_.valuePtr()[j]);
+		}
+		outer[k + 1] = inner.size();
+	}
+
+	mat_ = Eigen::Map<const StiffnessMatrix>(
+		mat_.rows(), mat_.cols(), inner.size(),
+		outer.data(), inner.data(), values.data());
+	used_.assign(inner.size(), true);
+	pattern_changed();
+	return true;
+}
+
+void polyfem::utils::FixedPatternMatrix::add(const StiffnessMatrix &m, const double scale)
+{
+	assert(!handed_out_);
+	assert(m.rows() == mat_.rows() && m.cols() == mat_.cols());
+
+	if (m.nonZeros() == 0)
+		return;
+
+	if (mat_.nonZeros() == 0)
+	{
+		mat_ = scale * m;
+		mat_.makeCompressed();
+		used_.assign(mat_.nonZeros(), true);
+		pattern_changed();
+		return;
+	}
+
+	for (int k = 0; k < m.outerSize(); ++k)
+	{
+		for (StiffnessMatrix::InnerIterator it(m, k); it; ++it)
+		{
+			const auto *begin = mat_.innerIndexPtr() + mat_.outerIndexPtr()[k];
+			const auto *end = mat_.innerIndexPtr() + mat_.outerIndexPtr()[k + 1];
+			const auto *pos = std::lower_bound(begin, end, it.index());
+
+			if (pos == end || *pos != it.index())
+			{
+				// Grow the pattern with the one of m. The values already scattered are
+				// kept since the added entries are explicit zeros.
+				POLYFEM_SCOPED_TIMER("grow fixed sparsity pattern");
+				StiffnessMatrix pattern = m;
+				pattern.makeCompressed();
+				pattern.coeffs().setZero();
+
+				// the used flags follow the entries in the grown pattern
+				StiffnessMatrix used = mat_;
+				for (size_t i = 0; i < used_.size(); ++i)
+					used.valuePtr()[i] = used_[i] ? 1 : 0;
+				used = used + pattern;
+
+				mat_ = mat_ + pattern;
+				used_.resize(mat_.nonZeros());
+				for (size_t i = 0; i < used_.size(); ++i)
+					used_[i] = used.valuePtr()[i] != 0;
+				pattern_changed();
+
+				begin = mat_.innerIndexPtr() + mat_.outerIndexPtr()[k];
+				end = mat_.innerIndexPtr() + mat_.outerIndexPtr()[k + 1];
+				pos = std::lower_bound(begin, end, it.index());
+				assert(pos != end && *pos == it.index());
+			}
+
+			const auto index = pos - mat_.innerIndexPtr();
+			mat_.valuePtr()[index] += scale * it.value();
+			used_[index] = true;
+		}
+	}
+}
+
+void polyfem::utils::FixedPatternMatrix::add(const StiffnessMatrix &m, ScatterMap &map, const double scale)
+{
+	if (!m.isCompressed())
+	{
+		add(m, scale);
+		return;
+	}
+
+	if (map.pattern_version != pattern_version_ || map.indices.size() != size_t(m.nonZeros()))
+	{
+		// grows the pattern if needed, the positions are then looked up once
+		add(m, scale);
+
+		map.indices.resize(m.nonZeros());
+		for (int k = 0; k < m.outerSize(); ++k)
+		{
+			const auto *begin = mat_.innerIndexPtr() + mat_.outerIndexPtr()[k];
+			const auto *end = mat_.innerIndexPtr() + mat_.outerIndexPtr()[k + 1];
+			for (auto j = m.outerIndexPtr()[k]; j < m.outerIndexPtr()[k + 1]; ++j)
+			{
+				const auto *pos = std::lower_bound(begin, end, m.innerIndexPtr()[j]);
+				assert(pos != end && *pos == m.innerIndexPtr()[j]);
+				map.indices[j] = pos - mat_.innerIndexPtr();
+			}
+		}
+		map.pattern_version = pattern_version_;
+		return;
+	}
+
+	assert(!handed_out_);
+	double *values = mat_.valuePtr();
+	const double *m_values = m.valuePtr();
+	for (size_t i = 0; i < map.indices.size(); ++i)
+	{
+		values[map.indices[i]] += scale * m_values[i];
+		used_[map.indices[i]] = true;
+	}
+}
+
+void polyfem::utils::SparsityPattern::assign(const StiffnessMatrix &m)
+{
+	rows_ = m.rows();
+	cols_ = m.cols();
+	outer_.clear();
+	inner_.clear();
+	outer_.reserve(m.outerSize() + 1);
+	inner_.reserve(m.nonZeros());
+
+	for (int k = 0; k < m.outerSize(); ++k)
+	{
+		outer_.push_back(inner_.size());
+		for (StiffnessMatrix::InnerIterator it(m, k); it; ++it)
+			inner_.push_back(it.index());
+	}
+	outer_.push_back(inner_.size());
+}
+
+bool polyfem::utils::SparsityPattern::matches(const StiffnessMatrix &m) const
+{
+	if (m.rows() != rows_ || m.cols() != cols_ || size_t(m.outerSize() + 1) != outer_.size() || size_t(m.nonZeros()) != inner_.size())
+		return false;
+
+	size_t i = 0;
+	for (int k = 0; k < m.outerSize(); ++k)
+	{
+		if (size_t(outer_[k]) != i)
+			return false;
+		for (StiffnessMatrix::InnerIterator it(m, k); it; ++it, ++i)
+		{
+			if (i >= inner_.size() || inner_[i] != it.index())
+				return false;
+		}
+	}
+
+	return i == inner_.size();
+}
+
+void polyfem::utils::SparsityPattern::zero_matrix(StiffnessMatrix &m) const
+{
+	m.resize(rows_, cols_);
+	m.resizeNonZeros(inner_.size());
+	std::copy(outer_.begin(), outer_.end(), m.outerIndexPtr());
+	std::copy(inner_.begin(), inner_.end(), m.innerIndexPtr());
+	std::fill(m.valuePtr(), m.valuePtr() + inner_.size(), 0.);
+}
+
+void polyfem::utils::SparsityPattern::clear()
+{
+	rows_ = -1;
+	cols_ = -1;
+	outer_.clear();
+	inner_.clear();
+}
+
+void polyfem::utils::FullToReducedMatrixMap::init(
+	const int full_size,
+	const int reduced_size,
+	const std::vector<int> &removed_vars,
+	const StiffnessMatrix &full)
+{
+	POLYFEM_SCOPED_TIMER("build full to reduced matrix map");
+
+	assert(full.rows() == full_size && full.cols() == full_size);
+	assert(full.isCompressed());
+
+	std::vector<int> indices(full_size);
+	int index = 0;
+	size_t kk = 0;
+	for (int i = 0; i < full_size; ++i)
+	{
+		if (kk < removed_vars.size() && removed_vars[kk] == i)
+		{
+			++kk;
+			indices[i] = -1;
+		}
+		else
+		{
+			indices[i] = index++;
+		}
+	}
+	assert(index == reduced_size);
+
+	// Dropping rows and columns keeps the relative order of the remaining
+	// entries, so the reduced matrix can be written directly in compressed form.
+	std::vector<StiffnessMatrix::StorageIndex> outer(reduced_size + 1, 0);
+	std::vector<StiffnessMatrix::StorageIndex> inner;
+	inner.reserve(full.nonZeros());
+	gather_.clear();
+	gather_.reserve(full.nonZeros());
+
+	for (int k = 0; k < full.outerSize(); ++k)
+	{
+		if (indices[k] < 0)
+			continue;
+
+		for (auto j = full.outerIndexPtr()[k]; j < full.outerIndexPtr()[k + 1]; ++j)
+		{
+			const int r = indices[full.innerIndexPtr()[j]];
+			if (r < 0)
+				continue;
+
+			inner.push_back(r);
+			gather_.push_back(j);
+		}
+		outer[indices[k] + 1] = inner.size();
+	}
+
+	const std::vector<double> values(inner.size(), 0);
+	reduced_ = Eigen::Map<const StiffnessMatrix>(
+		reduced_size, reduced_size, inner.size(),
+		outer.data(), inner.data(), values.data());
+	full_non_zeros_ = full.nonZeros();
+}
+
+void polyfem::utils::FullToReducedMatrixMap::apply(const StiffnessMatrix &full, StiffnessMatrix &reduced) const
+{
+	POLYFEM_SCOPED_TIMER("full to reduced matrix");
+
+	assert(full.isCompressed() && full.nonZeros() == full_non_zeros_);
+
+	reduced = reduced_;
+	double *values = reduced.valuePtr();
+	const double *full_values = full.valuePtr();
+	for (size_t i = 0; i < gather_.size(); ++i)
+		values[i] = full_values[gather_[i]];
+}
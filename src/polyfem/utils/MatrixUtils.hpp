@@ -43,6 +43,8 @@ namespace polyfem
 			SpareMatrixCache(const size_t size);
 			SpareMatrixCache(const size_t rows, const size_t cols);
 			SpareMatrixCache(const SpareMatrixCache &other);
+			// same as the copy constructor, but keeps the memory already allocated for the entries
+			SpareMatrixCache &operator=(const SpareMatrixCache &other);
 
 			void init(const size_t size);
 			void init(const size_t rows, const size_t cols);
@@ -57,7 +59,17 @@ namespace polyfem
 			inline size_t mapping_size() const { return mapping_.size(); }
 
 			void add_value(const int e, const int i, const int j, const double value);
-			StiffnessMatrix get_matrix(const bool compute_mapping = true);
+
+			// true once get_matrix has computed where the entries of every element go in the value array,
+			// later assemblies can then scatter directly with add_to_value
+			inline bool has_element_mapping() const { return use_second_cache_ && !mapping().empty(); }
+			// positions in the value array of the entries of element e, in the order they were added in the first assembly
+			inline const std::vector<int> &element_value_indices(const int e) const { return second_cache()[e]; }
+			// adds value to the index-th entry of the value array,
+			// it can be called concurrently as long as the threads never touch the same index
+			inline void add_to_value(const int index, const double value) { values_[index] += value; }
+			// assembled matrix, kept in the cache whose storage is reused once the mapping is known
+			const StiffnessMatrix &get_matrix(const bool compute_mapping = true);
 			void prune();
 
 			SpareMatrixCache operator+(const SpareMatrixCache &a) const;
@@ -115,5 +127,132 @@ namespace polyfem
 			const std::vector<int> &removed_vars,
 			const StiffnessMatrix &full,
 			StiffnessMatrix &reduced);
+
+		/// @brief Copy of the sparsity pattern (outer and inner indices) of a matrix.
+		///
+		/// Used to detect exactly when the pattern of a matrix changes, e.g., to reuse a
+		/// symbolic factorization, without keeping its values.
+		class SparsityPattern
+		{
+		public:
+			/// @brief Store the pattern of m.
+			void assign(const StiffnessMatrix &m);
+
+			/// @brief Whether m has exactly the stored pattern, works for uncompressed matrices.
+			bool matches(const StiffnessMatrix &m) const;
+
+			/// @brief Set m to a compressed matrix with the stored pattern and zero values.
+			void zero_matrix(StiffnessMatrix &m) const;
+
+			/// @brief Drop the pattern, nothing matches afterwards.
+			void clear();
+
+		private:
+			Eigen::Index rows_ = -1;
+			Eigen::Index cols_ = -1;
+			std::vector<StiffnessMatrix::StorageIndex> outer_;
+			std::vector<StiffnessMatrix::StorageIndex> inner_;
+		};
+
+		/// @brief Sparse matrix whose sparsity pattern is kept between assemblies.
+		///
+		/// Adding a matrix whose pattern is already contained only scatters its values.
+		/// Entries outside the pattern (e.g., new contact pairs) enlarge it once, and the
+		/// enlarged pattern is kept for the subsequent assemblies until shrink drops the
+		/// entries that are no longer assembled.
+		class FixedPatternMatrix
+		{
+		public:
+			/// @brief Positions in the values of a FixedPatternMatrix of the entries of a compressed matrix,
+			/// kept by the owner of the matrix so that adding it again only scatters its values
+			/// (as SpareMatrixCache does for the element matrices). The owner clears it when the pattern of its matrix changes.
+			struct ScatterMap
+			{
+				size_t pattern_version = size_t(-1); ///< Pattern the positions refer to
+				std::vector<StiffnessMatrix::StorageIndex> indices;
+
+				void clear()
+				{
+					pattern_version = size_t(-1);
+					indices.clear();
+				}
+			};
+
+			/// @brief Zero all values, keeping the pattern if the size did not change.
+			/// @param[in] rows Number of rows.
+			/// @param[in] cols Number of columns.
+			/// @param[in,out] handed_out Matrix given by swap_out, its storage is taken back if it still has the pattern.
+			void set_zero(const int rows, const int cols, StiffnessMatrix *handed_out = nullptr);
+
+			/// @brief Add scale times m to the matrix, growing the pattern if needed.
+			void add(const StiffnessMatrix &m, const double scale = 1);
+
+			/// @brief Add scale times m to the matrix through the positions in map, computed on the first call and whenever the pattern changed.
+			void add(const StiffnessMatrix &m, ScatterMap &map, const double scale = 1);
+
+			/// @brief Drop the pattern.
+			void clear();
+
+			/// @brief Remove the entries not added since the last set_zero if they are more than max_unused of the pattern.
+			///
+			/// The entries of the contact pairs that are no longer active stay in the pattern as zeros,
+			/// without shrinking the pattern would be the union of all pairs seen since the start.
+			/// Explicit zeros of the added matrices are kept.
+			/// @param[in] max_unused Fraction of zero entries above which the pattern is rebuilt.
+			/// @return If the pattern changed.
+			bool shrink(const double max_unused = 0.1);
+
+			/// @brief Hand the assembled matrix to m by swapping their storage instead of copying it.
+			/// Pass m back to the next set_zero to reuse its storage.
+			void swap_out(StiffnessMatrix &m);
+
+			const StiffnessMatrix &mat() const { return mat_; }
+
+			/// @brief Counter changed every time the pattern changes, unique among all FixedPatternMatrix.
+			size_t pattern_version() const { return pattern_version_; }
+
+		private:
+			StiffnessMatrix mat_;
+			/// entries of mat_ added since the last set_zero
+			std::vector<bool> used_;
+			size_t pattern_version_ = size_t(-1);
+			/// pattern of mat_ while it is handed out
+			SparsityPattern handed_out_pattern_;
+			bool handed_out_ = false;
+
+			void pattern_changed();
+		};
+
+		/// @brief Precomputed version of full_to_reduced_matrix for a fixed pattern.
+		///
+		/// Stores, for every entry of the reduced matrix, the index of the corresponding
+		/// entry of the full one so that the reduction becomes a gather of values.
+		class FullToReducedMatrixMap
+		{
+		public:
+			/// @brief Build the reduced pattern and the gather map.
+			/// @param[in] full_size Number of variables in the full system.
+			/// @param[in] reduced_size Number of variables in the reduced system.
+			/// @param[in] removed_vars Sorted indices of the variables to remove.
+			/// @param[in] full Compressed full size matrix.
+			void init(
+				const int full_size,
+				const int reduced_size,
+				const std::vector<int> &removed_vars,
+				const StiffnessMatrix &full);
+
+			/// @brief Gather the values of full into reduced.
+			/// @param[in] full Matrix with the same pattern as the one used in init.
+			/// @param[out] reduced Output reduced size matrix.
+			void apply(const StiffnessMatrix &full, StiffnessMatrix &reduced) const;
+
+			/// @brief Pattern version (see FixedPatternMatrix) the map was built for.
+			size_t pattern_version = size_t(-1);
+
+		private:
+			StiffnessMatrix reduced_;
+			std::vector<StiffnessMatrix::StorageIndex> gather_;
+			Eigen::Index full_non_zeros_ = 0;
+		};
 	} // namespace utils
 } // namespace polyfem
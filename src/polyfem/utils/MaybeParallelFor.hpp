@@ -10,6 +10,10 @@
 // Not using parallel for
 #endif
 
+#include <array>
+#include <cassert>
+#include <functional>
+
 namespace polyfem
 {
 	namespace utils
@@ -22,8 +26,10 @@ namespace polyfem
 
 		// Returns thread specific storage for further use in `maybe_parallel_for()`.
 		// The return type depends on the threading library used.
-		//     TBB         ⟹ `std::vector<LocalStorage>`
-		//     C++ Threads ⟹ `tbb::enumerable_thread_specific<LocalStorage>`
+		//     TBB         ⟹ `tbb::enumerable_thread_specific<LocalStorage>`
+		//     C++ Threads ⟹ `ThreadStorage<LocalStorage>` with one entry per thread of the
+		//                   persistent pool, indexed by the `thread_id` passed to the loop body,
+		//                   the entries are reused by the next storage of the same type
 		//     none        ⟹ `std::array<LocalStorage, 1>`
 		template <typename LocalStorage>
 		inline auto create_thread_storage(const LocalStorage &initial_local_storage);
@@ -31,8 +31,10 @@ namespace polyfem
 		inline void maybe_parallel_for(int size, const std::function<void(int)> &body)
 		{
 #if defined(POLYFEM_WITH_CPP_THREADS)
-			for (int i = 0; i < size; ++i)
-				body(i);
+			par_for(size, [&](int start, int end, int /*thread_id*/) {
+				for (int i = start; i < end; ++i)
+					body(i);
+			});
 #elif defined(POLYFEM_WITH_TBB)
 			tbb::parallel_for(0, size, body);
 #else
@@ -45,7 +47,7 @@ namespace polyfem
 		inline auto create_thread_storage(const LocalStorage &initial_local_storage)
 		{
 #if defined(POLYFEM_WITH_CPP_THREADS)
-			return std::vector<LocalStorage>(get_n_threads(), initial_local_storage);
+			return ThreadStorage<LocalStorage>(initial_local_storage);
 #elif defined(POLYFEM_WITH_TBB)
 			return tbb::enumerable_thread_specific<LocalStorage>(initial_local_storage);
 #else
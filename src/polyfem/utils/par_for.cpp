@@ -2,26 +2,251 @@
 
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <unordered_map>
 
 namespace polyfem
 {
 	namespace utils
 	{
-		void par_for(const int size, const std::function<void(int, int, int)> &func)
+		namespace
 		{
-#ifdef POLYFEM_WITH_CPP_THREADS
-			const size_t n_threads = get_n_threads();
-			std::vector<std::thread> threads(n_threads);
+			/// Id of the pool thread executing the current task, -1 outside of par_for.
+			thread_local int current_thread_id = -1;
+
+			/// Workers are created once and sleep between calls instead of being
+			/// spawned and joined at every par_for.
+			class ThreadPool
+			{
+			public:
+				static ThreadPool &get()
+				{
+					static ThreadPool instance;
+					return instance;
+				}
+
+				~ThreadPool() { stop_workers(); }
+
+				void run(const int size, const std::function<void(int, int, int)> &func)
+				{
+					const int n_threads = get_n_threads();
+
+					if (current_thread_id >= 0)
+					{
+						func(0, size, current_thread_id);
+						return;
+					}
+
+					if (n_threads <= 1 || size <= 1)
+					{
+						run_serial(size, func);
+						return;
+					}
+
+					// Another thread owns the workers, waiting for it would serialize the callers:
+					// the loop runs on the calling thread instead, with its own ThreadStorage
+					if (busy_.exchange(true))
+					{
+						run_serial(size, func);
+						return;
+					}
+					const BusyGuard busy_guard{busy_};
+
+					resize(n_threads - 1);
+
+					{
+						std::lock_guard<std::mutex> lock(mutex_);
+						func_ = &func;
+						size_ = size;
+						// A few chunks per thread to balance the load without too much contention
+						chunk_ = std::max(1, size / (8 * n_threads));
+						next_ = 0;
+						running_ = workers_.size();
+						error_ = nullptr;
+						++generation_;
+					}
+					start_cv_.notify_all();
+
+					current_thread_id = 0;
+					execute(0);
+					current_thread_id = -1;
+
+					{
+						std::unique_lock<std::mutex> lock(mutex_);
+						done_cv_.wait(lock, [&] { return running_ == 0; });
+						func_ = nullptr;
+					}
+
+					if (error_)
+						std::rethrow_exception(error_);
+				}
+
+				std::shared_ptr<void> acquire_storage(const std::type_index &type)
+				{
+					std::lock_guard<std::mutex> lock(storages_mutex_);
+					const auto it = free_storages_.find(type);
+					if (it == free_storages_.end() || it->second.empty())
+						return nullptr;
+					std::shared_ptr<void> storages = std::move(it->second.back());
+					it->second.pop_back();
+					return storages;
+				}
+
+				void release_storage(const std::type_index &type, std::shared_ptr<void> storages)
+				{
+					std::lock_guard<std::mutex> lock(storages_mutex_);
+					std::vector<std::shared_ptr<void>> &free = free_storages_[type];
+					if (free.size() < max_free_storages)
+						free.push_back(std::move(storages));
+				}
+
+			private:
+				ThreadPool() {}
+
+				struct BusyGuard
+				{
+					std::atomic<bool> &busy;
+					~BusyGuard() { busy = false; }
+				};
+
+				static void run_serial(const int size, const std::function<void(int, int, int)> &func)
+				{
+					current_thread_id = 0;
+					try
+					{
+						func(0, size, 0);
+					}
+					catch (...)
+					{
+						current_thread_id = -1;
+						throw;
+					}
+					current_thread_id = -1;
+				}
+
+				void resize(const size_t n_workers)
+				{
+					if (workers_.size() == n_workers)
+						return;
 
-			for (int t = 0; t < n_threads; t++)
+					{
+						// the entries were sized for the previous number of threads
+						std::lock_guard<std::mutex> lock(storages_mutex_);
+						free_storages_.clear();
+					}
+
+					stop_workers();
+					workers_.reserve(n_workers);
+					for (size_t t = 0; t < n_workers; ++t)
+						workers_.emplace_back(&ThreadPool::worker_loop, this, int(t + 1), generation_);
+				}
+
+				void stop_workers()
+				{
+					{
+						std::lock_guard<std::mutex> lock(mutex_);
+						stop_ = true;
+					}
+					start_cv_.notify_all();
+					for (auto &w : workers_)
+						w.join();
+					workers_.clear();
+					stop_ = false;
+				}
+
+				void worker_loop(const int thread_id, size_t seen_generation)
+				{
+					current_thread_id = thread_id;
+					while (true)
+					{
+						{
+							std::unique_lock<std::mutex> lock(mutex_);
+							start_cv_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+							if (stop_)
+								return;
+							seen_generation = generation_;
+						}
+
+						execute(thread_id);
+
+						{
+							std::lock_guard<std::mutex> lock(mutex_);
+							if (--running_ == 0)
+								done_cv_.notify_one();
+						}
+					}
+				}
+
+				void execute(const int thread_id)
+				{
+					while (true)
+					{
+						const int start = next_.fetch_add(chunk_);
+						if (start >= size_)
+							break;
+						const int end = std::min(size_, start + chunk_);
+
+						try
+						{
+							(*func_)(start, end, thread_id);
+						}
+						catch (...)
+						{
+							std::lock_guard<std::mutex> lock(mutex_);
+							if (!error_)
+								error_ = std::current_exception();
+							next_ = size_;
+							break;
+						}
+					}
+				}
+
+				std::vector<std::thread> workers_;
+
+				// set while a caller owns the workers
+				std::atomic<bool> busy_{false};
+				std::mutex mutex_;
+				std::condition_variable start_cv_;
+				std::condition_variable done_cv_;
+				size_t generation_ = 0;
+				bool stop_ = false;
+
+				// Current task
+				const std::function<void(int, int, int)> *func_ = nullptr;
+				int size_ = 0;
+				int chunk_ = 1;
+				std::atomic<int> next_{0};
+				size_t running_ = 0;
+				std::exception_ptr error_;
+
+				// entries of the ThreadStorages released by the previous loops, by type, more than
+				// max_free_storages per type are only alive with nested or concurrent loops
+				static constexpr size_t max_free_storages = 2;
+				std::mutex storages_mutex_;
+				std::unordered_map<std::type_index, std::vector<std::shared_ptr<void>>> free_storages_;
+			};
+		} // namespace
+
+		namespace internal
+		{
+			std::shared_ptr<void> acquire_thread_storage(const std::type_index &type)
+			{
+				return ThreadPool::get().acquire_storage(type);
+			}
+
+			void release_thread_storage(const std::type_index &type, std::shared_ptr<void> storages)
 			{
-				threads[t] = std::thread(std::bind(
-					func,
-					t * size / n_threads,
-					(t + 1) == n_threads ? size : (t + 1) * size / n_threads,
-					t));
+				ThreadPool::get().release_storage(type, std::move(storages));
 			}
-			std::for_each(threads.begin(), threads.end(), [](std::thread &x) { x.join(); });
+		} // namespace internal
+
+		void par_for(const int size, const std::function<void(int, int, int)> &func)
+		{
+#ifdef POLYFEM_WITH_CPP_THREADS
+			ThreadPool::get().run(size, func);
 #endif
 		}
 	} // namespace utils
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <functional>
+#include <memory>
 #include <thread>
+#include <typeindex>
+#include <vector>
 
 namespace polyfem
 {
@@ -10,7 +14,7 @@ namespace polyfem
 		class NThread
 		{
 		public:
-			size_t num_threads;
+			size_t num_threads = std::thread::hardware_concurrency();
 			static NThread &get()
 			{
 				static NThread instance;
@@ -21,7 +25,75 @@ namespace polyfem
 			NThread() {}
 		};
 
+		/// @brief Parallel for loop over [0, size) run on a persistent pool of get_n_threads() threads.
+		///
+		/// The range is split in chunks that are handed out dynamically, so func is called several
+		/// times per thread with consecutive sub-ranges [start, end) and the id of the thread
+		/// (in [0, get_n_threads())). The calling thread takes part with id 0. Nested calls, and
+		/// calls from another thread while the pool is busy, run serially on the calling thread
+		/// with id 0 (or its own id when nested).
 		void par_for(const int size, const std::function<void(int, int, int)> &func);
-		inline size_t get_n_threads() { return NThread::get().num_threads; }
+		inline size_t get_n_threads() { return std::max<size_t>(1, NThread::get().num_threads); }
+
+		namespace internal
+		{
+			/// @brief Takes entries of a ThreadStorage released by a previous loop, null if there are none
+			/// @param[in] type type of the entries
+			std::shared_ptr<void> acquire_thread_storage(const std::type_index &type);
+			/// @brief Gives the entries of a ThreadStorage back to the thread pool, they are freed
+			/// when the pool already keeps enough of them or when the number of threads changes
+			/// @param[in] type type of the entries
+			/// @param[in] storages entries
+			void release_thread_storage(const std::type_index &type, std::shared_ptr<void> storages);
+		} // namespace internal
+
+		/// @brief Thread local storage of par_for, one entry per pool thread indexed by the thread id.
+		///
+		/// The entries are not freed with the object but handed back to the thread pool, the next
+		/// ThreadStorage of the same type takes them and assigns the initial value to each, so the
+		/// memory they allocated in the previous loops (triplets, element values, ...) is reused.
+		template <typename LocalStorage>
+		class ThreadStorage
+		{
+		public:
+			using Storages = std::vector<LocalStorage>;
+
+			ThreadStorage(const LocalStorage &initial_local_storage)
+			{
+				storages_ = std::static_pointer_cast<Storages>(internal::acquire_thread_storage(typeid(Storages)));
+				if (!storages_)
+					storages_ = std::make_shared<Storages>();
+
+				const size_t n_threads = get_n_threads();
+				if (storages_->size() > n_threads)
+					storages_->erase(storages_->begin() + n_threads, storages_->end());
+				for (LocalStorage &local_storage : *storages_)
+					local_storage = initial_local_storage;
+				while (storages_->size() < n_threads)
+					storages_->push_back(initial_local_storage);
+			}
+
+			ThreadStorage(ThreadStorage &&) = default;
+			ThreadStorage(const ThreadStorage &) = delete;
+			ThreadStorage &operator=(const ThreadStorage &) = delete;
+
+			~ThreadStorage()
+			{
+				if (storages_)
+					internal::release_thread_storage(typeid(Storages), std::move(storages_));
+			}
+
+			LocalStorage &operator[](const size_t thread_id) { return (*storages_)[thread_id]; }
+			const LocalStorage &operator[](const size_t thread_id) const { return (*storages_)[thread_id]; }
+			size_t size() const { return storages_->size(); }
+
+			typename Storages::iterator begin() { return storages_->begin(); }
+			typename Storages::iterator end() { return storages_->end(); }
+			typename Storages::const_iterator begin() const { return storages_->begin(); }
+			typename Storages::const_iterator end() const { return storages_->end(); }
+
+		private:
+			std::shared_ptr<Storages> storages_;
+		};
 	} // namespace utils
 } // namespace polyfem
@@ -1,7 +1,22 @@
 #include <polyfem/State.hpp>
+#include <polyfem/autogen/auto_q_bases.hpp>
+#include <polyfem/basis/TensorProductBasis.hpp>
+#include <polyfem/io/Evaluator.hpp>
+#include <polyfem/quadrature/HexQuadrature.hpp>
+#include <polyfem/quadrature/QuadQuadrature.hpp>
+
+#include "test_state.hpp"
+
+#include <finitediff.hpp>
+
+#include <spdlog/sinks/ringbuffer_sink.h>
 
 #include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <thread>
 
 using namespace polyfem;
 using namespace polyfem::assembler;
@@ -62,3 +77,605 @@ TEST_CASE("hessian_lin", "[assembler]")
 		disp.setRandom();
 	}
 }
+
+TEST_CASE("lsq_bc_cache", "[assembler]")
+{
+	const auto state_ptr = tests::plane_hole_state("LinearElasticity");
+	State &state = *state_ptr;
+	REQUIRE(!state.boundary_nodes.empty());
+
+	// the factorizations are counted in the debug log
+	const auto log = std::make_shared<spdlog::sinks::ringbuffer_sink_mt>(1000);
+	set_logger(std::make_shared<spdlog::logger>("polyfem", log));
+	logger().set_level(spdlog::level::debug);
+	const auto n_factorizations = [&]() {
+		const std::vector<std::string> messages = log->last_formatted();
+		return std::count_if(messages.begin(), messages.end(), [](const std::string &m) {
+			return m.find("Factorizing the Dirichlet least-squares projection") != std::string::npos;
+		});
+	};
+
+	const auto rhs_assembler = state.build_rhs_assembler();
+	const int ndof = state.n_bases * state.mesh->dimension();
+	const auto set_bc = [&](const int resolution, const double t) {
+		Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(ndof, 1);
+		rhs_assembler->set_bc(state.local_boundary, state.boundary_nodes, resolution, state.local_neumann_boundary, rhs, Eigen::MatrixXd(), t);
+		return rhs;
+	};
+
+	const int resolution = state.n_boundary_samples();
+	const Eigen::MatrixXd first = set_bc(resolution, 1);
+	REQUIRE(n_factorizations() == 1);
+	REQUIRE(first.norm() > 0);
+
+	// same boundary, the factorization is reused
+	const Eigen::MatrixXd second = set_bc(resolution, 1);
+	REQUIRE(n_factorizations() == 1);
+	REQUIRE((first - second).norm() == Approx(0).margin(1e-12));
+
+	// concurrent calls share the cache
+	std::vector<Eigen::MatrixXd> results(4);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i)
+		threads.emplace_back([&, i]() { results[i] = set_bc(resolution, 1); });
+	for (auto &thread : threads)
+		thread.join();
+	REQUIRE(n_factorizations() == 1);
+	for (const auto &res : results)
+		REQUIRE((first - res).norm() == Approx(0).margin(1e-12));
+
+	// a different boundary rebuilds the projection
+	set_bc(resolution + 1, 1);
+	REQUIRE(n_factorizations() == 2);
+	const Eigen::MatrixXd third = set_bc(resolution, 1);
+	REQUIRE(n_factorizations() == 3);
+	REQUIRE((first - third).norm() == Approx(0).margin(1e-10));
+
+	state.init_logger("", spdlog::level::err, false);
+}
+
+TEST_CASE("assembly_schedule", "[assembler]")
+{
+	const auto state_ptr = tests::plane_hole_state("LinearElasticity");
+	State &state = *state_ptr;
+
+	AssemblySchedule schedule;
+	schedule.init(state.bases);
+	REQUIRE(schedule.size() == state.bases.size());
+
+	// every element is assembled exactly once
+	std::vector<int> count(state.bases.size(), 0);
+	for (const int e : schedule.elements(0, schedule.n_chunks()))
+		++count[e];
+	REQUIRE(std::all_of(count.begin(), count.end(), [](int c) { return c == 1; }));
+
+	// groups are homogeneous and keep the mesh order
+	for (int g = 0; g < schedule.n_groups(); ++g)
+	{
+		const auto group = schedule.group(g);
+		for (const int *e = group.begin() + 1; e < group.end(); ++e)
+		{
+			REQUIRE(state.bases[*e].bases.size() == state.bases[*(e - 1)].bases.size());
+			REQUIRE(*e > *(e - 1));
+		}
+	}
+
+	AssemblySchedule tmp;
+	REQUIRE(&state.ass_vals_cache.schedule(state.bases, tmp) != &tmp);
+
+	// a cache that was never initialized builds the schedule of the first basis set once
+	AssemblyValsCache cache;
+	REQUIRE(cache.generation() == 0);
+	const AssemblySchedule &lazy = cache.schedule(state.bases, tmp);
+	REQUIRE(&lazy != &tmp);
+	REQUIRE(lazy.size() == state.bases.size());
+	const size_t generation = cache.generation();
+	REQUIRE(generation != 0);
+	REQUIRE(&cache.schedule(state.bases, tmp) == &lazy);
+	REQUIRE(cache.generation() == generation);
+
+	// another basis set of the same size is not mistaken for the cached one
+	const std::vector<basis::ElementBases> other_bases = state.bases;
+	REQUIRE(&cache.schedule(other_bases, tmp) == &tmp);
+
+	// rebuilding the basis set starts a new generation
+	cache.init_schedule(other_bases);
+	REQUIRE(cache.generation() != generation);
+	REQUIRE(&cache.schedule(other_bases, tmp) != &tmp);
+	REQUIRE(&cache.schedule(state.bases, tmp) == &tmp);
+	cache.clear();
+	REQUIRE(cache.generation() == 0);
+}
+
+TEST_CASE("colored_hessian_assembly", "[assembler]")
+{
+	const auto state_ptr = tests::plane_hole_state("NeoHookean", 2);
+	State &state = *state_ptr;
+
+	ElementColoring tmp;
+	const ElementColoring &coloring = state.ass_vals_cache.coloring(state.bases, tmp);
+	REQUIRE(&coloring != &tmp);
+	REQUIRE(coloring.size() == state.bases.size());
+
+	// elements of the same color share no node
+	std::vector<int> node_color(state.n_bases, -1);
+	int n_colored = 0;
+	for (int c = 0; c < coloring.n_colors(); ++c)
+	{
+		REQUIRE(coloring.color_size(c) > 0);
+		for (int k = 0; k < coloring.color_size(c); ++k)
+		{
+			const int e = coloring.element(c, k);
+			REQUIRE(coloring.color(e) == c);
+			++n_colored;
+
+			std::vector<int> nodes;
+			for (const auto &b : state.bases[e].bases)
+				for (const auto &g : b.global())
+					nodes.push_back(g.index);
+			std::sort(nodes.begin(), nodes.end());
+			nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+			for (const int n : nodes)
+			{
+				REQUIRE(node_color[n] != c);
+				node_color[n] = c;
+			}
+		}
+	}
+	REQUIRE(n_colored == state.bases.size());
+
+	Eigen::MatrixXd disp(state.n_bases * 2, 1);
+	disp.setRandom();
+	disp *= 1e-3;
+
+	SpareMatrixCache mat_cache;
+	StiffnessMatrix first, colored;
+	// the first assembly computes the mapping, the second one scatters by color
+	state.assembler.assemble_energy_hessian(
+		"NeoHookean", false, state.n_bases, false,
+		state.bases, state.geom_bases(), state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), mat_cache, first);
+	REQUIRE(mat_cache.has_element_mapping());
+
+	disp.setRandom();
+	disp *= 1e-3;
+	state.assembler.assemble_energy_hessian(
+		"NeoHookean", false, state.n_bases, false,
+		state.bases, state.geom_bases(), state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), mat_cache, colored);
+
+	SpareMatrixCache fresh_cache;
+	StiffnessMatrix expected;
+	state.assembler.assemble_energy_hessian(
+		"NeoHookean", false, state.n_bases, false,
+		state.bases, state.geom_bases(), state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), fresh_cache, expected);
+
+	REQUIRE((colored - expected).norm() == Approx(0).margin(1e-8 * expected.norm()));
+}
+
+TEST_CASE("parallel_assembly", "[assembler]")
+{
+	// autodiff rhs, expression rhs, and mixed (velocity-pressure) assembly
+	const std::string setup = GENERATE(std::string("ElasticExact"), std::string("expression"), std::string("Stokes"));
+
+	json in_args = tests::plane_hole_args("LinearElasticity", 2);
+	in_args["materials"]["rho"] = 2;
+	if (setup == "Stokes")
+	{
+		in_args["preset_problem"] = {{"type", "SimpleStokeProblemExact"}};
+		in_args["materials"] = {{"type", "Stokes"}, {"viscosity", 1}};
+	}
+	else if (setup == "expression")
+	{
+		in_args.erase("preset_problem");
+		in_args["boundary_conditions"] = {{"rhs", {"sin(x) * y", "x * x + 2 * y"}}, {"dirichlet_boundary", {{{"id", "all"}, {"value", {0, 0}}}}}};
+	}
+
+	// the State sets the number of threads of the parallel loops, only one is alive at a time
+	const auto assemble = [&](const int n_threads, Eigen::MatrixXd &rhs, StiffnessMatrix &stiffness) {
+		const auto state = tests::build_state(in_args, n_threads);
+		state->assemble_rhs();
+		state->assemble_stiffness_mat();
+		rhs = state->rhs;
+		stiffness = state->stiffness;
+	};
+
+	Eigen::MatrixXd serial_rhs, parallel_rhs;
+	StiffnessMatrix serial_stiffness, parallel_stiffness;
+	assemble(1, serial_rhs, serial_stiffness);
+	assemble(8, parallel_rhs, parallel_stiffness);
+
+	REQUIRE(serial_rhs.size() == parallel_rhs.size());
+	REQUIRE(serial_rhs.norm() > 0);
+	CHECK((serial_rhs - parallel_rhs).norm() == Approx(0).margin(1e-12 * serial_rhs.norm()));
+
+	REQUIRE(serial_stiffness.rows() == parallel_stiffness.rows());
+	REQUIRE(serial_stiffness.cols() == parallel_stiffness.cols());
+	CHECK(StiffnessMatrix(serial_stiffness - parallel_stiffness).norm() == Approx(0).margin(1e-12 * serial_stiffness.norm()));
+}
+
+TEST_CASE("fused_energy_gradient_hessian", "[assembler]")
+{
+	const auto state_ptr = tests::plane_hole_state("NeoHookean", 2);
+	State &state = *state_ptr;
+
+	Eigen::MatrixXd disp(state.n_bases * 2, 1);
+	disp.setRandom();
+	disp *= 1e-3;
+
+	// NeoHookean and SaintVenant have a fused local kernel, LinearElasticity falls back to the separate local functions
+	for (const std::string formulation : {"NeoHookean", "SaintVenant", "LinearElasticity"})
+	{
+		const double energy = state.assembler.assemble_energy(
+			formulation, false, state.bases, state.geom_bases(), state.ass_vals_cache, 0, disp, Eigen::MatrixXd());
+		Eigen::MatrixXd grad;
+		state.assembler.assemble_energy_gradient(
+			formulation, false, state.n_bases, state.bases, state.geom_bases(), state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), grad);
+		SpareMatrixCache mat_cache;
+		StiffnessMatrix hessian;
+		state.assembler.assemble_energy_hessian(
+			formulation, false, state.n_bases, false,
+			state.bases, state.geom_bases(), state.ass_vals_cache, 0, disp, Eigen::MatrixXd(), mat_cache, hessian);
+
+		double fused_energy;
+		Eigen::MatrixXd fused_grad;
+		SpareMatrixCache fused_cache;
+		StiffnessMatrix fused_hessian;
+		// the first call builds the mapping of fused_cache, the second one scatters into its values
+		for (int i = 0; i < 2; ++i)
+		{
+			state.assembler.assemble_energy_gradient_hessian(
+				formulation, false, state.n_bases, false,
+				state.bases, state.geom_bases(), state.ass_vals_cache, 0, disp, Eigen::MatrixXd(),
+				&fused_energy, &fused_grad, fused_cache, &fused_hessian);
+
+			REQUIRE(fused_energy == Approx(energy).epsilon(1e-6));
+			REQUIRE((fused_grad - grad).norm() == Approx(0).margin(1e-8 * grad.norm()));
+			REQUIRE((fused_hessian - hessian).norm() == Approx(0).margin(1e-8 * hessian.norm()));
+		}
+
+		// only the requested outputs are computed
+		double energy_only;
+		state.assembler.assemble_energy_gradient_hessian(
+			formulation, false, state.n_bases, false,
+			state.bases, state.geom_bases(), state.ass_vals_cache, 0, disp, Eigen::MatrixXd(),
+			&energy_only, nullptr, fused_cache, nullptr);
+		REQUIRE(energy_only == Approx(energy).epsilon(1e-6));
+	}
+}
+
+TEST_CASE("batched_constitutive_kernels", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	// P1 tets and P2 triangles, both have a specialized kernel
+	const auto [mesh, discr_order] = GENERATE(
+		std::make_pair(std::string("/contact/meshes/3D/simple/bar/bar-186.msh"), 1),
+		std::make_pair(std::string("/plane_hole.obj"), 2));
+
+	json in_args = json({});
+	in_args["geometry"] = {};
+	in_args["geometry"]["mesh"] = path + mesh;
+
+	in_args["space"] = {};
+	in_args["space"]["discr_order"] = discr_order;
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = "NeoHookean";
+	in_args["materials"]["E"] = 1e5;
+	in_args["materials"]["nu"] = 0.3;
+
+	State state;
+	state.init_logger("", spdlog::level::err, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.build_basis();
+
+	const bool is_volume = state.mesh->is_volume();
+	const int n_dofs = state.n_bases * state.mesh->dimension();
+
+	Eigen::VectorXd x(n_dofs);
+	x.setRandom();
+	x *= 1e-2;
+
+	for (const std::string formulation : {"NeoHookean", "SaintVenant"})
+	{
+		const auto energy = [&](const Eigen::VectorXd &y) {
+			return state.assembler.assemble_energy(
+				formulation, is_volume, state.bases, state.geom_bases(), state.ass_vals_cache, 0, y, Eigen::MatrixXd());
+		};
+		const auto gradient = [&](const Eigen::VectorXd &y) {
+			Eigen::MatrixXd grad;
+			state.assembler.assemble_energy_gradient(
+				formulation, is_volume, state.n_bases, state.bases, state.geom_bases(), state.ass_vals_cache, 0, y, Eigen::MatrixXd(), grad);
+			return Eigen::VectorXd(grad);
+		};
+
+		const Eigen::VectorXd grad = gradient(x);
+		Eigen::VectorXd fgrad;
+		fd::finite_gradient(x, energy, fgrad);
+		CHECK(fd::compare_gradient(grad, fgrad));
+
+		SpareMatrixCache mat_cache;
+		StiffnessMatrix hessian;
+		state.assembler.assemble_energy_hessian(
+			formulation, is_volume, state.n_bases, false,
+			state.bases, state.geom_bases(), state.ass_vals_cache, 0, x, Eigen::MatrixXd(), mat_cache, hessian);
+
+		// directional derivative of the gradient, the full finite difference Hessian is too expensive
+		const Eigen::VectorXd v = Eigen::VectorXd::Random(n_dofs);
+		const double h = 1e-7;
+		const Eigen::VectorXd fhv = (gradient(x + h * v) - gradient(x - h * v)) / (2 * h);
+		const Eigen::VectorXd hv = hessian * v;
+		CHECK((hv - fhv).norm() == Approx(0).margin(1e-5 * hv.norm()));
+
+		// the fused assembly evaluates batches of elements of the same color together,
+		// the separate functions evaluate one element at a time
+		double batched_energy;
+		Eigen::MatrixXd batched_grad;
+		SpareMatrixCache batched_cache;
+		StiffnessMatrix batched_hessian;
+		state.assembler.assemble_energy_gradient_hessian(
+			formulation, is_volume, state.n_bases, false,
+			state.bases, state.geom_bases(), state.ass_vals_cache, 0, x, Eigen::MatrixXd(),
+			&batched_energy, &batched_grad, batched_cache, &batched_hessian);
+
+		CHECK(batched_energy == Approx(energy(x)).epsilon(1e-10));
+		CHECK((batched_grad - grad).norm() == Approx(0).margin(1e-10 * grad.norm()));
+		CHECK(StiffnessMatrix(batched_hessian - hessian).norm() == Approx(0).margin(1e-10 * hessian.norm()));
+	}
+}
+
+TEST_CASE("tensor_product_kernels", "[assembler]")
+{
+	const int dim = GENERATE(2, 3);
+	const int discr_order = GENERATE(1, 2, 3);
+	const bool is_volume = dim == 3;
+
+	// one distorted Q element, its bases are the same with and without the tensor product structure
+	Eigen::MatrixXd nodes;
+	if (is_volume)
+		autogen::q_nodes_3d(discr_order, nodes);
+	else
+		autogen::q_nodes_2d(discr_order, nodes);
+
+	ElementBases bs;
+	bs.bases.resize(nodes.rows());
+	for (int j = 0; j < nodes.rows(); ++j)
+	{
+		RowVectorNd node = nodes.row(j);
+		node(0) += 0.1 * node(1) * node(1);
+		node(dim - 1) *= 1.5 + 0.2 * node(0);
+
+		bs.bases[j].init(discr_order, j, j, node);
+		if (is_volume)
+		{
+			bs.bases[j].set_basis([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_3d(discr_order, j, uv, val); });
+			bs.bases[j].set_grad([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_3d(discr_order, j, uv, val); });
+		}
+		else
+		{
+			bs.bases[j].set_basis([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_2d(discr_order, j, uv, val); });
+			bs.bases[j].set_grad([discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_2d(discr_order, j, uv, val); });
+		}
+	}
+	const int quadrature_order = 2 * discr_order + 1;
+	bs.set_quadrature([is_volume, quadrature_order](quadrature::Quadrature &quad) {
+		if (is_volume)
+			quadrature::HexQuadrature().get_quadrature(quadrature_order, quad);
+		else
+			quadrature::QuadQuadrature().get_quadrature(quadrature_order, quad);
+	});
+
+	ElementAssemblyValues dense, tensor;
+	dense.compute(0, is_volume, bs, bs);
+	bs.set_tensor_product_basis(std::make_shared<const TensorProductBasis>(dim, discr_order));
+	tensor.compute(0, is_volume, bs, bs);
+	REQUIRE(!dense.has_tensor_product());
+	REQUIRE(tensor.has_tensor_product());
+
+	for (size_t i = 0; i < dense.basis_values.size(); ++i)
+	{
+		CHECK((dense.basis_values[i].val - tensor.basis_values[i].val).norm() == Approx(0).margin(1e-12));
+		CHECK((dense.basis_values[i].grad_t_m - tensor.basis_values[i].grad_t_m).norm() == Approx(0).margin(1e-12));
+	}
+
+	// evaluations only need the geometric mapping, the dense values of the bases are never filled
+	quadrature::Quadrature eval_quad;
+	bs.compute_quadrature(eval_quad);
+	ElementAssemblyValues geometry;
+	REQUIRE(geometry.compute_tensor_product(0, eval_quad.points, bs, bs));
+	REQUIRE(geometry.basis_values.size() == dense.basis_values.size());
+	for (const auto &basis_value : geometry.basis_values)
+	{
+		CHECK(basis_value.val.size() == 0);
+		CHECK(basis_value.grad.size() == 0);
+		CHECK(basis_value.grad_t_m.size() == 0);
+		CHECK(basis_value.global.size() == 1);
+	}
+	CHECK((geometry.val - dense.val).norm() == Approx(0).margin(1e-12));
+	CHECK((geometry.det - dense.det).norm() == Approx(0).margin(1e-12));
+	for (size_t p = 0; p < dense.jac_it.size(); ++p)
+		CHECK((geometry.jac_it[p] - dense.jac_it[p]).norm() == Approx(0).margin(1e-12));
+	// scattered points are not a grid
+	CHECK(!geometry.compute_tensor_product(0, (Eigen::MatrixXd::Random(5, dim).array() + 1) / 2, bs, bs));
+
+	{
+		const auto mesh = polyfem::mesh::Mesh::create(dim);
+		const std::vector<ElementBases> bases = {bs};
+		const Eigen::MatrixXd fun = Eigen::MatrixXd::Random(nodes.rows() * dim, 1);
+		Eigen::MatrixXd result, result_grad;
+		polyfem::io::Evaluator::interpolate_at_local_vals(*mesh, dim, bases, bases, 0, eval_quad.points, fun, result, result_grad);
+
+		Eigen::MatrixXd expected = Eigen::MatrixXd::Zero(eval_quad.points.rows(), dim);
+		Eigen::MatrixXd expected_grad = Eigen::MatrixXd::Zero(eval_quad.points.rows(), dim * dim);
+		for (size_t i = 0; i < dense.basis_values.size(); ++i)
+		{
+			for (int d = 0; d < dim; ++d)
+			{
+				expected.col(d) += fun(i * dim + d) * dense.basis_values[i].val;
+				expected_grad.middleCols(d * dim, dim) += fun(i * dim + d) * dense.basis_values[i].grad_t_m;
+			}
+		}
+		CHECK((result - expected).norm() == Approx(0).margin(1e-10));
+		CHECK((result_grad - expected_grad).norm() == Approx(0).margin(1e-10));
+	}
+
+	quadrature::Quadrature quad;
+	bs.compute_quadrature(quad);
+	const QuadratureVector da = dense.det.array() * quad.weights.array();
+
+	const Eigen::MatrixXd x = 1e-2 * Eigen::MatrixXd::Random(nodes.rows() * dim, 1);
+	const Eigen::MatrixXd direction = Eigen::MatrixXd::Random(nodes.rows() * dim, 1);
+	const NonLinearAssemblerData dense_data(dense, 0, x, x, da);
+	const NonLinearAssemblerData tensor_data(tensor, 0, x, x, da);
+
+	const json params = {{"E", 1e5}, {"nu", 0.3}};
+
+	NeoHookeanElasticity neo_hookean;
+	neo_hookean.set_size(dim);
+	neo_hookean.add_multimaterial(0, params);
+
+	CHECK(neo_hookean.compute_energy(tensor_data) == Approx(neo_hookean.compute_energy(dense_data)).epsilon(1e-12));
+	const Eigen::VectorXd grad = neo_hookean.assemble_grad(dense_data);
+	CHECK((neo_hookean.assemble_grad(tensor_data) - grad).norm() == Approx(0).margin(1e-10 * grad.norm()));
+	Eigen::VectorXd hv, tensor_hv;
+	neo_hookean.assemble_hessian_apply(dense_data, direction, hv);
+	neo_hookean.assemble_hessian_apply(tensor_data, direction, tensor_hv);
+	CHECK((tensor_hv - hv).norm() == Approx(0).margin(1e-10 * hv.norm()));
+
+	LinearElasticity linear_elasticity;
+	linear_elasticity.set_size(dim);
+	linear_elasticity.add_multimaterial(0, params);
+
+	// the energy is quadratic, its Hessian is the stiffness matrix
+	const Eigen::MatrixXd hessian = linear_elasticity.assemble_hessian(dense_data);
+	const Eigen::VectorXd hx = hessian * x;
+	const Eigen::VectorXd linear_grad = linear_elasticity.assemble_grad(tensor_data);
+	CHECK((linear_grad - hx).norm() == Approx(0).margin(1e-10 * linear_grad.norm()));
+	CHECK(linear_elasticity.compute_energy(tensor_data) == Approx(x.col(0).dot(hx) / 2).epsilon(1e-10));
+	for (int i = 0; i < bs.bases.size(); ++i)
+	{
+		for (int j = 0; j < bs.bases.size(); ++j)
+		{
+			const auto stiffness = linear_elasticity.assemble(LinearAssemblerData(dense, i, j, da));
+			for (int d = 0; d < dim; ++d)
+			{
+				for (int e = 0; e < dim; ++e)
+					CHECK(hessian(i * dim + d, j * dim + e) == Approx(stiffness(e * dim + d)).margin(1e-10 * hessian.norm()));
+			}
+		}
+	}
+}
+
+TEST_CASE("formulation_registry", "[assembler]")
+{
+	for (const auto &name : AssemblerUtils::scalar_assemblers())
+	{
+		const Formulation formulation(name);
+		REQUIRE(formulation.type() != AssemblerType::Unknown);
+		REQUIRE(formulation.name() == name);
+		REQUIRE(AssemblerUtils::is_scalar(formulation));
+	}
+
+	for (const auto &name : AssemblerUtils::tensor_assemblers())
+	{
+		const Formulation formulation(name);
+		REQUIRE(formulation.type() != AssemblerType::Unknown);
+		REQUIRE(formulation.name() == name);
+		REQUIRE(AssemblerUtils::is_tensor(formulation));
+	}
+
+	REQUIRE(Formulation("NavierStokesPicard").type() == AssemblerType::NavierStokesPicard);
+	REQUIRE(AssemblerUtils::is_linear("LinearElasticity"));
+	REQUIRE(!AssemblerUtils::is_linear("NeoHookean"));
+	REQUIRE(AssemblerUtils::is_mixed("Stokes"));
+
+	const Formulation unknown("NotAFormulation");
+	REQUIRE(unknown.type() == AssemblerType::Unknown);
+	REQUIRE(unknown.name() == "NotAFormulation");
+}
+
+TEST_CASE("assembly_vals_cache_modes", "[assembler]")
+{
+	const auto state_ptr = tests::plane_hole_state("NeoHookean", 2);
+	State &state = *state_ptr;
+
+	const bool is_volume = state.mesh->is_volume();
+	const int n_el = int(state.bases.size());
+
+	std::array<AssemblyValsCache, 3> caches;
+	const std::array<AssemblyValsCache::StorageMode, 3> modes = {{AssemblyValsCache::StorageMode::Full, AssemblyValsCache::StorageMode::Compact, AssemblyValsCache::StorageMode::None}};
+	for (int m = 0; m < 3; ++m)
+	{
+		caches[m].init(is_volume, state.bases, state.geom_bases(), modes[m]);
+		REQUIRE(caches[m].storage_mode() == modes[m]);
+		REQUIRE(AssemblyValsCache::storage_mode_from_string(AssemblyValsCache::to_string(modes[m])) == modes[m]);
+	}
+
+	REQUIRE(caches[2].memory() == 0);
+	REQUIRE(caches[1].memory() < caches[0].memory() / 4);
+
+	ElementAssemblyValues tmp_full, tmp;
+	for (int e = 0; e < n_el; ++e)
+	{
+		const ElementAssemblyValues &full = caches[0].get(e, is_volume, state.bases[e], state.geom_bases()[e], tmp_full);
+		for (int m = 1; m < 3; ++m)
+		{
+			const ElementAssemblyValues &vals = caches[m].get(e, is_volume, state.bases[e], state.geom_bases()[e], tmp);
+			REQUIRE(vals.element_id == e);
+			REQUIRE(vals.quadrature.weights == full.quadrature.weights);
+			REQUIRE(vals.quadrature.points == full.quadrature.points);
+			REQUIRE(vals.det == full.det);
+			REQUIRE(vals.val == full.val);
+			REQUIRE(vals.basis_values.size() == full.basis_values.size());
+			for (size_t j = 0; j < vals.basis_values.size(); ++j)
+			{
+				REQUIRE(vals.basis_values[j].global.size() == full.basis_values[j].global.size());
+				REQUIRE(vals.basis_values[j].val == full.basis_values[j].val);
+				REQUIRE((vals.basis_values[j].grad_t_m - full.basis_values[j].grad_t_m).norm() == Approx(0).margin(1e-12));
+			}
+		}
+	}
+
+	Eigen::MatrixXd disp(state.n_bases * 2, 1);
+	disp.setRandom();
+	disp *= 1e-3;
+
+	std::array<Eigen::MatrixXd, 3> grads;
+	for (int m = 0; m < 3; ++m)
+	{
+		state.assembler.assemble_energy_gradient(
+			"NeoHookean", is_volume, state.n_bases,
+			state.bases, state.geom_bases(), caches[m], 0, disp, Eigen::MatrixXd(), grads[m]);
+	}
+	REQUIRE((grads[1] - grads[0]).norm() == Approx(0).margin(1e-10 * grads[0].norm()));
+	REQUIRE((grads[2] - grads[0]).norm() == Approx(0).margin(1e-10 * grads[0].norm()));
+}
+
+TEST_CASE("assembly_vals_cache_borrow", "[assembler]")
+{
+	const auto state_ptr = tests::plane_hole_state("NeoHookean", 2);
+	State &state = *state_ptr;
+
+	const auto &cache = state.ass_vals_cache;
+	REQUIRE(cache.storage_mode() == AssemblyValsCache::StorageMode::Full);
+	const bool is_volume = state.mesh->is_volume();
+	const int n_el = int(state.bases.size());
+
+	// the stored values are returned in place, the temporary is never filled
+	// (the allocations of the assembly are measured by polyfem_bench, cache_copy and cache_borrow)
+	ElementAssemblyValues tmp, copy;
+	for (int e = 0; e < n_el; ++e)
+	{
+		const ElementAssemblyValues &v = cache.get(e, is_volume, state.bases[e], state.geom_bases()[e], tmp);
+		REQUIRE(&v != &tmp);
+		REQUIRE(&v == &cache.get(e, is_volume, state.bases[e], state.geom_bases()[e], tmp));
+		REQUIRE(v.element_id == e);
+
+		cache.compute(e, is_volume, state.bases[e], state.geom_bases()[e], copy);
+		REQUIRE(copy.element_id == e);
+		REQUIRE(copy.det == v.det);
+		REQUIRE(copy.basis_values.size() == v.basis_values.size());
+	}
+	REQUIRE(tmp.basis_values.empty());
+	REQUIRE(tmp.det.size() == 0);
+}
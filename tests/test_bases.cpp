@@ -7,6 +7,9 @@
 #include <polyfem/quadrature/HexQuadrature.hpp>
 
 #include <polyfem/basis/FEBasis3d.hpp>
+#include <polyfem/basis/TensorProductBasis.hpp>
+#include <polyfem/basis/BasisTabulation.hpp>
+#include <polyfem/assembler/ElementAssemblyValues.hpp>
 #include <polyfem/autogen/auto_p_bases.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
 
@@ -1044,6 +1047,156 @@ TEST_CASE("Qk_3d", "[bases]")
 	}
 }
 
+TEST_CASE("tensor_product_Qk", "[bases]")
+{
+	const int dim = GENERATE(2, 3);
+	for (int k = 0; k <= polyfem::autogen::MAX_Q_BASES; ++k)
+	{
+		const TensorProductBasis basis(dim, k);
+
+		Quadrature quad;
+		if (dim == 3)
+			HexQuadrature().get_quadrature(2 * k + 1, quad);
+		else
+			QuadQuadrature().get_quadrature(2 * k + 1, quad);
+
+		// the grid is detected whatever the order of the points
+		Eigen::MatrixXd pts = quad.points.colwise().reverse();
+
+		TensorProductBasis::Tabulation tab;
+		basis.tabulate(pts, tab);
+		REQUIRE(tab.is_grid);
+
+		std::vector<AssemblyValues> basis_values;
+		basis.evaluate_bases(tab, basis_values);
+		basis.evaluate_grads(tab, basis_values);
+		REQUIRE(basis_values.size() == basis.n_bases());
+
+		const Eigen::MatrixXd coeffs = Eigen::MatrixXd::Random(basis.n_bases(), 2);
+		Eigen::MatrixXd expected_val = Eigen::MatrixXd::Zero(pts.rows(), 2);
+		Eigen::MatrixXd expected_grad = Eigen::MatrixXd::Zero(pts.rows(), 2 * dim);
+
+		Eigen::MatrixXd val, grad;
+		for (int i = 0; i < basis.n_bases(); ++i)
+		{
+			if (dim == 3)
+			{
+				polyfem::autogen::q_basis_value_3d(k, i, pts, val);
+				polyfem::autogen::q_grad_basis_value_3d(k, i, pts, grad);
+			}
+			else
+			{
+				polyfem::autogen::q_basis_value_2d(k, i, pts, val);
+				polyfem::autogen::q_grad_basis_value_2d(k, i, pts, grad);
+			}
+
+			REQUIRE((basis_values[i].val - val).norm() == Approx(0).margin(1e-10));
+			REQUIRE((basis_values[i].grad - grad).norm() == Approx(0).margin(1e-10));
+
+			for (int f = 0; f < 2; ++f)
+			{
+				expected_val.col(f) += coeffs(i, f) * val;
+				expected_grad.middleCols(f * dim, dim) += coeffs(i, f) * grad;
+			}
+		}
+
+		// sum factorization
+		basis.interpolate(tab, coeffs, &val, &grad);
+		REQUIRE((val - expected_val).norm() == Approx(0).margin(1e-10));
+		REQUIRE((grad - expected_grad).norm() == Approx(0).margin(1e-10));
+
+		// integrate is the transpose of interpolate
+		const Eigen::MatrixXd w = Eigen::MatrixXd::Random(pts.rows(), 2);
+		const Eigen::MatrixXd w_grad = Eigen::MatrixXd::Random(pts.rows(), 2 * dim);
+		Eigen::MatrixXd integrated;
+		basis.integrate(tab, w, w_grad, integrated);
+		const double expected = (w.array() * val.array()).sum() + (w_grad.array() * grad.array()).sum();
+		REQUIRE((integrated.array() * coeffs.array()).sum() == Approx(expected).margin(1e-10));
+	}
+
+	// scattered points use the same 1D tables
+	const TensorProductBasis basis(dim, 2);
+	const Eigen::MatrixXd pts = (Eigen::MatrixXd::Random(10, dim).array() + 1) / 2;
+	TensorProductBasis::Tabulation tab;
+	basis.tabulate(pts, tab);
+	REQUIRE(!tab.is_grid);
+
+	std::vector<AssemblyValues> basis_values;
+	basis.evaluate_bases(tab, basis_values);
+	Eigen::MatrixXd val;
+	for (int i = 0; i < basis.n_bases(); ++i)
+	{
+		if (dim == 3)
+			polyfem::autogen::q_basis_value_3d(2, i, pts, val);
+		else
+			polyfem::autogen::q_basis_value_2d(2, i, pts, val);
+		REQUIRE((basis_values[i].val - val).norm() == Approx(0).margin(1e-10));
+	}
+}
+
+TEST_CASE("basis_tabulation_cache", "[bases]")
+{
+	BasisTabulation::clear_cache();
+
+	// two P2 triangles with different geometry share the reference tabulation
+	Eigen::MatrixXd nodes;
+	polyfem::autogen::p_nodes_2d(2, nodes);
+
+	std::array<ElementBases, 2> bases;
+	for (int e = 0; e < 2; ++e)
+	{
+		ElementBases &b = bases[e];
+		b.bases.resize(nodes.rows());
+		for (int j = 0; j < nodes.rows(); ++j)
+		{
+			RowVectorNd node = nodes.row(j);
+			node(0) += e * 0.3 * node(1);
+			b.bases[j].init(2, j, j, node);
+			b.bases[j].set_basis([j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { polyfem::autogen::p_basis_value_2d(2, j, uv, val); });
+			b.bases[j].set_grad([j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { polyfem::autogen::p_grad_basis_value_2d(2, j, uv, val); });
+		}
+		b.set_quadrature([](Quadrature &quad) { TriQuadrature().get_quadrature(4, quad); }, 4);
+		b.set_reference_key({true, 2, 2});
+	}
+
+	std::array<ElementAssemblyValues, 2> vals;
+	for (int e = 0; e < 2; ++e)
+		vals[e].compute(e, false, bases[e], bases[e]);
+
+	REQUIRE(BasisTabulation::cache_size() == 1);
+	REQUIRE(vals[0].tabulation);
+	REQUIRE(vals[0].tabulation == vals[1].tabulation);
+
+	for (int e = 0; e < 2; ++e)
+	{
+		// same values as the evaluation of the element bases
+		ElementAssemblyValues expected;
+		expected.compute(e, false, vals[e].quadrature.points, bases[e], bases[e]);
+		REQUIRE(!expected.tabulation);
+
+		for (int j = 0; j < nodes.rows(); ++j)
+		{
+			REQUIRE((vals[e].basis_values[j].val - expected.basis_values[j].val).norm() == Approx(0).margin(1e-14));
+			REQUIRE((vals[e].basis_values[j].grad_t_m - expected.basis_values[j].grad_t_m).norm() == Approx(0).margin(1e-12));
+		}
+		REQUIRE((vals[e].det - expected.det).norm() == Approx(0).margin(1e-12));
+	}
+
+	// the evaluations at other points are not cached, a quadrature of another order is a new entry
+	REQUIRE(BasisTabulation::cache_size() == 1);
+	for (int e = 0; e < 2; ++e)
+	{
+		bases[e].set_mass_quadrature([](Quadrature &quad) { TriQuadrature().get_quadrature(6, quad); }, 6);
+		ElementAssemblyValues mass_vals;
+		mass_vals.compute_mass(e, false, bases[e], bases[e]);
+		REQUIRE(mass_vals.tabulation);
+	}
+	REQUIRE(BasisTabulation::cache_size() == 2);
+
+	BasisTabulation::clear_cache();
+	REQUIRE(BasisTabulation::cache_size() == 0);
+}
+
 TEST_CASE("MV_2d", "[bases]")
 {
 	Eigen::MatrixXd b, b_prime, b_dx, b_dy;
@@ -5,16 +5,22 @@
 #include <polyfem/solver/forms/FrictionForm.hpp>
 #include <polyfem/solver/forms/InertiaForm.hpp>
 #include <polyfem/solver/forms/LaggedRegForm.hpp>
+#include <polyfem/solver/FullNLProblem.hpp>
 
 #include <polyfem/time_integrator/ImplicitEuler.hpp>
 
+#include <polyfem/assembler/SaintVenantElasticity.hpp>
+#include <polyfem/utils/AutodiffTypes.hpp>
+
 #include <finitediff.hpp>
 
 #include <polyfem/State.hpp>
 
 #include <catch2/catch.hpp>
+#include <atomic>
 #include <iostream>
 #include <memory>
+#include <thread>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -131,6 +137,19 @@ void test_form(Form &form, const State &state)
 			CHECK(fd::compare_hessian(hess, fhess));
 		}
 
+		// Test the Hessian-vector product with the assembled Hessian
+		{
+			StiffnessMatrix hess;
+			form.second_derivative(x, hess);
+
+			const Eigen::VectorXd v = Eigen::VectorXd::Random(x.size());
+			Eigen::VectorXd hv;
+			form.second_derivative_apply(x, v, hv);
+
+			const Eigen::VectorXd expected = hess * v;
+			CHECK((hv - expected).norm() == Approx(0).margin(1e-10 * std::max(1.0, expected.norm())));
+		}
+
 		x.setRandom();
 		x /= 100;
 	}
@@ -181,21 +200,344 @@ TEST_CASE("contact form derivatives", "[form][form_derivatives][contact_form]")
 	test_form(form, *state_ptr);
 }
 
+TEST_CASE("contact form cache", "[form][contact_form]")
+{
+	const auto state_ptr = get_state();
+
+	// large enough for the surface to be in contact with itself at rest
+	const double dhat = 0.5;
+	const auto make_form = [&]() {
+		return std::make_unique<ContactForm>(
+			state_ptr->collision_mesh,
+			state_ptr->boundary_nodes_pos,
+			dhat,
+			state_ptr->avg_mass,
+			/*use_adaptive_barrier_stiffness=*/false,
+			/*is_time_dependent=*/false, ipc::BroadPhaseMethod::HASH_GRID,
+			/*ccd_tolerance=*/1e-6, /*ccd_max_iterations=*/static_cast<int>(1e6));
+	};
+
+	const int ndof = state_ptr->n_bases * 2;
+	std::array<Eigen::VectorXd, 3> xs;
+	xs[0] = Eigen::VectorXd::Zero(ndof);
+	for (int i = 1; i < xs.size(); ++i)
+		xs[i] = Eigen::VectorXd::Random(ndof) / 1000;
+
+	// values of fresh forms, their cache only ever holds the queried x
+	std::array<double, 3> expected_value;
+	std::array<Eigen::VectorXd, 3> expected_grad;
+	for (int i = 0; i < xs.size(); ++i)
+	{
+		auto form = make_form();
+		form->init(xs[0]);
+		expected_value[i] = form->value(xs[i]);
+		form = make_form();
+		form->init(xs[0]);
+		form->first_derivative(xs[i], expected_grad[i]);
+	}
+	REQUIRE(expected_value[0] > 0);
+
+	const auto check = [&](const ContactForm &form, const int i) {
+		CHECK(form.value(xs[i]) == Approx(expected_value[i]).epsilon(1e-12));
+		Eigen::VectorXd grad;
+		form.first_derivative(xs[i], grad);
+		CHECK((grad - expected_grad[i]).norm() == Approx(0).margin(1e-12 * std::max(1.0, expected_grad[i].norm())));
+	};
+
+	auto form_a = make_form();
+	auto form_b = make_form();
+	form_a->init(xs[0]);
+	form_b->init(xs[0]);
+
+	SECTION("interleaved")
+	{
+		// alternates the two forms and cycles through more solutions than cached entries
+		const std::vector<int> order = {0, 1, 0, 2, 1, 1, 2, 0, 2, 1, 0, 0};
+		for (int k = 0; k < order.size(); ++k)
+		{
+			check(*form_a, order[k]);
+			check(*form_b, order[order.size() - 1 - k]);
+			// both solutions of a pair are displaced in one call
+			CHECK(form_a->is_step_collision_free(xs[order[k]], xs[order[(k + 1) % order.size()]]));
+		}
+	}
+
+	SECTION("concurrent")
+	{
+		const auto matches = [&](const ContactForm &form, const int i) {
+			Eigen::VectorXd grad;
+			form.first_derivative(xs[i], grad);
+			return std::abs(form.value(xs[i]) - expected_value[i]) <= 1e-12 * std::max(1.0, std::abs(expected_value[i]))
+				   && (grad - expected_grad[i]).norm() <= 1e-12 * std::max(1.0, expected_grad[i].norm());
+		};
+
+		std::atomic<int> n_mismatches(0);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; ++t)
+		{
+			threads.emplace_back([&, t]() {
+				for (int k = 0; k < 20; ++k)
+				{
+					const int i = (t + k) % xs.size();
+					if (!matches((k % 2) ? *form_a : *form_b, i))
+						++n_mismatches;
+				}
+			});
+		}
+		for (auto &thread : threads)
+			thread.join();
+
+		CHECK(n_mismatches == 0);
+		for (int i = 0; i < xs.size(); ++i)
+			check(*form_a, i);
+	}
+}
+
+namespace
+{
+	// ½ xᵀ A x, counts the assemblies of its Hessian
+	class QuadraticForm : public Form
+	{
+	public:
+		QuadraticForm(const StiffnessMatrix &A) : A_(A) {}
+
+		int n_hessians = 0;
+
+	protected:
+		double value_unweighted(const Eigen::VectorXd &x) const override { return 0.5 * x.dot(A_ * x); }
+		void first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const override { gradv = A_ * x; }
+		void second_derivative_unweighted(const Eigen::VectorXd &x, StiffnessMatrix &hessian) override
+		{
+			++n_hessians;
+			hessian = A_;
+		}
+
+	private:
+		const StiffnessMatrix A_;
+	};
+} // namespace
+
+TEST_CASE("problem hessian apply", "[form][contact_form][friction_form]")
+{
+	const auto state_ptr = get_state();
+	const int ndof = state_ptr->n_bases * 2;
+
+	// large enough for the surface to be in contact with itself at rest
+	const double dhat = 0.5;
+	const double dt = 1e-3;
+
+	auto elastic_form = std::make_shared<ElasticForm>(
+		state_ptr->n_bases,
+		state_ptr->bases,
+		state_ptr->geom_bases(),
+		state_ptr->assembler,
+		state_ptr->ass_vals_cache,
+		"NeoHookean",
+		dt,
+		state_ptr->mesh->is_volume());
+	auto contact_form = std::make_shared<ContactForm>(
+		state_ptr->collision_mesh,
+		state_ptr->boundary_nodes_pos,
+		dhat,
+		state_ptr->avg_mass,
+		/*use_adaptive_barrier_stiffness=*/false,
+		/*is_time_dependent=*/false, ipc::BroadPhaseMethod::HASH_GRID,
+		/*ccd_tolerance=*/1e-6, /*ccd_max_iterations=*/static_cast<int>(1e6));
+	auto friction_form = std::make_shared<FrictionForm>(
+		state_ptr->collision_mesh,
+		state_ptr->boundary_nodes_pos,
+		/*epsv=*/1e-3, /*mu=*/0.5, dhat, ipc::BroadPhaseMethod::HASH_GRID, dt, *contact_form, /*n_lagging_iters=*/-1);
+	auto quadratic_form = std::make_shared<QuadraticForm>(state_ptr->stiffness);
+
+	std::vector<std::shared_ptr<Form>> forms = {elastic_form, contact_form, friction_form, quadratic_form};
+	FullNLProblem problem(forms);
+
+	const Eigen::VectorXd x0 = Eigen::VectorXd::Zero(ndof);
+	problem.init(x0);
+	problem.init_lagging(x0);
+
+	// the products at the same x match the assembled Hessian, the Hessians without a matrix-free product are assembled once
+	const auto check = [&](const Eigen::VectorXd &x) {
+		StiffnessMatrix hessian;
+		problem.hessian(x, hessian);
+
+		quadratic_form->n_hessians = 0;
+		for (int k = 0; k < 3; ++k)
+		{
+			const Eigen::VectorXd v = Eigen::VectorXd::Random(ndof);
+			Eigen::VectorXd hv;
+			problem.hessian_apply(x, v, hv);
+
+			const Eigen::VectorXd expected = hessian * v;
+			CHECK((hv - expected).norm() == Approx(0).margin(1e-10 * std::max(1.0, expected.norm())));
+		}
+		CHECK(quadratic_form->n_hessians == 1);
+	};
+
+	Eigen::VectorXd x = Eigen::VectorXd::Random(ndof) / 1000;
+	problem.solution_changed(x);
+	check(x);
+
+	// the kept Hessians follow the changes of the forms at the same x
+	contact_form->set_weight(10 * contact_form->weight());
+	check(x);
+	problem.update_lagging(x, 1);
+	check(x);
+
+	x = Eigen::VectorXd::Random(ndof) / 1000;
+	problem.solution_changed(x);
+	check(x);
+}
+
+TEST_CASE("problem fixed hessian pattern", "[form][contact_form]")
+{
+	const auto state_ptr = get_state();
+	const int ndof = state_ptr->n_bases * 2;
+
+	const double dhat = 0.5;
+	const double dt = 1e-3;
+
+	auto elastic_form = std::make_shared<ElasticForm>(
+		state_ptr->n_bases,
+		state_ptr->bases,
+		state_ptr->geom_bases(),
+		state_ptr->assembler,
+		state_ptr->ass_vals_cache,
+		"NeoHookean",
+		dt,
+		state_ptr->mesh->is_volume());
+	auto contact_form = std::make_shared<ContactForm>(
+		state_ptr->collision_mesh,
+		state_ptr->boundary_nodes_pos,
+		dhat,
+		state_ptr->avg_mass,
+		/*use_adaptive_barrier_stiffness=*/false,
+		/*is_time_dependent=*/false, ipc::BroadPhaseMethod::HASH_GRID,
+		/*ccd_tolerance=*/1e-6, /*ccd_max_iterations=*/static_cast<int>(1e6));
+	auto quadratic_form = std::make_shared<QuadraticForm>(state_ptr->stiffness);
+
+	std::vector<std::shared_ptr<Form>> forms = {elastic_form, contact_form, quadratic_form};
+	FullNLProblem problem(forms), fixed_problem(forms);
+	fixed_problem.set_fixed_hessian_pattern(true);
+
+	const Eigen::VectorXd x0 = Eigen::VectorXd::Zero(ndof);
+	problem.init(x0);
+	fixed_problem.init(x0);
+
+	// the Hessian handed back by the previous call is passed again, as the Newton solver does
+	StiffnessMatrix fixed_hessian;
+	for (int iter = 0; iter < 3; ++iter)
+	{
+		const Eigen::VectorXd x = Eigen::VectorXd::Random(ndof) / 1000;
+		problem.solution_changed(x);
+
+		StiffnessMatrix hessian;
+		problem.hessian(x, hessian);
+
+		fixed_problem.hessian(x, fixed_hessian);
+		CHECK((fixed_hessian - hessian).norm() == Approx(0).margin(1e-10 * std::max(1.0, hessian.norm())));
+
+		double value, fixed_value;
+		Eigen::VectorXd grad, fixed_grad;
+		problem.value_gradient_hessian(x, value, grad, hessian);
+		fixed_problem.value_gradient_hessian(x, fixed_value, fixed_grad, fixed_hessian);
+		CHECK(fixed_value == Approx(value));
+		CHECK((fixed_grad - grad).norm() == Approx(0).margin(1e-10 * std::max(1.0, grad.norm())));
+		CHECK((fixed_hessian - hessian).norm() == Approx(0).margin(1e-10 * std::max(1.0, hessian.norm())));
+	}
+}
+
 TEST_CASE("elastic form derivatives", "[form][form_derivatives][elastic_form]")
 {
 	const auto state_ptr = get_state();
+	// both have analytic gradients and Hessians
+	const std::string formulation = GENERATE(std::string("NeoHookean"), std::string("SaintVenant"));
 	ElasticForm form(
 		state_ptr->n_bases,
 		state_ptr->bases,
 		state_ptr->geom_bases(),
 		state_ptr->assembler,
 		state_ptr->ass_vals_cache,
-		state_ptr->formulation(),
+		formulation,
 		state_ptr->args["time"]["dt"],
 		state_ptr->mesh->is_volume());
 	test_form(form, *state_ptr);
 }
 
+TEST_CASE("saint venant autodiff reference", "[form][form_derivatives][elastic_form]")
+{
+	const auto state_ptr = get_state();
+	const State &state = *state_ptr;
+	const int dim = 2;
+
+	// anisotropic, to exercise every entry of the expanded stiffness tensor
+	SaintVenantElasticity saint_venant;
+	saint_venant.set_size(dim);
+	const double entries[3][3] = {{2000, 700, 150}, {700, 1800, -90}, {150, -90, 600}};
+	for (int i = 0; i < 3; ++i)
+		for (int j = i; j < 3; ++j)
+			saint_venant.set_stiffness_tensor(i, j, entries[i][j]);
+
+	typedef DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd> AutodiffScalar;
+
+	Eigen::MatrixXd x = Eigen::MatrixXd::Random(state.n_bases * dim, 1) / 20;
+	const Eigen::MatrixXd x_prev = Eigen::MatrixXd::Zero(x.rows(), 1);
+
+	for (int e = 0; e < int(state.bases.size()); ++e)
+	{
+		ElementAssemblyValues vals;
+		vals.compute(e, false, state.bases[e], state.geom_bases()[e]);
+		const QuadratureVector da = vals.det.array() * vals.quadrature.weights.array();
+		const NonLinearAssemblerData data(vals, 0, x, x_prev, da);
+
+		double energy;
+		Eigen::VectorXd grad;
+		Eigen::MatrixXd hessian;
+		saint_venant.assemble_energy_gradient_hessian(data, &energy, &grad, &hessian);
+
+		// ½ ∫ C ε · ε with the Voigt Green strain ε = (E00, E11, 2 E01), differentiated by autodiff
+		const int n_loc_bases = int(vals.basis_values.size());
+		DiffScalarBase::setVariableCount(n_loc_bases * dim);
+		std::vector<AutodiffScalar> u;
+		for (int i = 0; i < n_loc_bases; ++i)
+		{
+			for (int d = 0; d < dim; ++d)
+			{
+				double value = 0;
+				for (const auto &g : vals.basis_values[i].global)
+					value += g.val * x(g.index * dim + d);
+				u.emplace_back(i * dim + d, value);
+			}
+		}
+
+		AutodiffScalar reference(0);
+		for (int p = 0; p < da.size(); ++p)
+		{
+			AutodiffScalar F[2][2] = {{AutodiffScalar(1), AutodiffScalar(0)}, {AutodiffScalar(0), AutodiffScalar(1)}};
+			for (int i = 0; i < n_loc_bases; ++i)
+				for (int d = 0; d < dim; ++d)
+					for (int c = 0; c < dim; ++c)
+						F[d][c] += u[i * dim + d] * vals.basis_values[i].grad_t_m(p, c);
+
+			AutodiffScalar E[2][2];
+			for (int d = 0; d < dim; ++d)
+				for (int c = 0; c < dim; ++c)
+					E[d][c] = 0.5 * (F[0][d] * F[0][c] + F[1][d] * F[1][c] - (d == c ? 1. : 0.));
+
+			const AutodiffScalar eps[3] = {E[0][0], E[1][1], 2 * E[0][1]};
+			AutodiffScalar psi(0);
+			for (int j = 0; j < 3; ++j)
+				for (int k = 0; k < 3; ++k)
+					psi += 0.5 * entries[std::min(j, k)][std::max(j, k)] * eps[j] * eps[k];
+			reference += psi * da(p);
+		}
+
+		CHECK(energy == Approx(reference.getValue()).epsilon(1e-12));
+		CHECK((grad - reference.getGradient()).norm() <= 1e-10 * std::max(1.0, reference.getGradient().norm()));
+		CHECK((hessian - reference.getHessian()).norm() <= 1e-10 * std::max(1.0, reference.getHessian().norm()));
+	}
+}
+
 TEST_CASE("friction form derivatives", "[form][form_derivatives][friction_form]")
 {
 	const auto state_ptr = get_state();
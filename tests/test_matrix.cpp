@@ -245,3 +245,210 @@ TEST_CASE("cache", "[matrix]")
 	REQUIRE(tmp2.coeff(9, 4) == 6);
 	REQUIRE(tmp2.coeff(9, 9) == 4);
 }
+
+TEST_CASE("fixed_pattern", "[matrix]")
+{
+	const int n = 20;
+	const std::vector<int> removed_vars = {0, 3, 7, 19};
+
+	FixedPatternMatrix fixed;
+	FullToReducedMatrixMap map;
+
+	for (int iter = 0; iter < 5; ++iter)
+	{
+		StiffnessMatrix elastic(n, n), contact(n, n);
+		for (int i = 0; i < n; ++i)
+		{
+			elastic.insert(i, i) = 4;
+			if (i > 0)
+				elastic.insert(i, i - 1) = -1;
+			if (i + 1 < n)
+				elastic.insert(i, i + 1) = -1;
+		}
+		// the contact pair changes at every iteration
+		contact.insert(iter, n - 1 - iter) = 1 + iter;
+		contact.insert(n - 1 - iter, iter) = 1 + iter;
+		elastic.makeCompressed();
+		contact.makeCompressed();
+
+		fixed.set_zero(n, n);
+		fixed.add(elastic);
+		fixed.add(contact);
+
+		const StiffnessMatrix expected = elastic + contact;
+		REQUIRE((StiffnessMatrix(fixed.mat()) - expected).norm() == Approx(0).margin(1e-14));
+
+		if (map.pattern_version != fixed.pattern_version())
+		{
+			map.init(n, n - removed_vars.size(), removed_vars, fixed.mat());
+			map.pattern_version = fixed.pattern_version();
+		}
+
+		StiffnessMatrix reduced, expected_reduced;
+		map.apply(fixed.mat(), reduced);
+		full_to_reduced_matrix(n, n - removed_vars.size(), removed_vars, expected, expected_reduced);
+		REQUIRE(reduced.rows() == expected_reduced.rows());
+		REQUIRE((reduced - expected_reduced).norm() == Approx(0).margin(1e-14));
+	}
+
+	// the pattern is the union of all contact pairs seen so far
+	REQUIRE(fixed.mat().nonZeros() == 3 * n - 2 + 2 * 5);
+}
+
+TEST_CASE("fixed_pattern_shrink", "[matrix]")
+{
+	const int n = 20;
+
+	StiffnessMatrix elastic(n, n);
+	for (int i = 0; i < n; ++i)
+	{
+		elastic.insert(i, i) = 4;
+		// explicit zeros of the assembled matrix stay in the pattern
+		if (i > 0)
+			elastic.insert(i, i - 1) = 0;
+		if (i + 1 < n)
+			elastic.insert(i, i + 1) = -1;
+	}
+	elastic.makeCompressed();
+	const int elastic_nnz = elastic.nonZeros();
+
+	FixedPatternMatrix fixed;
+	size_t n_shrinks = 0;
+	for (int iter = 0; iter < 10; ++iter)
+	{
+		// the contact pair changes at every iteration
+		StiffnessMatrix contact(n, n);
+		contact.insert(iter, n - 1 - iter) = 1 + iter;
+		contact.insert(n - 1 - iter, iter) = 1 + iter;
+		contact.makeCompressed();
+
+		fixed.set_zero(n, n);
+		fixed.add(elastic);
+		fixed.add(contact);
+
+		const size_t version = fixed.pattern_version();
+		if (fixed.shrink())
+		{
+			++n_shrinks;
+			REQUIRE(fixed.pattern_version() != version);
+			REQUIRE(fixed.mat().nonZeros() == elastic_nnz + 2);
+		}
+
+		// the unused pairs are dropped once they are more than 10% of the pattern
+		REQUIRE(fixed.mat().nonZeros() >= elastic_nnz + 2);
+		REQUIRE(fixed.mat().nonZeros() <= elastic_nnz + 2 + 0.1 * fixed.mat().nonZeros());
+
+		const StiffnessMatrix expected = elastic + contact;
+		REQUIRE((StiffnessMatrix(fixed.mat()) - expected).norm() == Approx(0).margin(1e-14));
+	}
+	REQUIRE(n_shrinks > 0);
+
+	// the same matrices do not change the pattern
+	const size_t version = fixed.pattern_version();
+	for (int iter = 0; iter < 3; ++iter)
+	{
+		fixed.set_zero(n, n);
+		fixed.add(elastic);
+		REQUIRE(!fixed.shrink(0.5));
+	}
+	REQUIRE(fixed.pattern_version() == version);
+}
+
+TEST_CASE("fixed_pattern_scatter", "[matrix]")
+{
+	const int n = 20;
+
+	StiffnessMatrix elastic(n, n);
+	for (int i = 0; i < n; ++i)
+	{
+		elastic.insert(i, i) = 4;
+		if (i + 1 < n)
+			elastic.insert(i, i + 1) = -1;
+	}
+	elastic.makeCompressed();
+
+	FixedPatternMatrix fixed;
+	FixedPatternMatrix::ScatterMap elastic_map;
+	StiffnessMatrix hessian;
+	for (int iter = 0; iter < 4; ++iter)
+	{
+		StiffnessMatrix contact(n, n);
+		contact.insert(iter, n - 1 - iter) = 1 + iter;
+		contact.makeCompressed();
+
+		fixed.set_zero(n, n, &hessian);
+		fixed.add(elastic, elastic_map, 2);
+		fixed.add(contact);
+		// the contact pair grew the pattern, the map is rebuilt on the next add
+		fixed.add(elastic, elastic_map, -1);
+		REQUIRE(elastic_map.pattern_version == fixed.pattern_version());
+
+		fixed.swap_out(hessian);
+		REQUIRE(fixed.mat().nonZeros() == 0);
+
+		const StiffnessMatrix expected = elastic + contact;
+		REQUIRE((hessian - expected).norm() == Approx(0).margin(1e-14));
+	}
+
+	// the handed out storage is taken back if its pattern was not touched
+	const double *values = hessian.valuePtr();
+	fixed.set_zero(n, n, &hessian);
+	REQUIRE(fixed.mat().valuePtr() == values);
+	fixed.add(elastic, elastic_map);
+	fixed.swap_out(hessian);
+
+	// otherwise the pattern is rebuilt
+	hessian = StiffnessMatrix(n, n);
+	const size_t version = fixed.pattern_version();
+	fixed.set_zero(n, n, &hessian);
+	fixed.add(elastic, elastic_map);
+	REQUIRE(fixed.pattern_version() == version);
+	REQUIRE((StiffnessMatrix(fixed.mat()) - elastic).norm() == Approx(0).margin(1e-14));
+}
+
+TEST_CASE("sparsity_pattern", "[matrix]")
+{
+	const int n = 10;
+	StiffnessMatrix a(n, n);
+	for (int i = 0; i < n; ++i)
+	{
+		a.insert(i, i) = 2;
+		if (i + 1 < n)
+			a.insert(i, i + 1) = -1;
+	}
+	a.makeCompressed();
+
+	SparsityPattern pattern;
+	REQUIRE(!pattern.matches(a));
+	pattern.assign(a);
+	REQUIRE(pattern.matches(a));
+
+	// the values do not matter
+	StiffnessMatrix b = 3 * a;
+	REQUIRE(pattern.matches(b));
+
+	// same number of entries, one of them moved
+	StiffnessMatrix c = a;
+	c.prune([](const int row, const int col, const double) { return !(row == 0 && col == 1); });
+	c.insert(5, 0) = 1;
+	c.makeCompressed();
+	REQUIRE(c.nonZeros() == a.nonZeros());
+	REQUIRE(!pattern.matches(c));
+
+	// uncompressed matrices are compared by their entries
+	StiffnessMatrix d(n, n);
+	d.reserve(Eigen::VectorXi::Constant(n, 4));
+	for (int i = n - 1; i >= 0; --i)
+	{
+		d.insert(i, i) = 1;
+		if (i + 1 < n)
+			d.insert(i, i + 1) = 1;
+	}
+	REQUIRE(!d.isCompressed());
+	REQUIRE(pattern.matches(d));
+
+	REQUIRE(!pattern.matches(StiffnessMatrix(n + 1, n + 1)));
+
+	pattern.clear();
+	REQUIRE(!pattern.matches(a));
+}
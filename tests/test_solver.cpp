@@ -1,5 +1,6 @@
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <polyfem/State.hpp>
 #include <polyfem/quadrature/TriQuadrature.hpp>
 #include <polyfem/basis/FEBasis2d.hpp>
 
@@ -43,3 +44,109 @@ TEST_CASE("solver", "[solver]")
 	std::cout << "f in argmin " << f(x) << std::endl;
 	REQUIRE(f(x) < 1e-10);
 }
+
+TEST_CASE("newton_krylov", "[solver]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"(
+	{
+		"materials": {
+			"type": "NeoHookean",
+			"E": 20000,
+			"nu": 0.3
+		},
+
+		"geometry": [{
+			"mesh": "",
+			"enabled": true,
+			"type": "mesh",
+			"surface_selection": 7
+		}],
+
+		"space": {
+			"discr_order": 2
+		},
+
+		"boundary_conditions": {
+			"dirichlet_boundary": [{
+				"id": "all",
+				"value": [0, 0]
+			}],
+			"rhs": [1000, 1000]
+		},
+
+		"solver": {
+			"nonlinear": {
+				"grad_norm": 1e-10
+			}
+		}
+	})"_json;
+	in_args["geometry"][0]["mesh"] = path + "/contact/meshes/2D/simple/circle/circle36.obj";
+
+	const auto solve = [&](const bool matrix_free) {
+		json args = in_args;
+		args["solver"]["nonlinear"]["Newton"]["matrix_free"] = matrix_free;
+		// the Hessian is only factorized in the first iteration
+		args["solver"]["nonlinear"]["Newton"]["preconditioner_update_interval"] = 1000;
+
+		State state(1);
+		state.init_logger("", spdlog::level::warn, false);
+		state.init(args, true);
+		state.load_mesh();
+		state.solve();
+		return Eigen::MatrixXd(state.sol);
+	};
+
+	const Eigen::MatrixXd newton = solve(false);
+	const Eigen::MatrixXd newton_krylov = solve(true);
+
+	REQUIRE(newton.norm() > 0);
+	REQUIRE((newton_krylov - newton).norm() == Approx(0).margin(1e-6 * newton.norm()));
+}
+
+TEST_CASE("transient_linear_factorization", "[solver]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	json in_args = R"(
+	{
+		"materials": {
+			"type": "LinearElasticity",
+			"E": 20000,
+			"nu": 0.3,
+			"rho": 1000
+		},
+
+		"geometry": [{
+			"mesh": "",
+			"enabled": true,
+			"type": "mesh",
+			"surface_selection": 7
+		}],
+
+		"time": {
+			"tend": 1,
+			"time_steps": 4
+		},
+
+		"boundary_conditions": {
+			"dirichlet_boundary": [{
+				"id": "all",
+				"value": ["0.01 * t", 0]
+			}],
+			"rhs": [0, 100]
+		}
+	})"_json;
+	in_args["geometry"][0]["mesh"] = path + "/contact/meshes/2D/simple/circle/circle36.obj";
+
+	State state(1);
+	state.init_logger("", spdlog::level::warn, false);
+	state.init(in_args, true);
+	state.load_mesh();
+	state.solve();
+
+	// dt is constant, the system is factorized once and every step only back-substitutes
+	REQUIRE(state.timings.n_factorizations == 1);
+	REQUIRE(state.timings.time_step_solving_times.size() == 4);
+	REQUIRE(state.sol.norm() > 0);
+	REQUIRE(std::isfinite(state.sol.norm()));
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <polyfem/State.hpp>
+
+#include <limits>
+#include <memory>
+#include <string>
+
+namespace polyfem::tests
+{
+	/// @brief Arguments of the plane with a hole (plane_hole.obj) with the exact elastic problem
+	/// @param[in] material type of the material, with E = 1e5 and nu = 0.3
+	/// @param[in] discr_order discretization order, 1 is the default one
+	inline json plane_hole_args(const std::string &material, const int discr_order = 1)
+	{
+		const std::string path = POLYFEM_DATA_DIR;
+		json in_args = json({});
+		in_args["geometry"] = {};
+		in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+		in_args["geometry"]["surface_selection"] = 7;
+
+		in_args["preset_problem"] = {};
+		in_args["preset_problem"]["type"] = "ElasticExact";
+
+		if (discr_order != 1)
+		{
+			in_args["space"] = {};
+			in_args["space"]["discr_order"] = discr_order;
+		}
+
+		in_args["materials"] = {};
+		in_args["materials"]["type"] = material;
+		in_args["materials"]["E"] = 1e5;
+		in_args["materials"]["nu"] = 0.3;
+
+		return in_args;
+	}
+
+	/// @brief State of the arguments with the mesh loaded and the bases built
+	inline std::unique_ptr<State> build_state(const json &in_args, const unsigned int n_threads = std::numeric_limits<unsigned int>::max())
+	{
+		auto state = std::make_unique<State>(n_threads);
+		state->init_logger("", spdlog::level::err, false);
+		state->init(in_args, true);
+		state->load_mesh();
+		state->build_basis();
+		return state;
+	}
+
+	/// @brief State of plane_hole_args with the mesh loaded and the bases built
+	inline std::unique_ptr<State> plane_hole_state(const std::string &material, const int discr_order = 1)
+	{
+		return build_state(plane_hole_args(material, discr_order));
+	}
+} // namespace polyfem::tests
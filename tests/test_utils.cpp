@@ -1,19 +1,48 @@
 ////////////////////////////////////////////////////////////////////////////////
+#include <polyfem/State.hpp>
 #include <polyfem/utils/InterpolatedFunction.hpp>
 #include <polyfem/utils/RBFInterpolation.hpp>
 #include <polyfem/utils/Bessel.hpp>
 #include <polyfem/utils/ExpressionValue.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 #include <polyfem/io/MshReader.hpp>
 #include <polyfem/io/VTUWriter.hpp>
+#include <polyfem/io/AsyncWriter.hpp>
+#include <polyfem/io/Evaluator.hpp>
+#include <polyfem/io/InterpolationOperator.hpp>
+#include <polyfem/basis/BasisTabulation.hpp>
+#include <polyfem/io/PVDWriter.hpp>
+#include <polyfem/io/HDF5Writer.hpp>
 #include <polyfem/mesh/Mesh.hpp>
+#include <polyfem/mesh/GeometryReader.hpp>
 
 #ifdef POLYFEM_WITH_REMESHING
 #include <wmtk/TriMesh.h>
 #endif
 
+#ifdef POLYFEM_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef POLYFEM_WITH_LZ4
+#include <lz4.h>
+#endif
+
 #include <Eigen/Dense>
 
+#include "test_state.hpp"
+
 #include <catch2/catch.hpp>
+
+#include <tinyexpr.h>
+
+#include <highfive/H5File.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -102,6 +131,197 @@ TEST_CASE("expression", "[utils]")
 	REQUIRE(expr(2, 3, 4) == Approx(2. * 2. + sqrt(2. * 3.) + sin(4.) * 2.).margin(1e-10));
 	REQUIRE(expr2d(2, 3) == Approx(2. * 2. + sqrt(2. * 3.)).margin(1e-10));
 	REQUIRE(val(2, 3, 4) == Approx(1).margin(1e-16));
+
+	Eigen::MatrixXd pts(4, 3);
+	pts << 2, 3, 4,
+		1, 1, 0,
+		0.5, 2, -1,
+		3, 0.1, 2;
+	Eigen::VectorXd res;
+
+	expr.evaluate(pts, 0, res);
+	REQUIRE(res.size() == pts.rows());
+	for (int i = 0; i < pts.rows(); ++i)
+		REQUIRE(res(i) == Approx(expr(pts(i, 0), pts(i, 1), pts(i, 2))).margin(1e-10));
+
+	expr2d.evaluate(pts.leftCols(2), 0, res);
+	for (int i = 0; i < pts.rows(); ++i)
+		REQUIRE(res(i) == Approx(expr2d(pts(i, 0), pts(i, 1))).margin(1e-10));
+
+	val.evaluate(pts, 0, res);
+	REQUIRE((res.array() - 1).abs().maxCoeff() == Approx(0).margin(1e-16));
+}
+
+TEST_CASE("expression_tinyexpr", "[utils]")
+{
+	// compare with a program compiled here on every kind of node:
+	// folded constants, variables, operators, and functions of 0 to 3 arguments
+	const std::vector<std::string> exprs = {
+		"2*3+1",
+		"pi*x",
+		"-x+y*z-t/2",
+		"x^2%3",
+		"x,y",
+		"sqrt(abs(x))+exp(-y)+ln(2+z)+log10(3+t)+fac(4)",
+		"floor(x)+ceil(y)+cos(z)+tan(t)+acos(0.1*x)+asin(0.1*y)+atan(z)",
+		"pow(x,y)+atan2(y,x)+ncr(5,2)+npr(5,2)",
+		"min(x,y)+max(z,t)+deg2rad(x)+smooth_abs(y,10)",
+		"if(x-y,z,t)+rotate_2D_x(x,y,t)+rotate_2D_y(x,y,z)",
+	};
+
+	double x = 0, y = 0, z = 0, t = 0;
+	const std::vector<te_variable> vars = {
+		{"x", &x, TE_VARIABLE},
+		{"y", &y, TE_VARIABLE},
+		{"z", &z, TE_VARIABLE},
+		{"t", &t, TE_VARIABLE},
+		{"min", (const void *)static_cast<double (*)(double, double)>([](double a, double b) { return a < b ? a : b; }), TE_FUNCTION2},
+		{"max", (const void *)static_cast<double (*)(double, double)>([](double a, double b) { return a > b ? a : b; }), TE_FUNCTION2},
+		{"deg2rad", (const void *)static_cast<double (*)(double)>([](double d) { return d * M_PI / 180.0; }), TE_FUNCTION1},
+		{"rotate_2D_x", (const void *)static_cast<double (*)(double, double, double)>([](double a, double b, double th) { return a * cos(th) - b * sin(th); }), TE_FUNCTION3},
+		{"rotate_2D_y", (const void *)static_cast<double (*)(double, double, double)>([](double a, double b, double th) { return a * sin(th) + b * cos(th); }), TE_FUNCTION3},
+		{"if", (const void *)static_cast<double (*)(double, double, double)>([](double c, double a, double b) { return c >= 0 ? a : b; }), TE_FUNCTION3},
+		{"smooth_abs", (const void *)static_cast<double (*)(double, double)>([](double a, double k) { return tanh(k * a) * a; }), TE_FUNCTION2},
+	};
+
+	Eigen::MatrixXd pts(3, 3);
+	pts << 2, 3, 4,
+		-1.5, 0.5, 0.25,
+		0.3, -2, 1;
+
+	for (const std::string &str : exprs)
+	{
+		int err;
+		te_expr *reference = te_compile(str.c_str(), vars.data(), vars.size(), &err);
+		REQUIRE(reference != nullptr);
+
+		utils::ExpressionValue expr;
+		expr.init(str);
+
+		for (int i = 0; i < pts.rows(); ++i)
+		{
+			x = pts(i, 0);
+			y = pts(i, 1);
+			z = pts(i, 2);
+			t = 0.7;
+			REQUIRE(expr(x, y, z, t) == Approx(te_eval(reference)).margin(1e-12));
+		}
+
+		Eigen::VectorXd res;
+		expr.evaluate(pts, 0.7, res);
+		for (int i = 0; i < pts.rows(); ++i)
+			REQUIRE(res(i) == Approx(expr(pts(i, 0), pts(i, 1), pts(i, 2), 0.7)).margin(1e-12));
+
+		te_free(reference);
+	}
+
+	utils::ExpressionValue expr;
+	REQUIRE_THROWS(expr.init(std::string("x+*y")));
+	REQUIRE_THROWS(expr.init(std::string("unknown(x)")));
+
+	// each thread evaluates its own program, a copy shares them
+	expr.init(std::string("x*y+z-t"));
+	const utils::ExpressionValue copy = expr;
+	std::vector<std::thread> threads;
+	std::vector<int> failures(4, 0);
+	for (int k = 0; k < 4; ++k)
+	{
+		threads.emplace_back([&, k]() {
+			for (int i = 0; i < 1000; ++i)
+			{
+				const double v = k + 0.001 * i;
+				if (std::abs(copy(v, 2, 1, v) - (v + 1)) > 1e-12)
+					++failures[k];
+			}
+		});
+	}
+	for (auto &t : threads)
+		t.join();
+	REQUIRE(std::all_of(failures.begin(), failures.end(), [](int f) { return f == 0; }));
+}
+
+TEST_CASE("maybe_parallel_for", "[utils]")
+{
+	for (const int size : {0, 1, 7, 1000, 100000})
+	{
+		auto storage = create_thread_storage<long>(0);
+		maybe_parallel_for(size, [&](int start, int end, int thread_id) {
+			long &local = get_local_thread_storage(storage, thread_id);
+			for (int i = start; i < end; ++i)
+				local += i;
+		});
+
+		long sum = 0;
+		for (const long local : storage)
+			sum += local;
+		REQUIRE(sum == long(size) * (size - 1) / 2);
+
+		std::vector<int> visited(size, 0);
+		maybe_parallel_for(size, [&](int i) { ++visited[i]; });
+		REQUIRE(std::all_of(visited.begin(), visited.end(), [](int v) { return v == 1; }));
+	}
+}
+
+#ifdef POLYFEM_WITH_CPP_THREADS
+TEST_CASE("thread_storage_reuse", "[utils]")
+{
+	struct LocalStorage
+	{
+		std::vector<double> values;
+	};
+
+	const auto total = [](const ThreadStorage<LocalStorage> &storage, const bool capacity) {
+		size_t n = 0;
+		for (const LocalStorage &local : storage)
+			n += capacity ? local.values.capacity() : local.values.size();
+		return n;
+	};
+
+	for (int call = 0; call < 3; ++call)
+	{
+		auto storage = create_thread_storage(LocalStorage());
+		REQUIRE(storage.size() == get_n_threads());
+		// the storage of the previous call is handed out again, reset to the initial value but keeping its memory
+		REQUIRE(total(storage, false) == 0);
+		if (call > 0)
+			CHECK(total(storage, true) >= 1000);
+
+		maybe_parallel_for(1000, [&](int start, int end, int thread_id) {
+			LocalStorage &local = get_local_thread_storage(storage, thread_id);
+			for (int i = start; i < end; ++i)
+				local.values.push_back(i);
+		});
+		REQUIRE(total(storage, false) == 1000);
+	}
+}
+#endif
+
+TEST_CASE("maybe_parallel_for_concurrent", "[utils]")
+{
+	// independent callers do not wait for each other, each loop uses its own storage
+	std::vector<long> sums(4, 0);
+	std::vector<std::thread> threads;
+	for (int k = 0; k < 4; ++k)
+	{
+		threads.emplace_back([&, k]() {
+			for (int call = 0; call < 20; ++call)
+			{
+				auto storage = create_thread_storage<long>(0);
+				maybe_parallel_for(10000, [&](int start, int end, int thread_id) {
+					long &local = get_local_thread_storage(storage, thread_id);
+					for (int i = start; i < end; ++i)
+						local += i;
+				});
+				for (const long local : storage)
+					sums[k] += local;
+			}
+		});
+	}
+	for (auto &t : threads)
+		t.join();
+
+	for (const long sum : sums)
+		REQUIRE(sum == 20 * (10000L * 9999 / 2));
 }
 
 TEST_CASE("mshreader", "[utils]")
@@ -113,6 +333,35 @@ TEST_CASE("mshreader", "[utils]")
 	REQUIRE(mesh);
 }
 
+TEST_CASE("in_memory_mesh", "[utils]")
+{
+	Eigen::MatrixXd V(4, 2);
+	V << 0, 0, 1, 0, 1, 1, 0, 1;
+	Eigen::MatrixXi F(2, 3);
+	F << 0, 1, 2, 0, 2, 3;
+
+	json in_args = json({});
+	in_args["geometry"] = json::array({{{"mesh", "square.obj"}, {"n_refs", 1}, {"volume_selection", 3}, {"transformation", {{"translation", {1, 0}}}}}});
+	in_args["materials"] = {{"type", "LinearElasticity"}, {"E", 1e5}, {"nu", 0.3}};
+
+	State state;
+	state.init_logger("", spdlog::level::err, false);
+	state.init(in_args, true);
+
+	// the name is matched before the file system, the rest of the geometry is processed as for a file
+	state.load_mesh(/*non_conforming=*/false, {"square.obj"}, {F}, {V});
+	REQUIRE(state.mesh);
+	REQUIRE(state.mesh->n_elements() == 8);
+	REQUIRE(state.mesh->get_body_id(0) == 3);
+	RowVectorNd min, max;
+	state.mesh->bounding_box(min, max);
+	REQUIRE(min(0) == Approx(1));
+	REQUIRE(max(0) == Approx(2));
+
+	// unknown names are still read from a file
+	REQUIRE_THROWS(read_fem_geometry(state.args["geometry"], "", {"other.obj"}, {V}, {F}));
+}
+
 TEST_CASE("vtu_writer", "[utils]")
 {
 	Eigen::MatrixXd pts(25, 3);
@@ -136,6 +385,409 @@ TEST_CASE("vtu_writer", "[utils]")
 	writer.write_mesh("test.vtu", pts, tris);
 }
 
+TEST_CASE("vtu_writer_compression", "[utils]")
+{
+	const auto read = [](const std::string &path) {
+		std::ifstream in(path);
+		std::stringstream ss;
+		ss << in.rdbuf();
+		return ss.str();
+	};
+
+	const int n = 10000;
+	Eigen::MatrixXd pts(n, 2);
+	Eigen::MatrixXd v(n, 2);
+	Eigen::MatrixXi edges(n - 1, 2);
+	for (int i = 0; i < n; ++i)
+	{
+		pts.row(i) << i, 0;
+		v.row(i) << i * 0.5, 1;
+		if (i < n - 1)
+			edges.row(i) << i, i + 1;
+	}
+
+	REQUIRE(VTUWriter::compression_from_string("none") == VTKCompression::None);
+	REQUIRE(VTUWriter::compression_from_string("zlib") == VTKCompression::ZLib);
+	REQUIRE(VTUWriter::compression_from_string("lz4") == VTKCompression::LZ4);
+	REQUIRE_THROWS(VTUWriter::compression_from_string("gzip"));
+
+	VTUWriter raw;
+	raw.add_field("test", v);
+	raw.write_mesh("test_raw.vtu", pts, edges);
+	const std::string raw_file = read("test_raw.vtu");
+	REQUIRE(raw_file.find("compressor=") == std::string::npos);
+
+	for (const auto &[compression, name] : {std::make_pair(VTKCompression::ZLib, "vtkZLibDataCompressor"), std::make_pair(VTKCompression::LZ4, "vtkLZ4DataCompressor")})
+	{
+		if (!VTUWriter::is_compression_available(compression))
+			continue;
+
+		VTUWriter writer(true, compression, true);
+		writer.add_field("test", v);
+		writer.write_mesh("test_compressed.vtu", pts, edges);
+
+		const std::string file = read("test_compressed.vtu");
+		CHECK(file.find("compressor=\"" + std::string(name) + "\"") != std::string::npos);
+		CHECK(file.find("<DataArray type=\"Float32\" Name=\"test\"") != std::string::npos);
+		CHECK(file.size() < raw_file.size() / 2);
+	}
+
+	// round trip of the payload of the arrays, empty, exactly one block, and several blocks with a partial last one
+	const auto decode_base64 = [](const std::string &str, const size_t start, const size_t n_chars) {
+		const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		REQUIRE(n_chars % 4 == 0);
+		std::vector<char> out;
+		for (size_t i = start; i < start + n_chars; i += 4)
+		{
+			uint32_t group = 0;
+			int n_padding = 0;
+			for (int k = 0; k < 4; ++k)
+			{
+				const char c = str[i + k];
+				group <<= 6;
+				if (c == '=')
+					++n_padding;
+				else
+				{
+					REQUIRE(alphabet.find(c) != std::string::npos);
+					group |= uint32_t(alphabet.find(c));
+				}
+			}
+			for (int k = 0; k < 3 - n_padding; ++k)
+				out.push_back(char((group >> (16 - 8 * k)) & 0xFF));
+		}
+		return out;
+	};
+	const auto encoded_length = [](const size_t n_bytes) { return 4 * ((n_bytes + 2) / 3); };
+	const size_t block_size = 32768;
+
+	for (const size_t n_bytes : {size_t(0), block_size, 3 * block_size + 1000})
+	{
+		std::vector<char> data(n_bytes);
+		for (size_t i = 0; i < n_bytes; ++i)
+			data[i] = char((i / 7) % 23);
+
+		{
+			std::stringstream ss;
+			write_binary_data(ss, data.data(), n_bytes, VTKCompression::None);
+			const std::string payload = ss.str();
+			REQUIRE(payload.size() == encoded_length(sizeof(uint64_t) + n_bytes));
+			const std::vector<char> decoded = decode_base64(payload, 0, payload.size());
+			uint64_t size;
+			std::memcpy(&size, decoded.data(), sizeof(uint64_t));
+			CHECK(size == n_bytes);
+			CHECK(std::equal(data.begin(), data.end(), decoded.begin() + sizeof(uint64_t)));
+		}
+
+		for (const VTKCompression compression : {VTKCompression::ZLib, VTKCompression::LZ4})
+		{
+			if (!VTUWriter::is_compression_available(compression))
+				continue;
+
+			std::stringstream ss;
+			write_binary_data(ss, data.data(), n_bytes, compression);
+			const std::string payload = ss.str();
+
+			// [#blocks, block size, last block size] are the first 24 bytes (32 characters) of the header
+			std::vector<uint64_t> header(3);
+			REQUIRE(payload.size() >= 32);
+			std::memcpy(header.data(), decode_base64(payload, 0, 32).data(), 3 * sizeof(uint64_t));
+			const size_t n_blocks = (n_bytes + block_size - 1) / block_size;
+			REQUIRE(header[0] == n_blocks);
+			CHECK(header[1] == block_size);
+			CHECK(header[2] == n_bytes % block_size);
+
+			// the header and the blocks are separate base64 sequences
+			const size_t header_length = encoded_length((3 + n_blocks) * sizeof(uint64_t));
+			REQUIRE(payload.size() >= header_length);
+			header.resize(3 + n_blocks);
+			std::memcpy(header.data(), decode_base64(payload, 0, header_length).data(), header.size() * sizeof(uint64_t));
+			const std::vector<char> blocks = decode_base64(payload, header_length, payload.size() - header_length);
+
+			std::vector<char> decompressed;
+			size_t offset = 0;
+			for (size_t b = 0; b < n_blocks; ++b)
+			{
+				const size_t compressed_size = header[3 + b];
+				const size_t size = (b + 1 == n_blocks && header[2] != 0) ? header[2] : header[1];
+				REQUIRE(offset + compressed_size <= blocks.size());
+
+				std::vector<char> block(size);
+				if (compression == VTKCompression::ZLib)
+				{
+#ifdef POLYFEM_WITH_ZLIB
+					uLongf out_size = size;
+					REQUIRE(uncompress(reinterpret_cast<Bytef *>(block.data()), &out_size, reinterpret_cast<const Bytef *>(&blocks[offset]), compressed_size) == Z_OK);
+					CHECK(out_size == size);
+#endif
+				}
+				else
+				{
+#ifdef POLYFEM_WITH_LZ4
+					CHECK(LZ4_decompress_safe(&blocks[offset], block.data(), int(compressed_size), int(size)) == int(size));
+#endif
+				}
+				decompressed.insert(decompressed.end(), block.begin(), block.end());
+				offset += compressed_size;
+			}
+			CHECK(offset == blocks.size());
+			CHECK(decompressed == data);
+		}
+	}
+}
+
+TEST_CASE("pvd_writer", "[utils]")
+{
+	const auto read = [](const std::string &path) {
+		std::ifstream in(path);
+		std::stringstream ss;
+		ss << in.rdbuf();
+		return ss.str();
+	};
+	const auto count = [](const std::string &str, const std::string &pattern) {
+		int n = 0;
+		for (size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + 1))
+			++n;
+		return n;
+	};
+	const std::string footer = "    </Collection>\n</VTKFile>\n";
+
+	{
+		PVDWriter writer("test.pvd");
+		REQUIRE(writer.good());
+		REQUIRE(writer.size() == 0);
+		REQUIRE(count(read("test.pvd"), footer) == 1);
+
+		// the collection is complete after every frame
+		for (int i = 0; i < 20; ++i)
+		{
+			REQUIRE(writer.add_dataset(i * 0.5, fmt::format("step_{:d}.vtm", i)));
+			const std::string content = read("test.pvd");
+			REQUIRE(content.size() >= footer.size());
+			REQUIRE(content.substr(content.size() - footer.size()) == footer);
+			REQUIRE(count(content, footer) == 1);
+			REQUIRE(count(content, "<DataSet ") == i + 1);
+		}
+		REQUIRE(writer.size() == 20);
+
+		const std::string content = read("test.pvd");
+		REQUIRE(count(content, "timestep=\"9.5\" group=\"\" part=\"0\" file=\"step_19.vtm\"") == 1);
+		REQUIRE(count(content, "compressor") == 0);
+	}
+
+	// a new writer starts a new collection
+	PVDWriter writer("test.pvd");
+	REQUIRE(writer.add_dataset(0, "a&b.vtm"));
+	const std::string content = read("test.pvd");
+	REQUIRE(count(content, "<DataSet ") == 1);
+	REQUIRE(count(content, "file=\"a&amp;b.vtm\"") == 1);
+}
+
+TEST_CASE("hdf5_writer", "[utils]")
+{
+	const auto read = [](const std::string &path) {
+		std::ifstream in(path);
+		std::stringstream ss;
+		ss << in.rdbuf();
+		return ss.str();
+	};
+	const auto count = [](const std::string &str, const std::string &pattern) {
+		int n = 0;
+		for (size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + 1))
+			++n;
+		return n;
+	};
+	const std::string footer = "    </Grid>\n  </Domain>\n</Xdmf>\n";
+
+	Eigen::MatrixXd points(5, 3);
+	points << 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 1;
+	Eigen::MatrixXi tets(2, 4);
+	tets << 0, 1, 2, 3, 1, 2, 3, 4;
+
+	{
+		HDF5Writer writer("test.hdf5", 4);
+		writer.write_mesh("volume", points, tets);
+		REQUIRE(writer.has_mesh("volume"));
+		REQUIRE(!writer.has_mesh("contact"));
+
+		// the XDMF file is complete after every step
+		for (int i = 0; i < 3; ++i)
+		{
+			writer.begin_time_step(i * 0.5);
+			writer.add_field("volume", "solution", Eigen::MatrixXd::Constant(5, 3, i));
+			writer.add_field("volume", "scalar_value", Eigen::MatrixXd::Constant(5, 1, i));
+			writer.end_time_step();
+
+			const std::string content = read("test.xdmf");
+			REQUIRE(content.size() >= footer.size());
+			REQUIRE(content.substr(content.size() - footer.size()) == footer);
+			REQUIRE(count(content, footer) == 1);
+			REQUIRE(count(content, "<Time ") == i + 1);
+		}
+		REQUIRE(writer.n_time_steps() == 3);
+
+		// the size of a field is fixed, the failure aborts the step and drops the fields already written in it
+		writer.begin_time_step(1.5);
+		writer.add_field("volume", "solution", Eigen::MatrixXd::Constant(5, 3, -1));
+		REQUIRE_THROWS(writer.add_field("volume", "scalar_value", Eigen::MatrixXd::Zero(5, 2)));
+		REQUIRE(writer.n_time_steps() == 3);
+
+		// the next step takes its place
+		writer.begin_time_step(2);
+		writer.add_field("volume", "solution", Eigen::MatrixXd::Constant(5, 3, 3));
+		writer.end_time_step();
+		REQUIRE(writer.n_time_steps() == 4);
+
+		writer.write_matrix("/raw/u", Eigen::MatrixXd::Zero(15, 1));
+		writer.write_matrix("/raw/u", Eigen::MatrixXd::Ones(15, 1));
+	}
+
+	const std::string content = read("test.xdmf");
+	REQUIRE(count(content, "test.hdf5:/volume/points") == 4);
+	REQUIRE(count(content, "test.hdf5:/volume/fields/solution") == 4);
+	REQUIRE(count(content, "<Time Value=\"1\"/>") == 1);
+	REQUIRE(count(content, "<Time Value=\"1.5\"/>") == 0);
+
+	HighFive::File file("test.hdf5", HighFive::File::ReadOnly);
+	std::vector<double> time;
+	file.getDataSet("/time").read(time);
+	// one entry per step written, the aborted one is not in the time series
+	REQUIRE(time == std::vector<double>{0, 0.5, 1, 2});
+
+	REQUIRE(file.getDataSet("/volume/points").getDimensions() == std::vector<size_t>{5, 3});
+	REQUIRE(file.getDataSet("/volume/cells").getDimensions() == std::vector<size_t>{2, 4});
+
+	std::vector<std::vector<std::vector<double>>> solution;
+	file.getDataSet("/volume/fields/solution").read(solution);
+	// the step that failed was not appended to the field
+	REQUIRE(solution.size() == time.size());
+	for (int i = 0; i < 4; ++i)
+	{
+		REQUIRE(solution[i].size() == 5);
+		REQUIRE(solution[i][4].size() == 3);
+		REQUIRE(solution[i][4][2] == i);
+	}
+
+	std::vector<std::vector<double>> u;
+	file.getDataSet("/raw/u").read(u);
+	REQUIRE(u.size() == 15);
+	REQUIRE(u[0][0] == 1);
+}
+
+TEST_CASE("async_writer", "[utils]")
+{
+	std::vector<int> written;
+	std::atomic<int> pending(0);
+	std::atomic<int> max_pending(0);
+	{
+		AsyncWriter writer(2);
+		for (int i = 0; i < 20; ++i)
+		{
+			const int p = ++pending;
+			max_pending = std::max(max_pending.load(), p);
+			writer.push([&, i]() {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				written.push_back(i);
+				--pending;
+			});
+		}
+
+		writer.flush();
+		REQUIRE(pending == 0);
+		REQUIRE(written.size() == 20);
+
+		// the tasks still queued are written before the writer is destroyed
+		for (int i = 20; i < 25; ++i)
+			writer.push([&, i]() { written.push_back(i); });
+	}
+
+	// tasks run in order, at most 2 tasks wait while one is written and one is being pushed
+	REQUIRE(written.size() == 25);
+	for (int i = 0; i < 25; ++i)
+		REQUIRE(written[i] == i);
+	REQUIRE(max_pending <= 4);
+}
+
+TEST_CASE("async_writer_errors", "[utils]")
+{
+	std::vector<int> written;
+	AsyncWriter writer(2);
+
+	// the first error is rethrown once, the tasks after it are still written
+	writer.push([]() { throw std::runtime_error("first"); });
+	writer.push([]() { throw std::runtime_error("second"); });
+	writer.push([&]() { written.push_back(0); });
+	REQUIRE_THROWS_WITH(writer.flush(), "first");
+	REQUIRE(written.size() == 1);
+	REQUIRE_NOTHROW(writer.flush());
+
+	writer.push([]() { throw std::runtime_error("third"); });
+	REQUIRE_THROWS_WITH(writer.close(), "third");
+	REQUIRE_NOTHROW(writer.close());
+}
+
+TEST_CASE("interpolation_operator", "[utils]")
+{
+	const auto state_ptr = tests::plane_hole_state("LinearElasticity", 2);
+	State &state = *state_ptr;
+
+	const Mesh &mesh = *state.mesh;
+	const int dim = mesh.dimension();
+	const int n_el = int(state.bases.size());
+
+	RefElementSampler sampler;
+	sampler.init(mesh.is_volume(), mesh.n_elements(), 0.1);
+	const Eigen::MatrixXd &ref_pts = sampler.simplex_points();
+	const int n_loc = int(ref_pts.rows());
+
+	// the sampler points of every element, as the visualization mesh
+	Eigen::VectorXi el_id(n_el * n_loc);
+	Eigen::MatrixXd local_pts(n_el * n_loc, dim);
+	for (int e = 0; e < n_el; ++e)
+	{
+		REQUIRE(mesh.is_simplex(e));
+		el_id.segment(e * n_loc, n_loc).setConstant(e);
+		local_pts.middleRows(e * n_loc, n_loc) = ref_pts;
+	}
+
+	InterpolationOperator op;
+	op.init(mesh.is_volume(), state.n_bases, state.bases, state.geom_bases(), el_id, local_pts, true);
+	REQUIRE(op.n_points() == n_el * n_loc);
+	REQUIRE(op.n_bases() == state.n_bases);
+	REQUIRE(op.has_grad());
+
+	const Eigen::MatrixXd fun = Eigen::MatrixXd::Random(state.n_bases * dim, 1);
+
+	Eigen::MatrixXd res, expected;
+	op.interpolate(fun, dim, res);
+	Evaluator::interpolate_function(
+		mesh, dim, state.bases, state.disc_orders, state.polys, state.polys_3d,
+		sampler, n_el * n_loc, fun, expected, /*use_sampler*/ true, /*boundary_only*/ false);
+	REQUIRE(res.rows() == expected.rows());
+	REQUIRE(res.cols() == dim);
+	REQUIRE((res - expected).norm() == Approx(0).margin(1e-10));
+
+	Eigen::MatrixXd grad, val, expected_grad;
+	op.interpolate_grad(fun, dim, grad);
+	REQUIRE(grad.cols() == dim * dim);
+	for (int e = 0; e < n_el; ++e)
+	{
+		Evaluator::interpolate_at_local_vals(
+			mesh, dim, state.bases, state.geom_bases(), e, ref_pts, fun, val, expected_grad);
+		REQUIRE((grad.middleRows(e * n_loc, n_loc) - expected_grad).norm() == Approx(0).margin(1e-8));
+	}
+
+	// points outside of the mesh are interpolated as zero, the sampler points do not go to the quadrature cache
+	const size_t n_cached_tabulations = basis::BasisTabulation::cache_size();
+	el_id.head(n_loc).setConstant(-1);
+	op.init(mesh.is_volume(), state.n_bases, state.bases, state.geom_bases(), el_id, local_pts, false);
+	REQUIRE(!op.has_grad());
+	REQUIRE(basis::BasisTabulation::cache_size() == n_cached_tabulations);
+	op.interpolate(fun, dim, res);
+	REQUIRE(res.topRows(n_loc).norm() == 0);
+	REQUIRE((res.bottomRows(res.rows() - n_loc) - expected.bottomRows(res.rows() - n_loc)).norm() == Approx(0).margin(1e-10));
+}
+
 #ifdef POLYFEM_WITH_REMESHING
 TEST_CASE("wmtk_instatiation", "[utils]")
 {